@@ -3,10 +3,16 @@
 require "bigdecimal"
 require "bigdecimal/util"
 
+begin
+  # Нативний міст до firmware/common/silken_attractor.c (той самий код, що на Солдаті).
+  require File.expand_path("../../../ext/silken_attractor/silken_attractor", __dir__)
+rescue LoadError
+  # Розширення не скомпільоване — працює біт-ідентичний Ruby-порт нижче.
+end
+
 module SilkenNet
   class Attractor
-    # Використовуємо BigDecimal для абсолютної крос-платформної детермінованості
-    # Це гарантує, що Slashing-вирок буде однаковим на будь-якому процесорі.
+    # Канонічні константи Лоренца (для Oracle/Chainlink payload та документації).
     BASE_SIGMA = "10.0".to_d
     BASE_RHO   = "28.0".to_d
     BASE_BETA  = ("8.0".to_d / "3.0".to_d).round(18)
@@ -19,30 +25,41 @@ module SilkenNet
     SIGMA_LIMITS = (5.0..30.0)
     RHO_LIMITS   = (10.0..50.0)
 
-    # Кількість значущих цифр для BigDecimal (запобігає експоненційному росту).
-    # 18 цифр точності достатньо для "Юридичної Точності" Web3-аудиту,
-    # при цьому час обчислення залишається O(n) а не O(2^n).
-    PRECISION = 18
+    # = :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    # ФІКСОВАНА КОМА Q16.16 (firmware/common/silken_attractor.h)
+    # [СИНХРОНІЗОВАНО з прошивкою]: інтеграція ведеться в цілих числах, тому
+    # вирок сервера збігається з вироком Солдата біт у біт. BigDecimal-версія
+    # (250 округлень на пакет) була і повільною, і несумісною з mruby float.
+    # = :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    Q_BITS        = 16
+    ONE_Q         = 1 << Q_BITS
+    BASE_SIGMA_Q  = 10 * ONE_Q
+    BASE_RHO_Q    = 28 * ONE_Q
+    BETA_Q        = 174_763 # round(8/3 * 65536)
+    DT_Q          = 655     # 0.01 * 65536 → 655 (0.0099945)
+    SIGMA_MIN_Q   = SIGMA_LIMITS.min.to_i * ONE_Q
+    SIGMA_MAX_Q   = SIGMA_LIMITS.max.to_i * ONE_Q
+    RHO_MIN_Q     = RHO_LIMITS.min.to_i * ONE_Q
+    RHO_MAX_Q     = RHO_LIMITS.max.to_i * ONE_Q
+    STATE_LIMIT_Q = 1000 * ONE_Q
+
+    INT32_RANGE = (-(2**31)..(2**31 - 1))
 
     # = :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
     # МЕТОД ДЛЯ БЕКЕНДУ (Розрахунок стабільності)
     # = :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
     def self.calculate_z(seed, temp, acoustic)
-      x, y, z, local_sigma, local_rho = initialize_state(seed, temp, acoustic)
-
-      # Обчислення в BigDecimal дають "Юридичну Точність" для Web3-аудиту.
-      # round(PRECISION) після кожної ітерації запобігає необмеженому росту цифр.
-      ITERATIONS.times do
-        dx = local_sigma * (y - x)
-        dy = x * (local_rho - z) - y
-        dz = (x * y) - (BASE_BETA * z)
+      from_q16(calculate_z_q16(seed, temp, acoustic))
+    end
 
-        x = (x + dx * DT).round(PRECISION)
-        y = (y + dy * DT).round(PRECISION)
-        z = (z + dz * DT).round(PRECISION)
-      end
+    # Сирий Z у Q16.16 — саме те ціле число, яке бачить mruby-контракт на Солдаті.
+    def self.calculate_z_q16(seed, temp, acoustic)
+      seed, temp, acoustic = normalize_inputs(seed, temp, acoustic)
+      return ::SilkenAttractor.z_q16(seed, temp, acoustic) if native?
 
-      z.to_f.round(4)
+      x, y, z, sigma, rho = initialize_state(seed, temp, acoustic)
+      ITERATIONS.times { x, y, z = step(x, y, z, sigma, rho) }
+      z
     end
 
     def self.homeostatic?(z_value, tree_family)
@@ -56,41 +73,75 @@ module SilkenNet
     # ідеально для Float32Array у JavaScript (Three.js/Deck.gl).
     # = :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
     def self.generate_trajectory(seed, temp, acoustic)
-      x, y, z, local_sigma, local_rho = initialize_state(seed, temp, acoustic)
+      seed, temp, acoustic = normalize_inputs(seed, temp, acoustic)
 
       # Результат: [x1, y1, z1, x2, y2, z2, ...]
-      Array.new(ITERATIONS * 3) do |i|
-        if i % 3 == 0 && i > 0
-          # Крок ітерації виконується кожні 3 значення
-          dx = local_sigma * (y - x)
-          dy = x * (local_rho - z) - y
-          dz = (x * y) - (BASE_BETA * z)
-
-          x = (x + dx * DT).round(PRECISION)
-          y = (y + dy * DT).round(PRECISION)
-          z = (z + dz * DT).round(PRECISION)
-        end
-
-        case i % 3
-        when 0 then x.to_f.round(4)
-        when 1 then y.to_f.round(4)
-        when 2 then z.to_f.round(4)
-        end
-      end
+      trajectory_q16(seed, temp, acoustic).map { |v| from_q16(v) }
+    end
+
+    def self.native?
+      defined?(::SilkenAttractor) ? true : false
+    end
+
+    private_class_method def self.trajectory_q16(seed, temp, acoustic)
+      return ::SilkenAttractor.trajectory_q16(seed, temp, acoustic, ITERATIONS) if native?
+
+      x, y, z, sigma, rho = initialize_state(seed, temp, acoustic)
+      Array.new(ITERATIONS) do |i|
+        # Перша трійка — початковий стан, далі один крок Ейлера на трійку
+        x, y, z = step(x, y, z, sigma, rho) if i > 0
+        [ x, y, z ]
+      end.flatten
     end
 
     private_class_method def self.initialize_state(seed, temp, acoustic)
-      # Початкові координати (насіння) з використанням DID
-      x = (((seed % 1000) / 500.0) - 1.0).to_d
-      y = ((((seed >> 4) % 1000) / 500.0) - 1.0).to_d
-      z = ((((seed >> 8) % 1000) / 500.0) - 1.0).to_d
+      # Початкові координати (насіння): ((seed % 1000) / 500.0) - 1.0
+      x = ((seed % 1000) << Q_BITS) / 500 - ONE_Q
+      y = (((seed >> 4) % 1000) << Q_BITS) / 500 - ONE_Q
+      z = (((seed >> 8) % 1000) << Q_BITS) / 500 - ONE_Q
 
       # [СЕРЕДОВИЩНИЙ ЗАПОБІЖНИК]: Clamp запобігає вильоту в нескінченність
       # навіть якщо дерево горить (temp > 100) або датчик видає шум.
-      local_sigma = (BASE_SIGMA + (acoustic.to_d * "0.1".to_d)).clamp(SIGMA_LIMITS.min, SIGMA_LIMITS.max)
-      local_rho   = (BASE_RHO + (temp.to_d * "0.2".to_d)).clamp(RHO_LIMITS.min, RHO_LIMITS.max)
+      sigma = (BASE_SIGMA_Q + div_trunc(acoustic * ONE_Q, 10)).clamp(SIGMA_MIN_Q, SIGMA_MAX_Q)
+      rho   = (BASE_RHO_Q + div_trunc(temp * 2 * ONE_Q, 10)).clamp(RHO_MIN_Q, RHO_MAX_Q)
+
+      [ x, y, z, sigma, rho ]
+    end
+
+    private_class_method def self.step(x, y, z, sigma, rho)
+      dx = mul_q16(sigma, y - x)
+      dy = mul_q16(x, rho - z) - y
+      dz = mul_q16(x, y) - mul_q16(BETA_Q, z)
+
+      [
+        (x + mul_q16(dx, DT_Q)).clamp(-STATE_LIMIT_Q, STATE_LIMIT_Q),
+        (y + mul_q16(dy, DT_Q)).clamp(-STATE_LIMIT_Q, STATE_LIMIT_Q),
+        (z + mul_q16(dz, DT_Q)).clamp(-STATE_LIMIT_Q, STATE_LIMIT_Q)
+      ]
+    end
+
+    # Integer#>> — floor, як арифметичний зсув int64 у C
+    private_class_method def self.mul_q16(a, b)
+      (a * b) >> Q_BITS
+    end
+
+    # Відкидання дробу до нуля, як `/` у C (Ruby `/` — floor)
+    private_class_method def self.div_trunc(num, den)
+      num >= 0 ? num / den : -(-num / den)
+    end
+
+    private_class_method def self.from_q16(value)
+      (value.to_f / ONE_Q).round(4)
+    end
 
-      [ x, y, z, local_sigma, local_rho ]
+    # Пейлоад несе uint32 DID, int8 температуру та лічильник подій —
+    # приводимо вхід сервера (Float після калібрування) до тих самих типів.
+    private_class_method def self.normalize_inputs(seed, temp, acoustic)
+      [
+        seed.to_i & 0xFFFF_FFFF,
+        temp.round.clamp(INT32_RANGE),
+        acoustic.to_i.clamp(INT32_RANGE)
+      ]
     end
   end
 end
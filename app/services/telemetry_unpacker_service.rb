@@ -8,6 +8,9 @@ class TelemetryUnpackerService < ApplicationService
   # Формат: DID(N), Vcap(n), Temp(c), Acoustic(C), Metabolism(n), Status(C), TTL(C), Pad(a4)
   PAYLOAD_FORMAT = "N n c C n C C a4"
   FIRMWARE_PAD_INDEX = 7 # Індекс елемента a4 у розпакованому масиві
+  # Байт TTL: [Hop:4 | TTL:4] — старший ніббл пише градієнтна маршрутизація
+  # (firmware/common/silken_route.h), це hop останнього передавача, а не дерева
+  MESH_TTL_MASK = 0x0F
 
   # --- МЕЖІ РЕАЛЬНОСТІ (Sanity Bounds) ---
   # Виключаємо сенсорний шум: ADC глюки, що виходять за межі фізики
@@ -17,6 +20,23 @@ class TelemetryUnpackerService < ApplicationService
   # DID-сентинел: Королева передає власну телеметрію з DID = 0x00000000
   QUEEN_SENTINEL_DID = "0"
 
+  # --- ДІАГНОСТИЧНІ КАДРИ (firmware/common/silken_diag.h) ---
+  # Байт 15 пейлоада: 0 — телеметрія, інакше тип діагностичного кадру.
+  FRAME_TYPE_OFFSET = 15
+  FRAME_TYPE_DIAG_HEAP = 0xD1
+  # DID(N), Peak(n), Carved(n), Allocs(n), GC runs(C), TTL(C), FW(n), Failed(C), Type(C)
+  DIAG_HEAP_FORMAT = "N n n n C C n C C"
+  FRAME_TYPE_DIAG_PROFILE = 0xD2
+  # DID(N), Phase(C), Min(n), Max(n), EWMA(n), TTL(C), FW(n), Count(C), Type(C); час у тіках по 16 мкс
+  DIAG_PROFILE_FORMAT = "N C n n n C n C C"
+  DIAG_PROFILE_TICK_US = 16
+  DIAG_PROFILE_PHASES = %w[acquire tinyml mruby tx rx flush].freeze
+  FRAME_TYPE_DIAG_RADIO = 0xD3
+  # DID(N), CAD runs(n), CAD busy(n), Backoff(n), Forced TX(C), TTL(C), FW(n), Max attempt(C), Type(C);
+  # backoff у одиницях по 100 мс
+  DIAG_RADIO_FORMAT = "N n n n C C n C C"
+  DIAG_RADIO_BACKOFF_UNIT_MS = 100
+
   def initialize(binary_batch, gateway_id = nil)
     @binary_batch = binary_batch
     @gateway = Gateway.find_by(id: gateway_id)
@@ -61,6 +81,14 @@ class TelemetryUnpackerService < ApplicationService
 
     # 2. РОЗПАКОВКА БІО-МЕТРИКИ (L3 Payload)
     payload = chunk[5..20]
+
+    # [ДІАГНОСТИКА]: Службовий кадр Солдата — не біометрика, TelemetryLog не створюємо
+    frame_type = payload.getbyte(FRAME_TYPE_OFFSET)
+    unless frame_type.zero?
+      route_diagnostics(hex_did, frame_type, payload)
+      return
+    end
+
     parsed_data = payload.unpack(PAYLOAD_FORMAT)
 
     # [СЕНТИНЕЛ]: DID = 0x00000000 — це "нульовий" пакет Королеви з її власною телеметрією.
@@ -102,15 +130,15 @@ class TelemetryUnpackerService < ApplicationService
       acoustic_events: parsed_data[3],
       metabolism_s: parsed_data[4],
       growth_points: status_byte & 0x3F, # Нижні 6 біт — бали росту
-      mesh_ttl: parsed_data[6],
+      mesh_ttl: parsed_data[6] & MESH_TTL_MASK,
       firmware_version_id: (firmware_id.positive? ? firmware_id : nil),
       bio_status: interpret_status(status_byte >> 6) # Верхні 2 біти — статус
     }
 
     # 4. МАТЕМАТИКА АТРАКТОРА (The Chaos Engine)
     # ⚡ [ФІКСАЦІЯ ІСТИНИ]: Ми розраховуємо Z один раз тут.
-    # Оскільки Attractor тепер використовує BigDecimal, ми отримуємо
-    # детермінований результат, який зберігається як єдина істина.
+    # Attractor рахує у фіксованій комі Q16.16 тим самим C-кодом, що й Солдат,
+    # тож результат детермінований і зберігається як єдина істина.
     log_attributes[:z_value] = SilkenNet::Attractor.calculate_z(
       parsed_data[0], # Використовуємо сирий DID як seed
       log_attributes[:temperature_c],
@@ -234,4 +262,35 @@ class TelemetryUnpackerService < ApplicationService
     )
     Rails.logger.info "👑 [Sentinel] Королева #{@gateway.uid} повідомляє: #{parsed_data[1]}mV, #{parsed_data[2]}°C, CSQ=#{parsed_data[3]}"
   end
+
+  # [ДІАГНОСТИКА СОЛДАТА]: Запас купи mruby для кожної версії контракту.
+  # Невідомі типи лише рахуємо — старий сервер не падає на новій прошивці.
+  def route_diagnostics(hex_did, frame_type, payload)
+    SilkenNet::Metrics::TELEMETRY_DIAGNOSTICS_TOTAL.increment(labels: { frame_type: format("0x%02X", frame_type) })
+    return log_profile_frame(hex_did, payload) if frame_type == FRAME_TYPE_DIAG_PROFILE
+    return log_radio_frame(hex_did, payload) if frame_type == FRAME_TYPE_DIAG_RADIO
+    return unless frame_type == FRAME_TYPE_DIAG_HEAP
+
+    _did, peak, carved, allocs, gc_runs, _ttl, firmware_id, failed, = payload.unpack(DIAG_HEAP_FORMAT)
+    Rails.logger.info "🧠 [Heap] Дерево #{hex_did} (FW #{firmware_id}): пік #{peak}B, нарізано #{carved}B, " \
+                      "алокацій #{allocs}, GC #{gc_runs}, відмов #{failed}"
+  end
+
+  # Тривалість однієї фази циклу вузла (firmware/common/silken_prof.h). DID = 0 — Королева.
+  def log_profile_frame(hex_did, payload)
+    _did, phase, min_t, max_t, ewma_t, _ttl, firmware_id, count, = payload.unpack(DIAG_PROFILE_FORMAT)
+    name = DIAG_PROFILE_PHASES.fetch(phase, "phase_#{phase}")
+    min_us, max_us, ewma_us = [ min_t, max_t, ewma_t ].map { |ticks| ticks * DIAG_PROFILE_TICK_US }
+    Rails.logger.info "⏱️ [Profile] Вузол #{hex_did} (FW #{firmware_id}): #{name} — min #{min_us}µs, " \
+                      "max #{max_us}µs, EWMA #{ewma_us}µs, замірів #{count}"
+  end
+
+  # Конкуренція за ефір навколо Солдата (firmware/common/silken_lbt.h).
+  # Лічильники CAD — молодші 16 біт: дивимось на приріст між кадрами.
+  def log_radio_frame(hex_did, payload)
+    _did, cad_runs, cad_busy, backoff, forced, _ttl, firmware_id, max_attempt, = payload.unpack(DIAG_RADIO_FORMAT)
+    backoff_s = (backoff * DIAG_RADIO_BACKOFF_UNIT_MS) / 1000.0
+    Rails.logger.info "📡 [LBT] Дерево #{hex_did} (FW #{firmware_id}): CAD #{cad_runs}, зайнято #{cad_busy}, " \
+                      "backoff #{backoff_s}s, примусових TX #{forced}, макс. серія #{max_attempt}"
+  end
 end
@@ -60,6 +60,13 @@ module SilkenNet
       docstring: "Total telemetry packets rejected (sensor noise, unknown DID, tamper)"
     )
 
+    # Soldier diagnostic frames (heap, profiler...) received in CoAP batches
+    TELEMETRY_DIAGNOSTICS_TOTAL = REGISTRY.counter(
+      :silkennet_telemetry_diagnostics_total,
+      docstring: "Total Soldier diagnostic frames received (by frame type)",
+      labels: [ :frame_type ]
+    )
+
     # -----------------------------------------------------------------------
     # ⚙️ SIDEKIQ QUEUE METRICS (Gauges — sampled at scrape time)
     # -----------------------------------------------------------------------
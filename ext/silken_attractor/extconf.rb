@@ -0,0 +1,13 @@
+# frozen_string_literal: true
+
+# Нативний міст до firmware/common/silken_attractor.c — того самого коду,
+# що рахує Z на Солдаті. Збірка: cd ext/silken_attractor && ruby extconf.rb && make
+require "mkmf"
+
+firmware_common = File.expand_path("../../firmware/common", __dir__)
+
+$VPATH << firmware_common
+$INCFLAGS << " -I#{firmware_common}"
+$srcs = %w[silken_attractor_ext.c silken_attractor.c]
+
+create_makefile("silken_attractor")
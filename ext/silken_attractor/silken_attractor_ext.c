@@ -0,0 +1,43 @@
+/*
+ * silken_attractor_ext.c — Ruby binding for firmware/common/silken_attractor.c.
+ *
+ * Exposes the bit-exact Q16.16 Lorenz integration to the server as
+ * SilkenAttractor.z_q16 / SilkenAttractor.trajectory_q16.
+ * Used by SilkenNet::Attractor when the extension is compiled.
+ */
+#include <ruby.h>
+
+#include "silken_attractor.h"
+
+static VALUE rb_silken_attractor_z_q16(VALUE self, VALUE seed, VALUE temp, VALUE acoustic)
+{
+    (void)self;
+    return INT2NUM(Attractor_Calculate_Z_Q16((uint32_t)NUM2ULL(seed), NUM2INT(temp), NUM2INT(acoustic)));
+}
+
+static VALUE rb_silken_attractor_trajectory_q16(VALUE self, VALUE seed, VALUE temp,
+                                                VALUE acoustic, VALUE points)
+{
+    (void)self;
+    uint16_t n = (uint16_t)NUM2USHORT(points);
+    int32_t* xyz = ALLOC_N(int32_t, (size_t)n * 3);
+
+    Attractor_Trajectory_Q16((uint32_t)NUM2ULL(seed), NUM2INT(temp), NUM2INT(acoustic), xyz, n);
+
+    VALUE result = rb_ary_new_capa((long)n * 3);
+    for (long i = 0; i < (long)n * 3; i++) {
+        rb_ary_push(result, INT2NUM(xyz[i]));
+    }
+    xfree(xyz);
+    return result;
+}
+
+void Init_silken_attractor(void)
+{
+    VALUE mod = rb_define_module("SilkenAttractor");
+
+    rb_define_const(mod, "ITERATIONS", INT2NUM(ATTRACTOR_ITERATIONS));
+    rb_define_const(mod, "Q_BITS", INT2NUM(ATTRACTOR_Q_BITS));
+    rb_define_module_function(mod, "z_q16", rb_silken_attractor_z_q16, 3);
+    rb_define_module_function(mod, "trajectory_q16", rb_silken_attractor_trajectory_q16, 4);
+}
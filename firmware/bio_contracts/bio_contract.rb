@@ -22,6 +22,21 @@ module SilkenNet
     RHO_MIN   = 10.0
     RHO_MAX   = 50.0
 
+    # Фіксована кома Q16.16 (firmware/common/silken_attractor.h)
+    Z_BITS = 16
+    Z_ONE  = 1 << Z_BITS
+
+    # [СИНХРОНІЗОВАНО з сервером] Z у Q16.16. Якщо прошивка надає C-міст
+    # SilkenNet.attractor_z_q16 — рахуємо біт-точно, як SilkenNet::Attractor
+    # на сервері. Старі прошивки без мосту падають на float-версію нижче.
+    def self.calculate_z_q16(seed, temp, acoustic)
+      if SilkenNet.respond_to?(:attractor_z_q16)
+        SilkenNet.attractor_z_q16(seed, temp, acoustic)
+      else
+        (calculate_z_axis(seed, temp, acoustic) * Z_ONE).to_i
+      end
+    end
+
     def self.calculate_z_axis(seed, temp, acoustic)
       x = ((seed % 1000) / 500.0) - 1.0
       y = (((seed >> 4) % 1000) / 500.0) - 1.0
@@ -57,14 +72,15 @@ module SilkenNet
   # =========================================================================
   class BioContract
     # Межі детермінованого хаосу здорового дерева
-    CRITICAL_Z_MIN = 2.0  # Падіння нижче = втрата тургору / посуха
-    CRITICAL_Z_MAX = 45.0 # Стрибок вище = аномальний стрес / втручання
+    # Порівняння ведуться в цілих Q16.16 — жодного float у вироку.
+    CRITICAL_Z_MIN = 2 * Attractor::Z_ONE  # Падіння нижче = втрата тургору / посуха
+    CRITICAL_Z_MAX = 45 * Attractor::Z_ONE # Стрибок вище = аномальний стрес / втручання
 
     # Ідеальний стан конвекції для максимізації поглинання CO2
-    OPTIMAL_Z_TARGET = 29.0
+    OPTIMAL_Z_TARGET = 29 * Attractor::Z_ONE
 
     def self.evaluate_and_pack(seed, temp, acoustic)
-      z_val = Attractor.calculate_z_axis(seed, temp, acoustic)
+      z_val = Attractor.calculate_z_q16(seed, temp, acoustic)
 
       status = 0
       growth_points = 0 # Бали росту (Proof of Growth)
@@ -81,10 +97,11 @@ module SilkenNet
 
         # Розрахунок винагороди: чим ближче стан дерева до ідеалу (20.0),
         # тим ефективніше воно депонує вуглець і більше балів отримує.
-        deviation = (OPTIMAL_Z_TARGET - z_val).abs
+        # Зсув замість ділення: Integer#/ у mruby 2.x повертає Float.
+        deviation = (OPTIMAL_Z_TARGET - z_val).abs >> Attractor::Z_BITS
 
         # Базова нагорода 50 балів мінус штраф за відхилення
-        reward = 50 - deviation.to_i
+        reward = 50 - deviation
         growth_points = reward > 0 ? reward : 10
       end
 
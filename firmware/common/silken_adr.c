@@ -0,0 +1,153 @@
+/**
+  ******************************************************************************
+  * @file           : silken_adr.c
+  * @brief          : Адаптивна потужність TX: Королева міряє лінк, Солдат підлаштовується
+  ******************************************************************************
+  */
+#include "silken_adr.h"
+
+#include <string.h>
+
+#define ADR_MARGIN_NONE   (-128)
+
+// Ціна TX у проміле від ціни на +14 дБм, крок 2 дБ вниз (RFO_LP, DS13105).
+// Пробудження радіо, CAD і ядро від потужності не залежать — звідси «підлога».
+static const uint16_t adr_tx_permille[] = { 1000, 860, 750, 660, 600, 550, 520 };
+
+static uint32_t adr_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static int8_t adr_clamp_i8(int32_t v)
+{
+    if (v < -128) return -128;
+    if (v > 127) return 127;
+    return (int8_t)v;
+}
+
+void Adr_Table_Init(AdrTable* t)
+{
+    memset(t, 0, sizeof(*t));
+}
+
+int8_t Adr_Link_Margin(int16_t rssi_dbm, int8_t snr_db)
+{
+    int32_t margin = (int32_t)rssi_dbm - ADR_RSSI_FLOOR_DBM;
+    // Шумовий лінк: SNR ближчий до межі, ніж RSSI
+    if (snr_db < ADR_SNR_CLEAN_DB && snr_db - ADR_SNR_FLOOR_DB < margin) {
+        margin = snr_db - ADR_SNR_FLOOR_DB;
+    }
+    return adr_clamp_i8(margin);
+}
+
+int8_t Adr_Delta_DB(int8_t best_margin)
+{
+    int32_t excess = (int32_t)best_margin - ADR_MARGIN_DB;
+    if (excess < 0) {
+        // Нестача — вгору одразу, з округленням до цілого кроку
+        int32_t steps = (-excess + ADR_POWER_STEP_DB - 1) / ADR_POWER_STEP_DB;
+        return adr_clamp_i8(steps * ADR_POWER_STEP_DB);
+    }
+    if (excess < ADR_POWER_STEP_DB + ADR_HYSTERESIS_DB) return 0;
+    return adr_clamp_i8(-((excess - ADR_HYSTERESIS_DB) / ADR_POWER_STEP_DB) * ADR_POWER_STEP_DB);
+}
+
+void Adr_Observe(AdrTable* t, uint32_t did, int16_t rssi_dbm, int8_t snr_db)
+{
+    AdrLink* link = NULL;
+    AdrLink* victim = &t->link[0];
+    for (int i = 0; i < ADR_TABLE_SLOTS; i++) {
+        AdrLink* l = &t->link[i];
+        if (l->stamp != 0 && l->did == did) { link = l; break; }
+        if (victim->stamp != 0 && l->stamp < victim->stamp) victim = l;
+    }
+    if (link == NULL) {
+        link = victim;
+        link->did = did;
+        link->frames = 0;
+        link->best_margin = ADR_MARGIN_NONE;
+    }
+    link->stamp = ++t->clock;
+
+    int8_t margin = Adr_Link_Margin(rssi_dbm, snr_db);
+    if (link->frames == 0 || margin > link->best_margin) link->best_margin = margin;
+    if (link->frames < 0xFF) link->frames++;
+}
+
+// Збіг 16-бітного Src: перевага свіжішому; DID у маяку все одно відсіє
+// чужого передавача
+static AdrLink* adr_find_src(const AdrTable* t, uint16_t src)
+{
+    const AdrLink* link = NULL;
+    for (int i = 0; i < ADR_TABLE_SLOTS; i++) {
+        const AdrLink* l = &t->link[i];
+        if (l->stamp == 0 || (uint16_t)(l->did & 0xFFFFU) != src) continue;
+        if (link == NULL || l->stamp > link->stamp) link = l;
+    }
+    return (AdrLink*)link;
+}
+
+uint8_t Adr_Fill_Beacon(AdrTable* t, uint16_t src, uint8_t* beacon)
+{
+    AdrLink* link = adr_find_src(t, src);
+    if (link == NULL || link->frames < ADR_HISTORY) return 0;
+
+    beacon[ADR_BEACON_DID]     = (uint8_t)(link->did >> 24);
+    beacon[ADR_BEACON_DID + 1] = (uint8_t)(link->did >> 16);
+    beacon[ADR_BEACON_DID + 2] = (uint8_t)(link->did >> 8);
+    beacon[ADR_BEACON_DID + 3] = (uint8_t)link->did;
+    beacon[ADR_BEACON_DELTA]   = (uint8_t)Adr_Delta_DB(link->best_margin);
+    link->frames = 0; // Наступне вікно міряє вже нову потужність
+    return 1;
+}
+
+uint32_t Adr_Did_For_Src(const AdrTable* t, uint16_t src)
+{
+    const AdrLink* link = adr_find_src(t, src);
+    return link != NULL ? link->did : 0;
+}
+
+void Adr_Init(AdrState* st)
+{
+    st->power_dbm = ADR_POWER_MAX_DBM;
+    st->quiet = 0;
+}
+
+uint8_t Adr_On_Beacon(AdrState* st, const uint8_t* beacon, uint32_t own_did)
+{
+    if (own_did == 0 || adr_be32(&beacon[ADR_BEACON_DID]) != own_did) return 0; // Маяк градієнта або чужа команда
+    st->quiet = 0;
+
+    int32_t delta = (int8_t)beacon[ADR_BEACON_DELTA];
+    if (delta < -ADR_MAX_STEPS_DOWN * ADR_POWER_STEP_DB) delta = -ADR_MAX_STEPS_DOWN * ADR_POWER_STEP_DB;
+
+    int32_t power = st->power_dbm + delta;
+    if (power > ADR_POWER_MAX_DBM) power = ADR_POWER_MAX_DBM;
+    if (power < ADR_POWER_MIN_DBM) power = ADR_POWER_MIN_DBM;
+    if (power == st->power_dbm) return 0;
+    st->power_dbm = (int8_t)power;
+    return 1;
+}
+
+uint8_t Adr_Window_Closed(AdrState* st)
+{
+    if (st->power_dbm >= ADR_POWER_MAX_DBM) {
+        st->quiet = 0;
+        return 0;
+    }
+    if (++st->quiet < ADR_BACKOFF_WINDOWS) return 0;
+    st->quiet = 0;
+    st->power_dbm = (int8_t)(st->power_dbm + ADR_POWER_STEP_DB);
+    if (st->power_dbm > ADR_POWER_MAX_DBM) st->power_dbm = ADR_POWER_MAX_DBM;
+    return 1;
+}
+
+uint32_t Adr_Tx_Cost_UJ(const AdrState* st, uint32_t cost_at_max_uj)
+{
+    int32_t step = (ADR_POWER_MAX_DBM - st->power_dbm) / ADR_POWER_STEP_DB;
+    int32_t last = (int32_t)(sizeof(adr_tx_permille) / sizeof(adr_tx_permille[0])) - 1;
+    if (step < 0) step = 0;
+    if (step > last) step = last;
+    return (uint32_t)(((uint64_t)cost_at_max_uj * adr_tx_permille[step]) / 1000U);
+}
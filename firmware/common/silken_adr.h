@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file           : silken_adr.h
+  * @brief          : Адаптивна потужність TX: Королева міряє лінк, Солдат підлаштовується
+  ******************************************************************************
+  *
+  * Досі радіо Солдата було заморожене: одна модуляція й одна потужність на
+  * весь ліс. Дерево за 50 м від Королеви кричало так само, як дерево на краю
+  * кластера, і платило ту саму ціну TX.
+  *
+  * Тепер Королева на кожен ПРЯМИЙ кадр (не естафету) дерева рахує запас
+  * лінку з RSSI та SNR пакета (Adr_Link_Margin) і тримає найкращий запас
+  * вікна з ADR_HISTORY кадрів у таблиці за повним DID. Коли вікно повне,
+  * її відповідь передавачу (маяк FRAME_TYPE_BEACON) несе команду:
+  *
+  *   байти 4-7   DID адресата (0 — команди немає)
+  *   байт 8      int8: зміна потужності, дБ (кратна ADR_POWER_STEP_DB)
+  *
+  * Команда відносна: Королеві не треба знати, на якій потужності Солдат
+  * зараз (скидання, пропущений маяк) — вона судить лише з того, що чує.
+  * Гістерезис з обох боків: Королева знижує лише при надлишку понад крок +
+  * ADR_HYSTERESIS_DB, Солдат за одну команду опускається не більше ніж на
+  * ADR_MAX_STEPS_DOWN кроків, а піднімається одразу. Якщо ADR_BACKOFF_WINDOWS
+  * вікон RX поспіль не принесли команди (Королева не чує?), Солдат сам
+  * піднімає потужність на крок.
+  *
+  * SF не змінюється: мережа живе на SF7/125 кГц — це вже найкоротший ефір
+  * EU868, а одно-демодуляторний SX126x Королеви і сусіди-ретранслятори чують
+  * лише свій SF. Виграш ADR — струм підсилювача: ціни ENERGY_COST_* заміряні
+  * на ADR_POWER_MAX_DBM, Adr_Tx_Cost_UJ масштабує їх під поточну потужність.
+  */
+#ifndef SILKEN_ADR_H
+#define SILKEN_ADR_H
+
+#include <stdint.h>
+
+#include "silken_route.h"
+
+#define ADR_POWER_MAX_DBM       14      // EU868: 25 мВт ERP; на ній заміряні ENERGY_COST_*
+#define ADR_POWER_MIN_DBM       2
+#define ADR_POWER_STEP_DB       2
+#define ADR_SNR_FLOOR_DB        (-7)    // Поріг демодуляції SF7 (−7.5 дБ)
+#define ADR_SNR_CLEAN_DB        8       // Вище SNR насичується: лінк міряємо за RSSI
+#define ADR_RSSI_FLOOR_DBM      ROUTE_RSSI_FLOOR_DBM // Слабший лінк градієнт не приймає
+#define ADR_MARGIN_DB           10      // Запас на завмирання (installation margin)
+#define ADR_HYSTERESIS_DB       3       // Надлишок понад крок, щоб знизити потужність
+#define ADR_HISTORY             8       // Прямих кадрів на одне рішення
+#define ADR_MAX_STEPS_DOWN      2       // Солдат: ≤ 4 дБ вниз за команду
+#define ADR_BACKOFF_WINDOWS     24      // Вікон RX без команди → +1 крок
+#define ADR_TABLE_SLOTS         64      // 64 × 12 Б ≈ 0.8 КБ SRAM Королеви
+
+// Поля команди у відкритому тексті маяка
+#define ADR_BEACON_DID          4       // uint32 BE
+#define ADR_BEACON_DELTA        8       // int8, дБ
+
+// --- Королева ---
+
+typedef struct {
+    uint32_t did;
+    uint32_t stamp;                     // LRU: більший — свіжіший; 0 — слот порожній
+    int8_t   best_margin;               // Найкращий запас вікна, дБ
+    uint8_t  frames;                    // Прямих кадрів у вікні
+} AdrLink;
+
+typedef struct {
+    uint32_t clock;
+    AdrLink  link[ADR_TABLE_SLOTS];
+} AdrTable;
+
+void Adr_Table_Init(AdrTable* t);
+
+// Запас лінку одного пакета над порогами RSSI / SNR, дБ (без ADR_MARGIN_DB)
+int8_t Adr_Link_Margin(int16_t rssi_dbm, int8_t snr_db);
+
+// Зміна потужності, дБ, для найкращого запасу вікна (0 — лишити як є)
+int8_t Adr_Delta_DB(int8_t best_margin);
+
+// Прямий кадр дерева did (заголовок не переписаний естафетою)
+void Adr_Observe(AdrTable* t, uint32_t did, int16_t rssi_dbm, int8_t snr_db);
+
+// Відповідь передавачу з Src: якщо його вікно повне — команда в маяк
+// (DID + зміна), вікно починається заново. 1 — команду вписано.
+uint8_t Adr_Fill_Beacon(AdrTable* t, uint16_t src, uint8_t* beacon);
+
+// Повний DID прямого сусіда з Src (свіжіший при збігу); 0 — не чули напряму
+uint32_t Adr_Did_For_Src(const AdrTable* t, uint16_t src);
+
+// --- Солдат ---
+
+typedef struct {
+    int8_t  power_dbm;
+    uint8_t quiet;                      // Вікон RX з останньої команди
+} AdrState;
+
+// Після скидання — повна потужність: так Солдата точно чутно
+void Adr_Init(AdrState* st);
+
+// Автентичний маяк Королеви. 1 — потужність змінилась (перенастроїти радіо).
+uint8_t Adr_On_Beacon(AdrState* st, const uint8_t* beacon, uint32_t own_did);
+
+// Вікно RX після власного кадру закрилось. 1 — backoff підняв потужність.
+uint8_t Adr_Window_Closed(AdrState* st);
+
+// Ціна TX, заміряна на ADR_POWER_MAX_DBM, на поточній потужності
+uint32_t Adr_Tx_Cost_UJ(const AdrState* st, uint32_t cost_at_max_uj);
+
+#endif /* SILKEN_ADR_H */
@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file           : silken_attractor.c
+  * @brief          : Біт-точний Атрактор Лоренца у фіксованій комі (Q16.16)
+  ******************************************************************************
+  */
+#include "silken_attractor.h"
+
+// Арифметичний зсув вправо для від'ємних int64 — implementation-defined у C,
+// але GCC (x86-64 та arm-none-eabi) гарантує floor-семантику. Саме її
+// повторює Integer#>> у Ruby-порті (app/services/silken_net/attractor.rb).
+_Static_assert((-3 >> 1) == -2, "silken_attractor: потрібен арифметичний зсув вправо");
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    int32_t sigma;
+    int32_t rho;
+} AttractorState;
+
+// Множення Q16.16 × Q16.16 → Q16.16 (floor)
+static inline int64_t fx_mul(int64_t a, int64_t b)
+{
+    return (a * b) >> ATTRACTOR_Q_BITS;
+}
+
+// Ділення з відкиданням дробу до нуля (однаково на всіх платформах і в Ruby)
+static inline int64_t fx_div_trunc(int64_t num, int64_t den)
+{
+    return (num >= 0) ? (num / den) : -((-num) / den);
+}
+
+static inline int32_t fx_clamp(int64_t v, int32_t lo, int32_t hi)
+{
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return (int32_t)v;
+}
+
+static void attractor_init(AttractorState* s, uint32_t seed, int32_t temp_c, int32_t acoustic)
+{
+    // Початкові координати: ((seed % 1000) / 500.0) - 1.0 → [-1.0, 1.0)
+    s->x = (int32_t)((((int64_t)(seed % 1000U)) << ATTRACTOR_Q_BITS) / 500) - ATTRACTOR_ONE;
+    s->y = (int32_t)((((int64_t)((seed >> 4) % 1000U)) << ATTRACTOR_Q_BITS) / 500) - ATTRACTOR_ONE;
+    s->z = (int32_t)((((int64_t)((seed >> 8) % 1000U)) << ATTRACTOR_Q_BITS) / 500) - ATTRACTOR_ONE;
+
+    // Пертурбація: sigma += acoustic × 0.1, rho += temp × 0.2
+    int64_t sigma = ATTRACTOR_BASE_SIGMA_Q + fx_div_trunc((int64_t)acoustic * ATTRACTOR_ONE, 10);
+    int64_t rho   = ATTRACTOR_BASE_RHO_Q + fx_div_trunc((int64_t)temp_c * 2 * ATTRACTOR_ONE, 10);
+
+    s->sigma = fx_clamp(sigma, ATTRACTOR_SIGMA_MIN_Q, ATTRACTOR_SIGMA_MAX_Q);
+    s->rho   = fx_clamp(rho, ATTRACTOR_RHO_MIN_Q, ATTRACTOR_RHO_MAX_Q);
+}
+
+static void attractor_step(AttractorState* s)
+{
+    int64_t dx = fx_mul(s->sigma, (int64_t)s->y - s->x);
+    int64_t dy = fx_mul(s->x, (int64_t)s->rho - s->z) - s->y;
+    int64_t dz = fx_mul(s->x, s->y) - fx_mul(ATTRACTOR_BETA_Q, s->z);
+
+    s->x = fx_clamp(s->x + fx_mul(dx, ATTRACTOR_DT_Q), -ATTRACTOR_STATE_LIMIT_Q, ATTRACTOR_STATE_LIMIT_Q);
+    s->y = fx_clamp(s->y + fx_mul(dy, ATTRACTOR_DT_Q), -ATTRACTOR_STATE_LIMIT_Q, ATTRACTOR_STATE_LIMIT_Q);
+    s->z = fx_clamp(s->z + fx_mul(dz, ATTRACTOR_DT_Q), -ATTRACTOR_STATE_LIMIT_Q, ATTRACTOR_STATE_LIMIT_Q);
+}
+
+int32_t Attractor_Calculate_Z_Q16(uint32_t seed, int32_t temp_c, int32_t acoustic)
+{
+    AttractorState s;
+    attractor_init(&s, seed, temp_c, acoustic);
+
+    for (uint16_t i = 0; i < ATTRACTOR_ITERATIONS; i++) {
+        attractor_step(&s);
+    }
+    return s.z;
+}
+
+uint16_t Attractor_Trajectory_Q16(uint32_t seed, int32_t temp_c, int32_t acoustic,
+                                  int32_t* xyz_out, uint16_t max_points)
+{
+    AttractorState s;
+    attractor_init(&s, seed, temp_c, acoustic);
+
+    for (uint16_t i = 0; i < max_points; i++) {
+        if (i > 0) attractor_step(&s);
+        xyz_out[i * 3]     = s.x;
+        xyz_out[i * 3 + 1] = s.y;
+        xyz_out[i * 3 + 2] = s.z;
+    }
+    return max_points;
+}
@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @file           : silken_attractor.h
+  * @brief          : Біт-точний Атрактор Лоренца у фіксованій комі (Q16.16)
+  ******************************************************************************
+  *
+  * Єдина реалізація інтеграції для трьох світів:
+  *   - Солдат (Cortex-M4, виклик з mruby-контракту через SilkenNet.attractor_z_q16)
+  *   - Хостові тести (firmware/test, golden vectors)
+  *   - Сервер (ext/silken_attractor → SilkenNet::Attractor)
+  *
+  * Тільки цілочисельна арифметика: int32 стан, int64 добутки, арифметичний
+  * зсув вправо. Жодного float → однаковий результат на будь-якому ядрі.
+  */
+#ifndef SILKEN_ATTRACTOR_H
+#define SILKEN_ATTRACTOR_H
+
+#include <stdint.h>
+
+#define ATTRACTOR_Q_BITS        16
+#define ATTRACTOR_ONE           ((int32_t)1 << ATTRACTOR_Q_BITS)   // 1.0 у Q16.16
+#define ATTRACTOR_ITERATIONS    250
+
+// Класичні константи Лоренца (Q16.16). BETA = round(8/3 * 65536).
+#define ATTRACTOR_BASE_SIGMA_Q  ((int32_t)10 * ATTRACTOR_ONE)
+#define ATTRACTOR_BASE_RHO_Q    ((int32_t)28 * ATTRACTOR_ONE)
+#define ATTRACTOR_BETA_Q        174763
+// DT = 0.01 → 655.36 → 655 (0.0099945). Зафіксовано назавжди: зміна = інший ліс.
+#define ATTRACTOR_DT_Q          655
+
+// Межі стабільності (Chaos Clamps), ідентичні SIGMA_LIMITS / RHO_LIMITS сервера
+#define ATTRACTOR_SIGMA_MIN_Q   ((int32_t)5  * ATTRACTOR_ONE)
+#define ATTRACTOR_SIGMA_MAX_Q   ((int32_t)30 * ATTRACTOR_ONE)
+#define ATTRACTOR_RHO_MIN_Q     ((int32_t)10 * ATTRACTOR_ONE)
+#define ATTRACTOR_RHO_MAX_Q     ((int32_t)50 * ATTRACTOR_ONE)
+
+// Запобіжник стану: ±1000.0. Реальна траєкторія не виходить за ±100,
+// а межа гарантує, що жоден int64-добуток не переповниться.
+#define ATTRACTOR_STATE_LIMIT_Q ((int32_t)1000 * ATTRACTOR_ONE)
+
+// Повертає Z після ATTRACTOR_ITERATIONS кроків Ейлера (Q16.16).
+//   seed     — зерно хаосу (HRNG на Солдаті, DID на сервері)
+//   temp_c   — температура, °C (int8 з пейлоада)
+//   acoustic — кількість акустичних подій
+int32_t Attractor_Calculate_Z_Q16(uint32_t seed, int32_t temp_c, int32_t acoustic);
+
+// Записує траєкторію [x0,y0,z0, x1,y1,z1, ...] (Q16.16) у xyz_out.
+// Перша трійка — початковий стан, далі по одній трійці на крок.
+// Повертає кількість записаних трійок (≤ max_points).
+uint16_t Attractor_Trajectory_Q16(uint32_t seed, int32_t temp_c, int32_t acoustic,
+                                  int32_t* xyz_out, uint16_t max_points);
+
+#endif /* SILKEN_ATTRACTOR_H */
@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file           : silken_chan.c
+  * @brief          : Частотний план EU868: канал на кластер Королеви
+  ******************************************************************************
+  */
+#include "silken_chan.h"
+
+#include <string.h>
+
+static const uint32_t chan_freq_hz[CHAN_COUNT] = {
+    868100000U, 868300000U, 868500000U,                         // 868.0-868.6 МГц, 1 %
+    867100000U, 867300000U, 867500000U, 867700000U, 867900000U  // 865.0-868.0 МГц, 1 %
+};
+
+uint32_t Chan_Freq_Hz(uint8_t ch)
+{
+    return chan_freq_hz[ch < CHAN_COUNT ? ch : 0];
+}
+
+void Chan_Survey_Init(ChanSurvey* s)
+{
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < CHAN_COUNT; i++) {
+        s->peak_dbm[i] = INT16_MIN;
+    }
+}
+
+void Chan_Survey_Add(ChanSurvey* s, uint8_t ch, int16_t rssi_dbm)
+{
+    if (ch >= CHAN_COUNT || s->samples[ch] == UINT16_MAX) return;
+    s->samples[ch]++;
+    if (rssi_dbm > CHAN_BUSY_DBM) s->busy[ch]++;
+    if (rssi_dbm > s->peak_dbm[ch]) s->peak_dbm[ch] = rssi_dbm;
+}
+
+uint8_t Chan_Home(const char* uid, uint8_t count)
+{
+    uint32_t h = 2166136261U;
+    for (; *uid != '\0'; uid++) {
+        h = (h ^ (uint8_t)*uid) * 16777619U;
+    }
+    return (uint8_t)(h % (count ? count : 1U));
+}
+
+// Зайнятість каналу в проміле: канали з різною кількістю вибірок порівнянні
+static uint32_t chan_busy_permille(const ChanSurvey* s, uint8_t ch)
+{
+    if (s->samples[ch] == 0) return 1000U; // Не слухали — не беремо наосліп
+    return (uint32_t)s->busy[ch] * 1000U / s->samples[ch];
+}
+
+uint8_t Chan_Survey_Pick(const ChanSurvey* s, uint8_t home, uint8_t count)
+{
+    if (count > CHAN_COUNT) count = CHAN_COUNT;
+    if (count == 0) return 0;
+    if (home >= count) home = 0;
+
+    uint8_t best = home;
+    uint32_t best_busy = chan_busy_permille(s, home);
+    uint32_t home_busy = best_busy;
+    for (uint8_t ch = 0; ch < count; ch++) {
+        uint32_t busy = chan_busy_permille(s, ch);
+        if (busy < best_busy) {
+            best = ch;
+            best_busy = busy;
+        }
+    }
+    // Домашній лишається, доки різниця в межах похибки вибірки
+    if (home_busy <= best_busy + CHAN_SURVEY_SLACK_PCT * 10U) return home;
+    return best;
+}
+
+void Chan_Init(ChanState* st)
+{
+    st->ch = 0;
+    st->quiet = 0;
+    st->locked = 0;
+}
+
+void Chan_Heard(ChanState* st)
+{
+    st->quiet = 0;
+    st->locked = 1;
+}
+
+uint8_t Chan_Tick(ChanState* st)
+{
+    uint8_t limit = st->locked ? CHAN_LOST_WAKES : CHAN_SCAN_WAKES;
+    if (++st->quiet < limit) return 0;
+    st->ch = (uint8_t)((st->ch + 1) % CHAN_COUNT);
+    st->quiet = 0;
+    st->locked = 0;
+    return 1;
+}
+
+uint8_t Chan_Pack(const ChanState* st)
+{
+    return (uint8_t)(st->ch + 1);
+}
+
+void Chan_Restore(ChanState* st, uint8_t packed)
+{
+    Chan_Init(st);
+    if (packed == 0 || packed > CHAN_COUNT) return;
+    st->ch = (uint8_t)(packed - 1);
+    st->locked = 1;
+}
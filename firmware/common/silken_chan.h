@@ -0,0 +1,98 @@
+/**
+  ******************************************************************************
+  * @file           : silken_chan.h
+  * @brief          : Частотний план EU868: канал на кластер Королеви
+  ******************************************************************************
+  *
+  * Досі весь ліс жив на одній частоті 868.000 МГц. Кластер сусідньої Королеви
+  * в межах чутності — це чужі кадри на тій самій частоті: вони б'ють прийом
+  * нашої Королеви так само, як власні колізії, і межа Солдатів на Королеву
+  * падає з кожним сусідом. (До того ж 868.000 МГц при 125 кГц виходить за
+  * нижню межу підсмуги 868.0-868.6 МГц.)
+  *
+  * Тепер мережа має CHAN_COUNT каналів по 125 кГц у двох підсмугах EU868
+  * (обидві 1 % duty cycle, 25 мВт ERP) — ті самі частоти, що й план LoRaWAN:
+  *
+  *   0-2   868.1 / 868.3 / 868.5 МГц        підсмуга 868.0-868.6 МГц
+  *   3-7   867.1 / 867.3 / … / 867.9 МГц    підсмуга 865.0-868.0 МГц
+  *
+  * Канал належить кластеру, а не Солдату: SX126x Королеви демодулює один
+  * канал за раз, а естафета вимагає, щоб сусіди чули одне одного. Тож
+  * розносимо по частотах сусідні кластери (повторне використання частот), а
+  * не Солдатів однієї Королеви.
+  *
+  * Королева при старті слухає кожен канал CHAN_SURVEY_SAMPLES разів (RSSI) і
+  * рахує зайняті вибірки (Chan_Survey_*). Бере найтихіший; домашній канал
+  * (хеш її UID) виграє, якщо інший тихіший менш ніж на CHAN_SURVEY_SLACK_PCT —
+  * так перезавантаження не переносить кластер без потреби.
+  *
+  * Солдат шукає канал своєї Королеви сам (Chan_Tick / Chan_Heard). Доки він
+  * нічого автентичного на каналі не почув (маяк, OTA, кадр сусіда), він
+  * сканує: CHAN_SCAN_WAKES пробуджень на канал, буферизована пачка йде одразу
+  * як зонд — пряму Солдату Королева відповість маяком. Почув — канал
+  * зафіксовано; CHAN_LOST_WAKES пробуджень тиші (довше ніж ROUTE_STALE_WAKES:
+  * градієнт забувається раніше) — кластер втрачено, скан далі. Канал
+  * переживає скидання у DR19 (Chan_Pack), тож просідання живлення скану не
+  * запускає.
+  */
+#ifndef SILKEN_CHAN_H
+#define SILKEN_CHAN_H
+
+#include <stdint.h>
+
+#define CHAN_COUNT              8
+#define CHAN_BUSY_DBM           (-105)  // ≈ 12 дБ над шумом 125 кГц: тут уже чийсь кадр
+#define CHAN_SURVEY_SAMPLES     200     // Вибірок RSSI на канал
+#define CHAN_SURVEY_STEP_MS     50      // 200 × 50 мс = 10 с на канал, 80 с на план
+#define CHAN_SURVEY_SLACK_PCT   2       // Перевага домашнього каналу, % вибірок
+#define CHAN_SCAN_WAKES         24      // Солдат: пробуджень на канал під час скану
+#define CHAN_LOST_WAKES         96      // Солдат: тиші на зафіксованому каналі до скану
+
+// Центральна частота каналу, Гц (ch ≥ CHAN_COUNT — канал 0)
+uint32_t Chan_Freq_Hz(uint8_t ch);
+
+// --- Королева ---
+
+typedef struct {
+    uint16_t samples[CHAN_COUNT];
+    uint16_t busy[CHAN_COUNT];          // Вибірок понад CHAN_BUSY_DBM
+    int16_t  peak_dbm[CHAN_COUNT];      // Найгучніша вибірка (діагностика)
+} ChanSurvey;
+
+void Chan_Survey_Init(ChanSurvey* s);
+
+// Одна вибірка Radio.Rssi() на каналі ch
+void Chan_Survey_Add(ChanSurvey* s, uint8_t ch, int16_t rssi_dbm);
+
+// Домашній канал Королеви серед перших count каналів плану: FNV-1a її UID
+uint8_t Chan_Home(const char* uid, uint8_t count);
+
+// Найтихіший з перших count каналів; home — якщо не гучніший за нього
+// більше ніж на CHAN_SURVEY_SLACK_PCT вибірок
+uint8_t Chan_Survey_Pick(const ChanSurvey* s, uint8_t home, uint8_t count);
+
+// --- Солдат ---
+
+typedef struct {
+    uint8_t ch;
+    uint8_t quiet;                      // Пробуджень без жодного кадру кластера
+    uint8_t locked;                     // 1 — на цьому каналі вже чули свій кластер
+} ChanState;
+
+// Холодний старт: канал 0, скан
+void Chan_Init(ChanState* st);
+
+// Почули автентичний маяк / OTA Королеви або кадр сусіда на поточному каналі
+void Chan_Heard(ChanState* st);
+
+// Раз на пробудження. 1 — канал змінено: перенастроїти радіо, забути
+// градієнт, синхронізацію TDMA і потужність ADR (інша Королева)
+uint8_t Chan_Tick(ChanState* st);
+
+// 4 біти для Backup-регістра: ch + 1 (0 — каналу ще не знаємо)
+uint8_t Chan_Pack(const ChanState* st);
+
+// Після скидання: збережений канал вважається зафіксованим
+void Chan_Restore(ChanState* st, uint8_t packed);
+
+#endif /* SILKEN_CHAN_H */
@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file           : silken_crc.c
+  * @brief          : CRC32 (ISO 3309) та CRC16-CCITT для OTA (Солдат і Королева)
+  ******************************************************************************
+  */
+#include "silken_crc.h"
+
+#if defined(__arm__)
+#include "main.h"             // CRC, __HAL_RCC_CRC_CLK_ENABLE, __RBIT, __REV (CMSIS)
+#endif
+
+uint32_t Crc32_Update_Bitwise(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 1U) ? ((crc >> 1) ^ CRC32_POLY_REFLECTED) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+#if defined(__arm__)
+
+void Crc_Init(void)
+{
+    __HAL_RCC_CRC_CLK_ENABLE();
+}
+
+// Невирівняний початок і хвіст — байтами, решта — словами. Перший байт потоку
+// має йти першим: слово розвертаємо, блок бере його зі старшого байта.
+static void crc_hw_feed(const uint8_t* p, uint32_t len)
+{
+    while (len > 0 && ((uintptr_t)p & 3U) != 0) {
+        *(__IO uint8_t*)&CRC->DR = *p++;
+        len--;
+    }
+    for (; len >= 4; len -= 4, p += 4) {
+        CRC->DR = __REV(*(const uint32_t*)p);
+    }
+    while (len-- > 0) {
+        *(__IO uint8_t*)&CRC->DR = *p++;
+    }
+}
+
+uint32_t Crc32_Update(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+    // Блок рахує MSB-first: реверс кожного вхідного байта і результату дає
+    // відзеркалений CRC32. INIT — у домені блока, тож теж розвертаємо.
+    CRC->POL = 0x04C11DB7U;
+    CRC->CR = CRC_CR_REV_OUT | CRC_CR_REV_IN_0;
+    CRC->INIT = __RBIT(crc);
+    CRC->CR |= CRC_CR_RESET;
+    crc_hw_feed(data, len);
+    return CRC->DR;
+}
+
+uint16_t Crc16_Update(uint16_t crc, const uint8_t* data, uint32_t len)
+{
+    CRC->POL = CRC16_POLY;
+    CRC->CR = CRC_CR_POLYSIZE_0;    // 16 біт, без реверсу
+    CRC->INIT = crc;
+    CRC->CR |= CRC_CR_RESET;
+    crc_hw_feed(data, len);
+    return (uint16_t)CRC->DR;
+}
+
+#else
+
+static uint32_t crc32_table[8][256];
+static uint16_t crc16_table[256];
+static uint8_t  crc_tables_ready = 0;
+
+void Crc_Init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint8_t b = (uint8_t)i;
+        crc32_table[0][i] = Crc32_Update_Bitwise(0, &b, 1);
+
+        uint16_t c = (uint16_t)(i << 8);
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            c = (c & 0x8000U) ? (uint16_t)((c << 1) ^ CRC16_POLY) : (uint16_t)(c << 1);
+        }
+        crc16_table[i] = c;
+    }
+    // table[k][i] — байт i, за яким ідуть k нульових байтів
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t prev = crc32_table[k - 1][i];
+            crc32_table[k][i] = (prev >> 8) ^ crc32_table[0][prev & 0xFFU];
+        }
+    }
+    crc_tables_ready = 1;
+}
+
+uint32_t Crc32_Update_Slice8(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+    if (!crc_tables_ready) Crc_Init();
+
+    // Вісім байт за крок: кожен дає внесок через таблицю своєї відстані до кінця
+    for (; len >= 8; len -= 8, data += 8) {
+        uint32_t lo = crc ^ ((uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                             ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+        uint32_t hi = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+                      ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+        crc = crc32_table[7][lo & 0xFFU] ^ crc32_table[6][(lo >> 8) & 0xFFU] ^
+              crc32_table[5][(lo >> 16) & 0xFFU] ^ crc32_table[4][lo >> 24] ^
+              crc32_table[3][hi & 0xFFU] ^ crc32_table[2][(hi >> 8) & 0xFFU] ^
+              crc32_table[1][(hi >> 16) & 0xFFU] ^ crc32_table[0][hi >> 24];
+    }
+    while (len-- > 0) {
+        crc = (crc >> 8) ^ crc32_table[0][(crc ^ *data++) & 0xFFU];
+    }
+    return crc;
+}
+
+uint32_t Crc32_Update(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+    return Crc32_Update_Slice8(crc, data, len);
+}
+
+uint16_t Crc16_Update(uint16_t crc, const uint8_t* data, uint32_t len)
+{
+    if (!crc_tables_ready) Crc_Init();
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 8) ^ crc16_table[((crc >> 8) ^ data[i]) & 0xFFU]);
+    }
+    return crc;
+}
+
+#endif
+
+uint32_t Crc32(const uint8_t* data, uint32_t len)
+{
+    return Crc32_Final(Crc32_Update(CRC32_INIT, data, len));
+}
+
+uint16_t Crc16_Ccitt(const uint8_t* data, uint32_t len)
+{
+    return Crc16_Update(CRC16_INIT, data, len);
+}
@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file           : silken_crc.h
+  * @brief          : CRC32 (ISO 3309) та CRC16-CCITT для OTA (Солдат і Королева)
+  ******************************************************************************
+  *
+  * Досі Солдат рахував CRC32 усього OTA-образу побітно (8 зсувів на байт)
+  * лише після останнього чанка — прямо у вікні слуху, а Королева CRC16-CCITT,
+  * який OtaPackagerService дописує до кожного CoAP-чанка, не перевіряла зовсім.
+  *
+  * Дві реалізації під одним API:
+  *   Cortex-M4 — апаратний блок CRC STM32WL: слово за 4 такти AHB, поліном і
+  *               реверс бітів налаштовуються на кожен виклик, тож CRC32 і CRC16
+  *               ділять один блок без власника;
+  *   хост      — slicing-by-8 (8 таблиць по 256 слів) для CRC32, байтова
+  *               таблиця для CRC16; таблиці будує Crc_Init().
+  * Crc32_Update_Bitwise — еталон (старий код Солдата) для тестів і бенчмарку.
+  *
+  * Crc32_Update приймає і повертає сирий регістр (без фінального XOR), тож
+  * CRC складається частинами в міру надходження чанків:
+  *   crc = CRC32_INIT; crc = Crc32_Update(crc, a, n); … ; Crc32_Final(crc)
+  *
+  * CRC16-CCITT (poly 0x1021, init 0xFFFF, без реверсу і XOR) над повідомленням
+  * разом з його CRC (big-endian) дає 0, і нульові байти після нього регістр не
+  * змінюють. Тож чанк з нульовим AES-доповненням (CoapEncryption) перевіряється
+  * цілком, без точної довжини: Crc16_Ccitt(buf, aligned) == 0.
+  */
+#ifndef SILKEN_CRC_H
+#define SILKEN_CRC_H
+
+#include <stdint.h>
+
+#define CRC32_INIT            0xFFFFFFFFU
+#define CRC32_POLY_REFLECTED  0xEDB88320U  // 0x04C11DB7, LSB-first
+#define CRC16_INIT            0xFFFFU
+#define CRC16_POLY            0x1021U
+
+// Cortex-M4: тактування блоку CRC; хост: таблиці. Раз при старті.
+void Crc_Init(void);
+
+// Наступні len байт у сирий регістр CRC32
+uint32_t Crc32_Update(uint32_t crc, const uint8_t* data, uint32_t len);
+
+static inline uint32_t Crc32_Final(uint32_t crc) { return crc ^ 0xFFFFFFFFU; }
+
+// CRC32 усього буфера: Crc32_Final(Crc32_Update(CRC32_INIT, …))
+uint32_t Crc32(const uint8_t* data, uint32_t len);
+
+// Еталон: 8 зсувів на байт, без таблиць
+uint32_t Crc32_Update_Bitwise(uint32_t crc, const uint8_t* data, uint32_t len);
+
+#if !defined(__arm__)
+// Хост: реалізація Crc32_Update (для бенчмарку поруч з Bitwise)
+uint32_t Crc32_Update_Slice8(uint32_t crc, const uint8_t* data, uint32_t len);
+#endif
+
+uint16_t Crc16_Update(uint16_t crc, const uint8_t* data, uint32_t len);
+
+// CRC16-CCITT усього буфера (init 0xFFFF)
+uint16_t Crc16_Ccitt(const uint8_t* data, uint32_t len);
+
+#endif /* SILKEN_CRC_H */
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file           : silken_diag.c
+  * @brief          : Діагностичні кадри Солдата (той самий 16-байтний AES-блок)
+  ******************************************************************************
+  */
+#include "silken_diag.h"
+
+#include <string.h>
+
+static inline uint16_t diag_sat_u16(uint32_t value)
+{
+    return (value > 0xFFFFU) ? 0xFFFFU : (uint16_t)value;
+}
+
+static inline uint8_t diag_sat_u8(uint32_t value)
+{
+    return (value > 0xFFU) ? 0xFFU : (uint8_t)value;
+}
+
+// Спільна шапка всіх діагностичних кадрів: DID, TTL, FW та тип
+static void diag_pack_header(uint8_t* frame, uint32_t did, uint8_t ttl,
+                             uint16_t fw_version, uint8_t frame_type)
+{
+    memset(frame, 0, DIAG_FRAME_SIZE);
+    frame[0] = (uint8_t)(did >> 24);
+    frame[1] = (uint8_t)(did >> 16);
+    frame[2] = (uint8_t)(did >> 8);
+    frame[3] = (uint8_t)(did & 0xFF);
+    frame[11] = ttl;
+    frame[12] = (uint8_t)(fw_version >> 8);
+    frame[13] = (uint8_t)(fw_version & 0xFF);
+    frame[DIAG_FRAME_TYPE_OFFSET] = frame_type;
+}
+
+void Diag_Pack_Heap_Frame(uint8_t* frame, uint32_t did, uint8_t ttl, uint16_t fw_version,
+                          const SilkenPoolStats* stats, uint32_t gc_runs)
+{
+    diag_pack_header(frame, did, ttl, fw_version, FRAME_TYPE_DIAG_HEAP);
+
+    uint16_t peak = diag_sat_u16(stats->peak_bytes_in_use);
+    uint16_t carved = diag_sat_u16(stats->carved_bytes);
+    uint16_t allocs = (uint16_t)(stats->alloc_count & 0xFFFFU);
+
+    frame[4] = (uint8_t)(peak >> 8);
+    frame[5] = (uint8_t)(peak & 0xFF);
+    frame[6] = (uint8_t)(carved >> 8);
+    frame[7] = (uint8_t)(carved & 0xFF);
+    frame[8] = (uint8_t)(allocs >> 8);
+    frame[9] = (uint8_t)(allocs & 0xFF);
+    frame[10] = diag_sat_u8(gc_runs);
+    frame[14] = diag_sat_u8(stats->failed_count);
+}
+
+static inline uint16_t diag_prof_ticks(uint32_t cycles)
+{
+    return diag_sat_u16(Prof_Cycles_To_US(cycles) / DIAG_PROF_TICK_US);
+}
+
+void Diag_Pack_Profile_Frame(uint8_t* frame, uint32_t did, uint8_t ttl, uint16_t fw_version,
+                             ProfPhase phase, const ProfStat* stat)
+{
+    diag_pack_header(frame, did, ttl, fw_version, FRAME_TYPE_DIAG_PROFILE);
+
+    uint16_t min_t = diag_prof_ticks(stat->min_cycles);
+    uint16_t max_t = diag_prof_ticks(stat->max_cycles);
+    uint16_t ewma_t = diag_prof_ticks(stat->ewma_cycles);
+
+    frame[4] = (uint8_t)phase;
+    frame[5] = (uint8_t)(min_t >> 8);
+    frame[6] = (uint8_t)(min_t & 0xFF);
+    frame[7] = (uint8_t)(max_t >> 8);
+    frame[8] = (uint8_t)(max_t & 0xFF);
+    frame[9] = (uint8_t)(ewma_t >> 8);
+    frame[10] = (uint8_t)(ewma_t & 0xFF);
+    frame[14] = diag_sat_u8(stat->count);
+}
+
+void Diag_Pack_Radio_Frame(uint8_t* frame, uint32_t did, uint8_t ttl, uint16_t fw_version,
+                           const LbtState* lbt)
+{
+    diag_pack_header(frame, did, ttl, fw_version, FRAME_TYPE_DIAG_RADIO);
+
+    uint16_t cad_runs = (uint16_t)(lbt->cad_runs & 0xFFFFU);
+    uint16_t cad_busy = (uint16_t)(lbt->cad_busy & 0xFFFFU);
+    uint16_t backoff = diag_sat_u16(lbt->backoff_ms_total / DIAG_LBT_BACKOFF_UNIT_MS);
+
+    frame[4] = (uint8_t)(cad_runs >> 8);
+    frame[5] = (uint8_t)(cad_runs & 0xFF);
+    frame[6] = (uint8_t)(cad_busy >> 8);
+    frame[7] = (uint8_t)(cad_busy & 0xFF);
+    frame[8] = (uint8_t)(backoff >> 8);
+    frame[9] = (uint8_t)(backoff & 0xFF);
+    frame[10] = diag_sat_u8(lbt->forced_tx);
+    frame[14] = lbt->max_attempt;
+}
@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file           : silken_diag.h
+  * @brief          : Діагностичні кадри Солдата (той самий 16-байтний AES-блок)
+  ******************************************************************************
+  *
+  * Діагностика їде тим самим шляхом, що й телеметрія (AES → Королева → CoAP
+  * батч), тому формат обмежений 16 байтами. Розрізняємо кадри по байту 15:
+  * у телеметрії він завжди 0 (Reserved), у діагностиці — тип кадру.
+  *
+  *   [DID:4] [Поля типу: 4-10] [TTL:1] [FW:2] [Поле типу: 14] [Type:1]
+  *
+  * Байти 11-13 збігаються з телеметрією, тож mesh-естафета (TTL у байті 11)
+  * та OTA targeting по FW працюють без змін.
+  */
+#ifndef SILKEN_DIAG_H
+#define SILKEN_DIAG_H
+
+#include <stdint.h>
+
+#include "silken_pool.h"
+#include "silken_prof.h"
+#include "silken_lbt.h"
+
+#define DIAG_FRAME_SIZE           16
+#define DIAG_FRAME_TYPE_OFFSET    15
+
+#define FRAME_TYPE_TELEMETRY      0x00  // Звичайний пакет (Reserved = 0)
+#define FRAME_TYPE_DIAG_HEAP      0xD1  // Купа mruby VM (SilkenPoolStats)
+#define FRAME_TYPE_DIAG_PROFILE   0xD2  // Тривалість однієї фази циклу (ProfStat)
+#define FRAME_TYPE_DIAG_RADIO     0xD3  // Конкуренція за ефір: CAD / backoff (LbtState)
+
+#define DIAG_PROF_TICK_US         16    // Одиниця часу профілю: 16 мкс (u16 → до 1.05 с)
+#define DIAG_LBT_BACKOFF_UNIT_MS  100   // Одиниця сумарного backoff: 100 мс (u16 → до 1.8 год)
+
+// Кадр купи:
+//   [4-5]  peak_bytes_in_use (u16, насичення 0xFFFF)
+//   [6-7]  carved_bytes — скільки арени вже нарізано (u16, насичення)
+//   [8-9]  alloc_count (u16, молодші біти — сервер бачить приріст між кадрами)
+//   [10]   gc_runs — примусові GC через поріг пулу (u8, насичення)
+//   [14]   failed_count — відмови алокатора (u8, насичення)
+void Diag_Pack_Heap_Frame(uint8_t* frame, uint32_t did, uint8_t ttl, uint16_t fw_version,
+                          const SilkenPoolStats* stats, uint32_t gc_runs);
+
+// Кадр профілю (одна фаза на кадр, фази йдуть по колу):
+//   [4]    ProfPhase
+//   [5-6]  min   (u16, одиниці DIAG_PROF_TICK_US, насичення 0xFFFF)
+//   [7-8]  max   (u16, те саме)
+//   [9-10] EWMA  (u16, те саме)
+//   [14]   count — кількість замірів (u8, насичення)
+void Diag_Pack_Profile_Frame(uint8_t* frame, uint32_t did, uint8_t ttl, uint16_t fw_version,
+                             ProfPhase phase, const ProfStat* stat);
+
+// Кадр радіо (Listen-Before-Talk):
+//   [4-5]  cad_runs (u16, молодші біти — сервер бачить приріст між кадрами)
+//   [6-7]  cad_busy — CAD із зайнятим каналом = кількість backoff (u16, молодші біти)
+//   [8-9]  backoff_ms_total / DIAG_LBT_BACKOFF_UNIT_MS (u16, насичення)
+//   [10]   forced_tx — кадри у зайнятий канал після LBT_MAX_ATTEMPTS (u8, насичення)
+//   [14]   max_attempt — найдовша серія зайнятих CAD (u8)
+void Diag_Pack_Radio_Frame(uint8_t* frame, uint32_t did, uint8_t ttl, uint16_t fw_version,
+                           const LbtState* lbt);
+
+static inline uint8_t Diag_Frame_Type(const uint8_t* frame)
+{
+    return frame[DIAG_FRAME_TYPE_OFFSET];
+}
+
+#endif /* SILKEN_DIAG_H */
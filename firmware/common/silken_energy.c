@@ -0,0 +1,138 @@
+/**
+  ******************************************************************************
+  * @file           : silken_energy.c
+  * @brief          : Енергетичний планувальник Солдата (іоністор → план пробудження)
+  ******************************************************************************
+  */
+#include "silken_energy.h"
+
+#include <string.h>
+
+int64_t Energy_Stored_UJ(uint16_t vcap_mv, uint16_t v_min_mv)
+{
+    // E = C·(V² − Vmin²)/2; C у мФ, V у мВ → мкДж = C_mF · mV² / 2000
+    int64_t v2 = (int64_t)vcap_mv * vcap_mv;
+    int64_t vmin2 = (int64_t)v_min_mv * v_min_mv;
+    return ((int64_t)ENERGY_CAP_MF * (v2 - vmin2)) / 2000;
+}
+
+void Energy_Init(EnergyState* st)
+{
+    memset(st, 0, sizeof(*st));
+}
+
+void Energy_Clock_Restore(EnergyClock* c, uint32_t word)
+{
+    memset(c, 0, sizeof(*c));
+    // Зберігаємо last_ms + 1: нуль лишається ознакою "ще не було"
+    if (word > 0 && word <= ENERGY_DAY_MS) {
+        c->last_ms = word - 1U;
+        c->valid = 1;
+    }
+}
+
+uint32_t Energy_Clock_Word(const EnergyClock* c)
+{
+    return c->valid ? c->last_ms + 1U : 0U;
+}
+
+uint32_t Energy_Clock_Elapsed_S(EnergyClock* c, uint32_t rtc_ms)
+{
+    uint32_t elapsed_ms = 0;
+    if (c->valid) {
+        elapsed_ms = (rtc_ms + ENERGY_DAY_MS - c->last_ms) % ENERGY_DAY_MS;
+    }
+    c->last_ms = rtc_ms;
+    c->valid = 1;
+
+    elapsed_ms += c->carry_ms;
+    c->carry_ms = elapsed_ms % 1000U;
+    return elapsed_ms / 1000U;
+}
+
+void Energy_Update(EnergyState* st, uint16_t vcap_mv, uint32_t delta_t_s)
+{
+    if (st->initialized && delta_t_s > 0) {
+        // Харвест = приріст енергії іоністора + усе, що ми за цей час витратили
+        int64_t gained = Energy_Stored_UJ(vcap_mv, 0) - Energy_Stored_UJ(st->last_vcap_mv, 0);
+        int64_t harvested = gained + (int64_t)st->spent_uj +
+                            (int64_t)ENERGY_P_SLEEP_UW * (int64_t)delta_t_s;
+        int64_t sample = harvested / (int64_t)delta_t_s;
+        if (sample < 0) sample = 0; // Шум АЦП не робить харвестер споживачем
+
+        if (st->initialized == 1) {
+            st->harvest_uw = (uint32_t)sample; // Перша оцінка — без згладжування
+            st->initialized = 2;
+        } else {
+            int64_t h = (int64_t)st->harvest_uw;
+            h += (sample - h) / (1 << ENERGY_HARVEST_EWMA_SHIFT);
+            st->harvest_uw = (uint32_t)h;
+        }
+    } else if (!st->initialized) {
+        st->initialized = 1;
+    }
+
+    st->last_vcap_mv = vcap_mv;
+    st->spent_uj = 0;
+}
+
+void Energy_Spend(EnergyState* st, uint32_t cost_uj)
+{
+    st->spent_uj += cost_uj;
+}
+
+// Енергонейтральний інтервал: сон, за який харвестер поверне ціну пробудження.
+// Масштабується запасом: вище ENERGY_TARGET_MV — частіше, нижче — рідше.
+static uint32_t energy_interval(int64_t p_net_uw, int64_t available_uj, uint32_t cost_uj)
+{
+    if (p_net_uw <= 0 || available_uj <= 0) return ENERGY_SLEEP_MAX_S;
+
+    int64_t target_uj = Energy_Stored_UJ(ENERGY_TARGET_MV, ENERGY_RESERVE_MV);
+    int64_t t = ((int64_t)cost_uj * target_uj) / (p_net_uw * available_uj);
+
+    if (t < ENERGY_SLEEP_MIN_S) return ENERGY_SLEEP_MIN_S;
+    if (t > ENERGY_SLEEP_MAX_S) return ENERGY_SLEEP_MAX_S;
+    return (uint32_t)t;
+}
+
+void Energy_Plan(const EnergyState* st, EnergyPlan* plan)
+{
+    static const uint32_t tier_cost[] = {
+        ENERGY_COST_WAKE_UJ,
+        ENERGY_COST_WAKE_UJ + ENERGY_COST_TINYML_UJ,
+        ENERGY_COST_WAKE_UJ + ENERGY_COST_TINYML_UJ + ENERGY_COST_LISTEN_UJ,
+        ENERGY_COST_WAKE_UJ + ENERGY_COST_TINYML_UJ + ENERGY_COST_LISTEN_UJ + ENERGY_COST_RELAY_UJ
+    };
+
+    int64_t available = Energy_Stored_UJ(st->last_vcap_mv, ENERGY_RESERVE_MV);
+    int64_t listen_floor = Energy_Stored_UJ(ENERGY_LISTEN_MV, ENERGY_RESERVE_MV);
+    // Без жодної оцінки харвесту (перше пробудження) вважаємо його нульовим
+    int64_t p_net = (st->initialized == 2 ? (int64_t)st->harvest_uw : 0) - ENERGY_P_SLEEP_UW;
+
+    // Каденс телеметрії — енергонейтральний для базового пробудження (+TinyML).
+    // Слухання та естафета — лише надлишок понад цей каденс.
+    uint32_t sleep_s = energy_interval(p_net, available, tier_cost[ENERGY_TIER_LEAN]);
+
+    // Без чистого харвесту (ніч, хмари) рахуємо лише стік STOP2
+    int64_t drift_uw = (p_net > 0) ? p_net : -(int64_t)ENERGY_P_SLEEP_UW;
+
+    // Від найдорожчого плану до найдешевшого: перший, де прогноз запасу на
+    // момент наступного пробудження не падає нижче вимог рівня
+    EnergyTier tier = ENERGY_TIER_SURVIVAL;
+    for (int t = ENERGY_TIER_RELAY; t > ENERGY_TIER_SURVIVAL; t--) {
+        int64_t projected = available - (int64_t)tier_cost[t] + drift_uw * (int64_t)sleep_s;
+        int64_t floor_uj = (t >= ENERGY_TIER_LISTEN) ? listen_floor : 0;
+        if (projected >= floor_uj) {
+            tier = (EnergyTier)t;
+            break;
+        }
+    }
+    if (tier == ENERGY_TIER_SURVIVAL) sleep_s = ENERGY_SLEEP_MAX_S;
+
+    plan->tier = tier;
+    plan->sleep_s = sleep_s;
+    plan->run_tinyml = (tier >= ENERGY_TIER_LEAN);
+    plan->listen = (tier >= ENERGY_TIER_LISTEN);
+    plan->relay = (tier >= ENERGY_TIER_RELAY);
+    plan->available_uj = available;
+}
@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file           : silken_energy.h
+  * @brief          : Енергетичний планувальник Солдата (іоністор → план пробудження)
+  ******************************************************************************
+  *
+  * Солдат живе з іоністора 0.47 Ф, який заряджає харвестер. Замість фіксованого
+  * періоду сну та одного порогу Vcap планувальник:
+  *   1. оцінює потужність харвестера з траєкторії Vcap між пробудженнями
+  *      (ΔE іоністора + витрачене минулого циклу) / delta_t_seconds;
+  *   2. прогнозує запас енергії над резервом PVD на момент наступного пробудження;
+  *   3. обирає інтервал RTC та дозволи: TinyML, слухання ефіру, mesh-естафета.
+  *
+  * Вся арифметика цілочисельна (мкДж, мкВт, мВ) — код однаковий на Cortex-M4
+  * та в хост-симуляції (firmware/test/sim_energy.c).
+  */
+#ifndef SILKEN_ENERGY_H
+#define SILKEN_ENERGY_H
+
+#include <stdint.h>
+
+// --- Фізика іоністора та бюджет (HARDWARE.md: 0.47 F / 5.5 V) ---
+#define ENERGY_CAP_MF             470     // Ємність, мФ
+#define ENERGY_PVD_MV             2200    // Поріг PVD (PWR_PVDLEVEL_7) — смерть
+#define ENERGY_RESERVE_MV         2400    // Резерв над PVD, який план не витрачає
+#define ENERGY_LISTEN_MV          2800    // Рівень, нижче якого не слухаємо ефір
+#define ENERGY_TARGET_MV          3000    // Рівень, довкола якого тримаємо заряд
+#define ENERGY_P_SLEEP_UW         7       // STOP2: 2.1 мкА × 3.3 В
+
+// --- Ціна дій одного пробудження, мкДж ---
+#define ENERGY_COST_WAKE_UJ       8800    // АЦП + mruby + AES + TX 20 байт (jitter у STOP2)
+#define ENERGY_COST_UPLINK_UJ     7300    // Частка WAKE: jitter у STOP2 + преамбула + власні 20 байт
+#define ENERGY_COST_TINYML_UJ     2000    // DMA 512 семплів + інференс
+#define ENERGY_COST_LISTEN_UJ     10000   // Вікно RX: радіо ~5 мА × 500 мс, ядро у STOP1
+#define ENERGY_COST_RELAY_UJ      7300    // Окремий кадр (діагностика): пауза у STOP2 + преамбула + 20 байт
+#define ENERGY_COST_RELAY_BLOCK_UJ 4000   // +20 байт естафети в агрегованому кадрі (~29 мс ефіру, без преамбули)
+#define ENERGY_COST_CAD_UJ        60      // Один CAD перед TX: ~2 символи SF7 + пробудження радіо
+
+// --- Межі інтервалу сну (RTC Wakeup, ck_spre 1 Гц) ---
+#define ENERGY_SLEEP_MIN_S        60
+#define ENERGY_SLEEP_MAX_S        3600
+
+#define ENERGY_HARVEST_EWMA_SHIFT 2       // α = 1/4 для оцінки потужності харвестера
+#define ENERGY_DAY_MS             86400000U // Календар RTC: мілісекунди доби
+
+// Рівні плану (для телеметрії та симуляції)
+typedef enum {
+    ENERGY_TIER_SURVIVAL = 0,  // Лише телеметрія, максимальний сон
+    ENERGY_TIER_LEAN     = 1,  // + TinyML
+    ENERGY_TIER_LISTEN   = 2,  // + вікно RX (OTA, чужі пакети)
+    ENERGY_TIER_RELAY    = 3   // + ретрансляція mesh
+} EnergyTier;
+
+// Стан живе в SRAM (переживає STOP2); після ребуту стартує консервативно
+typedef struct {
+    uint16_t last_vcap_mv;
+    uint8_t  initialized;
+    uint32_t harvest_uw;        // EWMA потужності харвестера, мкВт
+    uint32_t spent_uj;          // Витрачено з моменту попереднього пробудження
+} EnergyState;
+
+typedef struct {
+    uint32_t   sleep_s;         // Наступний інтервал RTC Wakeup
+    uint8_t    run_tinyml;
+    uint8_t    listen;
+    uint8_t    relay;
+    EnergyTier tier;
+    int64_t    available_uj;    // Запас над ENERGY_RESERVE_MV зараз
+} EnergyPlan;
+
+// Годинник пробуджень: SysTick у STOP2 стоїть, тож час між пробудженнями
+// рахується з календаря RTC (мс доби, LSE). Сон ≤ ENERGY_SLEEP_MAX_S, тож
+// перехід через північ однозначний. Дробові секунди переносяться далі.
+typedef struct {
+    uint32_t last_ms;           // Мс доби попереднього пробудження
+    uint32_t carry_ms;          // Залишок < 1 с, ще не відданий у секунди
+    uint8_t  valid;
+} EnergyClock;
+
+void Energy_Init(EnergyState* st);
+
+// word — з Backup-регістра (Energy_Clock_Word); 0 або сміття — час невідомий
+void Energy_Clock_Restore(EnergyClock* c, uint32_t word);
+uint32_t Energy_Clock_Word(const EnergyClock* c);
+
+// Цілі секунди від попереднього виклику; перший виклик (час невідомий) — 0
+uint32_t Energy_Clock_Elapsed_S(EnergyClock* c, uint32_t rtc_ms);
+
+// Викликається на початку пробудження: новий Vcap та час з минулого пробудження
+void Energy_Update(EnergyState* st, uint16_t vcap_mv, uint32_t delta_t_s);
+
+// Облік фактично виконаних дій (ENERGY_COST_*), щоб не сплутати витрати з поганим харвестом
+void Energy_Spend(EnergyState* st, uint32_t cost_uj);
+
+void Energy_Plan(const EnergyState* st, EnergyPlan* plan);
+
+// Енергія іоністора над v_min_mv (мкДж); від'ємна, якщо vcap < v_min
+int64_t Energy_Stored_UJ(uint16_t vcap_mv, uint16_t v_min_mv);
+
+#endif /* SILKEN_ENERGY_H */
@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @file           : silken_keys.c
+  * @brief          : Персональні ключі Солдатів на Королеві: таблиця у Flash + LRU у SRAM
+  ******************************************************************************
+  */
+#include "silken_keys.h"
+
+#include <string.h>
+
+static inline uint16_t keys_src(uint32_t did)
+{
+    return (uint16_t)(did & 0xFFFFU); // Src заголовка — молодші 16 біт DID
+}
+
+// Перший запис з Src ≥ src (таблиця відсортована за Src)
+static uint16_t keys_lower_bound(KeyCache* c, uint16_t src)
+{
+    uint16_t lo = 0, hi = c->count;
+    while (lo < hi) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        c->stats.table_probes++;
+        if (keys_src(c->table[mid].did) < src) lo = (uint16_t)(mid + 1);
+        else hi = mid;
+    }
+    return lo;
+}
+
+static uint16_t keys_run_length(KeyCache* c, uint16_t start, uint16_t src)
+{
+    uint16_t n = 0;
+    while (start + n < c->count) {
+        c->stats.table_probes++;
+        if (keys_src(c->table[start + n].did) != src) break;
+        n++;
+    }
+    return n;
+}
+
+static KeySlot* keys_find_slot(KeyCache* c, uint16_t src)
+{
+    for (int i = 0; i < KEYS_CACHE_SLOTS; i++) {
+        if (c->slot[i].stamp != 0 && c->slot[i].src == src) return &c->slot[i];
+    }
+    return NULL;
+}
+
+// Порожній слот або найдавніше використаний
+static KeySlot* keys_victim(KeyCache* c)
+{
+    KeySlot* victim = &c->slot[0];
+    for (int i = 1; i < KEYS_CACHE_SLOTS && victim->stamp != 0; i++) {
+        if (c->slot[i].stamp < victim->stamp) victim = &c->slot[i];
+    }
+    return victim;
+}
+
+static KeyRef keys_ref(const KeySlot* s)
+{
+    KeyRef ref = { s->key, s->did, s->index };
+    return ref;
+}
+
+const KeyRecord* Keys_Table_From_Flash(const void* base, uint16_t* count)
+{
+    const KeyTableHeader* hdr = (const KeyTableHeader*)base;
+    const KeyRecord* table = (const KeyRecord*)(const void*)(hdr + 1);
+
+    *count = 0;
+    if (hdr->magic != KEYS_TABLE_MAGIC || hdr->count == 0 || hdr->count > KEYS_TABLE_MAX) {
+        return NULL; // Стерта Flash (0xFFFFFFFF) або таблицю ще не прошито
+    }
+    for (uint32_t i = 1; i < hdr->count; i++) {
+        if (keys_src(table[i].did) < keys_src(table[i - 1].did)) return NULL; // Бінарний пошук збрехав би
+    }
+    *count = (uint16_t)hdr->count;
+    return table;
+}
+
+void Keys_Init(KeyCache* c, const KeyRecord* table, uint16_t count, const uint32_t* network_key)
+{
+    memset(c, 0, sizeof(*c));
+    c->table = table;
+    c->count = (table != NULL && count <= KEYS_TABLE_MAX) ? count : 0;
+    c->network_key = network_key;
+    c->loaded = KEYS_NETWORK;
+}
+
+KeyRef Keys_Lookup(KeyCache* c, uint16_t src, uint8_t attempt)
+{
+    KeyRef none = { NULL, 0, KEYS_NETWORK };
+    KeySlot* s = keys_find_slot(c, src);
+
+    if (attempt == 0) {
+        c->stats.lookups++;
+        if (s != NULL) {
+            c->stats.hits++;
+            s->stamp = ++c->clock;
+            return keys_ref(s);
+        }
+    } else {
+        c->stats.retries++;
+    }
+
+    // Кандидати: записи з цим Src підряд (run), останнім — ключ мережі
+    uint16_t start = keys_lower_bound(c, src);
+    uint16_t run = keys_run_length(c, start, src);
+    uint16_t total = (uint16_t)(run + 1);
+    uint16_t next;
+
+    if (attempt == 0) {
+        next = 0;
+    } else if (attempt >= total) {
+        return none;
+    } else if (s != NULL) {
+        // Слот тримає попереднього кандидата — беремо наступного по колу
+        uint16_t pos = (s->index == KEYS_NETWORK || s->index < start || s->index >= start + run)
+                     ? run : (uint16_t)(s->index - start);
+        next = (uint16_t)((pos + 1) % total);
+    } else {
+        next = attempt;
+    }
+
+    if (s == NULL) s = keys_victim(c);
+    s->src = src;
+    s->stamp = ++c->clock;
+    if (next == run) {
+        s->index = KEYS_NETWORK;
+        s->did = 0;
+        memcpy(s->key, c->network_key, sizeof(s->key));
+    } else {
+        const KeyRecord* r = &c->table[start + next];
+        c->stats.table_probes++;
+        s->index = (uint16_t)(start + next);
+        s->did = r->did;
+        memcpy(s->key, r->key, sizeof(s->key));
+    }
+    return keys_ref(s);
+}
+
+KeyRef Keys_Network(const KeyCache* c)
+{
+    KeyRef ref = { c->network_key, 0, KEYS_NETWORK };
+    return ref;
+}
+
+uint8_t Keys_Mark_Loaded(KeyCache* c, const KeyRef* ref)
+{
+    if (ref->index == c->loaded) return 0;
+    c->loaded = ref->index;
+    c->stats.loads++;
+    return 1;
+}
+
+void Keys_Forget_Loaded(KeyCache* c)
+{
+    c->loaded = KEYS_UNKNOWN;
+}
+
+uint8_t Keys_Ref_Owns(const KeyRef* ref, const uint8_t* plain_body)
+{
+    if (ref->index == KEYS_NETWORK) return 1; // Спільний ключ: DID не прив'язаний
+    uint32_t did = ((uint32_t)plain_body[0] << 24) | ((uint32_t)plain_body[1] << 16) |
+                   ((uint32_t)plain_body[2] << 8) | (uint32_t)plain_body[3];
+    return did == ref->did;
+}
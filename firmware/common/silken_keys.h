@@ -0,0 +1,112 @@
+/**
+  ******************************************************************************
+  * @file           : silken_keys.h
+  * @brief          : Персональні ключі Солдатів на Королеві: таблиця у Flash + LRU у SRAM
+  ******************************************************************************
+  *
+  * Досі вся мережа жила на одному aes_key[8], хоча сервер тримає окремий
+  * ключ кожного вузла (HardwareKey). Тепер Королева обирає ключ блоку за
+  * відкритим Src (silken_route.h) ще до розшифровки:
+  *
+  *   Src → LRU-кеш у SRAM (KEYS_CACHE_SLOTS) → таблиця у Flash (бінарний пошук)
+  *       → запису немає: спільний ключ мережі (Солдат без персонального ключа)
+  *
+  * Таблиця у Flash: [magic:4][count:4][KeyRecord × count], записи відсортовані
+  * за Src (молодші 16 біт DID). Src — лише 16 біт: серед тисяч дерев збіги
+  * неминучі, тож кандидати з однаковим Src лежать підряд, і Keys_Lookup
+  * обходить їх по колу (attempt = 0, 1, …), починаючи з того, що спрацював
+  * минулого разу; останнім кандидатом іде ключ мережі. Правильний ключ
+  * підтверджують Route_Hdr_Binds_Body і Keys_Ref_Owns (повний DID у тілі).
+  * Так само переживається ротація: на Grace Period у таблиці два записи
+  * одного DID — новий і попередній ключ.
+  *
+  * Персональні ключі — лише для аплінку. Відповіді Королеви (маяк, OTA-чанк)
+  * чують і сусіди адресата, а Солдат розшифровує ефір ключем мережі, тож
+  * вони йдуть на Keys_Network — без пошуку і без запису в статистику.
+  *
+  * Апаратний AES STM32WL розгортає ключ сам, тож слот кешу — копія 32 байтів
+  * ключа в SRAM, а не програмний розклад раундів. Кеш економить пошук у
+  * Flash; перемикання ключа в периферії (HAL_CRYP_Init з новим pKey) —
+  * лише коли блок потребує іншого ключа, ніж завантажений (Keys_Mark_Loaded).
+  * Лічильники — у KeyStats; хост-бенчмарк: firmware/test/sim_keys.c.
+  */
+#ifndef SILKEN_KEYS_H
+#define SILKEN_KEYS_H
+
+#include <stdint.h>
+
+#define KEYS_WORDS              8           // AES-256
+#define KEYS_CACHE_SLOTS        16          // 16 × 44 Б ≈ 0.7 КБ SRAM
+#define KEYS_TABLE_MAGIC        0x4B455931U // "KEY1"
+#define KEYS_TABLE_MAX          3000        // 8 + 3000 × 36 Б ≈ 105 КБ Flash
+#define KEYS_NETWORK            0xFFFFU     // Індекс: спільний ключ мережі
+#define KEYS_UNKNOWN            0xFFFEU     // Індекс: у периферії невідомо що
+
+// Запис таблиці у Flash (36 байт)
+typedef struct {
+    uint32_t did;                   // Повний DID Солдата
+    uint32_t key[KEYS_WORDS];       // AES-256, слова як у aes_key[]
+} KeyRecord;
+
+// Заголовок таблиці у Flash; записи йдуть одразу за ним
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+} KeyTableHeader;
+
+// Обраний ключ: дійсний до наступного Keys_Lookup (слот може бути витіснено)
+typedef struct {
+    const uint32_t* key;            // NULL — кандидатів більше немає
+    uint32_t did;                   // Очікуваний DID (для KEYS_NETWORK не перевіряється)
+    uint16_t index;                 // Запис таблиці або KEYS_NETWORK
+} KeyRef;
+
+typedef struct {
+    uint16_t src;
+    uint16_t index;                 // Запис таблиці або KEYS_NETWORK
+    uint32_t did;
+    uint32_t stamp;                 // LRU: більший — свіжіший; 0 — слот порожній
+    uint32_t key[KEYS_WORDS];
+} KeySlot;
+
+typedef struct {
+    uint32_t lookups;               // Keys_Lookup з attempt 0 (один на блок)
+    uint32_t hits;                  // …з них знайдено в кеші
+    uint32_t retries;               // attempt > 0: збіг Src або ротація
+    uint32_t table_probes;          // Прочитаних записів таблиці у Flash
+    uint32_t loads;                 // Перемикань ключа в периферії
+} KeyStats;
+
+typedef struct {
+    const KeyRecord* table;
+    uint16_t count;
+    const uint32_t* network_key;
+    uint16_t loaded;                // Що зараз у периферії AES
+    uint32_t clock;
+    KeySlot slot[KEYS_CACHE_SLOTS];
+    KeyStats stats;
+} KeyCache;
+
+// Таблиця з Flash: magic, розмір і сортування за Src. Інакше NULL, count = 0.
+const KeyRecord* Keys_Table_From_Flash(const void* base, uint16_t* count);
+
+// Порожній кеш; у периферії — network_key (так її ініціалізує MX_AES_Init)
+void Keys_Init(KeyCache* c, const KeyRecord* table, uint16_t count, const uint32_t* network_key);
+
+// Кандидат №attempt для блоку з Src. attempt 0 — той, що спрацював минулого
+// разу; далі — решта записів з тим самим Src, останнім — ключ мережі.
+KeyRef Keys_Lookup(KeyCache* c, uint16_t src, uint8_t attempt);
+
+// Ключ мережі для відповідей Королеви (маяк, OTA-чанк); не рахується як lookups
+KeyRef Keys_Network(const KeyCache* c);
+
+// 1 — периферію треба перезавантажити цим ключем (рахується як loads)
+uint8_t Keys_Mark_Loaded(KeyCache* c, const KeyRef* ref);
+
+// Хтось інший змінив pKey (CBC для Rails): наступний блок перезавантажить ключ
+void Keys_Forget_Loaded(KeyCache* c);
+
+// 1 — розшифроване тіло належить власнику ключа (DID у байтах 0-3)
+uint8_t Keys_Ref_Owns(const KeyRef* ref, const uint8_t* plain_body);
+
+#endif /* SILKEN_KEYS_H */
@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file           : silken_lbt.c
+  * @brief          : Listen-Before-Talk: CAD SX126x + двійковий експоненційний backoff
+  ******************************************************************************
+  */
+#include "silken_lbt.h"
+
+#include <string.h>
+
+void LBT_Init(LbtState* st)
+{
+    memset(st, 0, sizeof(*st));
+}
+
+void LBT_Frame_Start(LbtState* st)
+{
+    st->attempt = 0;
+}
+
+uint32_t LBT_On_Cad(LbtState* st, uint8_t channel_busy, uint32_t rnd)
+{
+    st->cad_runs++;
+
+    if (!channel_busy) {
+        st->frames++;
+        return 0;
+    }
+
+    st->cad_busy++;
+    if (st->attempt >= LBT_MAX_ATTEMPTS) {
+        // Канал зайнятий надто довго — передаємо, щоб кадр не загубився в черзі
+        st->forced_tx++;
+        st->frames++;
+        return 0;
+    }
+
+    uint32_t window = (uint32_t)LBT_SLOT_MS << st->attempt;
+    st->attempt++;
+    if (st->attempt > st->max_attempt) st->max_attempt = st->attempt;
+
+    uint32_t backoff = 1U + rnd % window; // ≥ 1: 0 зарезервований для «передавати»
+    st->backoff_ms_total += backoff;
+    return backoff;
+}
@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file           : silken_lbt.h
+  * @brief          : Listen-Before-Talk: CAD SX126x + двійковий експоненційний backoff
+  ******************************************************************************
+  *
+  * Перед кожним Radio.Send Солдат запускає CAD (Channel Activity Detection,
+  * ~2 символи LoRa). Канал зайнятий → пауза випадкової довжини у вікні
+  * LBT_SLOT_MS · 2^спроба (у STOP2 через LP_Delay_Ms) і повторний CAD.
+  * Після LBT_MAX_ATTEMPTS зайнятих CAD поспіль кадр іде в ефір попри все
+  * (телеметрія не повинна застрягати назавжди) — це рахується як forced_tx.
+  *
+  * Модуль — лише логіка рішень і лічильники; радіо та сон викликає прошивка.
+  * Той самий код ганяє хост-симулятор колізій (firmware/test/sim_lbt.c).
+  */
+#ifndef SILKEN_LBT_H
+#define SILKEN_LBT_H
+
+#include <stdint.h>
+
+#define LBT_SLOT_MS           50      // ≈ ефірний час 16-байтного кадру (SF7/125 кГц)
+#define LBT_MAX_ATTEMPTS      6       // Вікна: 50, 100, 200, 400, 800, 1600 мс
+#define LBT_CAD_TIMEOUT_MS    20      // Страховка, якщо CadDone не прийшов
+
+// Лічильники вузла (SRAM, переживають STOP2); ідуть у діагностичний кадр 0xD3
+typedef struct {
+    uint8_t  attempt;          // Зайнятих CAD поспіль для поточного кадру
+    uint8_t  max_attempt;      // Найдовша серія за аптайм
+    uint32_t cad_runs;         // Усі CAD
+    uint32_t cad_busy;         // CAD, що побачили чужу передачу (= кількість backoff)
+    uint32_t backoff_ms_total; // Сумарний час очікування
+    uint32_t frames;           // Кадри, що пішли в ефір
+    uint32_t forced_tx;        // Кадри, відправлені в зайнятий канал (вичерпано спроби)
+} LbtState;
+
+void LBT_Init(LbtState* st);
+
+// Новий кадр: серія спроб з нуля
+void LBT_Frame_Start(LbtState* st);
+
+// Результат CAD. Повертає паузу (мс) перед наступним CAD
+// або 0 — передавати зараз (канал вільний або спроби вичерпано).
+// rnd — апаратна випадковість (HRNG).
+uint32_t LBT_On_Cad(LbtState* st, uint8_t channel_busy, uint32_t rnd);
+
+#endif /* SILKEN_LBT_H */
@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : silken_lpdelay.c
+  * @brief          : Низькоенергетична пауза на LPTIM1 (замість HAL_Delay)
+  ******************************************************************************
+  */
+#include "silken_lpdelay.h"
+
+uint16_t LP_Delay_Ticks(uint32_t ms)
+{
+    if (ms > LPDELAY_MAX_CHUNK_MS) ms = LPDELAY_MAX_CHUNK_MS;
+    uint32_t ticks = (ms * LPDELAY_LSE_HZ) / 1000U;
+    return (ticks == 0) ? 1U : (uint16_t)ticks;
+}
+
+LpDelayMode LP_Delay_Mode(uint32_t ms)
+{
+    if (ms == 0) return LPDELAY_MODE_NONE;
+    return (ms < LPDELAY_STOP2_MIN_MS) ? LPDELAY_MODE_SLEEP : LPDELAY_MODE_STOP2;
+}
+
+LpDelayMode LP_Delay_Mode_Max(uint32_t ms, LpDelayMode deepest)
+{
+    LpDelayMode mode = LP_Delay_Mode(ms);
+    return (mode > deepest) ? deepest : mode;
+}
+
+#if defined(__arm__)
+static LPTIM_HandleTypeDef* lpdelay_timer = NULL;
+static volatile uint8_t lpdelay_expired = 0;
+
+void LP_Delay_Init(LPTIM_HandleTypeDef* hlptim)
+{
+    lpdelay_timer = hlptim;
+}
+
+void LP_Delay_On_Compare(void)
+{
+    lpdelay_expired = 1;
+}
+
+static void lp_delay(uint32_t ms, LpDelayMode deepest)
+{
+    while (ms > 0) {
+        uint32_t chunk = (ms > LPDELAY_MAX_CHUNK_MS) ? LPDELAY_MAX_CHUNK_MS : ms;
+        LpDelayMode mode = LP_Delay_Mode_Max(chunk, deepest);
+        ms -= chunk;
+
+        lpdelay_expired = 0;
+        HAL_LPTIM_SetOnce_Start_IT(lpdelay_timer, 0xFFFF, LP_Delay_Ticks(chunk));
+
+        HAL_SuspendTick();
+        while (!lpdelay_expired) {
+            // Прапорець під вимкненими перериваннями: compare між перевіркою
+            // та WFI лишається pending і все одно розбудить ядро
+            __disable_irq();
+            if (!lpdelay_expired) {
+                if (mode == LPDELAY_MODE_STOP2) {
+                    HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
+                } else {
+                    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+                }
+            }
+            __enable_irq();
+        }
+        HAL_ResumeTick();
+
+        HAL_LPTIM_SetOnce_Stop_IT(lpdelay_timer);
+    }
+}
+
+void LP_Delay_Ms(uint32_t ms)
+{
+    lp_delay(ms, LPDELAY_MODE_STOP2);
+}
+
+void LP_Delay_Sleep_Ms(uint32_t ms)
+{
+    lp_delay(ms, LPDELAY_MODE_SLEEP);
+}
+#endif
@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  * @file           : silken_lpdelay.h
+  * @brief          : Низькоенергетична пауза на LPTIM1 (замість HAL_Delay)
+  ******************************************************************************
+  *
+  * HAL_Delay крутить ядро на 48 МГц (~3.5 мА) заради таймера. LP_Delay_Ms
+  * заводить одноразовий compare LPTIM1 від LSE (32.768 кГц) і кладе ядро:
+  *   < LPDELAY_STOP2_MIN_MS — у SLEEP (пробудження за кілька тактів);
+  *   інакше                 — у STOP2 (~1 мкА; радіо SUBGHZ допрацьовує TX саме).
+  * Інші переривання (EXTI п'єзо, RxDone) будять ядро, і воно засинає знову,
+  * доки не спрацює compare. Пауза довша за один період LPTIM ділиться на шматки.
+  *
+  * Використовується там, де чекаємо на таймер: TX jitter, паузи між кадрами,
+  * пауза після OTA-пострілу Королеви. НЕ для очікування UART модема (USART1
+  * у STOP2 не приймає). Поки байти модема можуть прийти (Королева після
+  * HAL_UART_Receive_IT), пауза — LP_Delay_Sleep_Ms: лише SLEEP, периферія
+  * тактується, RXNE будить ядро, і жоден байт не губиться.
+  */
+#ifndef SILKEN_LPDELAY_H
+#define SILKEN_LPDELAY_H
+
+#include <stdint.h>
+
+#define LPDELAY_LSE_HZ          32768U
+#define LPDELAY_MAX_CHUNK_MS    1999U   // 16-бітний compare: 0xFFFF / 32.768 ≈ 2 с
+#define LPDELAY_STOP2_MIN_MS    5U      // Коротше — SLEEP: вихід зі STOP2 не окупиться
+
+typedef enum {
+    LPDELAY_MODE_NONE  = 0,   // 0 мс — повертаємось одразу
+    LPDELAY_MODE_SLEEP = 1,
+    LPDELAY_MODE_STOP2 = 2
+} LpDelayMode;
+
+// Мілісекунди → такти LPTIM (LSE), не менше 1; ms ≤ LPDELAY_MAX_CHUNK_MS
+uint16_t LP_Delay_Ticks(uint32_t ms);
+
+// Режим сну для паузи заданої довжини
+LpDelayMode LP_Delay_Mode(uint32_t ms);
+
+// Те саме, але не глибше deepest (LPDELAY_MODE_SLEEP — для LP_Delay_Sleep_Ms)
+LpDelayMode LP_Delay_Mode_Max(uint32_t ms, LpDelayMode deepest);
+
+#if defined(__arm__)
+#include "main.h"             // LPTIM_HandleTypeDef, HAL_PWREx_*
+
+// hlptim — LPTIM1 від LSE; той самий таймер може мати й інші одноразові задачі,
+// але не одночасно з паузою
+void LP_Delay_Init(LPTIM_HandleTypeDef* hlptim);
+void LP_Delay_Ms(uint32_t ms);
+void LP_Delay_Sleep_Ms(uint32_t ms);  // Без STOP2: UART лишається на прийомі
+
+// Викликати з HAL_LPTIM_CompareMatchCallback
+void LP_Delay_On_Compare(void);
+#endif
+
+#endif /* SILKEN_LPDELAY_H */
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file           : silken_ota.c
+  * @brief          : Збирання OTA-образу Солдатом з LoRa-чанків Королеви
+  ******************************************************************************
+  */
+#include "silken_ota.h"
+#include "silken_crc.h"
+
+#include <string.h>
+
+static void ota_rx_restart(OtaRx* ota)
+{
+    memset(ota->received, 0, sizeof(ota->received));
+    ota->bytes = 0;
+    ota->total = 0;
+    ota->chunks = 0;
+    ota->crc_running = CRC32_INIT;
+    ota->crc_bytes = 0;
+    ota->crc_next = 0;
+}
+
+void Ota_Rx_Init(OtaRx* ota)
+{
+    memset(ota->buffer, 0, sizeof(ota->buffer));
+    ota_rx_restart(ota);
+}
+
+OtaRxResult Ota_Rx_Chunk(OtaRx* ota, const uint8_t* plain, uint16_t size, uint16_t* image_len)
+{
+    // [FIX: AUDIT] Перевірка мінімального розміру пакета (5 байт заголовок + 1 байт даних)
+    if (size < OTA_MIN_PACKET_SIZE) return OTA_RX_IGNORED;
+
+    uint16_t chunk_idx = ((uint16_t)plain[1] << 8) | plain[2];
+    uint16_t incoming_total = ((uint16_t)plain[3] << 8) | plain[4];
+    uint16_t chunk_size = (uint16_t)(size - OTA_HEADER_SIZE);
+
+    // [FIX: AUDIT] Валідація: total_chunks не повинно змінюватися між пакетами
+    if (ota->total != 0 && incoming_total != ota->total) return OTA_RX_IGNORED;
+    ota->total = incoming_total;
+
+    // [FIX: AUDIT CRITICAL] Повна перевірка меж: індекс у бітовій карті,
+    // не дублікат, чанк у межах buffer
+    uint32_t offset = (uint32_t)chunk_idx * chunk_size;
+    if (chunk_idx >= OTA_RX_MAX_CHUNKS || ota->received[chunk_idx] ||
+        offset + chunk_size > sizeof(ota->buffer)) {
+        return OTA_RX_IGNORED;
+    }
+
+    memcpy(&ota->buffer[offset], &plain[OTA_HEADER_SIZE], chunk_size);
+    ota->received[chunk_idx] = 1;
+    ota->chunks++;
+    ota->bytes = (uint16_t)(ota->bytes + chunk_size);
+
+    // [ОПТИМІЗАЦІЯ OTA CRC] Складаємо лише суцільний префікс, що щойно подовжився
+    uint32_t crc_end = ota->crc_bytes;
+    while (ota->crc_next < ota->total && ota->crc_next < OTA_RX_MAX_CHUNKS &&
+           ota->received[ota->crc_next]) {
+        ota->crc_next++;
+        crc_end = (uint32_t)ota->crc_next * chunk_size;
+    }
+    if (crc_end > ota->crc_bytes + 4U) {
+        ota->crc_running = Crc32_Update(ota->crc_running, &ota->buffer[ota->crc_bytes],
+                                        crc_end - 4U - ota->crc_bytes);
+        ota->crc_bytes = (uint16_t)(crc_end - 4U);
+    }
+
+    if (ota->chunks < ota->total) return OTA_RX_STORED;
+
+    // [FIX: Risk 2 — OTA Integrity Gap] Останні 4 байти — CRC32 решти образу.
+    // Без перевірки пошкоджений байт = "вічний ребут".
+    OtaRxResult result = OTA_RX_BAD_CRC;
+    if (ota->bytes > 4) {
+        uint16_t data_len = (uint16_t)(ota->bytes - 4);
+        uint32_t expected_crc = ((uint32_t)ota->buffer[data_len] << 24) |
+                                ((uint32_t)ota->buffer[data_len + 1] << 16) |
+                                ((uint32_t)ota->buffer[data_len + 2] << 8) |
+                                (uint32_t)ota->buffer[data_len + 3];
+        if (ota->crc_bytes == data_len && Crc32_Final(ota->crc_running) == expected_crc) {
+            *image_len = data_len;
+            result = OTA_RX_COMPLETE;
+        }
+    }
+    ota_rx_restart(ota);
+    return result;
+}
@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file           : silken_ota.h
+  * @brief          : Збирання OTA-образу Солдатом з LoRa-чанків Королеви
+  ******************************************************************************
+  *
+  * Королева роздає образ по колу, один 16-байтний чанк на рефлекторний
+  * постріл: [0x99][index:2 BE][total:2 BE][дані:11]. Солдат приєднується з
+  * будь-якого чанка і пропускає частину — бітова карта відкидає дублікати,
+  * зсув чанка в буфері — index × розмір даних.
+  *
+  * Останні 4 байти образу — CRC32 (ISO 3309, big-endian) решти. Суцільний
+  * префікс складається в CRC, щойно подовжується (silken_crc.h), без 4
+  * останніх байт: вони можуть виявитися контрольною сумою. Останній чанк
+  * лише закриває рахунок.
+  *
+  * Досі це жило всередині циклу RX у firmware/soldier/main.c; винесено, щоб
+  * тести та бенчмарк ганяли той самий код, що й Солдат.
+  */
+#ifndef SILKEN_OTA_H
+#define SILKEN_OTA_H
+
+#include <stdint.h>
+
+#define OTA_MARKER            0x99    // Маркер OTA-пакета (перший байт)
+#define OTA_HEADER_SIZE       5       // [0x99][index:2][total:2]
+#define OTA_MIN_PACKET_SIZE   6       // OTA_HEADER_SIZE + 1 байт даних мінімум
+#define OTA_RX_BUFFER_SIZE    1024
+#define OTA_RX_MAX_CHUNKS     256     // Розмір бітової карти дублікатів
+
+typedef struct {
+    uint8_t  buffer[OTA_RX_BUFFER_SIZE];
+    uint8_t  received[OTA_RX_MAX_CHUNKS];   // 1 — чанк уже в buffer
+    uint16_t bytes;                         // Байт даних отримано
+    uint16_t total;                         // Чанків в образі (0 — ще не знаємо)
+    uint16_t chunks;                        // Чанків отримано
+    uint32_t crc_running;                   // Сирий CRC32 buffer[0..crc_bytes)
+    uint16_t crc_bytes;
+    uint16_t crc_next;                      // Перший чанк поза суцільним префіксом
+} OtaRx;
+
+typedef enum {
+    OTA_RX_IGNORED  = 0,   // Короткий, чужий total, дублікат або поза буфером
+    OTA_RX_STORED   = 1,   // Новий чанк у buffer
+    OTA_RX_COMPLETE = 2,   // Останній чанк, CRC32 збігся: образ у buffer
+    OTA_RX_BAD_CRC  = 3    // Останній чанк, CRC32 не збігся: чекаємо повтору
+} OtaRxResult;
+
+void Ota_Rx_Init(OtaRx* ota);
+
+// plain — розшифрований пакет, що починається з OTA_MARKER, size — його довжина.
+// OTA_RX_COMPLETE: *image_len — байт образу без CRC32 у ota->buffer. Після
+// COMPLETE і BAD_CRC збирання починається наново; buffer живе до наступного чанка.
+OtaRxResult Ota_Rx_Chunk(OtaRx* ota, const uint8_t* plain, uint16_t size, uint16_t* image_len);
+
+#endif /* SILKEN_OTA_H */
@@ -0,0 +1,152 @@
+/**
+  ******************************************************************************
+  * @file           : silken_pool.c
+  * @brief          : Статичний пул-алокатор з класами розмірів (купа mruby VM)
+  ******************************************************************************
+  */
+#include "silken_pool.h"
+
+#include <string.h>
+
+#define POOL_BLOCK_MAGIC 0x5EED0000U  // Верхні 16 біт header — захист від чужих вказівників
+
+typedef struct {
+    uint32_t tag;       // POOL_BLOCK_MAGIC | class_idx
+    uint32_t reserved;  // Доповнення до 8 байт (вирівнювання даних)
+} PoolHeader;
+
+typedef struct PoolFreeNode {
+    struct PoolFreeNode* next;
+} PoolFreeNode;
+
+static inline uint32_t pool_class_size(uint8_t class_idx)
+{
+    return (uint32_t)1 << (POOL_MIN_CLASS_SHIFT + class_idx);
+}
+
+// Найменший клас, що вміщує size. POOL_CLASS_COUNT — якщо не влазить ніде.
+static uint8_t pool_class_for(size_t size)
+{
+    uint8_t idx = 0;
+    while (idx < POOL_CLASS_COUNT && pool_class_size(idx) < size) {
+        idx++;
+    }
+    return idx;
+}
+
+static inline PoolHeader* pool_header(const void* ptr)
+{
+    return (PoolHeader*)((uint8_t*)(uintptr_t)ptr - POOL_HEADER_SIZE);
+}
+
+void Pool_Init(SilkenPool* pool, void* arena, uint32_t arena_size)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->arena = (uint8_t*)arena;
+    pool->arena_size = arena_size & ~(uint32_t)7U;
+}
+
+void* Pool_Alloc(SilkenPool* pool, size_t size)
+{
+    if (size == 0) size = 1;
+
+    uint8_t class_idx = pool_class_for(size);
+    if (class_idx >= POOL_CLASS_COUNT) {
+        pool->stats.failed_count++;
+        return NULL;
+    }
+
+    PoolHeader* hdr = NULL;
+
+    // 1. Свій free list — O(1)
+    if (pool->free_lists[class_idx]) {
+        PoolFreeNode* node = (PoolFreeNode*)pool->free_lists[class_idx];
+        pool->free_lists[class_idx] = node->next;
+        hdr = pool_header(node);
+    } else {
+        // 2. Нарізаємо новий блок з ненарізаної частини арени
+        uint32_t block = POOL_HEADER_SIZE + pool_class_size(class_idx);
+        if (pool->arena_size - pool->bump >= block) {
+            hdr = (PoolHeader*)(pool->arena + pool->bump);
+            pool->bump += block;
+            pool->stats.carved_bytes = pool->bump;
+        } else {
+            // 3. Арена нарізана повністю — позичаємо більший вільний блок.
+            //    Він залишається у своєму класі (header не змінюється).
+            for (uint8_t i = (uint8_t)(class_idx + 1); i < POOL_CLASS_COUNT; i++) {
+                if (pool->free_lists[i]) {
+                    PoolFreeNode* node = (PoolFreeNode*)pool->free_lists[i];
+                    pool->free_lists[i] = node->next;
+                    hdr = pool_header(node);
+                    class_idx = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!hdr) {
+        pool->stats.failed_count++;
+        return NULL;
+    }
+
+    hdr->tag = POOL_BLOCK_MAGIC | class_idx;
+
+    pool->stats.alloc_count++;
+    pool->stats.bytes_in_use += pool_class_size(class_idx);
+    if (pool->stats.bytes_in_use > pool->stats.peak_bytes_in_use) {
+        pool->stats.peak_bytes_in_use = pool->stats.bytes_in_use;
+    }
+    return (uint8_t*)hdr + POOL_HEADER_SIZE;
+}
+
+void Pool_Free(SilkenPool* pool, void* ptr)
+{
+    if (!ptr) return;
+
+    PoolHeader* hdr = pool_header(ptr);
+    // [MISRA C] Чужий або вже звільнений вказівник — ігноруємо, а не ламаємо free list
+    if ((hdr->tag & 0xFFFF0000U) != POOL_BLOCK_MAGIC) return;
+
+    uint8_t class_idx = (uint8_t)(hdr->tag & 0xFFU);
+    if (class_idx >= POOL_CLASS_COUNT) return;
+    hdr->tag = 0; // Подвійний free більше не пройде перевірку magic
+
+    PoolFreeNode* node = (PoolFreeNode*)ptr;
+    node->next = (PoolFreeNode*)pool->free_lists[class_idx];
+    pool->free_lists[class_idx] = node;
+
+    pool->stats.free_count++;
+    pool->stats.bytes_in_use -= pool_class_size(class_idx);
+}
+
+void* Pool_Realloc(SilkenPool* pool, void* ptr, size_t size)
+{
+    if (size == 0) {
+        Pool_Free(pool, ptr);
+        return NULL;
+    }
+    if (!ptr) return Pool_Alloc(pool, size);
+
+    uint32_t old_size = Pool_Block_Size(ptr);
+    if (old_size == 0) return NULL; // Не наш блок
+
+    // Влазить у поточний клас — нічого не рухаємо (типово для росту mruby-масивів)
+    if (size <= old_size) return ptr;
+
+    void* fresh = Pool_Alloc(pool, size);
+    if (!fresh) return NULL; // Старий блок лишається валідним (контракт realloc)
+
+    memcpy(fresh, ptr, old_size);
+    Pool_Free(pool, ptr);
+    return fresh;
+}
+
+uint32_t Pool_Block_Size(const void* ptr)
+{
+    if (!ptr) return 0;
+    const PoolHeader* hdr = pool_header(ptr);
+    if ((hdr->tag & 0xFFFF0000U) != POOL_BLOCK_MAGIC) return 0;
+    uint8_t class_idx = (uint8_t)(hdr->tag & 0xFFU);
+    return (class_idx < POOL_CLASS_COUNT) ? pool_class_size(class_idx) : 0;
+}
@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  * @file           : silken_pool.h
+  * @brief          : Статичний пул-алокатор з класами розмірів (купа mruby VM)
+  ******************************************************************************
+  *
+  * Детермінована заміна libc malloc для mrb_open_allocf():
+  *   - одна статична арена, що виділяється при лінкуванні (жодного sbrk);
+  *   - 10 класів розмірів (16 … 8192 байт), кожен зі своїм free list;
+  *   - звільнений блок повертається лише у свій клас → фрагментація обмежена
+  *     внутрішньою (≤ 50% блоку), а не росте тижнями як у malloc.
+  *
+  * Блок: [Header:8][Дані: 2^k байт]. Header зберігає індекс класу, тому
+  * free/realloc не потребують розміру (mruby allocf його не передає).
+  */
+#ifndef SILKEN_POOL_H
+#define SILKEN_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define POOL_MIN_CLASS_SHIFT   4     // 16 байт
+#define POOL_CLASS_COUNT       10    // 16, 32, 64, ..., 8192
+#define POOL_MAX_BLOCK         ((uint32_t)1 << (POOL_MIN_CLASS_SHIFT + POOL_CLASS_COUNT - 1))
+#define POOL_HEADER_SIZE       8     // Зберігає 8-байтне вирівнювання даних
+
+// Лічильники для діагностичного аплінку (скільки запасу має контракт)
+typedef struct {
+    uint32_t bytes_in_use;       // Зайнято зараз (з округленням до класу)
+    uint32_t peak_bytes_in_use;  // Пік bytes_in_use за весь аптайм
+    uint32_t carved_bytes;       // Скільки арени вже нарізано на блоки (high-water)
+    uint32_t alloc_count;        // Успішні алокації
+    uint32_t free_count;         // Звільнення
+    uint32_t failed_count;       // Відмови (арена вичерпана / запит > POOL_MAX_BLOCK)
+} SilkenPoolStats;
+
+typedef struct {
+    uint8_t*        arena;
+    uint32_t        arena_size;
+    uint32_t        bump;                          // Зсув ненарізаної частини арени
+    void*           free_lists[POOL_CLASS_COUNT];
+    SilkenPoolStats stats;
+} SilkenPool;
+
+// arena має бути вирівняна на 8 байт (оголошуйте як uint64_t[])
+void  Pool_Init(SilkenPool* pool, void* arena, uint32_t arena_size);
+void* Pool_Alloc(SilkenPool* pool, size_t size);
+void  Pool_Free(SilkenPool* pool, void* ptr);
+
+// Семантика mruby allocf: size == 0 → free(ptr) і NULL;
+// ptr == NULL → alloc(size); інакше — realloc (на місці, якщо влазить у клас).
+void* Pool_Realloc(SilkenPool* pool, void* ptr, size_t size);
+
+// Фактичний розмір даних блоку (розмір його класу)
+uint32_t Pool_Block_Size(const void* ptr);
+
+#endif /* SILKEN_POOL_H */
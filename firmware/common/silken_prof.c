@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file           : silken_prof.c
+  * @brief          : Профайлер фаз циклу на DWT CYCCNT (Солдат і Королева)
+  ******************************************************************************
+  */
+#if !defined(__arm__)
+#define _POSIX_C_SOURCE 199309L   // clock_gettime під -std=c11
+#endif
+#include "silken_prof.h"
+
+#include <string.h>
+
+#if !defined(__arm__)
+#include <time.h>
+
+// Хост: наносекунди монотонного годинника → такти ядра PROF_CORE_MHZ.
+// Переповнюється так само, як CYCCNT, тож арифметика фаз однакова.
+uint32_t Prof_Cycles(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    return (uint32_t)((ns * PROF_CORE_MHZ) / 1000ULL);
+}
+#endif
+
+void Prof_Init(ProfTable* tbl)
+{
+    memset(tbl, 0, sizeof(*tbl));
+#if defined(__arm__)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+void Prof_Record(ProfTable* tbl, ProfPhase phase, uint32_t cycles)
+{
+    if ((unsigned)phase >= PROF_PHASE_COUNT) return;
+    ProfStat* s = &tbl->stat[phase];
+
+    if (s->count == 0) {
+        // Перший замір — без згладжування
+        s->min_cycles = cycles;
+        s->max_cycles = cycles;
+        s->ewma_cycles = cycles;
+    } else {
+        if (cycles < s->min_cycles) s->min_cycles = cycles;
+        if (cycles > s->max_cycles) s->max_cycles = cycles;
+        int64_t e = (int64_t)s->ewma_cycles;
+        e += ((int64_t)cycles - e) / (1 << PROF_EWMA_SHIFT);
+        s->ewma_cycles = (uint32_t)e;
+    }
+    if (s->count < UINT32_MAX) s->count++;
+}
+
+const char* Prof_Phase_Name(ProfPhase phase)
+{
+    static const char* const names[PROF_PHASE_COUNT] = {
+        "acquire", "tinyml", "mruby", "tx", "rx", "flush"
+    };
+    return ((unsigned)phase < PROF_PHASE_COUNT) ? names[phase] : "?";
+}
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file           : silken_prof.h
+  * @brief          : Профайлер фаз циклу на DWT CYCCNT (Солдат і Королева)
+  ******************************************************************************
+  *
+  * Іменовані точки заміру навколо фаз циклу: Prof_Begin / Prof_End рахують
+  * такти ядра між ними. На фазу — min, max, EWMA та кількість замірів
+  * (16 байт), уся таблиця — 96 байт у SRAM, яку STOP2 зберігає.
+  *
+  * Джерело тактів:
+  *   Cortex-M4 — DWT->CYCCNT (48 МГц, переповнення раз на ~89 с; фаза значно
+  *               коротша, тож беззнакова різниця завжди коректна);
+  *   хост      — монотонний годинник, перерахований у такти PROF_CORE_MHZ,
+  *               щоб бенчмарки та тести звітували в тих самих одиницях.
+  *
+  * CYCCNT не рахує у STOP2 — заміри охоплюють лише активний час ядра
+  * (включно з HAL_Delay та очікуванням радіо), тобто саме той, що коштує енергії.
+  */
+#ifndef SILKEN_PROF_H
+#define SILKEN_PROF_H
+
+#include <stdint.h>
+
+#ifndef PROF_CORE_MHZ
+#define PROF_CORE_MHZ         48      // SYSCLK STM32WLE5 (MSI 48 МГц)
+#endif
+#define PROF_EWMA_SHIFT       3       // α = 1/8
+
+typedef enum {
+    PROF_PHASE_ACQUIRE = 0,   // Солдат, Фаза 1: АЦП, HRNG, план енергії
+    PROF_PHASE_TINYML  = 1,   // Солдат, Фаза 1.5: DMA 512 семплів + інференс
+    PROF_PHASE_MRUBY   = 2,   // Солдат, Фаза 3: виклик контракту (+ відкат)
+    PROF_PHASE_TX      = 3,   // Солдат, Фаза 4: jitter + естафета + AES + TX
+    PROF_PHASE_RX      = 4,   // Солдат, Фаза 4.5: вікно RX / Королева: обробка пакета
+    PROF_PHASE_FLUSH   = 5,   // Королева: пакування та шифрування батча
+    PROF_PHASE_COUNT
+} ProfPhase;
+
+typedef struct {
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t ewma_cycles;
+    uint32_t count;           // 0 — фаза ще не заміряна
+} ProfStat;
+
+typedef struct {
+    ProfStat stat[PROF_PHASE_COUNT];
+    uint32_t start[PROF_PHASE_COUNT];  // Значення лічильника на Prof_Begin
+} ProfTable;
+
+#if defined(__arm__)
+#include "main.h"             // CMSIS: DWT, CoreDebug
+static inline uint32_t Prof_Cycles(void) { return DWT->CYCCNT; }
+#else
+uint32_t Prof_Cycles(void);
+#endif
+
+// Обнуляє таблицю; на Cortex-M4 також вмикає DWT CYCCNT (TRCENA + CYCCNTENA)
+void Prof_Init(ProfTable* tbl);
+
+// Додає один замір фази (такти) до min / max / EWMA
+void Prof_Record(ProfTable* tbl, ProfPhase phase, uint32_t cycles);
+
+static inline void Prof_Begin(ProfTable* tbl, ProfPhase phase)
+{
+    tbl->start[phase] = Prof_Cycles();
+}
+
+static inline void Prof_End(ProfTable* tbl, ProfPhase phase)
+{
+    Prof_Record(tbl, phase, Prof_Cycles() - tbl->start[phase]);
+}
+
+// Такти → мікросекунди (для логів хоста та діагностичного кадру)
+static inline uint32_t Prof_Cycles_To_US(uint32_t cycles)
+{
+    return cycles / PROF_CORE_MHZ;
+}
+
+const char* Prof_Phase_Name(ProfPhase phase);
+
+#endif /* SILKEN_PROF_H */
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file           : silken_rbe.c
+  * @brief          : Report-by-exception: Солдат мовчить, поки показання в межах мертвих зон
+  ******************************************************************************
+  */
+#include "silken_rbe.h"
+
+#include <string.h>
+
+static uint16_t rbe_quantize_vcap(uint16_t vcap_mv)
+{
+    uint32_t q = ((uint32_t)vcap_mv + RBE_VCAP_LSB_MV / 2) / RBE_VCAP_LSB_MV;
+    if (q == 0) q = 1;          // 0 зарезервовано під "знімку немає"
+    if (q > 0xFF) q = 0xFF;
+    return (uint16_t)(q * RBE_VCAP_LSB_MV);
+}
+
+static inline uint16_t rbe_abs_diff(int32_t a, int32_t b)
+{
+    return (uint16_t)(a > b ? a - b : b - a);
+}
+
+void Rbe_Init(RbeState* st)
+{
+    memset(st, 0, sizeof(*st));
+}
+
+RbeDecision Rbe_Decide(const RbeState* st, const uint8_t* payload)
+{
+    uint16_t vcap = (uint16_t)(((uint16_t)payload[4] << 8) | payload[5]);
+    int8_t temp = (int8_t)payload[6];
+    uint8_t acoustic = payload[7];
+    uint8_t bio = payload[10];
+
+    if (st->vcap_mv == 0) return RBE_SEND_FIRST;
+    if ((bio ^ st->bio) & RBE_STATUS_MASK) return RBE_SEND_STATUS;
+    if (acoustic >= RBE_ACOUSTIC_EVENTS) return RBE_SEND_ACOUSTIC;
+
+    if (rbe_abs_diff(vcap, st->vcap_mv) > RBE_VCAP_DEADBAND_MV ||
+        rbe_abs_diff(temp, st->temp_c) > RBE_TEMP_DEADBAND_C ||
+        rbe_abs_diff(bio & RBE_GROWTH_MASK, st->bio & RBE_GROWTH_MASK) > RBE_GROWTH_DEADBAND) {
+        return RBE_SEND_DELTA;
+    }
+
+    // Це пробудження стало б RBE_HEARTBEAT_CYCLES-м поспіль без кадру
+    if (st->silent + 1U >= RBE_HEARTBEAT_CYCLES) return RBE_SEND_HEARTBEAT;
+    return RBE_SKIP;
+}
+
+void Rbe_Sent(RbeState* st, const uint8_t* payload)
+{
+    st->vcap_mv = rbe_quantize_vcap((uint16_t)(((uint16_t)payload[4] << 8) | payload[5]));
+    st->temp_c = (int8_t)payload[6];
+    st->bio = payload[10];
+    st->silent = 0;
+}
+
+void Rbe_Skipped(RbeState* st)
+{
+    if (st->silent < 0xFF) st->silent++;
+}
+
+uint8_t Rbe_Batch_Due(RbeDecision d, uint8_t buffered, uint32_t held_s)
+{
+    if (buffered == 0) return 0;
+    if (d == RBE_SEND_FIRST || d == RBE_SEND_STATUS) return 1; // Термінове — без очікування
+    return buffered >= RBE_BATCH_READINGS || held_s >= RBE_BATCH_MAX_HOLD_S;
+}
+
+uint32_t Rbe_Pack(const RbeState* st)
+{
+    return ((uint32_t)st->silent << 24) | ((uint32_t)st->bio << 16) |
+           ((uint32_t)(uint8_t)st->temp_c << 8) | (uint32_t)(st->vcap_mv / RBE_VCAP_LSB_MV);
+}
+
+void Rbe_Restore(RbeState* st, uint32_t packed)
+{
+    st->vcap_mv = (uint16_t)((packed & 0xFFU) * RBE_VCAP_LSB_MV);
+    st->temp_c = (int8_t)(uint8_t)(packed >> 8);
+    st->bio = (uint8_t)(packed >> 16);
+    st->silent = (uint8_t)(packed >> 24);
+}
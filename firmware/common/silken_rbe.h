@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : silken_rbe.h
+  * @brief          : Report-by-exception: Солдат мовчить, поки показання в межах мертвих зон
+  ******************************************************************************
+  *
+  * Досі власний кадр ішов в ефір на кожному пробудженні, навіть коли Vcap,
+  * температура, акустика і біо-статус не змінились. TX — найдорожча дія
+  * Солдата, а Королева щоразу переписувала той самий рядок forest_cache.
+  *
+  * Тепер після ФАЗИ 3 (байт 10 уже пораховано) Rbe_Decide порівнює готовий
+  * 16-байтний пейлоад зі знімком останнього ЗАПИСАНОГО показання:
+  *
+  *   статус байта 10 (біти [7:6]) змінився    → кадр негайно (RBE_SEND_STATUS)
+  *   акустика ≥ RBE_ACOUSTIC_EVENTS            → кадр (події накопичуються між кадрами)
+  *   Vcap / Temp / GrowthPoints поза зоною      → кадр (RBE_SEND_DELTA)
+  *   RBE_HEARTBEAT_CYCLES пробуджень мовчання   → кадр-пульс (RBE_SEND_HEARTBEAT)
+  *   інакше                                     → RBE_SKIP
+  *
+  * Паніка (Trigger_Emergency_LoRa_TX) йде своїм шляхом і сюди не потрапляє.
+  * Пульс обмежує мовчання: при максимальному сні 3600 с — ≤ 12 год, тобто
+  * дерево не стає "silent" на сервері (24 год).
+  *
+  * Знімок — рівно одне слово (Rbe_Pack): Солдат тримає його в RTC_BKP_DR0,
+  * тож скидання (IWDG, PVD) не спричиняє зайвої хвилі кадрів. Нульове слово —
+  * знімку немає: перший кадр після народження йде завжди (RBE_SEND_FIRST).
+  *
+  * Буферизований uplink. Показання, що пройшло Rbe_Decide, не мусить іти в
+  * ефір одразу: Солдат збирає до RBE_BATCH_READINGS запечатаних блоків і шле
+  * їх одним агрегованим кадром — преамбула, CAD і пробудження радіо одні на
+  * всіх. Байти 8-9 кожного показання — секунди від попереднього показання;
+  * сервер зберігає їх як metabolism_s, а час запису — час прийому пачки
+  * (хронологію пачки він не відновлює). Rbe_Batch_Due вирішує,
+  * коли пачка йде: повна, найстаріше чекає RBE_BATCH_MAX_HOLD_S, або подія
+  * термінова (новий статус, перше показання) — тоді без очікування.
+  */
+#ifndef SILKEN_RBE_H
+#define SILKEN_RBE_H
+
+#include <stdint.h>
+
+#define RBE_VCAP_DEADBAND_MV    50      // |ΔVcap| ≤ 50 мВ — не новина
+#define RBE_TEMP_DEADBAND_C     2       // |ΔTemp| ≤ 2 °C
+#define RBE_GROWTH_DEADBAND     4       // |ΔGrowthPoints| ≤ 4 (біти [5:0] байта 10)
+#define RBE_ACOUSTIC_EVENTS     2       // Накопичених подій кавітації для кадру
+#define RBE_HEARTBEAT_CYCLES    12      // Найдовше мовчання, пробуджень
+#define RBE_VCAP_LSB_MV         16      // Квант Vcap у знімку: 8 біт до 4080 мВ
+#define RBE_BATCH_READINGS      4       // Показань на один TX (1 — без буфера)
+#define RBE_BATCH_MAX_HOLD_S    21600U  // Найстаріше показання чекає ≤ 6 год (+ пульс 12 год < 24 год)
+
+#define RBE_STATUS_MASK         0xC0    // Біти [7:6] байта 10: статус біо-контракту
+#define RBE_GROWTH_MASK         0x3F
+
+typedef enum {
+    RBE_SKIP           = 0,
+    RBE_SEND_FIRST     = 1,             // Знімку ще немає
+    RBE_SEND_STATUS    = 2,
+    RBE_SEND_ACOUSTIC  = 3,
+    RBE_SEND_DELTA     = 4,
+    RBE_SEND_HEARTBEAT = 5
+} RbeDecision;
+
+// Знімок останнього записаного показання (SRAM, копія в DR0)
+typedef struct {
+    uint16_t vcap_mv;                   // Квантовано до RBE_VCAP_LSB_MV; 0 — знімку немає
+    int8_t   temp_c;
+    uint8_t  bio;                       // Байт 10 як є
+    uint8_t  silent;                    // Пробуджень без кадру поспіль (насичення)
+} RbeState;
+
+void Rbe_Init(RbeState* st);
+
+// Рішення для готового пейлоада (байти 4-5 Vcap, 6 Temp, 7 Acoustic, 10 Bio)
+RbeDecision Rbe_Decide(const RbeState* st, const uint8_t* payload);
+
+// Показання записане (в ефір або в пачку): пейлоад стає новим знімком
+void Rbe_Sent(RbeState* st, const uint8_t* payload);
+
+// Кадр пропущено: ще одне пробудження мовчання
+void Rbe_Skipped(RbeState* st);
+
+// 1 — буфер показань іде в ефір зараз. buffered — разом з щойно доданим,
+// held_s — скільки чекає найстаріше з них.
+uint8_t Rbe_Batch_Due(RbeDecision d, uint8_t buffered, uint32_t held_s);
+
+// [7:0] Vcap / RBE_VCAP_LSB_MV, [15:8] Temp, [23:16] Bio, [31:24] silent
+uint32_t Rbe_Pack(const RbeState* st);
+void Rbe_Restore(RbeState* st, uint32_t packed);
+
+#endif /* SILKEN_RBE_H */
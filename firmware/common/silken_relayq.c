@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file           : silken_relayq.c
+  * @brief          : Черга mesh-естафети Солдата + агреговані кадри
+  ******************************************************************************
+  */
+#include "silken_relayq.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static uint32_t relayq_checksum(const RelayQueue* q)
+{
+    // FNV-1a: кілька сотень тактів на ~90 байт, ловить сміття холодного старту
+    const uint8_t* p = (const uint8_t*)q;
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < offsetof(RelayQueue, checksum); i++) {
+        h ^= p[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+static void relayq_seal(RelayQueue* q)
+{
+    q->checksum = relayq_checksum(q);
+}
+
+void RelayQ_Init(RelayQueue* q)
+{
+    memset(q, 0, sizeof(*q));
+    q->magic = RELAYQ_MAGIC;
+    relayq_seal(q);
+}
+
+uint8_t RelayQ_Restore(RelayQueue* q)
+{
+    if (q->magic != RELAYQ_MAGIC || q->head >= RELAYQ_CAPACITY ||
+        q->count > RELAYQ_CAPACITY || q->checksum != relayq_checksum(q)) {
+        RelayQ_Init(q);
+    }
+    return q->count;
+}
+
+void RelayQ_Push(RelayQueue* q, const uint8_t* frame)
+{
+    if (q->count == RELAYQ_CAPACITY) {
+        q->head = (uint8_t)((q->head + 1) % RELAYQ_CAPACITY);
+        q->count--;
+        if (q->dropped < 0xFF) q->dropped++;
+    }
+    uint8_t tail = (uint8_t)((q->head + q->count) % RELAYQ_CAPACITY);
+    memcpy(q->frames[tail], frame, RELAYQ_FRAME_SIZE);
+    q->count++;
+    relayq_seal(q);
+}
+
+uint16_t RelayQ_Build_Frame(RelayQueue* q, const uint8_t* own, uint8_t max_relays, uint8_t* out)
+{
+    uint16_t size = 0;
+    if (own != NULL) {
+        memcpy(out, own, RELAYQ_FRAME_SIZE);
+        size = RELAYQ_FRAME_SIZE;
+    }
+    return (uint16_t)(size + RelayQ_Drain(q, max_relays, out + size));
+}
+
+uint16_t RelayQ_Drain(RelayQueue* q, uint8_t max_frames, uint8_t* out)
+{
+    uint16_t size = 0;
+    while (q->count > 0 && max_frames > 0) {
+        memcpy(out + size, q->frames[q->head], RELAYQ_FRAME_SIZE);
+        size += RELAYQ_FRAME_SIZE;
+        q->head = (uint8_t)((q->head + 1) % RELAYQ_CAPACITY);
+        q->count--;
+        max_frames--;
+    }
+    relayq_seal(q);
+    return size;
+}
@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : silken_relayq.h
+  * @brief          : Черга mesh-естафети Солдата + агреговані кадри
+  ******************************************************************************
+  *
+  * Раніше Солдат тримав лише один чужий пакет (DR3–DR6): другий почутий
+  * затирав перший, а кожна естафета коштувала окремий TX з преамбулою.
+  * Тепер до RELAYQ_CAPACITY чужих кадрів чекають у черзі (FIFO), а на
+  * пробудженні йдуть разом із власним кадром ОДНИМ LoRa-пакетом:
+  *
+  *   [Власний блок:20] [Естафета 1:20] … [Естафета N:20]   (N ≤ 4)
+  *
+  * Та сама черга тримає й власні показання Солдата, що чекають пачки
+  * (буферизований uplink, silken_rbe.h): тоді власних блоків до 4.
+  *
+  * Кожен блок — самостійний кадр: відкритий заголовок маршрутизації +
+  * 16-байтне AES-ECB тіло (silken_route.h), тому Королева та сусідні
+  * Солдати просто ріжуть пакет по ROUTE_BLOCK_SIZE байт.
+  *
+  * Черга живе у SRAM2 (секція .noinit): переживає і STOP2, і скидання без
+  * втрати живлення. Після холодного старту вміст — сміття, тому
+  * RelayQ_Restore перевіряє magic і контрольну суму. Кожна зміна черги
+  * одразу оновлює суму — скидання посеред циклу (IWDG, PVD) її не зламає.
+  */
+#ifndef SILKEN_RELAYQ_H
+#define SILKEN_RELAYQ_H
+
+#include <stdint.h>
+
+#include "silken_route.h"
+
+#define RELAYQ_FRAME_SIZE       ROUTE_BLOCK_SIZE        // Заголовок + AES-тіло
+#define RELAYQ_CAPACITY         4                       // Чужих кадрів у черзі
+#define RELAYQ_AGG_MAX_BLOCKS   (2 * RELAYQ_CAPACITY)   // Пачка власних показань + естафета
+#define RELAYQ_AGG_MAX_SIZE     (RELAYQ_AGG_MAX_BLOCKS * RELAYQ_FRAME_SIZE) // 160 байт
+#define RELAYQ_MAGIC            0x52514D31U             // "RQM1"
+
+typedef struct {
+    uint32_t magic;
+    uint8_t  head;                                      // Найстаріший кадр
+    uint8_t  count;
+    uint8_t  dropped;                                   // Витіснені при переповненні (u8, насичення)
+    uint8_t  reserved;
+    uint8_t  frames[RELAYQ_CAPACITY][RELAYQ_FRAME_SIZE];// Кадри з ефіру, TTL у заголовку вже зменшено
+    uint32_t checksum;                                  // FNV-1a усього, що вище
+} RelayQueue;
+
+// Порожня черга з дійсним magic
+void RelayQ_Init(RelayQueue* q);
+
+// Після скидання: вміст дійсний → лишаємо, інакше RelayQ_Init. Повертає count.
+uint8_t RelayQ_Restore(RelayQueue* q);
+
+// Додати кадр. Черга повна → витісняється найстаріший (він найближчий до смерті по TTL).
+void RelayQ_Push(RelayQueue* q, const uint8_t* frame);
+
+// Агрегований кадр: own (RELAYQ_FRAME_SIZE) + до max_relays кадрів з черги (FIFO).
+// own = NULL — лише естафета (власний кадр пропущено, silken_rbe.h).
+// Відправлені кадри знімаються з черги. Повертає розмір кадру в байтах (0 — нічого).
+uint16_t RelayQ_Build_Frame(RelayQueue* q, const uint8_t* own, uint8_t max_relays, uint8_t* out);
+
+// Дописати до out до max_frames кадрів з черги (FIFO), знявши їх. Повертає байти.
+uint16_t RelayQ_Drain(RelayQueue* q, uint8_t max_frames, uint8_t* out);
+
+// Кількість блоків у прийнятому пакеті або 0, якщо розмір не з цього формату
+static inline uint8_t RelayQ_Frame_Blocks(uint16_t size)
+{
+    if (size == 0 || size > RELAYQ_AGG_MAX_SIZE || (size % RELAYQ_FRAME_SIZE) != 0) return 0;
+    return (uint8_t)(size / RELAYQ_FRAME_SIZE);
+}
+
+#endif /* SILKEN_RELAYQ_H */
@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : silken_route.c
+  * @brief          : Градієнтна mesh-маршрутизація: відстань до Королеви в хопах
+  ******************************************************************************
+  */
+#include "silken_route.h"
+
+#include <string.h>
+
+void Route_Init(RouteState* st)
+{
+    st->hop = ROUTE_HOP_UNKNOWN;
+    st->age = 0;
+}
+
+uint16_t Route_Pack(const RouteState* st)
+{
+    return (uint16_t)(((uint16_t)st->age << 8) | st->hop);
+}
+
+void Route_Restore(RouteState* st, uint16_t packed)
+{
+    st->hop = (uint8_t)(packed & 0xFF);
+    st->age = (uint8_t)(packed >> 8);
+    if (st->hop == ROUTE_HOP_QUEEN || st->hop > ROUTE_HOP_MAX) {
+        Route_Init(st);
+    }
+}
+
+uint8_t Route_On_Heard(RouteState* st, uint8_t tx_hop, int16_t rssi_dbm)
+{
+    if (tx_hop >= ROUTE_HOP_MAX || rssi_dbm < ROUTE_RSSI_FLOOR_DBM) return 0;
+
+    uint8_t candidate = (uint8_t)(tx_hop + 1);
+    if (candidate < st->hop) {
+        st->hop = candidate;
+        st->age = 0;
+        return 1;
+    }
+    if (candidate == st->hop) {
+        st->age = 0; // Той самий градієнт підтверджено
+    }
+    return 0;
+}
+
+void Route_Tick(RouteState* st)
+{
+    if (st->hop == ROUTE_HOP_UNKNOWN) return;
+    if (++st->age >= ROUTE_STALE_WAKES) {
+        Route_Init(st);
+    }
+}
+
+uint8_t Route_Should_Relay(const RouteState* st, uint8_t tx_hop)
+{
+    if (st->hop == ROUTE_HOP_UNKNOWN || tx_hop == ROUTE_HOP_UNKNOWN) return 1;
+    return tx_hop > st->hop;
+}
+
+void Route_Pack_Beacon(uint8_t* frame)
+{
+    memset(frame, 0, 16);
+    frame[11] = Route_Byte(ROUTE_HOP_QUEEN, 0);
+    frame[15] = FRAME_TYPE_BEACON;
+}
+
+void Route_Hdr_From_Body(uint8_t* hdr, const uint8_t* plain_body)
+{
+    hdr[ROUTE_HDR_SRC]     = plain_body[2]; // DID big-endian: байти 2-3 — молодші
+    hdr[ROUTE_HDR_SRC + 1] = plain_body[3];
+    hdr[ROUTE_HDR_HOP_TTL] = plain_body[11];
+    hdr[ROUTE_HDR_TYPE]    = plain_body[15];
+}
+
+uint8_t Route_Hdr_Binds_Body(const uint8_t* hdr, const uint8_t* plain_body)
+{
+    return hdr[ROUTE_HDR_SRC] == plain_body[2] &&
+           hdr[ROUTE_HDR_SRC + 1] == plain_body[3] &&
+           hdr[ROUTE_HDR_TYPE] == plain_body[15];
+}
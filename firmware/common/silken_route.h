@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  * @file           : silken_route.h
+  * @brief          : Градієнтна mesh-маршрутизація: відстань до Королеви в хопах
+  ******************************************************************************
+  *
+  * Раніше естафета була TTL-флудом: кожен Солдат, що почув чужий кадр,
+  * пересилав його далі. У густому кластері ефір ріс квадратично.
+  *
+  * Тепер кожен вузол знає свою відстань до Королеви (hop) і пише її у
+  * старший ніббл байта Hop/TTL кожного кадру, який передає (власного чи
+  * чужого): [Hop:4 | TTL:4]. Королева — hop 0; вона відповідає маяком
+  * (FRAME_TYPE_BEACON) Солдату, який почув її напряму, але рахує себе
+  * далі. Решта вчиться з підслуханих кадрів сусідів: hop = min(сусід + 1).
+  * Пересилає кадр лише той, хто ближчий до Королеви за передавача
+  * («вниз по схилу»). Вузли з невідомим градієнтом працюють як флуд.
+  *
+  * Маршрут старіє: без підтвердження ROUTE_STALE_WAKES пробуджень поспіль
+  * hop забувається, і вузол знову вчиться (сусід зник, Королеву перенесли).
+  * Слабкі лінки (RSSI < ROUTE_RSSI_FLOOR_DBM) градієнт не задають.
+  *
+  * Відкритий заголовок. Раніше TTL жив у зашифрованому блоці, тож кожна
+  * естафета робила HAL_CRYP_Decrypt + HAL_CRYP_Encrypt, а Королева
+  * розшифровувала все, щоб хоч щось вирішити. Тепер кожен блок в ефірі:
+  *
+  *   [Src:2][Hop|TTL:1][Type:1] [AES-тіло:16]        ROUTE_BLOCK_SIZE = 20
+  *
+  * Src — молодші 16 біт DID, Type — байт 15 тіла. Естафета переписує лише
+  * Hop|TTL і нічого не шифрує; Королева сортує блоки за Type до розшифровки.
+  * Автентичність: Src і Type повторюються всередині AES-тіла (DID, байт 15),
+  * Королева відкидає блок, якщо вони розходяться (Route_Hdr_Binds_Body).
+  * Hop|TTL змінюються на кожному хопі й не автентифікуються; у тілі байт 11
+  * лишається початковим значенням джерела. Ціна — +4 байти ефіру на блок.
+  *
+  * Той самий код ганяє хост-симулятор естафети (firmware/test/sim_mesh.c).
+  */
+#ifndef SILKEN_ROUTE_H
+#define SILKEN_ROUTE_H
+
+#include <stdint.h>
+
+#define ROUTE_HOP_QUEEN         0
+#define ROUTE_HOP_MAX           14
+#define ROUTE_HOP_UNKNOWN       0x0F    // Градієнт ще не вивчено — флуд
+#define ROUTE_TTL_MASK          0x0F    // TTL ≤ 15 (PANIC_TTL = 5)
+#define ROUTE_STALE_WAKES       64      // Пробуджень без підтвердження до забування
+#define ROUTE_RSSI_FLOOR_DBM    (-118)  // ≈ 5 дБ над чутливістю SF7/125 кГц
+
+#define FRAME_TYPE_BEACON       0xB0    // Маяк Королеви (байт 15), DID = 0, TTL = 0
+
+// Блок в ефірі: відкритий заголовок + AES-тіло
+#define ROUTE_HDR_SRC           0       // uint16 BE: молодші 16 біт DID
+#define ROUTE_HDR_HOP_TTL       2       // [Hop:4 | TTL:4] — єдине, що змінює естафета
+#define ROUTE_HDR_TYPE          3       // = байт 15 тіла
+#define ROUTE_HDR_SIZE          4
+#define ROUTE_BODY_SIZE         16      // Один блок AES-256-ECB
+#define ROUTE_BLOCK_SIZE        (ROUTE_HDR_SIZE + ROUTE_BODY_SIZE) // 20
+
+// Стан вузла (SRAM); у DR19 поряд з tx_seq через Route_Pack
+typedef struct {
+    uint8_t hop;   // Відстань до Королеви або ROUTE_HOP_UNKNOWN
+    uint8_t age;   // Пробуджень з останнього підтвердження
+} RouteState;
+
+static inline uint8_t Route_Byte(uint8_t hop, uint8_t ttl)
+{
+    return (uint8_t)((hop << 4) | (ttl & ROUTE_TTL_MASK));
+}
+
+static inline uint8_t Route_Byte_Hop(uint8_t b)
+{
+    return (uint8_t)(b >> 4);
+}
+
+static inline uint8_t Route_Byte_TTL(uint8_t b)
+{
+    return (uint8_t)(b & ROUTE_TTL_MASK);
+}
+
+void Route_Init(RouteState* st);
+
+// 16 біт для Backup-регістра. Hop 0 має лише Королева, тож нульовий
+// регістр (холодний старт) відновлюється як невідомий градієнт.
+uint16_t Route_Pack(const RouteState* st);
+void Route_Restore(RouteState* st, uint16_t packed);
+
+// Почули кадр передавача з його hop. Повертає 1, якщо hop вузла змінився.
+uint8_t Route_On_Heard(RouteState* st, uint8_t tx_hop, int16_t rssi_dbm);
+
+// Одне пробудження минуло
+void Route_Tick(RouteState* st);
+
+// 1 — пересилати кадр передавача з tx_hop (ми ближчі до Королеви або хтось
+// із двох градієнта не знає); 0 — передавач сам ближчий або поруч.
+uint8_t Route_Should_Relay(const RouteState* st, uint8_t tx_hop);
+
+// Маяк Королеви: 16 байт відкритого тексту перед шифруванням
+void Route_Pack_Beacon(uint8_t* frame);
+
+// Заголовок з відкритого тексту тіла (перед шифруванням): Src, Hop|TTL, Type
+void Route_Hdr_From_Body(uint8_t* hdr, const uint8_t* plain_body);
+
+// 1 — Src і Type заголовка збігаються з розшифрованим тілом
+uint8_t Route_Hdr_Binds_Body(const uint8_t* hdr, const uint8_t* plain_body);
+
+#endif /* SILKEN_ROUTE_H */
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file           : silken_rxring.c
+  * @brief          : Кільце прийнятих кадрів Королеви: OnRxDone → головний цикл без замків
+  ******************************************************************************
+  */
+#include "silken_rxring.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// Запис слоту не можна переставляти за оновлення індексу (і навпаки)
+#define RXRING_BARRIER()  __asm__ volatile ("" ::: "memory")
+
+#define RXRING_MASK       (RXRING_SLOTS - 1U)
+
+_Static_assert((RXRING_SLOTS & RXRING_MASK) == 0 && RXRING_SLOTS <= 128,
+               "RXRING_SLOTS: степінь двійки, що вміщується в uint8_t індекси");
+_Static_assert(offsetof(RxSlot, frame) % 4 == 0, "AES читає тіла блоків словами");
+
+void RxRing_Init(RxRing* r)
+{
+    memset(r, 0, sizeof(*r));
+}
+
+uint8_t RxRing_Count(const RxRing* r)
+{
+    return (uint8_t)(r->head - r->tail);
+}
+
+RxSlot* RxRing_Claim(RxRing* r)
+{
+    r->received++;
+    if (RxRing_Count(r) >= RXRING_SLOTS) {
+        r->dropped++;
+        return NULL;
+    }
+    return &r->slot[r->head & RXRING_MASK];
+}
+
+void RxRing_Publish(RxRing* r)
+{
+    RXRING_BARRIER();
+    r->head = (uint8_t)(r->head + 1U);
+    uint8_t count = RxRing_Count(r);
+    if (count > r->high_water) r->high_water = count;
+}
+
+RxSlot* RxRing_Peek(RxRing* r)
+{
+    if (r->head == r->tail) return NULL;
+    RXRING_BARRIER();
+    return &r->slot[r->tail & RXRING_MASK];
+}
+
+void RxRing_Release(RxRing* r)
+{
+    RXRING_BARRIER();
+    r->tail = (uint8_t)(r->tail + 1U);
+}
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file           : silken_rxring.h
+  * @brief          : Кільце прийнятих кадрів Королеви: OnRxDone → головний цикл без замків
+  ******************************************************************************
+  *
+  * Досі OnRxDone Королеви копіював пакет в один буфер і піднімав lora_rx_flag.
+  * Радіо слухає безперервно, а головний цикл буває зайнятий: рефлекторний
+  * постріл (TX + 60 мс у STOP2), розшифровка пачки, скидання кешу на сервер
+  * (~4 с AT-команд і HAL_Delay). Кадр, що прийшов у цей час, або затирав
+  * попередній, ще не оброблений, або губився разом з його RSSI / SNR.
+  *
+  * Тепер кадри йдуть у кільце з RXRING_SLOTS дескрипторів: сирий пакет,
+  * RSSI, SNR і мітка часу кінця пакета. Один виробник (ISR) і один споживач
+  * (головний цикл) — замки не потрібні:
+  *
+  *   ISR:   RxRing_Claim → заповнити слот → RxRing_Publish   (пише лише head)
+  *   цикл:  RxRing_Peek  → обробити слот  → RxRing_Release   (пише лише tail)
+  *
+  * Індекси — uint8_t, що біжать по колу; слот — індекс & (RXRING_SLOTS − 1).
+  * Запис слоту стає видимим споживачу лише після head++ (бар'єр компілятора;
+  * Cortex-M4 одноядерний — апаратний бар'єр не потрібен). Кільце повне —
+  * новий кадр відкидається (старіші вже в черзі, їхні вікна RX Солдатів
+  * ще не закрились) і рахується в dropped.
+  *
+  * Головний цикл обробляє кадр прямо в слоті: тіла блоків розшифровуються на
+  * місці і звідти йдуть у кеш — жодних проміжних копій після ISR. Рефлекс
+  * (маяк / OTA-чанк) для кадру, що простояв у черзі понад
+  * RXRING_REFLEX_MAX_AGE_MS, не стріляє: вікно RX Солдата вже закрите, а
+  * постріл лише оглушив би Королеву на 60 мс.
+  */
+#ifndef SILKEN_RXRING_H
+#define SILKEN_RXRING_H
+
+#include <stdint.h>
+
+#include "silken_relayq.h"
+
+#define RXRING_SLOTS            8       // Степінь двійки; 8 × 168 Б ≈ 1.3 КБ SRAM
+#define RXRING_FRAME_MAX        RELAYQ_AGG_MAX_SIZE
+#define RXRING_REFLEX_MAX_AGE_MS 400U   // Вікно Солдата 500 мс − ефір маяка 57 мс − запас
+
+typedef struct {
+    uint32_t rx_ms;                     // Кінець пакета за годинником кадрів Королеви
+    uint8_t  frame[RXRING_FRAME_MAX];   // N × [заголовок:4][AES:16], вирівняно на 4
+    uint16_t size;
+    int8_t   rssi_dbm;                  // Вже обмежено до [-128, 127]
+    int8_t   snr_db;
+} RxSlot;
+
+typedef struct {
+    RxSlot            slot[RXRING_SLOTS];
+    volatile uint8_t  head;             // Пише лише виробник (ISR)
+    volatile uint8_t  tail;             // Пише лише споживач (головний цикл)
+    volatile uint8_t  high_water;       // Найбільша черга за аптайм
+    volatile uint32_t received;         // Усі кадри, що дійшли до ISR
+    volatile uint32_t dropped;          // Відкинуті: кільце повне
+} RxRing;
+
+void RxRing_Init(RxRing* r);
+
+// ISR: вільний слот для нового кадру або NULL (кільце повне, dropped++)
+RxSlot* RxRing_Claim(RxRing* r);
+
+// ISR: заповнений слот віддається споживачу
+void RxRing_Publish(RxRing* r);
+
+// Головний цикл: найстаріший кадр або NULL
+RxSlot* RxRing_Peek(RxRing* r);
+
+// Головний цикл: кадр оброблено, слот вільний
+void RxRing_Release(RxRing* r);
+
+// Кадрів у черзі
+uint8_t RxRing_Count(const RxRing* r);
+
+#endif /* SILKEN_RXRING_H */
@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file           : silken_sched.c
+  * @brief          : Кооперативний планувальник Королеви: задачі до завершення, події, таймери
+  ******************************************************************************
+  */
+#include "silken_sched.h"
+
+#include <string.h>
+
+#if defined(__arm__)
+#include "main.h"             // __get_PRIMASK, __disable_irq (CMSIS)
+
+// Вкладено-безпечно: Post з ISR не вмикає переривання, вимкнені головним циклом
+#define SCHED_CRITICAL_ENTER()  uint32_t sched_primask = __get_PRIMASK(); __disable_irq()
+#define SCHED_CRITICAL_EXIT()   __set_PRIMASK(sched_primask)
+#else
+#define SCHED_CRITICAL_ENTER()  do { } while (0)
+#define SCHED_CRITICAL_EXIT()   do { } while (0)
+#endif
+
+// Дедлайн настав: різниця зі знаком переживає перехід годинника через 2^32
+static uint8_t sched_due(uint32_t now_ms, uint32_t due_ms)
+{
+    return (int32_t)(now_ms - due_ms) >= 0;
+}
+
+void Sched_Init(Sched* s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+uint8_t Sched_Add(Sched* s, SchedHandler handler)
+{
+    if (s->count >= SCHED_MAX_TASKS || handler == NULL) return SCHED_NO_TASK;
+    s->task[s->count].handler = handler;
+    return s->count++;
+}
+
+void Sched_Post(Sched* s, uint8_t id, uint32_t events)
+{
+    if (id >= s->count) return;
+    SCHED_CRITICAL_ENTER();
+    s->task[id].events |= events;
+    SCHED_CRITICAL_EXIT();
+}
+
+void Sched_Timer(Sched* s, uint8_t id, uint32_t now_ms, uint32_t delay_ms, uint32_t period_ms)
+{
+    if (id >= s->count) return;
+    s->task[id].due_ms = now_ms + delay_ms;
+    s->task[id].period_ms = period_ms;
+    s->task[id].armed = 1;
+}
+
+void Sched_Timer_Stop(Sched* s, uint8_t id)
+{
+    if (id >= s->count) return;
+    s->task[id].armed = 0;
+}
+
+uint8_t Sched_Run(Sched* s, uint32_t now_ms)
+{
+    // Таймери — лише з головного циклу, тож без критичної секції
+    for (uint8_t i = 0; i < s->count; i++) {
+        SchedTask* t = &s->task[i];
+        if (!t->armed || !sched_due(now_ms, t->due_ms)) continue;
+        if (t->period_ms == 0) {
+            t->armed = 0;
+        } else {
+            // Пропущені періоди не накопичуються: одне спрацювання, наступне — від now
+            t->due_ms += t->period_ms;
+            if (sched_due(now_ms, t->due_ms)) t->due_ms = now_ms + t->period_ms;
+        }
+        Sched_Post(s, i, SCHED_EV_TIMER);
+    }
+
+    for (uint8_t i = 0; i < s->count; i++) {
+        SchedTask* t = &s->task[i];
+        if (t->events == 0) continue;
+        SCHED_CRITICAL_ENTER();
+        uint32_t events = t->events;
+        t->events = 0;
+        SCHED_CRITICAL_EXIT();
+        t->runs++;
+        t->handler(events, now_ms);
+        return 1;
+    }
+    return 0;
+}
+
+uint32_t Sched_Idle_Ms(const Sched* s, uint32_t now_ms)
+{
+    uint32_t idle = SCHED_IDLE_FOREVER;
+    for (uint8_t i = 0; i < s->count; i++) {
+        const SchedTask* t = &s->task[i];
+        if (t->events != 0) return 0;
+        if (!t->armed) continue;
+        if (sched_due(now_ms, t->due_ms)) return 0;
+        uint32_t left = t->due_ms - now_ms;
+        if (left < idle) idle = left;
+    }
+    return idle;
+}
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file           : silken_sched.h
+  * @brief          : Кооперативний планувальник Королеви: задачі до завершення, події, таймери
+  ******************************************************************************
+  *
+  * Королева крутила голий while(1): опитувала прапорець RX і HAL_GetTick на
+  * 48 МГц навіть тоді, коли в лісі тиша, а скидання кешу (HAL_Delay, AT-команди
+  * з очікуванням) зупиняло все інше на секунди.
+  *
+  * Тепер робота поділена на задачі, що виконуються до завершення (run-to-
+  * completion) і ніколи не чекають усередині:
+  *
+  *   Sched_Add    — задача = обробник + пріоритет (порядок додавання, 0 — найвищий)
+  *   Sched_Post   — виставити біти подій задачі (з ISR або з іншої задачі)
+  *   Sched_Timer  — одноразовий / періодичний таймер задачі → SCHED_EV_TIMER
+  *   Sched_Run    — один крок: прострочені таймери, потім найпріоритетніша
+  *                  задача з подіями отримує всі свої біти разом
+  *   Sched_Idle_Ms — скільки можна спати: 0 — є події, SCHED_IDLE_FOREVER — ні подій,
+  *                   ні таймерів
+  *
+  * Черга подій задачі — маска бітів: повторний Post тієї ж події до обробки
+  * зливається в одну (обробник сам дренує свою чергу — кільце RX, байти UART).
+  * Маска змінюється під вимкненими перериваннями (ISR теж постить), сам
+  * обробник — з увімкненими.
+  *
+  * Довгі операції стають скінченними автоматами на таймерах: крок → Sched_Timer
+  * на час, який раніше йшов на HAL_Delay, → наступний крок. Між кроками
+  * виконуються задачі вищого пріоритету. Коли подій немає, ядро Королеви
+  * спить у SLEEP до наступного переривання (SysTick, RxDone, байт UART).
+  *
+  * Час — мс будь-якого монотонного годинника (Королева: Queen_Now_Ms);
+  * порівняння дедлайнів стійке до переходу через 2^32.
+  */
+#ifndef SILKEN_SCHED_H
+#define SILKEN_SCHED_H
+
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS         6
+#define SCHED_EV_TIMER          0x80000000U     // Таймер задачі спрацював
+#define SCHED_IDLE_FOREVER      0xFFFFFFFFU
+#define SCHED_NO_TASK           0xFF
+
+// Обробник: усі події, що накопичились з минулого виклику, і поточний час
+typedef void (*SchedHandler)(uint32_t events, uint32_t now_ms);
+
+typedef struct {
+    SchedHandler      handler;
+    volatile uint32_t events;
+    uint32_t          due_ms;
+    uint32_t          period_ms;        // 0 — одноразовий
+    uint8_t           armed;
+    uint32_t          runs;             // Викликів обробника (діагностика)
+} SchedTask;
+
+typedef struct {
+    SchedTask task[SCHED_MAX_TASKS];
+    uint8_t   count;
+} Sched;
+
+void Sched_Init(Sched* s);
+
+// Нова задача; пріоритет — порядок додавання. SCHED_NO_TASK — таблиця повна.
+uint8_t Sched_Add(Sched* s, SchedHandler handler);
+
+// Безпечно з ISR
+void Sched_Post(Sched* s, uint8_t id, uint32_t events);
+
+// (Пере)заводить таймер задачі: перше спрацювання через delay_ms, далі кожні period_ms
+void Sched_Timer(Sched* s, uint8_t id, uint32_t now_ms, uint32_t delay_ms, uint32_t period_ms);
+void Sched_Timer_Stop(Sched* s, uint8_t id);
+
+// Один крок планувальника. 1 — виконано задачу, 0 — робити нічого.
+uint8_t Sched_Run(Sched* s, uint32_t now_ms);
+
+// Мс до наступної роботи: 0 — події вже чекають
+uint32_t Sched_Idle_Ms(const Sched* s, uint32_t now_ms);
+
+#endif /* SILKEN_SCHED_H */
@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file           : silken_seen.c
+  * @brief          : Seen-set mesh-естафети: Bloom-фільтр з двома поколіннями
+  ******************************************************************************
+  */
+#include "silken_seen.h"
+
+#include <string.h>
+
+#define SEEN_ACTIVE      0
+#define SEEN_PREVIOUS    SEEN_WORDS_PER_GEN
+#define SEEN_META        (2 * SEEN_WORDS_PER_GEN)
+#define SEEN_AGE_MAX     0x00FFFFFFU
+
+static inline uint8_t seen_count(const SeenSet* set)
+{
+    return (uint8_t)(set->words[SEEN_META] & 0xFFU);
+}
+
+static inline uint32_t seen_age(const SeenSet* set)
+{
+    return set->words[SEEN_META] >> 8;
+}
+
+static inline void seen_set_meta(SeenSet* set, uint8_t count, uint32_t age_s)
+{
+    if (age_s > SEEN_AGE_MAX) age_s = SEEN_AGE_MAX;
+    set->words[SEEN_META] = (age_s << 8) | count;
+}
+
+// Хеш блоку без Hop|TTL: FNV-1a + фінальне перемішування (murmur3 fmix32)
+static uint32_t seen_hash(const uint8_t* frame)
+{
+    uint32_t h = 2166136261U;
+    for (int i = 0; i < SEEN_FRAME_SIZE; i++) {
+        if (i == SEEN_TTL_OFFSET) continue;
+        h ^= frame[i];
+        h *= 16777619U;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35U;
+    h ^= h >> 16;
+    return h;
+}
+
+// Double hashing: біт_i = (h1 + i·h2) mod m; h2 непарний
+static void seen_bits(uint32_t h, uint16_t bits[SEEN_HASHES])
+{
+    uint32_t h1 = h & 0xFFFFU;
+    uint32_t h2 = (h >> 16) | 1U;
+    for (uint32_t i = 0; i < SEEN_HASHES; i++) {
+        bits[i] = (uint16_t)((h1 + i * h2) % SEEN_BITS_PER_GEN);
+    }
+}
+
+static uint8_t seen_gen_has(const SeenSet* set, int base, const uint16_t bits[SEEN_HASHES])
+{
+    uint32_t hit = 1;
+    for (int i = 0; i < SEEN_HASHES; i++) {
+        hit &= (set->words[base + bits[i] / 32] >> (bits[i] % 32)) & 1U;
+    }
+    return (uint8_t)hit;
+}
+
+static void seen_rotate(SeenSet* set)
+{
+    memcpy(&set->words[SEEN_PREVIOUS], &set->words[SEEN_ACTIVE], SEEN_WORDS_PER_GEN * sizeof(uint32_t));
+    memset(&set->words[SEEN_ACTIVE], 0, SEEN_WORDS_PER_GEN * sizeof(uint32_t));
+    seen_set_meta(set, 0, 0);
+}
+
+void Seen_Init(SeenSet* set)
+{
+    memset(set, 0, sizeof(*set));
+}
+
+uint8_t Seen_Contains(const SeenSet* set, const uint8_t* frame)
+{
+    uint16_t bits[SEEN_HASHES];
+    seen_bits(seen_hash(frame), bits);
+    return seen_gen_has(set, SEEN_ACTIVE, bits) | seen_gen_has(set, SEEN_PREVIOUS, bits);
+}
+
+uint8_t Seen_Check_And_Insert(SeenSet* set, const uint8_t* frame)
+{
+    uint16_t bits[SEEN_HASHES];
+    seen_bits(seen_hash(frame), bits);
+    if (seen_gen_has(set, SEEN_ACTIVE, bits) | seen_gen_has(set, SEEN_PREVIOUS, bits)) {
+        return 1;
+    }
+
+    if (seen_count(set) >= SEEN_GEN_CAPACITY) {
+        seen_rotate(set);
+    }
+    for (int i = 0; i < SEEN_HASHES; i++) {
+        set->words[SEEN_ACTIVE + bits[i] / 32] |= 1U << (bits[i] % 32);
+    }
+    seen_set_meta(set, (uint8_t)(seen_count(set) + 1), seen_age(set));
+    return 0;
+}
+
+void Seen_Age(SeenSet* set, uint32_t elapsed_s)
+{
+    uint32_t age = seen_age(set) + elapsed_s;
+    if (age >= SEEN_GEN_MAX_AGE_S) {
+        seen_rotate(set); // Попереднє покоління прожило вже ≥ години — забуваємо
+        return;
+    }
+    seen_set_meta(set, seen_count(set), age);
+}
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file           : silken_seen.h
+  * @brief          : Seen-set mesh-естафети: Bloom-фільтр з двома поколіннями
+  ******************************************************************************
+  *
+  * Замінює список останніх 8 DID (DR8–DR15). Той список переповнювався в
+  * густому лісі і блокував наступний законний пакет дерева, поки його DID
+  * ще висів у списку. Тепер ключ — сам блок з ефіру без байта Hop|TTL
+  * (заголовок + AES-тіло, silken_route.h): тіло між хопами не змінюється,
+  * тож розшифровка не потрібна. Для телеметрії це (DID, seq) (байт 14 тіла —
+  * лічильник кадрів Солдата), діагностичні кадри розрізняються вмістом.
+  * Повтор того самого кадру від іншого сусіда — дублікат; свіже показання
+  * того ж дерева — ні.
+  *
+  * Два покоління по SEEN_BITS_PER_GEN біт, SEEN_HASHES хешів (double hashing).
+  * Нові ключі йдуть в активне покоління; перевірка дивиться обидва. Активне
+  * стає попереднім (а попереднє забувається), коли в ньому SEEN_GEN_CAPACITY
+  * ключів або йому SEEN_GEN_MAX_AGE_S секунд сну. Ключ живе 1–2 покоління.
+  * Це менше за цикл seq (256 кадрів ≥ 4.3 год при мінімальному інтервалі 60 с).
+  *
+  * Хибно-позитивна ймовірність на покоління, n ≤ 20, m = 224, k = 4:
+  *   (1 − e^(−kn/m))^k ≈ 0.81 %;  обидва покоління повні — ≈ 1.6 %
+  *   (заміряно на хості: 0.77 % і 1.72 %).
+  * Хибний позитив лише пропускає одну естафету (джерело саме дійде до
+  * Королеви або через іншого сусіда); хибних негативів немає.
+  *
+  * Стан — рівно SEEN_STATE_WORDS слів по 32 біти: Солдат зберігає їх у
+  * RTC Backup-регістрах. Усі нулі — дійсна порожня множина (холодний старт).
+  * Перевірка та вставка — фіксовані 2·k звертань до бітів, без циклів по вмісту.
+  */
+#ifndef SILKEN_SEEN_H
+#define SILKEN_SEEN_H
+
+#include <stdint.h>
+
+#include "silken_route.h"
+
+#define SEEN_WORDS_PER_GEN      7
+#define SEEN_BITS_PER_GEN       (SEEN_WORDS_PER_GEN * 32)  // 224
+#define SEEN_HASHES             4
+#define SEEN_GEN_CAPACITY       20      // Ключів на покоління до ротації
+#define SEEN_GEN_MAX_AGE_S      3600U   // Покоління старше години — ротація
+#define SEEN_STATE_WORDS        (2 * SEEN_WORDS_PER_GEN + 1) // 15: два покоління + meta
+
+#define SEEN_FRAME_SIZE         ROUTE_BLOCK_SIZE
+#define SEEN_TTL_OFFSET         ROUTE_HDR_HOP_TTL // Змінюється на кожному хопі — не входить у ключ
+
+// words[0..6] — активне покоління, words[7..13] — попереднє,
+// words[14] — meta: [7:0] ключів в активному, [31:8] вік активного (с, насичення)
+typedef struct {
+    uint32_t words[SEEN_STATE_WORDS];
+} SeenSet;
+
+void Seen_Init(SeenSet* set);
+
+// 1 — кадр (імовірно) вже бачили: не ретранслювати.
+// 0 — новий: ключ додано, можна ставити в чергу естафети.
+uint8_t Seen_Check_And_Insert(SeenSet* set, const uint8_t* frame);
+
+// Лише перевірка, без вставки
+uint8_t Seen_Contains(const SeenSet* set, const uint8_t* frame);
+
+// Минув elapsed_s секунд (сон між пробудженнями); старі покоління відмирають
+void Seen_Age(SeenSet* set, uint32_t elapsed_s);
+
+#endif /* SILKEN_SEEN_H */
@@ -0,0 +1,199 @@
+/**
+  ******************************************************************************
+  * @file           : silken_sync.c
+  * @brief          : Синхронізація часу з маяків Королеви і слоти TDMA для Солдатів
+  ******************************************************************************
+  */
+#include "silken_sync.h"
+
+#include <string.h>
+
+#define SYNC_SYMBOL_US          1024U   // SF7 / 125 кГц
+#define SYNC_PREAMBLE_SYMBOLS   8U      // LORA_PREAMBLE_LENGTH Солдата
+#define SYNC_BEACON_SIZE        20U     // ROUTE_BLOCK_SIZE: маяк — один блок
+
+static uint32_t sync_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// Мс від a до b на локальному годиннику доби (RTC переходить через північ)
+static uint32_t sync_span(uint32_t a, uint32_t b)
+{
+    return (b + SYNC_DAY_MS - a) % SYNC_DAY_MS;
+}
+
+// Різниця фаз у (−FRAME/2, FRAME/2]
+static int32_t sync_wrap(int32_t d)
+{
+    d %= (int32_t)SYNC_FRAME_MS;
+    if (d > (int32_t)SYNC_FRAME_MS / 2) d -= (int32_t)SYNC_FRAME_MS;
+    if (d <= -(int32_t)SYNC_FRAME_MS / 2) d += (int32_t)SYNC_FRAME_MS;
+    return d;
+}
+
+static uint32_t sync_phase(int64_t ms)
+{
+    int64_t p = ms % (int64_t)SYNC_FRAME_MS;
+    return (uint32_t)(p < 0 ? p + (int64_t)SYNC_FRAME_MS : p);
+}
+
+// Домашній слот DID: мультиплікативний хеш, старші 7 біт
+static uint8_t sync_home_slot(uint32_t did)
+{
+    return (uint8_t)((did * 2654435761U) >> 25);
+}
+
+uint32_t Sync_Airtime_Ms(uint16_t size)
+{
+    // Semtech AN1200.13: явний заголовок, CRC, без LDRO
+    uint32_t n = (8U * size + 16U + 27U) / 28U;
+    uint32_t symbols_x4 = 4U * SYNC_PREAMBLE_SYMBOLS + 17U + 4U * (8U + n * 5U);
+    return (symbols_x4 * SYNC_SYMBOL_US / 4U + 500U) / 1000U;
+}
+
+void Sync_Schedule_Init(SyncSchedule* s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+uint8_t Sync_Schedule_Slot(SyncSchedule* s, uint32_t did, uint32_t now_ms)
+{
+    uint8_t home = sync_home_slot(did);
+    uint8_t free_slot = SYNC_SLOT_NONE;
+    for (uint32_t i = 0; i < SYNC_SLOTS; i++) {
+        uint8_t slot = (uint8_t)((home + i) % SYNC_SLOTS);
+        if (Sync_Is_Contention(slot)) continue;
+        SyncOwner* o = &s->owner[slot];
+        if (o->did == did) {
+            o->heard_ms = now_ms;
+            return slot;
+        }
+        // Перший вільний на шляху зондування; шукаємо далі — раптом did вже має слот
+        if (free_slot == SYNC_SLOT_NONE &&
+            (o->did == 0 || now_ms - o->heard_ms > SYNC_SLOT_EXPIRY_MS)) {
+            free_slot = slot;
+        }
+    }
+    if (free_slot != SYNC_SLOT_NONE) {
+        s->owner[free_slot].did = did;
+        s->owner[free_slot].heard_ms = now_ms;
+    }
+    return free_slot;
+}
+
+uint8_t Sync_On_Slot(uint8_t slot, uint32_t tx_start_ms)
+{
+    if (slot == SYNC_SLOT_NONE) return 1; // Слотів немає — виправляти нічого
+    uint32_t phase = tx_start_ms % SYNC_FRAME_MS;
+    uint8_t heard_slot = (uint8_t)(phase / SYNC_SLOT_MS);
+    if (Sync_Is_Contention(heard_slot)) return 1; // Паніка чи позапланове — не збій
+    if (heard_slot != slot) return 0;
+
+    int32_t err = (int32_t)(phase % SYNC_SLOT_MS) - (int32_t)SYNC_GUARD_MS;
+    return (uint8_t)(err >= -(int32_t)SYNC_RESYNC_MS && err <= (int32_t)SYNC_RESYNC_MS);
+}
+
+void Sync_Fill_Beacon(uint8_t* beacon, uint32_t did, uint8_t slot, uint32_t now_ms)
+{
+    uint32_t phase = now_ms % SYNC_FRAME_MS;
+    beacon[SYNC_BEACON_DID]       = (uint8_t)(did >> 24);
+    beacon[SYNC_BEACON_DID + 1]   = (uint8_t)(did >> 16);
+    beacon[SYNC_BEACON_DID + 2]   = (uint8_t)(did >> 8);
+    beacon[SYNC_BEACON_DID + 3]   = (uint8_t)did;
+    beacon[SYNC_BEACON_SLOT]      = slot;
+    beacon[SYNC_BEACON_PHASE]     = (uint8_t)(phase >> 16);
+    beacon[SYNC_BEACON_PHASE + 1] = (uint8_t)(phase >> 8);
+    beacon[SYNC_BEACON_PHASE + 2] = (uint8_t)phase;
+}
+
+void Sync_Init(SyncState* st)
+{
+    memset(st, 0, sizeof(*st));
+    st->slot = SYNC_SLOT_NONE;
+}
+
+uint8_t Sync_On_Beacon(SyncState* st, const uint8_t* beacon, uint32_t own_did, uint32_t local_ms)
+{
+    if (own_did == 0 || sync_be32(&beacon[SYNC_BEACON_DID]) != own_did) return 0;
+
+    uint8_t slot = beacon[SYNC_BEACON_SLOT];
+    if (slot != SYNC_SLOT_NONE && Sync_Is_Contention(slot)) return 0; // Лише команда ADR
+
+    const uint8_t* p = &beacon[SYNC_BEACON_PHASE];
+    uint32_t phase = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[2];
+    if (phase >= SYNC_FRAME_MS) return 0;
+
+    // Фаза записана на старті TX маяка; ми чуємо його кінець
+    uint32_t queen_ms = (phase + Sync_Airtime_Ms(SYNC_BEACON_SIZE)) % SYNC_FRAME_MS;
+    int32_t offset = sync_wrap((int32_t)queen_ms - (int32_t)(local_ms % SYNC_FRAME_MS));
+
+    if (!st->valid) {
+        st->anchor_ms = local_ms;
+        st->anchor_offset_ms = offset;
+    } else {
+        uint32_t span = sync_span(st->anchor_ms, local_ms);
+        if (span >= SYNC_MAX_AGE_MS) {
+            st->anchor_ms = local_ms; // Опора надто стара: дрейф за нею вже не виміряти
+            st->anchor_offset_ms = offset;
+        } else if (span >= SYNC_DRIFT_MIN_SPAN_MS) {
+            int32_t moved = sync_wrap(offset - st->anchor_offset_ms);
+            int32_t ppm = (int32_t)((int64_t)moved * 1000000 / (int64_t)span);
+            if (ppm >= -SYNC_DRIFT_MAX_PPM && ppm <= SYNC_DRIFT_MAX_PPM) {
+                // EWMA ½: один вимір з тремтінням маяка не розгойдує оцінку
+                st->drift_ppm = (int16_t)(st->drift_ppm == 0 ? ppm : (st->drift_ppm + ppm) / 2);
+            }
+            st->anchor_ms = local_ms;
+            st->anchor_offset_ms = offset;
+        }
+    }
+
+    st->offset_ms = offset;
+    st->synced_ms = local_ms;
+    st->slot = slot;
+    st->valid = 1;
+    return 1;
+}
+
+void Sync_Expire(SyncState* st, uint32_t local_ms)
+{
+    if (st->valid && sync_span(st->synced_ms, local_ms) >= SYNC_MAX_AGE_MS) {
+        st->valid = 0;
+        st->slot = SYNC_SLOT_NONE;
+    }
+}
+
+uint32_t Sync_Queen_Ms(const SyncState* st, uint32_t local_ms)
+{
+    int64_t drift = (int64_t)st->drift_ppm * sync_span(st->synced_ms, local_ms) / 1000000;
+    return sync_phase((int64_t)(local_ms % SYNC_FRAME_MS) + st->offset_ms + drift);
+}
+
+// Від фази Королеви q до старту TX у слоті, мс (< FRAME)
+static uint32_t sync_until(uint32_t q, uint8_t slot)
+{
+    uint32_t target = (uint32_t)slot * SYNC_SLOT_MS + SYNC_GUARD_MS;
+    return (target + SYNC_FRAME_MS - q) % SYNC_FRAME_MS;
+}
+
+uint32_t Sync_Slot_Wait_Ms(const SyncState* st, uint32_t local_ms)
+{
+    if (!st->valid || st->slot == SYNC_SLOT_NONE) return SYNC_WAIT_MISSED;
+    uint32_t wait = sync_until(Sync_Queen_Ms(st, local_ms), st->slot);
+    return wait <= SYNC_WAIT_MAX_MS ? wait : SYNC_WAIT_MISSED;
+}
+
+uint32_t Sync_Sleep_S(const SyncState* st, uint32_t local_ms, uint32_t planned_s)
+{
+    if (!st->valid || st->slot == SYNC_SLOT_NONE) return planned_s;
+
+    // Входження слота, найближче до плану: у середньому сон = план (енергія та
+    // сама), але не коротше половини плану — короткий план і так обмежений кадром
+    uint32_t wait = sync_until(Sync_Queen_Ms(st, local_ms), st->slot);
+    uint32_t plan_ms = planned_s * 1000U;
+    uint32_t need = (plan_ms > SYNC_FRAME_MS ? plan_ms - SYNC_FRAME_MS / 2U : plan_ms / 2U) + SYNC_WAKE_LEAD_MS;
+    if (wait < need) {
+        wait += (need - wait + SYNC_FRAME_MS - 1U) / SYNC_FRAME_MS * SYNC_FRAME_MS;
+    }
+    return (wait - SYNC_WAKE_LEAD_MS) / 1000U;
+}
@@ -0,0 +1,131 @@
+/**
+  ******************************************************************************
+  * @file           : silken_sync.h
+  * @brief          : Синхронізація часу з маяків Королеви і слоти TDMA для Солдатів
+  ******************************************************************************
+  *
+  * Досі кожен Солдат виходив в ефір, коли прокинувся: jitter 0-500 мс + LBT.
+  * Поки кластер малий, цього досить; коли прямих сусідів Королеви сотня,
+  * колізії (і приховані вузли, яких CAD не чує) стають межею пропускної
+  * здатності, а кожен втрачений кадр — це спалений ENERGY_COST_UPLINK_UJ.
+  *
+  * Тепер час Королеви ділиться на кадри SYNC_FRAME_MS по SYNC_SLOTS слотів.
+  * Кожен SYNC_CONTENTION_EVERY-й слот спільний: його не видають нікому, це запас
+  * ефіру для позапланових кадрів. Паніка слота не чекає — виходить одразу через
+  * LBT, як і раніше. Решта — власні слоти прямих Солдатів:
+  * Королева видає слот з хешу повного DID (лінійне зондування при збігу,
+  * звільнення після SYNC_SLOT_EXPIRY_MS мовчання). Хто слота не має (ще не
+  * синхронізований, слоти скінчились — понад 112 прямих Солдатів) або
+  * прокинувся поза планом (вібрація), виходить як раніше: jitter + LBT.
+  *
+  * Синхронізація їде в тому ж маяку-відповіді, що й ADR (Солдат слухає лише
+  * після власного кадру, "сліпий" періодичний маяк ніхто б не почув):
+  *
+  *   байти 4-7   DID адресата (спільні з ADR)
+  *   байт 9      слот адресата (SYNC_SLOT_NONE — слотів немає, лише спільні;
+  *               0 — спільний слот, його не видають: синхронізації в маяку немає)
+  *   байти 12-14 uint24: фаза Королеви, мс від початку кадру, на старті TX маяка
+  *
+  * Королева відповідає синхронізацією, коли кадр прямого Солдата почався не у
+  * своєму слоті (або далі SYNC_RESYNC_MS від SYNC_GUARD_MS), — решту часу
+  * фаза їде з кожною командою ADR. Солдат міряє фазу своїм RTC (мс доби:
+  * 675 кадрів = рівно доба, тож північ не рве фазу) і рахує дрейф кварцу в
+  * ppm між маяками, що рознесені на ≥ SYNC_DRIFT_MIN_SPAN_MS. Сон вирівнюється
+  * на входження слота, найближче до енергетичного плану (±SYNC_FRAME_MS/2 —
+  * у середньому той самий сон), мінус SYNC_WAKE_LEAD_MS на ФАЗИ 1-3; решту
+  * Солдат дочікується у STOP2.
+  *
+  * Лише прямі Солдати (hop 1) отримують слоти: кадр естафети Королева чує
+  * від ретранслятора, не від джерела. Багатохопові дерева — в спільних слотах.
+  * Модуляція фіксована (SF7/125 кГц, CR 4/5, преамбула 8) — Sync_Airtime_Ms
+  * рахує ефір саме для неї.
+  */
+#ifndef SILKEN_SYNC_H
+#define SILKEN_SYNC_H
+
+#include <stdint.h>
+
+#define SYNC_SLOT_MS            1000U   // Пачка 8 блоків (261 мс) + діагностика + вікно RX
+#define SYNC_SLOTS              128U
+#define SYNC_FRAME_MS           (SYNC_SLOT_MS * SYNC_SLOTS)  // 128 с; доба = 675 кадрів
+#define SYNC_DAY_MS             86400000U
+#define SYNC_CONTENTION_EVERY   8U      // Слоти 0, 8, 16, … — спільні (16 з 128)
+#define SYNC_GUARD_MS           100U    // Старт TX від початку слота: запас на дрейф
+#define SYNC_RESYNC_MS          50U     // Похибка старту, після якої Королева синхронізує знову
+#define SYNC_WAKE_LEAD_MS       2000U   // Пробудження раніше слота: ФАЗИ 1-3
+#define SYNC_WAIT_MAX_MS        (SYNC_WAKE_LEAD_MS + 2000U) // + 2 с гранулярності ck_spre
+#define SYNC_DRIFT_MIN_SPAN_MS  1800000U // Дрейф міряємо між маяками через ≥ 30 хв
+#define SYNC_DRIFT_MAX_PPM      200     // Більше — збій, а не кварц
+#define SYNC_MAX_AGE_MS         43200000U // 12 год: залишок ~2 ppm → ≤ GUARD_MS похибки
+#define SYNC_SLOT_EXPIRY_MS     86400000U // Королева: доба мовчання звільняє слот (пульс RBE ≤ 18 год)
+#define SYNC_SLOT_NONE          0xFF
+#define SYNC_WAIT_MISSED        0xFFFFFFFFU
+
+// Поля синхронізації у відкритому тексті маяка (адресат — ADR_BEACON_DID)
+#define SYNC_BEACON_DID         4       // uint32 BE
+#define SYNC_BEACON_SLOT        9
+#define SYNC_BEACON_PHASE       12      // uint24 BE, мс
+
+// Ефір кадру size байт на модуляції мережі, мс (20 Б → 57, 160 Б → 261)
+uint32_t Sync_Airtime_Ms(uint16_t size);
+
+static inline uint8_t Sync_Is_Contention(uint8_t slot)
+{
+    return (uint8_t)(slot % SYNC_CONTENTION_EVERY == 0);
+}
+
+// --- Королева ---
+
+typedef struct {
+    uint32_t did;                       // 0 — слот вільний
+    uint32_t heard_ms;                  // Останній кадр власника (годинник Королеви)
+} SyncOwner;
+
+typedef struct {
+    SyncOwner owner[SYNC_SLOTS];        // Спільні слоти ніколи не зайняті
+} SyncSchedule;
+
+void Sync_Schedule_Init(SyncSchedule* s);
+
+// Слот прямого Солдата did (вже виданий або новий). SYNC_SLOT_NONE — все зайнято.
+uint8_t Sync_Schedule_Slot(SyncSchedule* s, uint32_t did, uint32_t now_ms);
+
+// 1 — кадр, що стартував у tx_start_ms, ліг у свій слот (або у спільний,
+// або слота немає): синхронізація не потрібна
+uint8_t Sync_On_Slot(uint8_t slot, uint32_t tx_start_ms);
+
+// Синхронізація в маяк: адресат, слот і фаза now_ms (безпосередньо перед TX)
+void Sync_Fill_Beacon(uint8_t* beacon, uint32_t did, uint8_t slot, uint32_t now_ms);
+
+// --- Солдат ---
+
+typedef struct {
+    int32_t  offset_ms;                 // Фаза Королеви − локальна фаза на synced_ms
+    uint32_t synced_ms;                 // Локальні мс доби останнього маяка
+    int32_t  anchor_offset_ms;          // Опорна точка виміру дрейфу
+    uint32_t anchor_ms;
+    int16_t  drift_ppm;                 // > 0 — локальний кварц відстає
+    uint8_t  slot;
+    uint8_t  valid;
+} SyncState;
+
+void Sync_Init(SyncState* st);
+
+// Автентичний маяк Королеви, прийнятий у local_ms (RTC, мс доби). 1 — для нас.
+uint8_t Sync_On_Beacon(SyncState* st, const uint8_t* beacon, uint32_t own_did, uint32_t local_ms);
+
+// Раз на пробудження: застаріла синхронізація (≥ SYNC_MAX_AGE_MS) скидається
+void Sync_Expire(SyncState* st, uint32_t local_ms);
+
+// Оцінка фази Королеви з урахуванням дрейфу, мс від початку кадру
+uint32_t Sync_Queen_Ms(const SyncState* st, uint32_t local_ms);
+
+// Очікування до старту TX у власному слоті; SYNC_WAIT_MISSED — слота немає
+// або він далі SYNC_WAIT_MAX_MS (позапланове пробудження)
+uint32_t Sync_Slot_Wait_Ms(const SyncState* st, uint32_t local_ms);
+
+// Сон, с: входження слота, найближче до planned_s (не коротше planned_s / 2),
+// пробудження за SYNC_WAKE_LEAD_MS до нього
+uint32_t Sync_Sleep_S(const SyncState* st, uint32_t local_ms, uint32_t planned_s);
+
+#endif /* SILKEN_SYNC_H */
@@ -17,6 +17,35 @@
 
 // Підключаємо низькорівневий драйвер радіо (Radio Middleware)
 #include "radio.h"
+
+// Профайлер фаз на DWT CYCCNT та діагностичні кадри (firmware/common)
+#include "silken_prof.h"
+#include "silken_diag.h"
+
+// Низькоенергетичні паузи на LPTIM1 замість HAL_Delay (firmware/common)
+#include "silken_lpdelay.h"
+
+// Формат агрегованих кадрів Солдата: N × 20-байтних блоків (firmware/common)
+#include "silken_relayq.h"
+
+// Градієнтна маршрутизація: маяк hop 0 для Солдатів (firmware/common)
+#include "silken_route.h"
+
+// Персональні ключі Солдатів: таблиця у Flash + LRU у SRAM (firmware/common)
+#include "silken_keys.h"
+
+// Адаптивна потужність TX Солдатів за якістю лінку (firmware/common)
+#include "silken_adr.h"
+// Синхронізація часу та слоти TDMA прямих Солдатів (firmware/common)
+#include "silken_sync.h"
+// [ОПТИМІЗАЦІЯ Channel Plan] Канал кластера з плану EU868 — найтихіший при старті
+#include "silken_chan.h"
+// [ОПТИМІЗАЦІЯ RX Ring] Кадри з OnRxDone — у кільце, не в один буфер
+#include "silken_rxring.h"
+// [ОПТИМІЗАЦІЯ Scheduler] Задачі до завершення замість while(1) з опитуванням
+#include "silken_sched.h"
+// [ОПТИМІЗАЦІЯ OTA CRC] CRC16-CCITT кожного CoAP-чанка OTA — на апаратному блоці CRC
+#include "silken_crc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -40,7 +69,27 @@
 #define FLUSH_INTERVAL_MS     3600000   // Інтервал скидання кешу (1 година)
 #define FLUSH_HEADROOM        5         // Кількість вільних слотів до примусового скидання
 #define QUEEN_HEALTH_GP_MAX   63        // Максимальне значення growth_points
+#define QUEEN_FIRMWARE_ID     0x0000    // Королева не має OTA — версія для кадрів профілю
 #define OTA_MAX_CHUNKS        16        // 8192 / 512 = максимальна кількість OTA-чанків
+#define KEYS_TABLE_FLASH_ADDR 0x08020000U // Таблиця ключів Солдатів (≤ 112 КБ), прошивається при провіженінгу
+
+// [ОПТИМІЗАЦІЯ Scheduler] Події задач (біти маски; SCHED_EV_TIMER — спільний)
+#define EV_RADIO_RX           0x01U     // OnRxDone: кадр у кільці rx_ring
+#define EV_MODEM_RX           0x01U     // UART ISR: байти модема в modem_rx_ring
+#define EV_HEALTH_FLUSH_DUE   0x01U     // Кеш майже повний — пора скидати
+#define EV_FLUSH_START        0x01U     // Здоров'я додано, батч можна пакувати
+#define EV_FLUSH_STEP         0x02U     // Наступна порція hex у UART
+
+// Кроки скидання: колишні HAL_Delay стали таймерами задачі FLUSH
+#define FLUSH_OPEN_MS         1000      // AT+CCOAPNEW → сесія відкрита
+#define FLUSH_ACK_MS          2000      // AT+CCOAPSEND → UDP ACK сервера
+#define FLUSH_CLOSE_MS        500       // AT+CCOAPDEL → модем вільний
+#define FLUSH_HEX_CHUNK       64        // Байт батча за крок: 128 hex-символів ≈ 11 мс UART
+
+// Прийом від модема: байти з ISR → рядки AT / URC
+#define MODEM_RX_RING         256       // Індекси uint8_t: 255 байт у черзі
+#define MODEM_LINE_PREFIX     24        // Початок рядка до першої лапки
+#define MODEM_URC_COAP        "+CCOAPRECV:" // Downlink: +CCOAPRECV: <id>,<len>,"<hex>"
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -51,6 +100,7 @@
 UART_HandleTypeDef huart1;  // Інтерфейс для модему SIM7070G (LTE-M / Starlink)
 SUBGHZ_HandleTypeDef hsubghz;
 CRYP_HandleTypeDef hcryp; // Апаратний криптопроцесор AES
+LPTIM_HandleTypeDef hlptim1; // Низькоенергетичні паузи (LSE)
 RNG_HandleTypeDef hrng;   // Апаратний генератор випадкових чисел (HRNG)
 
 /* USER CODE BEGIN PV */
@@ -68,17 +118,76 @@ uint32_t aes_key[8] = {0x2B7E1516, 0x28AED2A6, 0xABF71588, 0x09CF4F3C,
 // Дозволяє серверу ідентифікувати шлюз навіть при зміні IP (Starlink NAT).
 const char queen_uid[] = "QUEEN-001";
 
+// [ОПТИМІЗАЦІЯ Per-Device Keys] Персональні ключі Солдатів (HardwareKey на
+// сервері) за відкритим Src блоку. Солдат без запису — на aes_key вище.
+KeyCache key_cache;
+
 // =========================================================================
 // === 1. ПАМ'ЯТЬ КОРОЛЕВИ (Прийом Даних) ===
 // =========================================================================
-volatile uint8_t lora_rx_flag = 0;      // Прапорець: 1 - пакет спіймано
-// [FIX: AUDIT] volatile — записуються в OnRxDone ISR, читаються в main loop
-volatile uint8_t incoming_lora_payload[16]; // Сирий 16-байтний зашифрований пакет
-uint8_t decrypted_payload[16];          // Розшифрований пакет від Солдата
-volatile int8_t current_rssi = 0;       // Рівень сигналу
+// [ОПТИМІЗАЦІЯ RX Ring] OnRxDone (виробник) → головний цикл (споживач) без замків.
+// Слот — сирий пакет (N × [заголовок:4][AES:16]), RSSI, SNR і Queen_Now_Ms()
+// кінця пакета (для TDMA). Кадри, що прийшли під час рефлексу чи скидання
+// кешу, чекають у черзі, а не затирають один одного.
+RxRing rx_ring;
+
+// [ОПТИМІЗАЦІЯ ADR] Запас лінку прямих Солдатів за DID; команда — у маяку-відповіді
+AdrTable adr_table;
+
+// [ОПТИМІЗАЦІЯ TDMA] Слоти прямих Солдатів за DID і годинник кадрів.
+// SysTick стоїть на час паузи (LP_Delay_*) — паузи докладаються вручну.
+SyncSchedule sync_schedule;
+uint32_t queen_paused_ms = 0;
+uint8_t modem_rx_armed = 0;             // 1 — байти модема йдуть: паузи без STOP2
+
+// [ОПТИМІЗАЦІЯ Channel Plan] Зайнятість кожного каналу плану при старті і
+// вибраний канал кластера (Солдати знаходять його скануванням)
+ChanSurvey chan_survey;
+uint8_t queen_channel = 0;
 
 char at_tx_buffer[256];                 // Буфер для формування AT-команд
 
+// [ОПТИМІЗАЦІЯ Profiling] Тривалість обробки пакета та скидання батча (такти ядра).
+// На кожен батч — один кадр профілю (DID=0), фази RX / FLUSH по черзі.
+ProfTable phase_prof;
+uint8_t prof_next_phase = PROF_PHASE_RX;
+
+// [ОПТИМІЗАЦІЯ Scheduler] Планувальник і задачі Королеви (пріоритет — порядок
+// додавання): RADIO → MODEM → HEALTH → FLUSH
+Sched queen_sched;
+uint8_t task_radio, task_modem, task_health, task_flush;
+
+// Скидання кешу — скінченний автомат задачі FLUSH; між кроками працює RX
+typedef enum {
+    FLUSH_IDLE = 0,
+    FLUSH_OPEN,                         // Чекаємо сесію CoAP
+    FLUSH_SEND,                         // Hex батча порціями
+    FLUSH_ACK,                          // Чекаємо UDP ACK
+    FLUSH_CLOSE                         // Чекаємо закриття сесії
+} FlushStep;
+FlushStep flush_step = FLUSH_IDLE;
+uint16_t flush_total = 0;               // Байт у encrypted_batch_buffer (IV + шифротекст)
+uint16_t flush_sent = 0;
+
+// Байти від SIM7070G: ISR пише лише head, задача MODEM — лише tail
+uint8_t modem_rx_byte;                  // Буфер HAL_UART_Receive_IT на один байт
+volatile uint8_t modem_rx_ring[MODEM_RX_RING];
+volatile uint8_t modem_rx_head = 0;
+volatile uint8_t modem_rx_tail = 0;
+volatile uint16_t modem_rx_overruns = 0;
+
+// Розбір рядка модема: префікс до лапки, далі hex downlink-пакета
+typedef enum {
+    MODEM_LINE = 0,                     // Збираємо префікс
+    MODEM_HEX,                          // Декодуємо hex у modem_downlink
+    MODEM_HEX_DONE,                     // Закривна лапка — чекаємо кінця рядка
+    MODEM_SKIP                          // Чужий / битий рядок — до кінця рядка
+} ModemParse;
+ModemParse modem_parse = MODEM_LINE;
+char modem_line[MODEM_LINE_PREFIX];
+uint8_t modem_line_len = 0;
+uint8_t modem_hex_high = 0;             // 1 — старший напівбайт уже прийнято
+
 // =========================================================================
 // === 1.5. EDGE КЕШУВАННЯ (CIFO & Дедуплікація) ===
 // =========================================================================
@@ -98,6 +207,9 @@ uint8_t cache_count = 0;
 // Замість 8192 байтів текстового JSON використовуємо компактний бінарний буфер
 // 50 записів по 21 байту = всього 1050 байтів.
 uint8_t binary_batch_buffer[2048];
+// [FIX: AUDIT CRITICAL] Не на стеку: 2064 байти при 64KB RAM — ризик переповнення.
+// Буфер: IV (16 байт) + зашифровані дані; задача FLUSH шле його порціями.
+uint8_t encrypted_batch_buffer[2048 + 16];
 
 // =========================================================================
 // === 1.6. ДЕДУПЛІКАЦІЯ КОМАНД АКТУАТОРІВ (Idempotency Ring Buffer) ===
@@ -120,6 +232,11 @@ uint8_t  cmd_dedup_used = 0;            // Кількість заповнени
 #define CMD_DECRYPT_BUF_SIZE 544
 uint8_t cmd_decrypt_buf[CMD_DECRYPT_BUF_SIZE];
 
+// Декодований downlink [IV:16][шифротекст] для Handle_CoAP_Command.
+// uint32_t — шифротекст іде в HAL_CRYP_Decrypt словами.
+uint32_t modem_downlink[(CMD_DECRYPT_BUF_SIZE + 16) / 4];
+uint16_t modem_downlink_len = 0;
+
 // =========================================================================
 // === 2. БУНКЕР OTA-ОНОВЛЕНЬ (Передача нових контрактів) ===
 // =========================================================================
@@ -152,16 +269,31 @@ static void MX_GPIO_Init(void);
 static void MX_USART1_UART_Init(void);
 static void MX_SUBGHZ_Init(void);
 static void MX_CRYP_Init(void); // Ініціалізація шифрування
+static void MX_LPTIM1_Init(void);
 
 /* USER CODE BEGIN PFP */
 // Функції-обгортки для роботи з модемом та транзитом
 void SIM7070_SendATCommand(char* command, uint32_t delay_ms);
+void SIM7070_Send(const char* command);
 void Process_And_Cache_Data(uint32_t uid, uint8_t* payload, int8_t rssi);
-void Flush_Cache_To_Rails(void);
+void Cache_Append_Data(uint32_t uid, uint8_t* payload, int8_t rssi);
+void Cache_Store_Reading(uint32_t uid, uint8_t* payload, int8_t rssi);
+static uint8_t Rx_Block_In_Batch(const uint8_t* rx, uint8_t rx_blocks, uint8_t b,
+                                 uint32_t sender_id, uint32_t prev_sender);
+uint16_t Flush_Cache_To_Rails(void);
+static void Task_Radio(uint32_t events, uint32_t now_ms);
+static void Task_Modem(uint32_t events, uint32_t now_ms);
+static void Task_Health(uint32_t events, uint32_t now_ms);
+static void Task_Flush(uint32_t events, uint32_t now_ms);
+static void Modem_Parse_Byte(uint8_t c);
+static void Queen_Idle(void);
 // [СИНХРОНІЗОВАНО з Rails]: Обробка вхідних CoAP-команд від сервера
 static uint32_t djb2_hash(const char* str, uint8_t len);
 uint8_t Cmd_Dedup_Check(uint32_t hash);
 void Handle_CoAP_Command(uint8_t* payload, uint16_t len);
+static void Queen_Use_Key(const KeyRef* ref);
+static uint32_t Queen_Now_Ms(void);
+static void Queen_Pause_Ms(uint32_t ms);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -186,19 +318,57 @@ int main(void)
   MX_USART1_UART_Init(); // UART для розмови з SIM7070G (115200 baud)
   MX_SUBGHZ_Init();
   MX_CRYP_Init();        // Вмикаємо апаратний модуль AES
+  MX_LPTIM1_Init();      // Таймер для LP_Delay_Ms
 
   /* USER CODE BEGIN 2 */
 
+  LP_Delay_Init(&hlptim1);
+
   // 1. Ініціалізація низькорівневого радіо
   Radio.Init(NULL);
-  Radio.SetChannel(868000000); // 868 МГц (Європа / Україна)
+  // [ОПТИМІЗАЦІЯ Channel Plan] ~80 с слухаємо кожен канал плану EU868: кластери
+  // сусідніх Королев уже там. Беремо найтихіший (домашній за UID — при рівних),
+  // щоб чужі кадри не забирали ефір наших Солдатів.
+  Chan_Survey_Init(&chan_survey);
+  for (uint8_t ch = 0; ch < CHAN_COUNT; ch++) {
+      Radio.SetChannel(Chan_Freq_Hz(ch));
+      Radio.Rx(LORA_RX_INFINITE);
+      for (uint16_t i = 0; i < CHAN_SURVEY_SAMPLES; i++) {
+          Queen_Pause_Ms(CHAN_SURVEY_STEP_MS);
+          Chan_Survey_Add(&chan_survey, ch, Radio.Rssi(MODEM_LORA));
+      }
+      Radio.Standby();
+  }
+  queen_channel = Chan_Survey_Pick(&chan_survey, Chan_Home(queen_uid, CHAN_COUNT), CHAN_COUNT);
+  Radio.SetChannel(Chan_Freq_Hz(queen_channel));
+  RxRing_Init(&rx_ring); // Кадри, спіймані під час огляду, — з чужих каналів
 
   // 2. Ініціалізація Кешу нулями
   memset(forest_cache, 0, sizeof(forest_cache));
+  Prof_Init(&phase_prof);
+  Crc_Init();
+  Adr_Table_Init(&adr_table);
+  Sync_Schedule_Init(&sync_schedule);
+  // Таблиця ключів у Flash; стерта чи зіпсована → усі Солдати на ключі мережі
+  uint16_t key_count;
+  const KeyRecord* key_table = Keys_Table_From_Flash((const void*)KEYS_TABLE_FLASH_ADDR, &key_count);
+  Keys_Init(&key_cache, key_table, key_count, aes_key);
   // [СИНХРОНІЗОВАНО з Rails]: Ініціалізація кільцевого буфера дедуплікації команд
   memset(cmd_dedup_ring, 0, sizeof(cmd_dedup_ring));
 
+  // [ОПТИМІЗАЦІЯ Scheduler] Задачі за пріоритетом: ефір не чекає ні на кого,
+  // відповідь сервера — на ефір, скидання кешу — на всіх
+  Sched_Init(&queen_sched);
+  task_radio  = Sched_Add(&queen_sched, Task_Radio);
+  task_modem  = Sched_Add(&queen_sched, Task_Modem);
+  task_health = Sched_Add(&queen_sched, Task_Health);
+  task_flush  = Sched_Add(&queen_sched, Task_Flush);
+  Sched_Timer(&queen_sched, task_health, Queen_Now_Ms(), FLUSH_INTERVAL_MS, 0);
+
   // 3. Ініціалізація модему SIM7070G
+  // Відповіді й downlink модема — байтами в modem_rx_ring (задача MODEM)
+  HAL_UART_Receive_IT(&huart1, &modem_rx_byte, 1);
+  modem_rx_armed = 1;
   // Перевіряємо зв'язок та налаштовуємо режим (LTE-M / NB-IoT)
   SIM7070_SendATCommand("AT\r\n", 500);
   SIM7070_SendATCommand("AT+CNMP=38\r\n", 1000);
@@ -208,147 +378,460 @@ int main(void)
 
   /* USER CODE END 2 */
 
-  uint32_t last_flush_time = HAL_GetTick();
-
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-    // =========================================================================
-    // ФАЗА ОЧІКУВАННЯ ТА ОБРОБКИ РАДІОЕФІРУ
-    // =========================================================================
+    // [ОПТИМІЗАЦІЯ Scheduler] Одна задача за крок; подій немає — ядро в SLEEP
+    if (Sched_Run(&queen_sched, Queen_Now_Ms())) continue;
+    Queen_Idle();
+
+    /* USER CODE END WHILE */
+
+    /* USER CODE BEGIN 3 */
+  }
+  /* USER CODE END 3 */
+}
 
-    // Якщо апаратне переривання OnRxDone спіймало пакет від Солдата
-    if (lora_rx_flag == 1)
+/* USER CODE BEGIN 4 */
+
+// =========================================================================
+// АПАРАТНИЙ РЕФЛЕКС РАДІО (Вуха Королеви)
+// =========================================================================
+void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
+{
+    // Очікуємо 1..8 блоків [заголовок:4][AES-256:16] (пачка власних показань + естафета)
+    uint8_t blocks = RelayQ_Frame_Blocks(size);
+    if (blocks > 0)
     {
-        // 1. РОЗШИФРОВУЄМО ПАКЕТ
-        // Розшифровуємо 4 слова (16 байт) апаратним модулем
-        // (void*) cast strips volatile — safe: lora_rx_flag serializes ISR→main access.
-        HAL_CRYP_Decrypt(&hcryp, (uint32_t*)(void*)incoming_lora_payload, 4, (uint32_t*)decrypted_payload, 1000);
-
-        // =========================================================================
-        // РЕФЛЕКТОРНИЙ ПОСТРІЛ (OTA BROADCAST)
-        // Солдат прямо зараз (після відправки) слухає ефір рівно 500 мс.
-        // Ми маємо блискавично вистрілити шматком нової прошивки йому у відповідь.
-        // =========================================================================
-        if (ota_is_active) {
-            uint8_t ota_chunk[16] = {0};
-            uint8_t encrypted_ota[16] = {0};
-
-            // В один 16-байтний пакет влазить 11 байт чистого коду (5 байтів - заголовок: 1 маркер + 2 index + 2 total)
-            uint16_t total_chunks = (pending_ota_size + 10) / 11;
-
-            // [FIX: AUDIT] Перевірка індексу перед використанням
-            if (current_ota_chunk_idx < total_chunks) {
-                // Формуємо заголовок (0x99 = маркер OTA-пакета, 16-bit big-endian index/total)
-                ota_chunk[0] = 0x99;
-                ota_chunk[1] = (uint8_t)(current_ota_chunk_idx >> 8);
-                ota_chunk[2] = (uint8_t)(current_ota_chunk_idx & 0xFF);
-                ota_chunk[3] = (uint8_t)(total_chunks >> 8);
-                ota_chunk[4] = (uint8_t)(total_chunks & 0xFF);
-
-                // Копіюємо до 11 байт коду в пакет
-                uint16_t offset = current_ota_chunk_idx * 11;
-                // [FIX: AUDIT CRITICAL] Перевірка на підтікання (offset >= pending_ota_size)
-                if (offset < pending_ota_size) {
-                    uint8_t bytes_to_copy = (pending_ota_size - offset > 11) ? 11 : (uint8_t)(pending_ota_size - offset);
-                    memcpy(&ota_chunk[5], &pending_ota_bytecode[offset], bytes_to_copy);
-                }
-
-                // Шифруємо цей шматок коду
-                HAL_CRYP_Encrypt(&hcryp, (uint32_t*)ota_chunk, 4, (uint32_t*)encrypted_ota, 1000);
-
-                // СТРІЛЯЄМО В ЕФІР
-                Radio.Send(encrypted_ota, 16);
-
-                // Даємо радіомодулю час фізично передати пакет (бл. 50-60 мс)
-                HAL_Delay(60);
-            }
+        // [ОПТИМІЗАЦІЯ RX Ring] Кільце повне — кадр відкидається (rx_ring.dropped):
+        // старіші вже в черзі й важать не менше.
+        RxSlot* slot = RxRing_Claim(&rx_ring);
+        if (slot == NULL) return;
+        memcpy(slot->frame, payload, size);
+        slot->size = size;
+        // [FIX: RSSI Truncation] SX1262 може повернути RSSI < -128.
+        // Clamp до int8_t діапазону перед приведенням, щоб запобігти
+        // overflow (наприклад, -130 → 126, що б отруїло CIFO eviction).
+        if (rssi < -128) rssi = -128;
+        if (rssi > 127) rssi = 127;
+        slot->rssi_dbm = (int8_t)rssi;
+        slot->snr_db = snr;
+        slot->rx_ms = Queen_Now_Ms();
+        RxRing_Publish(&rx_ring);
+        Sched_Post(&queen_sched, task_radio, EV_RADIO_RX); // Сигналізуємо задачі RADIO
+    }
+}
 
-            // Перемикаємося на наступний шматок для наступного дерева
-            current_ota_chunk_idx++;
-            if (current_ota_chunk_idx >= total_chunks) {
-                current_ota_chunk_idx = 0;
-                // Якщо маємо оновити ліс лише один раз, розкоментувати:
-                // ota_is_active = 0;
+// =========================================================================
+// [ОПТИМІЗАЦІЯ Scheduler] ЗАДАЧА RADIO: кадр із кільця → рефлекс → кеш
+// =========================================================================
+// Один кадр за виклик; решта кільця — наступними викликами (RADIO найвищого
+// пріоритету, тож кільце дренується раніше за все інше). Рефлекс (маяк / OTA-
+// чанк) лишається тут: він мусить влучити у вікно RX Солдата одразу після кадру.
+static void Task_Radio(uint32_t events, uint32_t now_ms)
+{
+    (void)events;
+    (void)now_ms;
+    RxSlot* rx_slot = RxRing_Peek(&rx_ring);
+    if (rx_slot == NULL) return;
+
+    Prof_Begin(&phase_prof, PROF_PHASE_RX);
+
+    // 1. ЧИТАЄМО ВІДКРИТІ ЗАГОЛОВКИ
+    // [ОПТИМІЗАЦІЯ Cleartext Header] Рефлекс і сортування — до розшифровки:
+    // маяк чи OTA-чанк летять у вікно Солдата без жодного HAL_CRYP_Decrypt.
+    // Слот наш до RxRing_Release: ISR пише лише у вільні.
+    uint8_t rx_blocks = RelayQ_Frame_Blocks(rx_slot->size);
+    uint8_t* rx = rx_slot->frame;
+    uint32_t rx_done_ms = rx_slot->rx_ms;
+    uint8_t reflex_sent = 0;
+    // Кадр чекав у черзі (скидання кешу) — вікно RX Солдата вже закрите
+    uint8_t reflex_fresh = (Queen_Now_Ms() - rx_done_ms) <= RXRING_REFLEX_MAX_AGE_MS;
+
+    // [FIX: Reply Key] Відповідь (OTA-чанк чи маяк) — на ключі мережі: лише ним
+    // Солдат розшифровує ефір. Персональний ключ передавача шукає вже розбір
+    // блоків нижче, один раз на блок.
+    uint16_t reply_src = (uint16_t)((rx[ROUTE_HDR_SRC] << 8) | rx[ROUTE_HDR_SRC + 1]);
+    KeyRef reply_key = Keys_Network(&key_cache);
+
+    // =========================================================================
+    // РЕФЛЕКТОРНИЙ ПОСТРІЛ (OTA BROADCAST)
+    // Солдат прямо зараз (після відправки) слухає ефір рівно 500 мс.
+    // Ми маємо блискавично вистрілити шматком нової прошивки йому у відповідь.
+    // =========================================================================
+    if (reflex_fresh && ota_is_active) {
+        uint8_t ota_chunk[16] = {0};
+        uint8_t encrypted_ota[16] = {0};
+
+        // В один 16-байтний пакет влазить 11 байт чистого коду (5 байтів - заголовок: 1 маркер + 2 index + 2 total)
+        uint16_t total_chunks = (pending_ota_size + 10) / 11;
+
+        // [FIX: AUDIT] Перевірка індексу перед використанням
+        if (current_ota_chunk_idx < total_chunks) {
+            // Формуємо заголовок (0x99 = маркер OTA-пакета, 16-bit big-endian index/total)
+            ota_chunk[0] = 0x99;
+            ota_chunk[1] = (uint8_t)(current_ota_chunk_idx >> 8);
+            ota_chunk[2] = (uint8_t)(current_ota_chunk_idx & 0xFF);
+            ota_chunk[3] = (uint8_t)(total_chunks >> 8);
+            ota_chunk[4] = (uint8_t)(total_chunks & 0xFF);
+
+            // Копіюємо до 11 байт коду в пакет
+            uint16_t offset = current_ota_chunk_idx * 11;
+            // [FIX: AUDIT CRITICAL] Перевірка на підтікання (offset >= pending_ota_size)
+            if (offset < pending_ota_size) {
+                uint8_t bytes_to_copy = (pending_ota_size - offset > 11) ? 11 : (uint8_t)(pending_ota_size - offset);
+                memcpy(&ota_chunk[5], &pending_ota_bytecode[offset], bytes_to_copy);
             }
-        }
 
-        // =========================================================================
-        // ОБРОБКА ДАНИХ (КЕШУВАННЯ)
-        // =========================================================================
-        // Витягуємо унікальний ID Солдата (перші 4 байти - DID)
-        uint32_t sender_id = ((uint32_t)decrypted_payload[0] << 24) |
-                             ((uint32_t)decrypted_payload[1] << 16) |
-                             ((uint32_t)decrypted_payload[2] << 8)  |
-                             (uint32_t)decrypted_payload[3];
+            // Шифруємо цей шматок коду
+            Queen_Use_Key(&reply_key);
+            HAL_CRYP_Encrypt(&hcryp, (uint32_t*)ota_chunk, 4, (uint32_t*)encrypted_ota, 1000);
 
-        // Замість миттєвої відправки, складаємо в CIFO-кеш
-        Process_And_Cache_Data(sender_id, decrypted_payload, current_rssi);
+            // СТРІЛЯЄМО В ЕФІР
+            Radio.Send(encrypted_ota, 16);
 
-        // Очищаємо прапорець і знову відкриваємо вуха
-        lora_rx_flag = 0;
-        Radio.Rx(LORA_RX_INFINITE);
+            // Даємо радіомодулю час фізично передати пакет (бл. 50-60 мс).
+            // [ОПТИМІЗАЦІЯ LP Delay] Ядро у SLEEP, радіо передає саме.
+            // SysTick стоїть — FLUSH_INTERVAL_MS розтягується на ці 60 мс.
+            Queen_Pause_Ms(60);
+            reflex_sent = 1;
+        }
+
+        // Перемикаємося на наступний шматок для наступного дерева
+        current_ota_chunk_idx++;
+        if (current_ota_chunk_idx >= total_chunks) {
+            current_ota_chunk_idx = 0;
+            // Якщо маємо оновити ліс лише один раз, розкоментувати:
+            // ota_is_active = 0;
+        }
+    }
+    // [ОПТИМІЗАЦІЯ Gradient] Передавач дістав нас напряму, отже він hop 1.
+    // Якщо він рахує себе далі (або градієнта ще не знає) — маяк у його
+    // вікно RX. Під час OTA вікно зайняте чанком: градієнт доучиться з сусідів.
+    // [ОПТИМІЗАЦІЯ ADR] Той самий маяк везе команду потужності, щойно вікно
+    // ADR_HISTORY прямих кадрів передавача повне (навіть "лишити як є" —
+    // Солдат знає, що його чують, і не піднімає потужність сам).
+    // [ОПТИМІЗАЦІЯ TDMA] Прямий Солдат, чий кадр почався не у своєму слоті,
+    // отримує слот і фазу кадру Королеви; фаза їде і з кожною командою ADR.
+    else if (reflex_fresh && rx[ROUTE_HDR_TYPE] != FRAME_TYPE_BEACON) {
+        uint8_t beacon[ROUTE_BODY_SIZE];
+        uint8_t beacon_block[ROUTE_BLOCK_SIZE];
+
+        Route_Pack_Beacon(beacon);
+        uint8_t adr_due = Adr_Fill_Beacon(&adr_table, reply_src, beacon);
+        uint8_t direct = Route_Byte_Hop(rx[ROUTE_HDR_HOP_TTL]) == ROUTE_HOP_QUEEN + 1;
+        uint8_t sync_due = 0;
+        uint32_t sync_did = Adr_Did_For_Src(&adr_table, reply_src); // 0 — ще не чули напряму
+        uint8_t sync_slot = SYNC_SLOT_NONE;
+        if (sync_did != 0 && direct) {
+            uint32_t tx_start = rx_done_ms - Sync_Airtime_Ms((uint16_t)(rx_blocks * RELAYQ_FRAME_SIZE));
+            sync_slot = Sync_Schedule_Slot(&sync_schedule, sync_did, rx_done_ms);
+            sync_due = !Sync_On_Slot(sync_slot, tx_start);
+        }
+        if (adr_due || sync_due || !direct) {
+            Queen_Use_Key(&reply_key);
+            // Фаза — якомога ближче до Radio.Send: шифрування займає мікросекунди
+            if (sync_did != 0 && direct) Sync_Fill_Beacon(beacon, sync_did, sync_slot, Queen_Now_Ms());
+            Route_Hdr_From_Body(beacon_block, beacon);
+            HAL_CRYP_Encrypt(&hcryp, (uint32_t*)beacon, 4, (uint32_t*)&beacon_block[ROUTE_HDR_SIZE], 1000);
+            Radio.Send(beacon_block, ROUTE_BLOCK_SIZE);
+            Queen_Pause_Ms(60);
+            reflex_sent = 1;
+        }
     }
+    // [ОПТИМІЗАЦІЯ RX Ring] Вуха — одразу після пострілу, до розшифровки:
+    // кадри, що прийдуть, поки ми розбираємо цей, ляжуть у кільце. Без
+    // пострілу радіо й не виходило з безперервного RX — не чіпаємо, щоб не
+    // обірвати кадр, що саме летить.
+    if (reflex_sent) Radio.Rx(LORA_RX_INFINITE);
 
     // =========================================================================
-    // СКИДАННЯ КЕШУ НА СЕРВЕР (GCCS Batching -> UDP/CoAP)
+    // ОБРОБКА ДАНИХ (КЕШУВАННЯ)
     // =========================================================================
-    // Відправляємо пакет даних, якщо кеш заповнений майже повністю (залишилось 5 вільних слотів)
-    // АБО пройшло достатньо часу (наприклад, 1 година = 3 600 000 мс)
-    if (cache_count >= (CACHE_MAX_ENTRIES - FLUSH_HEADROOM) || (HAL_GetTick() - last_flush_time > FLUSH_INTERVAL_MS)) {
-        if (cache_count > 0) {
-            // [FIX: Queen Health Blind Spot]
-            // Перед скиданням кешу додаємо власний пакет здоров'я Королеви.
-            // DID=0 — зарезервований sentinel, backend розпізнає як gateway health.
-            // Це дозволяє серверу бачити стан шлюзу (температура, рівень сигналу CSQ)
-            // без окремого протоколу.
-            {
-                uint8_t queen_health[16] = {0};
-                // DID = 0x00000000 (sentinel — "це Королева, не дерево")
-                // Bytes 4-5: Тік як proxy для uptime (wraps кожні ~65 секунд при /1000)
-                uint16_t uptime_sec = (uint16_t)(HAL_GetTick() / 1000);
-                queen_health[4] = (uint8_t)(uptime_sec >> 8);
-                queen_health[5] = (uint8_t)(uptime_sec & 0xFF);
-                // Byte 7: Кількість дерев у кеші (навантаження на шлюз)
-                queen_health[7] = cache_count;
-                // Byte 10: Status = homeostasis (0), growth_points = cache_count (proxy for health)
-                queen_health[10] = (cache_count < QUEEN_HEALTH_GP_MAX) ? cache_count : QUEEN_HEALTH_GP_MAX;
-                Process_And_Cache_Data(0, queen_health, 0); // RSSI=0 (локальний пакет)
-            }
-            Flush_Cache_To_Rails();
-            last_flush_time = HAL_GetTick(); // Оновлюємо таймер
+    // Кожен блок — окремий кадр: пачка власних показань відправника, далі його естафета.
+    // RSSI один на весь пакет — це сигнал останнього хопа.
+    // [ОПТИМІЗАЦІЯ RX Ring] Тіла розшифровуються на місці, у слоті кільця.
+    uint32_t prev_sender = 0;
+    for (uint8_t b = 0; b < rx_blocks; b++) {
+        uint8_t* hdr = &rx[b * RELAYQ_FRAME_SIZE];
+
+        // Маяк сусідньої Королеви — не телеметрія, на сервер не йде.
+        // Відкидаємо за заголовком, не витрачаючи AES.
+        if (hdr[ROUTE_HDR_TYPE] == FRAME_TYPE_BEACON) continue;
+
+        // 2. РОЗШИФРОВУЄМО ТІЛО: 4 слова (16 байт) апаратним модулем.
+        // Ключ — за Src. Заголовок не автентифікований сам по собі: Src і
+        // Type мусять збігтися з тілом, DID — з власником ключа. Ні — пробуємо
+        // наступного кандидата з тим самим Src (збіг 16 біт, ротація ключа).
+        // Невдала спроба повертає шифротекст на місце: ECB, E(D(c)) = c.
+        uint8_t* block = &hdr[ROUTE_HDR_SIZE];
+        uint16_t src = (uint16_t)((hdr[ROUTE_HDR_SRC] << 8) | hdr[ROUTE_HDR_SRC + 1]);
+        uint8_t authentic = 0;
+        for (uint8_t attempt = 0; !authentic; attempt++) {
+            KeyRef key = Keys_Lookup(&key_cache, src, attempt);
+            if (key.key == NULL) break; // Жоден ключ не підійшов — підроблений або побитий
+            Queen_Use_Key(&key);
+            HAL_CRYP_Decrypt(&hcryp, (uint32_t*)block, 4, (uint32_t*)block, 1000);
+            authentic = Route_Hdr_Binds_Body(hdr, block) && Keys_Ref_Owns(&key, block);
+            if (!authentic) HAL_CRYP_Encrypt(&hcryp, (uint32_t*)block, 4, (uint32_t*)block, 1000);
+        }
+        if (!authentic) continue;
+
+        // Витягуємо унікальний ID Солдата (перші 4 байти - DID)
+        uint32_t sender_id = ((uint32_t)block[0] << 24) |
+                             ((uint32_t)block[1] << 16) |
+                             ((uint32_t)block[2] << 8)  |
+                             (uint32_t)block[3];
+
+        // [ОПТИМІЗАЦІЯ ADR] Hop|TTL заголовка такий, як запечатало джерело, —
+        // естафети не було: RSSI і SNR пакета належать саме цьому дереву.
+        if (block[11] == hdr[ROUTE_HDR_HOP_TTL]) {
+            Adr_Observe(&adr_table, sender_id, rx_slot->rssi_dbm, rx_slot->snr_db);
+        }
+
+        // Серверу — Hop|TTL на момент прийому (у тілі лежить початковий)
+        block[11] = hdr[ROUTE_HDR_HOP_TTL];
+
+        // Замість миттєвої відправки, складаємо в CIFO-кеш.
+        // [ОПТИМІЗАЦІЯ Batched Uplink] Кожне показання пачки (і перше теж) —
+        // окремий запис (байти 8-9: секунди від попереднього). Інакше — дедуплікація як завжди.
+        if (Rx_Block_In_Batch(rx, rx_blocks, b, sender_id, prev_sender)) {
+            Cache_Store_Reading(sender_id, block, rx_slot->rssi_dbm);
+        } else {
+            Process_And_Cache_Data(sender_id, block, rx_slot->rssi_dbm);
         }
+        prev_sender = sender_id;
     }
 
-    /* USER CODE END WHILE */
+    // Слот — назад виробнику
+    RxRing_Release(&rx_ring);
+    Prof_End(&phase_prof, PROF_PHASE_RX);
 
-    /* USER CODE BEGIN 3 */
-  }
-  /* USER CODE END 3 */
+    if (cache_count >= (CACHE_MAX_ENTRIES - FLUSH_HEADROOM)) {
+        Sched_Post(&queen_sched, task_health, EV_HEALTH_FLUSH_DUE);
+    }
+    if (RxRing_Count(&rx_ring) > 0) Sched_Post(&queen_sched, task_radio, EV_RADIO_RX);
 }
 
-/* USER CODE BEGIN 4 */
+// =========================================================================
+// [ОПТИМІЗАЦІЯ Scheduler] ЗАДАЧА MODEM: байти UART → рядки → downlink
+// =========================================================================
+static void Task_Modem(uint32_t events, uint32_t now_ms)
+{
+    (void)events;
+    (void)now_ms;
+    while (modem_rx_tail != modem_rx_head) {
+        uint8_t c = modem_rx_ring[modem_rx_tail];
+        modem_rx_tail = (uint8_t)(modem_rx_tail + 1U);
+        Modem_Parse_Byte(c);
+    }
+}
+
+static int8_t hex_nibble(uint8_t c)
+{
+    if (c >= '0' && c <= '9') return (int8_t)(c - '0');
+    if (c >= 'a' && c <= 'f') return (int8_t)(c - 'a' + 10);
+    if (c >= 'A' && c <= 'F') return (int8_t)(c - 'A' + 10);
+    return -1;
+}
+
+// "OK" / "ERROR" та інші відповіді не потрібні: кроки FLUSH ідуть за таймерами,
+// як ішли за HAL_Delay. Розбираємо лише downlink сервера — одразу в байти,
+// без буфера на весь hex-рядок (≈ 1.1 КБ для OTA-чанка).
+static void Modem_Parse_Byte(uint8_t c)
+{
+    uint8_t* downlink = (uint8_t*)modem_downlink;
+
+    if (c == '\n') {
+        if (modem_parse == MODEM_HEX_DONE && modem_downlink_len > 0) {
+            Handle_CoAP_Command(downlink, modem_downlink_len);
+        }
+        modem_parse = MODEM_LINE;
+        modem_line_len = 0;
+        return;
+    }
+    if (c == '\r') return;
+
+    switch (modem_parse) {
+    case MODEM_LINE:
+        if (c == '"') {
+            size_t urc_len = sizeof(MODEM_URC_COAP) - 1;
+            if (modem_line_len >= urc_len && memcmp(modem_line, MODEM_URC_COAP, urc_len) == 0) {
+                modem_parse = MODEM_HEX;
+                modem_downlink_len = 0;
+                modem_hex_high = 0;
+            } else {
+                modem_parse = MODEM_SKIP;
+            }
+        } else if (modem_line_len < sizeof(modem_line)) {
+            modem_line[modem_line_len++] = (char)c;
+        } else {
+            modem_parse = MODEM_SKIP;
+        }
+        break;
+
+    case MODEM_HEX: {
+        if (c == '"') {
+            modem_parse = modem_hex_high ? MODEM_SKIP : MODEM_HEX_DONE;
+            break;
+        }
+        int8_t nibble = hex_nibble(c);
+        if (nibble < 0 || modem_downlink_len >= sizeof(modem_downlink)) {
+            modem_parse = MODEM_SKIP; // Битий або завеликий — Handle_CoAP_Command не побачить
+            break;
+        }
+        if (!modem_hex_high) {
+            downlink[modem_downlink_len] = (uint8_t)(nibble << 4);
+            modem_hex_high = 1;
+        } else {
+            downlink[modem_downlink_len++] |= (uint8_t)nibble;
+            modem_hex_high = 0;
+        }
+        break;
+    }
+
+    case MODEM_HEX_DONE:
+    case MODEM_SKIP:
+        break;
+    }
+}
 
 // =========================================================================
-// АПАРАТНИЙ РЕФЛЕКС РАДІО (Вуха Королеви)
+// [ОПТИМІЗАЦІЯ Scheduler] ЗАДАЧА HEALTH: кадри здоров'я перед скиданням
 // =========================================================================
-void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
+// Раз на FLUSH_INTERVAL_MS (таймер) або коли кеш майже повний (RADIO).
+static void Task_Health(uint32_t events, uint32_t now_ms)
 {
-    // Очікуємо рівно 16 байт (повний зашифрований блок AES-256)
-    if (size == 16)
+    (void)events;
+    // Скидання ще триває — FLUSH сам нагадає, коли звільниться
+    if (flush_step != FLUSH_IDLE) return;
+    Sched_Timer(&queen_sched, task_health, now_ms, FLUSH_INTERVAL_MS, 0);
+    if (cache_count == 0) return;
+
+    // [FIX: Queen Health Blind Spot]
+    // Перед скиданням кешу додаємо власний пакет здоров'я Королеви.
+    // DID=0 — зарезервований sentinel, backend розпізнає як gateway health.
+    // Це дозволяє серверу бачити стан шлюзу (температура, рівень сигналу CSQ)
+    // без окремого протоколу.
     {
-        // (void*) cast removes volatile qualifier for HAL function — safe because
-        // ISR is sole writer and main loop does not read until lora_rx_flag is set.
-        memcpy((void*)incoming_lora_payload, payload, 16);
-        // [FIX: RSSI Truncation] SX1262 може повернути RSSI < -128.
-        // Clamp до int8_t діапазону перед приведенням, щоб запобігти
-        // overflow (наприклад, -130 → 126, що б отруїло CIFO eviction).
-        if (rssi < -128) rssi = -128;
-        if (rssi > 127) rssi = 127;
-        current_rssi = (int8_t)rssi;
-        lora_rx_flag = 1; // Сигналізуємо головному циклу
+        uint8_t queen_health[16] = {0};
+        // DID = 0x00000000 (sentinel — "це Королева, не дерево")
+        // Bytes 4-5: Тік як proxy для uptime (wraps кожні ~65 секунд при /1000)
+        uint16_t uptime_sec = (uint16_t)(HAL_GetTick() / 1000);
+        queen_health[4] = (uint8_t)(uptime_sec >> 8);
+        queen_health[5] = (uint8_t)(uptime_sec & 0xFF);
+        // Byte 7: Кількість дерев у кеші (навантаження на шлюз)
+        queen_health[7] = cache_count;
+        // Byte 10: Status = homeostasis (0), growth_points = cache_count (proxy for health)
+        queen_health[10] = (cache_count < QUEEN_HEALTH_GP_MAX) ? cache_count : QUEEN_HEALTH_GP_MAX;
+        Process_And_Cache_Data(0, queen_health, 0); // RSSI=0 (локальний пакет)
+    }
+    // Профіль фаз Королеви: той самий sentinel DID=0, тип кадру 0xD2.
+    // FLUSH відображає попереднє скидання (поточне ще не заміряне).
+    if (phase_prof.stat[prof_next_phase].count > 0) {
+        uint8_t queen_prof[16];
+        Diag_Pack_Profile_Frame(queen_prof, 0, 0, QUEEN_FIRMWARE_ID,
+                                (ProfPhase)prof_next_phase, &phase_prof.stat[prof_next_phase]);
+        Process_And_Cache_Data(0, queen_prof, 0);
     }
+    prof_next_phase = (prof_next_phase == PROF_PHASE_RX) ? PROF_PHASE_FLUSH : PROF_PHASE_RX;
+
+    Sched_Post(&queen_sched, task_flush, EV_FLUSH_START);
+}
+
+// =========================================================================
+// [ОПТИМІЗАЦІЯ Scheduler] ЗАДАЧА FLUSH: батч → CoAP через SIM7070G
+// =========================================================================
+// Кожен крок повертається одразу; очікування модема — таймери задачі.
+// Кеш спорожнів ще на пакуванні: кадри, що приходять під час сесії, лягають
+// у нього як завжди.
+static void Task_Flush(uint32_t events, uint32_t now_ms)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+
+    switch (flush_step) {
+    case FLUSH_IDLE:
+        if (!(events & EV_FLUSH_START)) return;
+        Prof_Begin(&phase_prof, PROF_PHASE_FLUSH);
+        flush_total = Flush_Cache_To_Rails();
+        Prof_End(&phase_prof, PROF_PHASE_FLUSH);
+        if (flush_total == 0) return;
+        // Ініціалізація CoAP сесії (UDP)
+        SIM7070_Send("AT+CCOAPNEW=\"coap://api.silkennet.com:5683\"\r\n");
+        flush_step = FLUSH_OPEN;
+        Sched_Timer(&queen_sched, task_flush, now_ms, FLUSH_OPEN_MS, 0);
+        return;
+
+    case FLUSH_OPEN:
+        if (!(events & SCHED_EV_TIMER)) return;
+        // 1. Початок команди.
+        // URI-Path: /telemetry/batch/<queen_uid> — сервер ідентифікує шлюз за UID,
+        // а не за IP, що вирішує проблему Starlink NAT та динамічних адрес.
+        snprintf(at_tx_buffer, sizeof(at_tx_buffer),
+                 "AT+CCOAPSEND=0,2,\"telemetry/batch/%s\",%d,\"",
+                 queen_uid, flush_total * 2);
+        HAL_UART_Transmit(&huart1, (uint8_t*)at_tx_buffer, strlen(at_tx_buffer), 100);
+        flush_sent = 0;
+        flush_step = FLUSH_SEND;
+        Sched_Post(&queen_sched, task_flush, EV_FLUSH_STEP);
+        return;
+
+    case FLUSH_SEND: {
+        if (!(events & EV_FLUSH_STEP)) return;
+        // 2. Порція зашифрованого буфера як hex-рядок; між порціями — RX і модем
+        char hex[2 * FLUSH_HEX_CHUNK];
+        uint16_t n = flush_total - flush_sent;
+        if (n > FLUSH_HEX_CHUNK) n = FLUSH_HEX_CHUNK;
+        for (uint16_t i = 0; i < n; i++) {
+            uint8_t b = encrypted_batch_buffer[flush_sent + i];
+            hex[2 * i] = hex_digits[b >> 4];
+            hex[2 * i + 1] = hex_digits[b & 0x0F];
+        }
+        HAL_UART_Transmit(&huart1, (uint8_t*)hex, (uint16_t)(2 * n), 100);
+        flush_sent += n;
+        if (flush_sent < flush_total) {
+            Sched_Post(&queen_sched, task_flush, EV_FLUSH_STEP);
+            return;
+        }
+        // 3. Завершуємо команду (Закриваємо лапки і імітуємо натискання Enter)
+        HAL_UART_Transmit(&huart1, (uint8_t*)"\"\r\n", 3, 100);
+        // Модем надсилає дані через ефір та чекає UDP ACK від сервера
+        flush_step = FLUSH_ACK;
+        Sched_Timer(&queen_sched, task_flush, now_ms, FLUSH_ACK_MS, 0);
+        return;
+    }
+
+    case FLUSH_ACK:
+        if (!(events & SCHED_EV_TIMER)) return;
+        // Закриваємо CoAP сесію, звільняючи ресурси модему
+        SIM7070_Send("AT+CCOAPDEL=0\r\n");
+        flush_step = FLUSH_CLOSE;
+        Sched_Timer(&queen_sched, task_flush, now_ms, FLUSH_CLOSE_MS, 0);
+        return;
+
+    case FLUSH_CLOSE:
+        if (!(events & SCHED_EV_TIMER)) return;
+        flush_step = FLUSH_IDLE;
+        // Кеш наповнився, поки сесія тривала, — одразу наступне скидання
+        if (cache_count >= (CACHE_MAX_ENTRIES - FLUSH_HEADROOM)) {
+            Sched_Post(&queen_sched, task_health, EV_HEALTH_FLUSH_DUE);
+        }
+        return;
+    }
+}
+
+// Подій немає — ядро в SLEEP до будь-якого переривання (RxDone, байт UART,
+// SysTick). SysTick лишається: він веде Queen_Now_Ms і таймери задач.
+// Перевірка під вимкненими перериваннями: Post з ISR між перевіркою та WFI
+// лишає переривання pending, і WFI не засне.
+static void Queen_Idle(void)
+{
+    __disable_irq();
+    if (Sched_Idle_Ms(&queen_sched, Queen_Now_Ms()) > 0) {
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+    __enable_irq();
 }
 
 // =========================================================================
@@ -357,15 +840,58 @@ void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
 void Process_And_Cache_Data(uint32_t uid, uint8_t* payload, int8_t rssi)
 {
     // 1. ДЕДУПЛІКАЦІЯ: Шукаємо, чи є вже це дерево в кеші
+    // Ключ — (DID, тип кадру з байта 15): діагностика Солдата не повинна
+    // затирати його телеметрію, і навпаки.
+    uint8_t frame_type = payload[15];
     for(int i = 0; i < CACHE_MAX_ENTRIES; i++) {
-        if(forest_cache[i].is_active && forest_cache[i].uid == uid) {
+        if(forest_cache[i].is_active && forest_cache[i].uid == uid &&
+           forest_cache[i].payload[15] == frame_type) {
             // Оновлюємо дані на найсвіжіші (бо дерево могло надіслати новий статус)
             memcpy(forest_cache[i].payload, payload, 16);
             forest_cache[i].rssi = rssi;
             return;
         }
     }
+    Cache_Append_Data(uid, payload, rssi);
+}
+
+// Показання пачки: той самий кадр (DID, тип, seq з байта 14), почутий вдруге
+// через естафету, лише оновлює запис; інше показання — новий запис.
+// Дві пачки дерева до скидання не затирають одна одну.
+void Cache_Store_Reading(uint32_t uid, uint8_t* payload, int8_t rssi)
+{
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        if (forest_cache[i].is_active && forest_cache[i].uid == uid &&
+            forest_cache[i].payload[15] == payload[15] &&
+            forest_cache[i].payload[14] == payload[14]) {
+            memcpy(forest_cache[i].payload, payload, 16);
+            forest_cache[i].rssi = rssi;
+            return;
+        }
+    }
+    Cache_Append_Data(uid, payload, rssi);
+}
+
+// Блок b — показання пачки, якщо поруч у кадрі телеметрія того ж дерева:
+// попередній блок (DID уже розшифрований) або наступний (ще шифротекст,
+// тож дивимось його відкритий заголовок: Src = молодші 16 біт DID).
+static uint8_t Rx_Block_In_Batch(const uint8_t* rx, uint8_t rx_blocks, uint8_t b,
+                                 uint32_t sender_id, uint32_t prev_sender)
+{
+    const uint8_t* hdr = &rx[b * RELAYQ_FRAME_SIZE];
+    if (hdr[ROUTE_HDR_SIZE + 15] != FRAME_TYPE_TELEMETRY) return 0;
+    if (b > 0 && sender_id == prev_sender) return 1;
+    if (b + 1 >= rx_blocks) return 0;
+    const uint8_t* next = &rx[(b + 1) * RELAYQ_FRAME_SIZE];
+    uint16_t next_src = (uint16_t)((next[ROUTE_HDR_SRC] << 8) | next[ROUTE_HDR_SRC + 1]);
+    return next[ROUTE_HDR_TYPE] == FRAME_TYPE_TELEMETRY && next_src == (uint16_t)sender_id;
+}
 
+// Новий запис без дедуплікації: вільний слот або CIFO-витіснення.
+// [ОПТИМІЗАЦІЯ Batched Uplink] Так лягають показання пачки Солдата (Cache_Store_Reading):
+// кожне — окремий запис, а не "новіше затирає старіше".
+void Cache_Append_Data(uint32_t uid, uint8_t* payload, int8_t rssi)
+{
     // 2. ВСТАВКА: Якщо є вільне місце в кеші
     if(cache_count < CACHE_MAX_ENTRIES) {
         for(int i = 0; i < CACHE_MAX_ENTRIES; i++) {
@@ -396,7 +922,9 @@ void Process_And_Cache_Data(uint32_t uid, uint8_t* payload, int8_t rssi)
             if (!forest_cache[i].is_active) continue;
 
             // bio_status з байта 10 пейлоада: біти [7:6]
-            uint8_t bio_status = (forest_cache[i].payload[10] >> 6) & 0x03;
+            // Діагностичні кадри (байт 15 != 0) не несуть статусу — завжди некритичні
+            uint8_t bio_status = forest_cache[i].payload[15] ? 0 :
+                                 ((forest_cache[i].payload[10] >> 6) & 0x03);
 
             // Абсолютний fallback — найгірший RSSI серед усіх
             if (forest_cache[i].rssi < fallback_rssi) {
@@ -422,14 +950,16 @@ void Process_And_Cache_Data(uint32_t uid, uint8_t* payload, int8_t rssi)
 // =========================================================================
 // ПАКЕТНЕ ВІДПРАВЛЕННЯ ЧЕРЕЗ CoAP (Бінарний масив поверх UDP)
 // =========================================================================
-void Flush_Cache_To_Rails(void)
+// Пакує і шифрує кеш у encrypted_batch_buffer; повертає його довжину (0 — кеш
+// порожній). Відправку веде задача FLUSH.
+uint16_t Flush_Cache_To_Rails(void)
 {
     uint16_t offset = 0;
 
     // Пакуємо весь кеш у щільний бінарний масив (21 байт на запис)
     for(int i = 0; i < CACHE_MAX_ENTRIES; i++) {
         if(forest_cache[i].is_active) {
-            if ((offset + 21) > sizeof(binary_batch_buffer)) break;
+            if ((offset + 21U) > sizeof(binary_batch_buffer)) break;
             // Копіюємо 4 байти DID (великоендіанний формат мережі)
             binary_batch_buffer[offset++] = (uint8_t)(forest_cache[i].uid >> 24);
             binary_batch_buffer[offset++] = (uint8_t)(forest_cache[i].uid >> 16);
@@ -451,7 +981,7 @@ void Flush_Cache_To_Rails(void)
     }
     cache_count = 0;
 
-    if (offset == 0) return;
+    if (offset == 0) return 0;
 
     // =========================================================================
     // ШИФРУВАННЯ БАТЧА AES-256-CBC
@@ -485,49 +1015,18 @@ void Flush_Cache_To_Rails(void)
 
     HAL_RNG_DeInit(&hrng);
 
-    // 3. Оновлюємо IV у конфігурації крипто-модуля та переініціалізуємо
+    // 3. Оновлюємо IV у конфігурації крипто-модуля та переініціалізуємо.
+    //    Батч для Rails — завжди на ключі Королеви, не на ключі останнього Солдата.
     hcryp.Init.pInitVect = batch_iv;
+    hcryp.Init.pKey = aes_key;
     HAL_CRYP_Init(&hcryp);
+    Keys_Forget_Loaded(&key_cache);
 
     // 4. Шифруємо батч. Довжина в 32-бітних словах = padded_size / 4.
-    //    Буфер: IV (16 байт) + зашифровані дані
-    // [FIX: AUDIT CRITICAL] Переміщено з стеку в static.
-    // 2064 байти на стеку при 64KB RAM — ризик переповнення стеку.
-    // STM32 default stack = 1-4KB, а ця функція може бути викликана з глибокого call chain.
-    static uint8_t encrypted_batch_buffer[2048 + 16];
     memcpy(encrypted_batch_buffer, batch_iv, 16); // Prepend IV як заголовок пакета
     HAL_CRYP_Encrypt(&hcryp, (uint32_t*)binary_batch_buffer, padded_size / 4,
                      (uint32_t*)(encrypted_batch_buffer + 16), 2000);
 
-    uint16_t total_size = 16 + padded_size; // IV (16) + зашифровані дані
-
-    // Ініціалізація CoAP сесії (UDP)
-    SIM7070_SendATCommand("AT+CCOAPNEW=\"coap://api.silkennet.com:5683\"\r\n", 1000);
-
-    // 1. Початок команди.
-    // URI-Path: /telemetry/batch/<queen_uid> — сервер ідентифікує шлюз за UID,
-    // а не за IP, що вирішує проблему Starlink NAT та динамічних адрес.
-    snprintf(at_tx_buffer, sizeof(at_tx_buffer),
-             "AT+CCOAPSEND=0,2,\"telemetry/batch/%s\",%d,\"",
-             queen_uid, total_size * 2);
-    HAL_UART_Transmit(&huart1, (uint8_t*)at_tx_buffer, strlen(at_tx_buffer), 100);
-
-    // 2. Перетворюємо зашифрований буфер у Hex-рядок на льоту і відправляємо в модем
-    char hex_byte[3];
-    for (int i = 0; i < total_size; i++) {
-        snprintf(hex_byte, sizeof(hex_byte), "%02x", encrypted_batch_buffer[i]);
-        HAL_UART_Transmit(&huart1, (uint8_t*)hex_byte, 2, 10);
-    }
-
-    // 3. Завершуємо команду (Закриваємо лапки і імітуємо натискання Enter)
-    HAL_UART_Transmit(&huart1, (uint8_t*)"\"\r\n", 3, 100);
-
-    // Чекаємо, поки модем надішле дані через ефір та отримає UDP ACK від сервера
-    HAL_Delay(2000);
-
-    // Закриваємо CoAP сесію, звільняючи ресурси модему
-    SIM7070_SendATCommand("AT+CCOAPDEL=0\r\n", 500);
-
     // [FIX: CRITICAL — ECB Restoration]
     // Flush_Cache_To_Rails() переключає CRYP на CBC для шифрування батча.
     // Якщо не повернути ECB, всі наступні HAL_CRYP_Decrypt() для LoRa-пакетів
@@ -536,15 +1035,54 @@ void Flush_Cache_To_Rails(void)
     hcryp.Init.Algorithm = CRYP_AES_ECB;
     hcryp.Init.pInitVect = NULL;
     HAL_CRYP_Init(&hcryp);
+
+    return (uint16_t)(16 + padded_size); // IV (16) + зашифровані дані
+}
+
+// =========================================================================
+// [ОПТИМІЗАЦІЯ Per-Device Keys] Перемикання ключа в периферії AES
+// =========================================================================
+// HAL_CRYP_Init з новим pKey — лише коли потрібен інший ключ, ніж завантажений.
+// Блоки одного Солдата підряд (рефлекс + блок 0, телеметрія + діагностика)
+// йдуть без перезавантаження.
+static void Queen_Use_Key(const KeyRef* ref)
+{
+    if (Keys_Mark_Loaded(&key_cache, ref)) {
+        hcryp.Init.pKey = (uint32_t*)ref->key;
+        HAL_CRYP_Init(&hcryp);
+    }
+}
+
+// Годинник кадрів TDMA: HAL_GetTick + час, проспаний у паузах (SysTick стоїть).
+// Перехід через 2^32 мс (~49 діб) зсуває фазу — Солдати синхронізуються наново.
+static uint32_t Queen_Now_Ms(void)
+{
+    return HAL_GetTick() + queen_paused_ms;
+}
+
+// [FIX: UART у STOP2] USART1 у STOP2 не приймає: байт модема посеред паузи
+// пропав би. Огляд каналів (до HAL_UART_Receive_IT) ще спить у STOP2, далі —
+// лише SLEEP: RXNE будить ядро, ISR кладе байт у modem_rx_ring.
+static void Queen_Pause_Ms(uint32_t ms)
+{
+    if (modem_rx_armed) LP_Delay_Sleep_Ms(ms);
+    else LP_Delay_Ms(ms);
+    queen_paused_ms += ms;
 }
 
 // =========================================================================
 // ДРАЙВЕР СТІЛЬНИКОВОГО МОДЕМУ (SIM7070G)
 // =========================================================================
 // Проста обгортка для відправки AT-команд через UART
-void SIM7070_SendATCommand(char* command, uint32_t delay_ms)
+void SIM7070_Send(const char* command)
 {
     HAL_UART_Transmit(&huart1, (uint8_t*)command, strlen(command), 1000);
+}
+
+// Лише при старті, до планувальника: після нього очікування модема — таймери задачі FLUSH
+void SIM7070_SendATCommand(char* command, uint32_t delay_ms)
+{
+    SIM7070_Send(command);
     HAL_Delay(delay_ms); // Чекаємо на відповідь (OK)
 }
 
@@ -601,10 +1139,12 @@ void Handle_CoAP_Command(uint8_t* payload, uint16_t len)
     uint32_t cmd_iv[4];
     memcpy(cmd_iv, payload, 16);
 
-    // 2. Перемикаємо CRYP на CBC для дешифрування команди
+    // 2. Перемикаємо CRYP на CBC для дешифрування команди (ключ Королеви)
     hcryp.Init.Algorithm = CRYP_AES_CBC;
     hcryp.Init.pInitVect = cmd_iv;
+    hcryp.Init.pKey = aes_key;
     HAL_CRYP_Init(&hcryp);
+    Keys_Forget_Loaded(&key_cache);
 
     // 3. Дешифруємо шифротекст (після IV)
     uint16_t ciphertext_len = len - 16;
@@ -673,6 +1213,12 @@ void Handle_CoAP_Command(uint8_t* payload, uint16_t len)
         // MIN_OTA_ALIGNED = AES_BLOCK_SIZE (16) + OTA_HEADER_SIZE (5) + OTA_CRC_SIZE (2) = 23
         if (aligned < MIN_OTA_ALIGNED) return;
 
+        // [ОПТИМІЗАЦІЯ OTA CRC] OtaPackagerService дописує CRC16-CCITT заголовка й коду.
+        // Повідомлення разом із власним CRC дає 0, нульове AES-доповнення його не
+        // змінює — тож перевіряємо весь розшифрований буфер без точної довжини.
+        // Битий чанк не потрапляє в ліс; Rails повторить його за таймаутом.
+        if (Crc16_Ccitt(cmd_decrypt_buf, aligned) != 0) return;
+
         // Розрахунок довжини чистого байткоду (без заголовка, CRC, AES-padding):
         // aligned — повна довжина розшифрованих даних (вирівняна по AES-блоку).
         // Останній AES-блок може бути padding → гарантована корисна довжина = aligned - AES_BLOCK_SIZE.
@@ -745,6 +1291,46 @@ static void MX_CRYP_Init(void)
   HAL_CRYP_Init(&hcryp);
 }
 
+// =========================================================================
+// LPTIM1 (LSE): одноразовий compare для LP_Delay_Ms
+// =========================================================================
+static void MX_LPTIM1_Init(void)
+{
+  hlptim1.Instance = LPTIM1;
+  hlptim1.Init.Clock.Source = LPTIM_CLOCKSOURCE_APBCLOCK_LPOSC;
+  hlptim1.Init.Clock.Prescaler = LPTIM_PRESCALER_DIV1;
+  hlptim1.Init.Trigger.Source = LPTIM_TRIGSOURCE_SOFTWARE;
+  hlptim1.Init.OutputPolarity = LPTIM_OUTPUTPOLARITY_HIGH;
+  hlptim1.Init.UpdateMode = LPTIM_UPDATE_IMMEDIATE;
+  hlptim1.Init.CounterSource = LPTIM_COUNTERSOURCE_INTERNAL;
+  hlptim1.Init.Input1Source = LPTIM_INPUT1SOURCE_GPIO;
+  hlptim1.Init.Input2Source = LPTIM_INPUT2SOURCE_GPIO;
+  HAL_LPTIM_Init(&hlptim1);
+}
+
+void HAL_LPTIM_CompareMatchCallback(LPTIM_HandleTypeDef *hlptim)
+{
+    if (hlptim->Instance == LPTIM1) {
+        LP_Delay_On_Compare();
+    }
+}
+
+// [ОПТИМІЗАЦІЯ Scheduler] Байт від SIM7070G → modem_rx_ring, задача MODEM розбере.
+// Кільце повне — байт втрачено (modem_rx_overruns): рядок не пройде розбір hex.
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART1) return;
+    uint8_t next = (uint8_t)(modem_rx_head + 1U);
+    if (next == modem_rx_tail) {
+        modem_rx_overruns++;
+    } else {
+        modem_rx_ring[modem_rx_head] = modem_rx_byte;
+        modem_rx_head = next;
+    }
+    HAL_UART_Receive_IT(&huart1, &modem_rx_byte, 1);
+    Sched_Post(&queen_sched, task_modem, EV_MODEM_RX);
+}
+
 /* USER CODE END 4 */
 
 /**
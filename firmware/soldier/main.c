@@ -20,6 +20,52 @@
 // Підключаємо скомпільовану нейромережу TinyML
 #include "silken_net_audio_model.h"
 
+// Біт-точний Атрактор Лоренца (спільний із сервером, firmware/common)
+#include "silken_attractor.h"
+
+// Статичний пул для купи mruby та діагностичні кадри (firmware/common)
+#include "silken_pool.h"
+#include "silken_diag.h"
+
+// Енергетичний планувальник пробуджень (firmware/common)
+#include "silken_energy.h"
+
+// Профайлер фаз циклу на DWT CYCCNT (firmware/common)
+#include "silken_prof.h"
+
+// Низькоенергетичні паузи на LPTIM1 замість HAL_Delay (firmware/common)
+#include "silken_lpdelay.h"
+
+// Listen-Before-Talk: CAD + експоненційний backoff перед кожним TX (firmware/common)
+#include "silken_lbt.h"
+
+// Черга mesh-естафети у SRAM2 + агреговані кадри (firmware/common)
+#include "silken_relayq.h"
+
+// Seen-set естафети: Bloom-фільтр у Backup-регістрах (firmware/common)
+#include "silken_seen.h"
+
+// Градієнтна маршрутизація: hop до Королеви у байті 11 (firmware/common)
+#include "silken_route.h"
+
+// Report-by-exception: власний кадр лише при зміні показань або пульсі (firmware/common)
+#include "silken_rbe.h"
+
+// Адаптивна потужність TX за командами Королеви (firmware/common)
+#include "silken_adr.h"
+
+// Слоти TDMA і синхронізація RTC з маяків Королеви (firmware/common)
+#include "silken_sync.h"
+
+// Частотний план EU868: канал кластера своєї Королеви (firmware/common)
+#include "silken_chan.h"
+
+// CRC32 OTA-образу на апаратному блоці CRC, по мірі надходження чанків (firmware/common)
+#include "silken_crc.h"
+
+// Збирання OTA-образу з чанків Королеви (firmware/common)
+#include "silken_ota.h"
+
 // Підключаємо низькорівневий драйвер радіо (Radio Middleware)
 #include "radio.h"
 /* USER CODE END Includes */
@@ -29,20 +75,49 @@
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
-#define MRUBY_CONTRACT_FLASH_ADDR 0x0803F000 // Адреса для OTA оновлень
+#define MRUBY_CONTRACT_FLASH_ADDR 0x0803F000 // Слот A для OTA оновлень (історична адреса)
+#define MRUBY_CONTRACT_FLASH_ADDR_B 0x0803E000 // Слот B: новий контракт пишеться у неактивний слот
+#define MRUBY_RITE_MAGIC          0x45544952 // "RITE" у little-endian (ознака mruby байткоду)
+#define SOLDIER_FLASH_BASE        0x08000000U // Початок Flash STM32WLE5JC
+#define SOLDIER_FLASH_SIZE        (256U * 1024U) // 256 КБ Flash (включно з OTA-слотом)
 #define FIRMWARE_VERSION_ID       0x0001     // Версія прошивки (інкрементується при OTA)
 
 // [FIX: AUDIT MISRA] Іменовані константи замість магічних чисел
-#define OTA_MARKER                0x99       // Маркер OTA-пакета (перший байт)
-#define OTA_HEADER_SIZE           5          // [0x99][index:2][total:2]
-#define MIN_OTA_PACKET_SIZE       6          // OTA_HEADER_SIZE + 1 байт даних мінімум
 #define BIO_STATUS_VM_ERROR       0xFF       // Мітка помилки mruby VM
-#define VCAP_LISTEN_THRESHOLD     2800       // Поріг напруги для прослуховування ефіру (мВ)
 #define LORA_RX_TIMEOUT_MS        500        // Таймаут прийому LoRa (мс)
 #define LORA_RX_LOOP_MS           600        // Максимальний час очікування пакета (мс)
+#define RX_DEADLINE_LPTIM_TICKS   ((LORA_RX_LOOP_MS * LPDELAY_LSE_HZ) / 1000U) // Страховка вікна RX
+#define TX_INTERFRAME_GAP_MS      100        // Пауза між кадрами: радіо встигає випромінити попередній
 #define TX_JITTER_MAX_MS          500        // Максимальна рандомізована затримка TX (мс)
 #define PANIC_TTL                 5          // TTL для екстрених пакетів
 #define DEFAULT_TTL               3          // Стандартний TTL для пакетів
+
+// Модуляція мережі — одна на всіх (Королева і сусіди чують лише її); ADR змінює потужність
+#define LORA_SPREADING_FACTOR     7          // SF7: найкоротший ефір EU868
+#define LORA_BANDWIDTH            0          // 125 кГц
+#define LORA_CODINGRATE           1          // 4/5
+#define LORA_PREAMBLE_LENGTH      8          // Символів
+#define LORA_TX_TIMEOUT_MS        3000
+
+#if RBE_BATCH_READINGS > RELAYQ_CAPACITY
+#error "Пачка власних показань мусить влазити в uplink_queue"
+#endif
+
+// [ОПТИМІЗАЦІЯ mruby Heap] Купа VM — статична арена замість libc malloc.
+// 32 КБ з 64 КБ SRAM; mruby збирається з MRB_HEAP_PAGE_SIZE=128, щоб сторінка
+// об'єктів влазила у клас 8192 пулу.
+#define MRB_ARENA_SIZE            (32 * 1024)
+#define MRB_GC_WATERMARK_PCT      75         // Поріг зайнятості пулу для примусового GC (%)
+#define DIAG_INTERVAL_CYCLES      96         // Діагностичний кадр кожні N пробуджень
+#define PROF_INTERVAL_CYCLES      16         // Кадр профілю (одна фаза) кожні N пробуджень
+#define PROF_SOLDIER_PHASES       (PROF_PHASE_RX + 1) // ACQUIRE..RX; FLUSH — лише Королева
+
+// [ОПТИМІЗАЦІЯ Hot Swap] Ідентифікатори слотів контракту (RTC_BKP_DR16)
+#define CONTRACT_SLOT_UNSET       0          // Backup Domain скинуто — вибір за наявністю
+#define CONTRACT_SLOT_A           1
+#define CONTRACT_SLOT_B           2
+#define CONTRACT_SLOT_BUILTIN     3          // lorenz_bytecode[] з прошивки
+#define CONTRACT_PROBATION_CYCLES 8          // Пробуджень без винятку до закриття старої VM
 /* USER CODE BEGIN PD */
 /* USER CODE END PD */
 
@@ -58,6 +133,7 @@ RNG_HandleTypeDef hrng;
 RTC_HandleTypeDef hrtc;
 SUBGHZ_HandleTypeDef hsubghz;
 CRYP_HandleTypeDef hcryp; // Апаратний криптопроцесор AES
+LPTIM_HandleTypeDef hlptim1; // Дедлайн вікна RX та низькоенергетичні паузи (LSE)
 
 /* USER CODE BEGIN PV */
 
@@ -68,15 +144,20 @@ uint32_t aes_key[8] = {0x2B7E1516, 0x28AED2A6, 0xABF71588, 0x09CF4F3C,
 
 // === 1. ОРГАНИ ЧУТТЯ ТА ПАМ'ЯТЬ ===
 volatile uint8_t vibration_detected = 0; // Прапорець переривання від п'єзодиска
-uint16_t acoustic_events = 0;          // Відфільтровані мікророзриви (Кавітація)
-uint32_t last_wakeup_timestamp = 0;    // Час попереднього пробудження
-uint32_t delta_t_seconds = 0;          // Швидкість заряду іоністора (Метаболізм)
+uint8_t acoustic_events = 0;           // Відфільтровані мікророзриви (Кавітація), з останнього кадру
+EnergyClock wake_clock;                // Час попереднього пробудження (календар RTC)
+uint32_t delta_t_seconds = 0;          // Секунд від попереднього пробудження, разом зі сном
 uint32_t tree_did = 0;                 // Decentralized Identity (Гаманець Дерева)
 
+// [ОПТИМІЗАЦІЯ Energy] Оцінка харвестера та план поточного пробудження.
+// Живе в SRAM (STOP2 її зберігає); після ребуту план стартує консервативно.
+EnergyState energy_state;
+EnergyPlan energy_plan;
+
 // Пейлоад залишається 16 байтів (бо розмір блоку AES завжди 128 біт)
-// [DID:4] [Vcap:2] [Temp:1] [Acoustic:1] [Time:2] [Chaos:1] [TTL:1] [Pad:4]
+// [DID:4] [Vcap:2] [Temp:1] [Acoustic:1] [Time:2] [Chaos:1] [Hop:4|TTL:4] [FW:2] [Seq:1] [Type:1]
 uint8_t lora_payload[16] = {0};
-uint8_t encrypted_payload[16] = {0}; // Буфер для зашифрованих даних перед відправкою
+uint8_t encrypted_payload[ROUTE_BLOCK_SIZE] = {0}; // Блок в ефір: відкритий заголовок + AES-тіло
 
 // === 1.5. ПАМ'ЯТЬ TINYML (Свідомість звуку + DMA) ===
 uint16_t raw_audio_buffer[512];   // Буфер для DMA (сирі 12-бітні дані від АЦП)
@@ -86,32 +167,99 @@ uint8_t ml_event_id = 0;          // Результат: 0-Тиша, 1-Віте
 float ml_confidence = 0.0;        // Рівень впевненості моделі (0.0 - 1.0)
 
 // === 1.8. ПАМ'ЯТЬ ЕСТАФЕТИ (Directed Mesh) ТА OTA ===
-uint8_t mesh_relay_payload[16] = {0}; // Буфер для чужого 16-байтного пакета
-uint8_t has_mesh_relay = 0;           // Прапорець: 1 - є пакет для ретрансляції
+// [ОПТИМІЗАЦІЯ Relay Queue] До 4 чужих кадрів замість одного в DR3–DR6.
+// SRAM2, .noinit (NOLOAD у лінкер-скрипті): стартап не обнуляє, тож черга
+// переживає скидання; холодний старт відсіює RelayQ_Restore.
+RelayQueue relay_queue __attribute__((section(".noinit")));
+uint8_t relay_frame[RELAYQ_AGG_MAX_SIZE]; // Агрегований кадр: власні блоки + естафета
+
+// [ОПТИМІЗАЦІЯ Batched Uplink] Власні запечатані показання, що чекають пачки
+// (до RBE_BATCH_READINGS на один TX). Теж SRAM2 .noinit — переживають скидання.
+RelayQueue uplink_queue __attribute__((section(".noinit")));
+// Обидва лічильники ростуть на delta_t_seconds — час RTC разом зі сном
+uint32_t uplink_held_s = 0;   // Скільки чекає найстаріше показання в пачці
+uint32_t reading_gap_s = 0;   // Секунд від попереднього показання (байти 8-9)
+
+// Кеш "пліток" (Wall to Wall Cobwebs): які кадри ми вже пересилали,
+// щоб не ганяти їх по колу (захист від пінг-понгу).
+// [ОПТИМІЗАЦІЯ Seen-Set] Bloom-фільтр по (DID, seq) замість 8 останніх DID:
+// сотні кадрів у 15 Backup-регістрах, свіже показання того ж дерева проходить.
+SeenSet mesh_seen;
+static const uint32_t mesh_seen_bkp_regs[SEEN_STATE_WORDS] = {
+    RTC_BKP_DR2,  RTC_BKP_DR3,  RTC_BKP_DR4,  RTC_BKP_DR5,  RTC_BKP_DR6,
+    RTC_BKP_DR8,  RTC_BKP_DR9,  RTC_BKP_DR10, RTC_BKP_DR11, RTC_BKP_DR12,
+    RTC_BKP_DR13, RTC_BKP_DR14, RTC_BKP_DR15, RTC_BKP_DR17, RTC_BKP_DR18
+};
+
+// Лічильник власних кадрів (байт 14): ключ seen-set у сусідів, DR19
+uint8_t tx_seq = 0;
+
+// [ОПТИМІЗАЦІЯ Report-by-Exception] Знімок останнього записаного показання (DR0):
+// поки показання в мертвих зонах, власний кадр не йде в ефір (крім пульсу).
+RbeState rbe_state;
+
+// [ОПТИМІЗАЦІЯ Gradient] Відстань до Королеви в хопах: естафету несуть лише
+// вузли ближчі за передавача, а не всі, хто почув. DR19 біти [23:8].
+RouteState route_state;
+
+// [ОПТИМІЗАЦІЯ ADR] Потужність TX за командами Королеви (SRAM; після скидання — максимум)
+AdrState adr_state;
 
-// Кеш "пліток" (Wall to Wall Cobwebs). Пам'ятаємо останні 8 чужих DID,
-// щоб не ганяти їхні дані по колу (захист від пінг-понгу).
-// [FIX: Mesh Ping-Pong] Збільшено з 3 до 8 слотів: при 100 деревах у кластері
-// 3 слоти швидко заповнюються і два дерева починають нескінченно перекидати пакет.
-#define MESH_DID_CACHE_SIZE 8
-uint32_t recent_mesh_dids[MESH_DID_CACHE_SIZE] = {0};
+// [ОПТИМІЗАЦІЯ TDMA] Фаза кадру Королеви, дрейф кварцу і власний слот (SRAM;
+// після скидання — jitter + LBT, доки Королева не відповість маяком)
+SyncState sync_state;
+
+// [ОПТИМІЗАЦІЯ Channel Plan] Канал кластера своєї Королеви: скан, доки не почули
+// свій кластер. DR19 біти [15:12].
+ChanState chan_state;
 
 volatile uint8_t lora_rx_flag = 0;
+// 1 — вікно RX закрите: RxTimeout / RxError радіо або дедлайн LPTIM1
+volatile uint8_t lora_rx_window_closed = 0;
+// Результат CAD (CadDone ISR): 1 — завершено; busy 1 — у каналі чужа передача
+volatile uint8_t lora_cad_done = 0;
+volatile uint8_t lora_cad_busy = 0;
 // [FIX: AUDIT] volatile — записуються в OnRxDone ISR, читаються в main loop
 volatile uint8_t incoming_lora_payload[256];
 uint8_t decrypted_rx_payload[256]; // Розшифрований вхідний потік
 volatile uint16_t incoming_lora_size = 0;
+volatile int16_t incoming_lora_rssi = 0;  // RSSI останнього хопа — градієнт вчиться лише з надійних лінків
+volatile uint32_t incoming_lora_rtc_ms = 0; // Rtc_Now_Ms() кінця пакета (синхронізація TDMA)
 
-// Буфер для збирання байт-коду по шматочках (OTA)
-uint8_t ota_buffer[1024];
-uint16_t ota_bytes_received = 0;
-uint16_t ota_total_chunks = 0;
-uint16_t ota_chunks_received = 0;
-// Масив прапорців для захисту від дублікатів OTA
-uint8_t ota_chunk_received[256] = {0};
+// Буфер для збирання байт-коду по шматочках (OTA), бітова карта дублікатів і CRC32
+OtaRx ota_rx;
 
 uint8_t* current_lorenz_bytecode;
 
+// [ОПТИМІЗАЦІЯ Hot Swap] Активна VM та попередня (fallback) після OTA без ребуту.
+// Обидві живуть у тому ж пулі mrb_pool; fallback закривається після випробування.
+static mrb_state *contract_vm = NULL;
+static mrb_state *fallback_vm = NULL;
+uint8_t contract_slot = CONTRACT_SLOT_UNSET;  // Слот, з якого виконується contract_vm (XIP)
+uint8_t fallback_slot = CONTRACT_SLOT_UNSET;  // Слот, з якого виконується fallback_vm
+uint8_t contract_probation = 0;               // Успішні пробудження нового контракту
+uint8_t contract_committed_slot = CONTRACT_SLOT_UNSET; // У RTC_BKP_DR16: з нього стартує ребут
+
+// === 1.9. КУПА mruby (Статична арена + діагностика) ===
+// uint64_t — гарантує 8-байтне вирівнювання блоків пулу
+static uint64_t mrb_arena[MRB_ARENA_SIZE / sizeof(uint64_t)];
+static SilkenPool mrb_pool;
+uint32_t mrb_gc_runs = 0;         // Примусові GC через поріг пулу
+// SRAM живе у STOP2, тому лічильник пробуджень не потребує Backup-регістра
+uint16_t diag_cycle_counter = 0;
+uint8_t diag_payload[16] = {0};
+
+// [ОПТИМІЗАЦІЯ Profiling] Тривалість фаз у тактах ядра (min/max/EWMA, 96 байт).
+// Теж у SRAM: переживає STOP2, обнуляється лише ребутом.
+ProfTable phase_prof;
+uint16_t prof_cycle_counter = 0;
+uint8_t prof_next_phase = PROF_PHASE_ACQUIRE; // Фаза наступного кадру профілю (по колу)
+
+// [ОПТИМІЗАЦІЯ LBT] Лічильники конкуренції за ефір (SRAM, переживають STOP2).
+// Діагностичний слот чергує кадр купи (0xD1) та кадр радіо (0xD3).
+LbtState lbt_state;
+uint8_t diag_next_radio = 0;
+
 // === 2. РУДА СВІДОМОСТІ (Байт-код mruby) ===
 // Скомпільований скрипт Атрактора Лоренца.
 // Цей масив генерується на Mac командою mrbc.
@@ -133,12 +281,34 @@ static void MX_RNG_Init(void);
 static void MX_RTC_Init(void);
 static void MX_SUBGHZ_Init(void);
 static void MX_CRYP_Init(void); // Ініціалізація шифрування
+static void MX_LPTIM1_Init(void); // Дедлайн вікна RX у STOP1
 
 /* USER CODE BEGIN PFP */
 // Псевдо-функції для роботи зі звуком та тривогами
 void Record_Audio_Wave(float* buffer, uint16_t length);
 void Trigger_Emergency_LoRa_TX(void);
-void Write_OTA_Contract_To_Flash(uint8_t* data, uint16_t size);
+void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr);
+void OnRxTimeout(void);
+void OnRxError(void);
+void OnCadDone(bool channel_activity_detected);
+static uint8_t Radio_Channel_Busy(void);
+static void Radio_Send_LBT(uint8_t* buffer, uint8_t size);
+static void Radio_Set_Tx_Power(int8_t power_dbm);
+static void Mesh_Seal_Block(uint8_t* plain, uint8_t* block);
+static void Rx_Sleep_Until_Event(void);
+static uint32_t Bkp_Counters_Word(void);
+static uint32_t Rtc_Now_Ms(void);
+static void Tx_Slot_Wait_Ms(uint32_t ms);
+void Write_OTA_Contract_To_Flash(uint32_t flash_addr, uint8_t* data, uint16_t size);
+uint8_t Contract_Select_Boot_Slot(uint8_t stored_slot, uint8_t slot_a_valid, uint8_t slot_b_valid);
+uint8_t Contract_Inactive_Slot(uint8_t active_slot);
+static const uint8_t* Contract_Slot_Bytecode(uint8_t slot);
+static mrb_state* Contract_Open_VM(const uint8_t* bytecode);
+static uint8_t Contract_Call(mrb_state *vm, mrb_value* args, uint8_t* result);
+static void Contract_Hot_Swap(uint8_t target_slot, uint16_t data_len);
+static mrb_value mrb_silken_attractor_z_q16(mrb_state *mrb, mrb_value self);
+static void* mrb_pool_allocf(mrb_state *mrb, void *p, size_t size, void *ud);
+mrb_bool mrb_ro_data_p(const char *p);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -167,6 +337,8 @@ int main(void)
   MX_RTC_Init();
   MX_SUBGHZ_Init();
   MX_CRYP_Init(); // Вмикаємо апаратний AES
+  MX_LPTIM1_Init();
+  LP_Delay_Init(&hlptim1);
 
   /* USER CODE BEGIN 2 */
 
@@ -182,33 +354,26 @@ int main(void)
   HAL_PWR_EnableBkUpAccess();
 
   // 2. Відновлюємо пам'ять з RTC (якщо було перезавантаження)
-  acoustic_events = (uint16_t)HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR0);
-  last_wakeup_timestamp = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR1);
-  has_mesh_relay = (uint8_t)HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR2); // Відновлюємо прапорець естафети
-
-  // Відновлюємо транзитний пакет з 4-х Backup-регістрів (16 байтів)
-  if (has_mesh_relay) {
-      uint32_t r3 = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR3);
-      uint32_t r4 = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR4);
-      uint32_t r5 = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR5);
-      uint32_t r6 = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR6);
-
-      mesh_relay_payload[0] = r3>>24; mesh_relay_payload[1] = r3>>16; mesh_relay_payload[2] = r3>>8; mesh_relay_payload[3] = r3;
-      mesh_relay_payload[4] = r4>>24; mesh_relay_payload[5] = r4>>16; mesh_relay_payload[6] = r4>>8; mesh_relay_payload[7] = r4;
-      mesh_relay_payload[8] = r5>>24; mesh_relay_payload[9] = r5>>16; mesh_relay_payload[10] = r5>>8; mesh_relay_payload[11] = r5;
-      mesh_relay_payload[12] = r6>>24; mesh_relay_payload[13] = r6>>16; mesh_relay_payload[14] = r6>>8; mesh_relay_payload[15] = r6;
+  Rbe_Restore(&rbe_state, HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR0));
+  Energy_Clock_Restore(&wake_clock, HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR1));
+
+  // Транзитні пакети: черга у SRAM2 (DR2–DR6 більше не використовуються)
+  RelayQ_Restore(&relay_queue);
+  // Вік показань у буфері після скидання невідомий — пачка піде першим же пробудженням
+  if (RelayQ_Restore(&uplink_queue) > 0) {
+      uplink_held_s = RBE_BATCH_MAX_HOLD_S;
   }
 
-  // Відновлюємо пам'ять останніх почутих DID з вічних регістрів
-  // [FIX: Mesh Ping-Pong] 8 слотів замість 3
-  recent_mesh_dids[0] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR8);
-  recent_mesh_dids[1] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR9);
-  recent_mesh_dids[2] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR10);
-  recent_mesh_dids[3] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR11);
-  recent_mesh_dids[4] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR12);
-  recent_mesh_dids[5] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR13);
-  recent_mesh_dids[6] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR14);
-  recent_mesh_dids[7] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR15);
+  // Відновлюємо seen-set естафети та лічильник кадрів з вічних регістрів.
+  // Після першого живлення регістри нульові — це дійсна порожня множина.
+  for (int i = 0; i < SEEN_STATE_WORDS; i++) {
+      mesh_seen.words[i] = HAL_RTCEx_BKUPRead(&hrtc, mesh_seen_bkp_regs[i]);
+  }
+  uint32_t seq_route_word = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR19);
+  tx_seq = (uint8_t)(seq_route_word & 0xFF);
+  Route_Restore(&route_state, (uint16_t)((seq_route_word >> 8) & 0xFF0F));
+  Chan_Restore(&chan_state, (uint8_t)((seq_route_word >> 12) & 0x0F));
+  acoustic_events = (uint8_t)(seq_route_word >> 24);
 
   // =========================================================================
   // ГЕНЕРАЦІЯ DECENTRALIZED IDENTITY (DID)
@@ -237,37 +402,55 @@ int main(void)
       HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR7, tree_did);
 
       // При народженні очищаємо кеш пліток від заводського "сміття"
-      memset(recent_mesh_dids, 0, sizeof(recent_mesh_dids));
-  }
-
-  // Якщо це найперший старт в житті анкера (пам'ять порожня)
-  if (last_wakeup_timestamp == 0) {
-      last_wakeup_timestamp = HAL_GetTick() / 1000;
+      Seen_Init(&mesh_seen);
   }
 
   // 3. Калібрування АЦП (Встановлюємо абсолютний фізичний нуль)
   HAL_ADCEx_Calibration_Start(&hadc);
+  Energy_Init(&energy_state);
+  Prof_Init(&phase_prof);
+  LBT_Init(&lbt_state);
+  Crc_Init();
+  Ota_Rx_Init(&ota_rx);
 
   // 4. Ініціалізація низькорівневого радіодрайвера
-  Radio.Init(NULL); // Передаємо NULL, бо ми не використовуємо складні колбеки
-  Radio.SetChannel(868000000); // Налаштовуємо на 868 МГц
-
-  // 5. Вибір контракту: Перевіряємо, чи є в Flash-пам'яті оновлений код
-  uint32_t* flash_check = (uint32_t*)MRUBY_CONTRACT_FLASH_ADDR;
-  if (*flash_check == 0x45544952) { // "RITE" у little-endian (ознака mruby байткоду)
-      current_lorenz_bytecode = (uint8_t*)MRUBY_CONTRACT_FLASH_ADDR;
-  } else {
-      current_lorenz_bytecode = (uint8_t*)lorenz_bytecode;
-  }
+  // Колбеки прийому: з ними ядро може спати, поки слухає радіо
+  static RadioEvents_t radio_events = {0};
+  radio_events.RxDone = OnRxDone;
+  radio_events.RxTimeout = OnRxTimeout;
+  radio_events.RxError = OnRxError;
+  radio_events.CadDone = OnCadDone;
+  Radio.Init(&radio_events);
+  Radio.SetChannel(Chan_Freq_Hz(chan_state.ch)); // Канал кластера (після холодного старту — перший у плані)
+  Adr_Init(&adr_state);
+  Radio_Set_Tx_Power(adr_state.power_dbm);
+  Sync_Init(&sync_state);
+
+  // 5. Вибір контракту: активний слот з RTC_BKP_DR16, якщо в ньому є байткод.
+  // Після скидання Backup Domain — як раніше: слот A, потім B, потім вбудований.
+  contract_slot = Contract_Select_Boot_Slot(
+      (uint8_t)HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR16),
+      *(const uint32_t*)MRUBY_CONTRACT_FLASH_ADDR == MRUBY_RITE_MAGIC,
+      *(const uint32_t*)MRUBY_CONTRACT_FLASH_ADDR_B == MRUBY_RITE_MAGIC);
+  current_lorenz_bytecode = (uint8_t*)Contract_Slot_Bytecode(contract_slot);
 
   // =========================================================================
   // ІНІЦІАЛІЗАЦІЯ RUBY (Запуск VM один раз на все життя)
   // =========================================================================
   // Це рятує нас від OOM (Out Of Memory) та фрагментації купи в циклі
-  mrb_state *mrb = mrb_open();
-  if (mrb) {
-      mrb_load_irep(mrb, current_lorenz_bytecode);
+  // [ОПТИМІЗАЦІЯ mruby Heap] Уся купа VM живе у статичному пулі з класами
+  // розмірів: жодного malloc, детермінований час алокації, видимий запас пам'яті.
+  Pool_Init(&mrb_pool, mrb_arena, sizeof(mrb_arena));
+  contract_vm = Contract_Open_VM(current_lorenz_bytecode);
+
+  // OTA-контракт падає вже при завантаженні — не лишаємо дерево без VM
+  if (!contract_vm && contract_slot != CONTRACT_SLOT_BUILTIN) {
+      contract_slot = CONTRACT_SLOT_BUILTIN;
+      current_lorenz_bytecode = (uint8_t*)lorenz_bytecode;
+      contract_vm = Contract_Open_VM(current_lorenz_bytecode);
   }
+  contract_committed_slot = contract_slot;
+  HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR16, contract_committed_slot);
 
   /* USER CODE END 2 */
 
@@ -281,15 +464,17 @@ int main(void)
     // Гладимо Сторожового Пса. Якщо ядро зависне і не виконає цю команду,
     // система автоматично перезавантажиться і відновить дані з RTC.
     HAL_IWDG_Refresh(&hiwdg);
+    Sync_Expire(&sync_state, Rtc_Now_Ms()); // Без свіжого маяка слот не тримаємо
 
     // =========================================================================
     // ФАЗА 1: ЗБІР ФІЗИЧНИХ ДАНИХ (Нульова ентропія)
     // =========================================================================
+    Prof_Begin(&phase_prof, PROF_PHASE_ACQUIRE);
 
     // 1. Метаболізм (Час)
-    uint32_t current_time = HAL_GetTick() / 1000;
-    delta_t_seconds = current_time - last_wakeup_timestamp;
-    last_wakeup_timestamp = current_time;
+    // [FIX: STOP2 Time] HAL_GetTick у STOP2 стоїть (HAL_SuspendTick) — лише
+    // календар RTC бачить увесь цикл: сон + попереднє пробудження.
+    delta_t_seconds = Energy_Clock_Elapsed_S(&wake_clock, Rtc_Now_Ms());
 
     // 2. Внутрішні метрики (Температура та Заряд)
     uint16_t internal_temp = 0;
@@ -308,17 +493,46 @@ int main(void)
     }
     HAL_ADC_Stop(&hadc);
 
+    // [ОПТИМІЗАЦІЯ Energy] Замість одного порогу Vcap — план на все пробудження:
+    // харвест оцінюється з траєкторії Vcap, а TinyML / слух / естафета вмикаються
+    // лише якщо прогноз запасу на наступне пробудження це дозволяє.
+    Energy_Update(&energy_state, vcap_voltage, delta_t_seconds);
+    Energy_Plan(&energy_state, &energy_plan);
+    // Власний TX (ENERGY_COST_UPLINK_UJ) — лише якщо кадр таки піде (ФАЗА 4)
+    Energy_Spend(&energy_state, ENERGY_COST_WAKE_UJ - ENERGY_COST_UPLINK_UJ);
+    // [FIX: Route Age] Градієнт старіє лише на пробудженнях з вікном RX (ФАЗА 4.5):
+    // Солдат без запасу на слух маяків не чув, і маршрут від цього не гірший.
+    if (energy_plan.listen) Route_Tick(&route_state);
+    // [ОПТИМІЗАЦІЯ Channel Plan] Свого кластера давно не чути — шукаємо Королеву
+    // на наступному каналі. Градієнт, слот і потужність були для іншої Королеви.
+    // [FIX: Chan Age] Тиша рахується теж лише на пробудженнях з вікном RX:
+    // голодний Солдат не кидає канал Королеви, якого просто не слухав.
+    if (energy_plan.listen && Chan_Tick(&chan_state)) {
+        Radio.SetChannel(Chan_Freq_Hz(chan_state.ch));
+        Route_Init(&route_state);
+        Sync_Init(&sync_state);
+        Adr_Init(&adr_state);
+        Radio_Set_Tx_Power(adr_state.power_dbm);
+    }
+
     // 3. Квантовий Хаос (Зерно для Атрактора)
     uint32_t chaos_seed = 0;
     HAL_RNG_GenerateRandomNumber(&hrng, &chaos_seed);
+    Prof_End(&phase_prof, PROF_PHASE_ACQUIRE);
 
     // =========================================================================
     // ФАЗА 1.5: TINYML (Шаховий розтин / Фільтрація Свідомості через DMA)
     // =========================================================================
 
     // Якщо ядро прокинулось через вібрацію на піні
+    // У режимі виживання вібрацію лише скидаємо: інференс не вартий брауну
+    if (vibration_detected && !energy_plan.run_tinyml) {
+        vibration_detected = 0;
+    }
     if (vibration_detected) {
         vibration_detected = 0;
+        Energy_Spend(&energy_state, ENERGY_COST_TINYML_UJ);
+        Prof_Begin(&phase_prof, PROF_PHASE_TINYML);
         audio_ready = 0;
 
         // 1. Запускаємо Таймер-метроном і АЦП у режимі DMA
@@ -357,13 +571,15 @@ int main(void)
             if (ml_confidence > 0.80) {
                 if (ml_event_id == 2) {
                     // Це підтверджена кавітація ксилеми!
-                    acoustic_events++;
+                    // Насичення: між кадрами події накопичуються, байт 7 — u8
+                    if (acoustic_events < 0xFF) acoustic_events++;
                 } else if (ml_event_id == 3) {
                     // Тривога: Аномальна вібрація (Бензопила / Вандалізм)
                     Trigger_Emergency_LoRa_TX();
                 }
             }
         }
+        Prof_End(&phase_prof, PROF_PHASE_TINYML);
     }
 
     // =========================================================================
@@ -384,257 +600,331 @@ int main(void)
     lora_payload[6] = (int8_t)__LL_ADC_CALC_TEMPERATURE(3300, internal_temp, LL_ADC_RESOLUTION_12B);
 
     // Байт 7: Акустичні події (Відфільтровані TinyML)
-    lora_payload[7] = (uint8_t)(acoustic_events & 0xFF);
+    lora_payload[7] = acoustic_events;
 
-    // Байти 8-9: Швидкість заряду (Секунди)
-    lora_payload[8] = (uint8_t)(delta_t_seconds >> 8);
-    lora_payload[9] = (uint8_t)(delta_t_seconds & 0xFF);
+    // Байти 8-9: Секунди від попереднього показання (пропущені report-by-exception
+    // пробудження додаються). У пачці кожне показання так відлічує час від попереднього.
+    reading_gap_s += delta_t_seconds;
+    if (reading_gap_s > 0xFFFF) reading_gap_s = 0xFFFF;
+    lora_payload[8] = (uint8_t)(reading_gap_s >> 8);
+    lora_payload[9] = (uint8_t)(reading_gap_s & 0xFF);
 
-    // Байт 11: TTL (Time to Live) для Mesh-маршрутизації.
-    // Початкове життя пакета = 3 стрибки.
-    lora_payload[11] = DEFAULT_TTL;
+    // Байт 11: [Hop:4 | TTL:4] для Mesh-маршрутизації.
+    // Початкове життя пакета = 3 стрибки; hop — наша відстань до Королеви.
+    // У дорозі змінюється лише копія у відкритому заголовку, тіло — ні.
+    lora_payload[11] = Route_Byte(route_state.hop, DEFAULT_TTL);
 
     // [FIX: Firmware Version] Байти 12-13: версія прошивки (big-endian).
     // Дозволяє серверу знати яка прошивка на кожному дереві, для OTA targeting.
     lora_payload[12] = (uint8_t)(FIRMWARE_VERSION_ID >> 8);
     lora_payload[13] = (uint8_t)(FIRMWARE_VERSION_ID & 0xFF);
 
-    // Обнуляємо лічильник після архівації
-    acoustic_events = 0;
 
     // =========================================================================
     // ФАЗА 3: ПЛАВКА (Запуск Ruby та Атрактора Лоренца)
     // =========================================================================
+    Prof_Begin(&phase_prof, PROF_PHASE_MRUBY);
 
-    if (mrb) {
-      // [FIX: mruby Heap Fragmentation] Зберігаємо стан арени GC перед кожним
-      // виконанням. Після отримання результату — відновлюємо. Це запобігає
-      // повільному «витоку» пам'яті через тижні безперервної роботи.
-      int arena_idx = mrb_gc_arena_save(mrb);
-
+    if (contract_vm) {
       mrb_value args[3];
       args[0] = mrb_fixnum_value(chaos_seed);
       args[1] = mrb_fixnum_value((int8_t)lora_payload[6]); // Температура (Зимовий щит)
       args[2] = mrb_fixnum_value(lora_payload[7]); // Акустика
 
-      mrb_value ruby_result = mrb_funcall_argv(mrb, mrb_top_self(mrb), mrb_intern_lit(mrb, "calculate_state"), 3, args);
-
       // Байт 10: Біо-Контракт (Токеноміка)
-      if (!mrb->exc) {
-          lora_payload[10] = (uint8_t)mrb_fixnum(ruby_result);
-      } else {
+      uint8_t contract_ok = Contract_Call(contract_vm, args, &lora_payload[10]);
+
+      if (!contract_ok && fallback_vm) {
+          // [ОПТИМІЗАЦІЯ Hot Swap] Новий контракт кинув виняток — миттєвий відкат
+          // на попередню VM у цьому ж пробудженні, без ребуту.
+          // DR16 і так тримає fallback_slot: випробування його не чіпало.
+          mrb_close(contract_vm);
+          contract_vm = fallback_vm;
+          contract_slot = fallback_slot;
+          contract_probation = 0;
+          fallback_vm = NULL;
+          current_lorenz_bytecode = (uint8_t*)Contract_Slot_Bytecode(contract_slot);
+          contract_ok = Contract_Call(contract_vm, args, &lora_payload[10]);
+      } else if (contract_ok && contract_slot != contract_committed_slot &&
+                 ++contract_probation >= CONTRACT_PROBATION_CYCLES) {
+          // Новий контракт довів себе — звільняємо пул від старої VM і лише
+          // тепер пишемо його слот у DR16.
+          if (fallback_vm) {
+              mrb_close(fallback_vm);
+              fallback_vm = NULL;
+          }
+          contract_committed_slot = contract_slot;
+          HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR16, contract_committed_slot);
+      }
+
+      if (!contract_ok) {
           // [FIX: AUDIT] Обробка помилки mruby — позначаємо status=tamper
           lora_payload[10] = BIO_STATUS_VM_ERROR;
-          mrb->exc = NULL; // Скидаємо виняток для наступної ітерації
       }
-
-      mrb_gc_arena_restore(mrb, arena_idx);
     } else {
       // Якщо VM не запустилася при старті через нестачу пам'яті
       lora_payload[10] = BIO_STATUS_VM_ERROR;
     }
+    Prof_End(&phase_prof, PROF_PHASE_MRUBY);
 
     // =========================================================================
     // ФАЗА 4: ПЕРЕДАЧА ДАНИХ (AES-256 + Mesh)
     // =========================================================================
+    Prof_Begin(&phase_prof, PROF_PHASE_TX);
+
+    // [ОПТИМІЗАЦІЯ Report-by-Exception] Нове показання — лише якщо воно вийшло
+    // з мертвих зон, змінився статус байта 10 або настав час пульсу.
+    // Паніка сюди не потрапляє: Trigger_Emergency_LoRa_TX уже відправив її у ФАЗІ 1.5.
+    RbeDecision rbe = Rbe_Decide(&rbe_state, lora_payload);
+    if (uplink_queue.count > 0) {
+        uplink_held_s += delta_t_seconds;
+    }
+    uint8_t max_relays = energy_plan.relay ? RELAYQ_CAPACITY : 0;
+
+    if (rbe != RBE_SKIP) {
+        // [ОПТИМІЗАЦІЯ Seen-Set] Байт 14: номер кадру (u8, по колу). Разом з DID
+        // відрізняє свіже показання від повтору того самого кадру в mesh.
+        lora_payload[14] = tx_seq++;
+
+        // 1. Шифруємо наші власні дані (16 байтів = 4 слова по 32 біти) під відкритий заголовок.
+        // [ОПТИМІЗАЦІЯ Batched Uplink] Запечатаний блок чекає пачки в uplink_queue.
+        Mesh_Seal_Block(lora_payload, encrypted_payload);
+        RelayQ_Push(&uplink_queue, encrypted_payload);
+        Rbe_Sent(&rbe_state, lora_payload);
+
+        // Обнуляємо лічильники після архівації
+        acoustic_events = 0;
+        reading_gap_s = 0;
+    } else {
+        Rbe_Skipped(&rbe_state);
+    }
 
-    // [FIX: LoRa Collision Storm] Рандомізована затримка 0-500 мс перед TX.
-    // Якщо 100 дерев прокинуться одночасно (грім, землетрус), без jitter
-    // вони заб'ють ефір колізіями. HRNG дає апаратну ентропію з теплового шуму.
-    {
+    // Пачка йде, коли повна, застаріла або подія термінова. Якщо радіо й так
+    // вмикається заради естафети — власні показання їдуть тим самим пакетом.
+    // [ОПТИМІЗАЦІЯ Channel Plan] Під час скану пачка — зонд: прямому Солдату
+    // Королева відповість маяком, і канал зафіксується.
+    uint8_t relays_due = (max_relays > 0 && relay_queue.count > 0);
+    uint8_t own_due = Rbe_Batch_Due(rbe, uplink_queue.count, uplink_held_s) ||
+                      ((relays_due || !chan_state.locked) && uplink_queue.count > 0);
+    uint8_t own_tx = own_due || relays_due; // Після нього Королева може відповісти маяком
+
+    if (own_tx) {
+        // [FIX: LoRa Collision Storm] Рандомізована затримка 0-500 мс перед TX.
+        // Якщо 100 дерев прокинуться одночасно (грім, землетрус), без jitter
+        // вони заб'ють ефір колізіями. HRNG дає апаратну ентропію з теплового шуму.
         uint32_t random_jitter = 0;
         HAL_RNG_GenerateRandomNumber(&hrng, &random_jitter);
-        HAL_Delay(random_jitter % TX_JITTER_MAX_MS);
-    }
+        // [ОПТИМІЗАЦІЯ TDMA] Солдат зі слотом чекає його старту (сон уже
+        // вирівняний на нього). Jitter лишається тим, хто слота не має або
+        // прокинувся поза планом (вібрація).
+        uint32_t slot_wait = Sync_Slot_Wait_Ms(&sync_state, Rtc_Now_Ms());
+        if (slot_wait != SYNC_WAIT_MISSED) {
+            Tx_Slot_Wait_Ms(slot_wait);
+        } else {
+            // [ОПТИМІЗАЦІЯ LP Delay] До 500 мс у STOP2 замість busy-wait на 48 МГц
+            LP_Delay_Ms(random_jitter % TX_JITTER_MAX_MS);
+        }
 
-    // 1. Якщо у нас є чужий зашифрований пакет (Mesh), спочатку відправляємо його
-    if (has_mesh_relay) {
-        Radio.Send(mesh_relay_payload, 16);
-        HAL_Delay(100); // Коротка пауза між передачами
-        has_mesh_relay = 0; // Пакет відправлено, очищаємо пам'ять
+        // 2. [ОПТИМІЗАЦІЯ Relay Queue] Чужі кадри з черги їдуть у тому ж LoRa-пакеті,
+        // що й власні: одна преамбула, один CAD, одне пробудження радіо.
+        // Без енергії на естафету черга чекає наступного пробудження.
+        // [ОПТИМІЗАЦІЯ LBT] Jitter лише розводить перший CAD; далі кожен кадр
+        // чекає вільного каналу (Radio_Send_LBT).
+        uint16_t tx_size = RelayQ_Drain(&uplink_queue, own_due ? RELAYQ_CAPACITY : 0, relay_frame);
+        tx_size += RelayQ_Drain(&relay_queue, max_relays, relay_frame + tx_size);
+        uplink_held_s = 0;
+
+        // 3. Відправляємо захищені дані в ефір. Преамбулу оплачує перший блок,
+        // кожен наступний — лише свої 20 байт ефіру.
+        Radio_Send_LBT(relay_frame, (uint8_t)tx_size);
+        // [ОПТИМІЗАЦІЯ ADR] Ціни заміряні на повній потужності — масштабуємо під поточну.
+        Energy_Spend(&energy_state, Adr_Tx_Cost_UJ(&adr_state, ENERGY_COST_UPLINK_UJ +
+                     (uint32_t)(tx_size / RELAYQ_FRAME_SIZE - 1) * ENERGY_COST_RELAY_BLOCK_UJ));
     }
+    Prof_End(&phase_prof, PROF_PHASE_TX);
 
-    // 2. Шифруємо наші власні дані (16 байтів = 4 слова по 32 біти)
-    HAL_CRYP_Encrypt(&hcryp, (uint32_t*)lora_payload, 4, (uint32_t*)encrypted_payload, 1000);
+    // 4. Діагностика купи mruby / радіо (раз на DIAG_INTERVAL_CYCLES пробуджень, по черзі).
+    // Окремий кадр лише при надлишку енергії; інакше переносимо на наступне пробудження.
+    if (diag_cycle_counter < DIAG_INTERVAL_CYCLES) {
+        diag_cycle_counter++;
+    }
+    if (diag_cycle_counter >= DIAG_INTERVAL_CYCLES && energy_plan.listen) {
+        if (diag_next_radio) {
+            Diag_Pack_Radio_Frame(diag_payload, tree_did, Route_Byte(route_state.hop, DEFAULT_TTL), FIRMWARE_VERSION_ID,
+                                  &lbt_state);
+        } else {
+            Diag_Pack_Heap_Frame(diag_payload, tree_did, Route_Byte(route_state.hop, DEFAULT_TTL), FIRMWARE_VERSION_ID,
+                                 &mrb_pool.stats, mrb_gc_runs);
+        }
+        Mesh_Seal_Block(diag_payload, encrypted_payload);
+        LP_Delay_Ms(TX_INTERFRAME_GAP_MS); // Та сама пауза, що й між естафетою та власним пакетом
+        Radio_Send_LBT(encrypted_payload, ROUTE_BLOCK_SIZE);
+        diag_next_radio ^= 1;
+        diag_cycle_counter = 0;
+        Energy_Spend(&energy_state, Adr_Tx_Cost_UJ(&adr_state, ENERGY_COST_RELAY_UJ)); // Пауза + TX, як естафета
+    }
 
-    // 3. Відправляємо захищені дані в ефір
-    Radio.Send(encrypted_payload, 16);
+    // 5. Профіль фаз: одна фаза на кадр, повна таблиця за 5 кадрів.
+    // Незаміряні фази (TinyML без вібрацій) пропускаємо.
+    if (prof_cycle_counter < PROF_INTERVAL_CYCLES) {
+        prof_cycle_counter++;
+    }
+    if (prof_cycle_counter >= PROF_INTERVAL_CYCLES && energy_plan.listen) {
+        for (uint8_t i = 0; i < PROF_SOLDIER_PHASES &&
+                            phase_prof.stat[prof_next_phase].count == 0; i++) {
+            prof_next_phase = (uint8_t)((prof_next_phase + 1) % PROF_SOLDIER_PHASES);
+        }
+        Diag_Pack_Profile_Frame(diag_payload, tree_did, Route_Byte(route_state.hop, DEFAULT_TTL), FIRMWARE_VERSION_ID,
+                                (ProfPhase)prof_next_phase, &phase_prof.stat[prof_next_phase]);
+        Mesh_Seal_Block(diag_payload, encrypted_payload);
+        LP_Delay_Ms(TX_INTERFRAME_GAP_MS);
+        Radio_Send_LBT(encrypted_payload, ROUTE_BLOCK_SIZE);
+        prof_next_phase = (uint8_t)((prof_next_phase + 1) % PROF_SOLDIER_PHASES);
+        prof_cycle_counter = 0;
+        Energy_Spend(&energy_state, Adr_Tx_Cost_UJ(&adr_state, ENERGY_COST_RELAY_UJ));
+    }
 
     // =========================================================================
     // ФАЗА 4.5: ЕНЕРГОЕФЕКТИВНИЙ СЛУХ (Directed Mesh & OTA)
     // =========================================================================
 
-    // Слухаємо ефір ТІЛЬКИ якщо ми багаті на енергію (напруга > 2.8В)
-    if (vcap_voltage > VCAP_LISTEN_THRESHOLD) {
+    // Слухаємо ефір ТІЛЬКИ якщо план пробудження має на це запас
+    if (energy_plan.listen) {
+        Energy_Spend(&energy_state, ENERGY_COST_LISTEN_UJ);
+        Prof_Begin(&phase_prof, PROF_PHASE_RX);
         lora_rx_flag = 0;
+        lora_rx_window_closed = 0;
         Radio.Rx(LORA_RX_TIMEOUT_MS);
 
-        uint32_t rx_start_time = HAL_GetTick();
-        while((HAL_GetTick() - rx_start_time) < LORA_RX_LOOP_MS) {
-            if(lora_rx_flag == 1) {
-                // МИ ЗЛОВИЛИ ПАКЕТ! Розшифровуємо його.
-                uint16_t blocks = incoming_lora_size / 4;
-                HAL_CRYP_Decrypt(&hcryp, (uint32_t*)incoming_lora_payload, blocks, (uint32_t*)decrypted_rx_payload, 1000);
+        // [ОПТИМІЗАЦІЯ RX Sleep] Слухає радіо, а не ядро: замість 600 мс опитування
+        // на 48 МГц ядро чекає у STOP1 до RxDone / RxTimeout / RxError або
+        // дедлайну LPTIM1 (якщо радіо так і не відповіло).
+        HAL_LPTIM_SetOnce_Start_IT(&hlptim1, 0xFFFF, RX_DEADLINE_LPTIM_TICKS);
 
-                // Сценарій А: OTA Оновлення від Королеви (Пакет починається з OTA_MARKER)
-                if (decrypted_rx_payload[0] == OTA_MARKER) {
-                    // [FIX: AUDIT] Перевірка мінімального розміру пакета (5 байт заголовок + 1 байт даних)
-                    if (incoming_lora_size < MIN_OTA_PACKET_SIZE) {
-                        lora_rx_flag = 0;
-                        break;
-                    }
+        while (1) {
+            HAL_IWDG_Refresh(&hiwdg);
+            Rx_Sleep_Until_Event();
 
-                    // 16-bit big-endian index та total (5 байт заголовок: 1 маркер + 2 index + 2 total)
-                    uint16_t chunk_idx = ((uint16_t)decrypted_rx_payload[1] << 8) | decrypted_rx_payload[2];
-                    uint16_t incoming_total = ((uint16_t)decrypted_rx_payload[3] << 8) | decrypted_rx_payload[4];
-                    uint8_t chunk_size = (uint8_t)(incoming_lora_size - OTA_HEADER_SIZE);
+            if(lora_rx_flag == 1) {
+                // МИ ЗЛОВИЛИ ПАКЕТ! Mesh-блоки мають відкритий заголовок і
+                // розшифровки не потребують; голий AES (OTA Королеви) — розшифровуємо.
+                // (void*) cast strips volatile — safe: lora_rx_flag serializes ISR→main access.
+                uint8_t* rx = (uint8_t*)(void*)incoming_lora_payload;
+                uint8_t rx_blocks = RelayQ_Frame_Blocks(incoming_lora_size);
+                if (rx_blocks == 0) {
+                    uint16_t blocks = incoming_lora_size / 4;
+                    HAL_CRYP_Decrypt(&hcryp, (uint32_t*)rx, blocks, (uint32_t*)decrypted_rx_payload, 1000);
+                }
 
-                    // [FIX: AUDIT] Валідація: total_chunks не повинно змінюватися між пакетами
-                    if (ota_total_chunks != 0 && incoming_total != ota_total_chunks) {
-                        break; // Невалідний пакет — ігноруємо
+                // Сценарій А: OTA Оновлення від Королеви (Пакет починається з OTA_MARKER)
+                if (rx_blocks == 0 && decrypted_rx_payload[0] == OTA_MARKER) {
+                    // Межі, дублікати й CRC32 — у Ota_Rx_Chunk
+                    uint16_t image_len = 0;
+                    OtaRxResult ota_result = Ota_Rx_Chunk(&ota_rx, decrypted_rx_payload,
+                                                          incoming_lora_size, &image_len);
+                    if (ota_result != OTA_RX_IGNORED) {
+                        Chan_Heard(&chan_state); // OTA-чанк Королеви — ми на її каналі
                     }
-                    ota_total_chunks = incoming_total;
-
-                    // Явне приведення типів для розрахунку зміщення (MISRA C)
-                    uint32_t offset = (uint32_t)chunk_idx * (uint32_t)chunk_size;
-
-                    // [FIX: AUDIT CRITICAL] Повна перевірка меж:
-                    // 1. chunk_idx < 256 (розмір бітової карти)
-                    // 2. Не дублікат
-                    // 3. offset + chunk_size <= 1024 (розмір ota_buffer)
-                    if (chunk_idx < sizeof(ota_chunk_received) &&
-                        !ota_chunk_received[chunk_idx] &&
-                        (offset + chunk_size) <= sizeof(ota_buffer)) {
-
-                        memcpy(&ota_buffer[offset], &decrypted_rx_payload[OTA_HEADER_SIZE], chunk_size);
-                        ota_chunk_received[chunk_idx] = 1; // Маркуємо шматок як отриманий
-                        ota_chunks_received++;
-                        ota_bytes_received += chunk_size;
-
-                        if (ota_chunks_received >= ota_total_chunks) {
-                            // [FIX: Risk 2 — OTA Integrity Gap]
-                            // Перевіряємо CRC32 перед записом у Flash.
-                            // Останні 4 байти OTA-пейлоада — це контрольна сума.
-                            // Без цієї перевірки пошкоджений байт = "вічний ребут".
-                            if (ota_bytes_received > 4) {
-                                uint16_t data_len = ota_bytes_received - 4;
-                                uint32_t expected_crc =
-                                    ((uint32_t)ota_buffer[data_len] << 24) |
-                                    ((uint32_t)ota_buffer[data_len + 1] << 16) |
-                                    ((uint32_t)ota_buffer[data_len + 2] << 8)  |
-                                    (uint32_t)ota_buffer[data_len + 3];
-
-                                // CRC32 (ISO 3309)
-                                uint32_t crc = 0xFFFFFFFF;
-                                for (uint16_t ci = 0; ci < data_len; ci++) {
-                                    crc ^= ota_buffer[ci];
-                                    for (uint8_t bit = 0; bit < 8; bit++) {
-                                        crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
-                                    }
-                                }
-                                crc = ~crc;
-
-                                if (crc == expected_crc) {
-                                    Write_OTA_Contract_To_Flash(ota_buffer, data_len);
-                                    NVIC_SystemReset();
-                                }
-                                // CRC не збігся — ігноруємо, чекаємо на повторну передачу
-                            }
-                            // Скидаємо стан OTA для повторної спроби
-                            memset(ota_chunk_received, 0, sizeof(ota_chunk_received));
-                            ota_chunks_received = 0;
-                            ota_bytes_received = 0;
-                            ota_total_chunks = 0;
-                        }
+                    if (ota_result == OTA_RX_COMPLETE) {
+                        // [ОПТИМІЗАЦІЯ Hot Swap] Пишемо в неактивний слот і
+                        // перемикаємо VM на місці — без NVIC_SystemReset,
+                        // RAM-стан та периферія живуть далі.
+                        Contract_Hot_Swap(Contract_Inactive_Slot(contract_slot), image_len);
                     }
+                    // CRC не збігся — стан скинуто, чекаємо на повторну передачу
                 }
-                // Сценарій Б: Mesh Естафета (Чужі дані на 16 байт)
-                else if (incoming_lora_size == 16) {
-                    uint8_t incoming_ttl = decrypted_rx_payload[11];
-
-                    if (incoming_ttl > 0) {
-                        // Витягуємо DID відправника (перші 4 байти)
-                        uint32_t incoming_did = ((uint32_t)decrypted_rx_payload[0] << 24) |
-                            ((uint32_t)decrypted_rx_payload[1] << 16) |
-                            ((uint32_t)decrypted_rx_payload[2] << 8)  |
-                            (uint32_t)decrypted_rx_payload[3];
-
-                        // Захист від власного відлуння (Ігноруємо свій голос)
-                        if (incoming_did == tree_did) {
-                            break; // Миттєво припиняємо слухати ефір, йдемо спати
-                        }
-
-                        // Логіка Checkerboard (Захист від пінг-понгу)
-                        // [FIX: Mesh Ping-Pong] Перевіряємо всі 8 слотів замість 3
-                        uint8_t is_known_did = 0;
-                        for(int i = 0; i < MESH_DID_CACHE_SIZE; i++) {
-                            if (recent_mesh_dids[i] == incoming_did) {
-                                is_known_did = 1;
-                                break;
-                            }
-                        }
-
-                        // Якщо пакет ще "живий", І ми його ще не пересилали
-                        if (!is_known_did) {
-                            // Зменшуємо TTL
-                            decrypted_rx_payload[11] = incoming_ttl - 1;
-
-                            // Зашифровуємо змінений пакет назад для зберігання
-                            HAL_CRYP_Encrypt(&hcryp, (uint32_t*)decrypted_rx_payload, 4, (uint32_t*)mesh_relay_payload, 1000);
-                            has_mesh_relay = 1;
-
-                            // Оновлюємо кеш "пліток" (зсуваємо старі записи, додаємо новий)
-                            // [FIX: Mesh Ping-Pong] Зсув на 8 слотів
-                            for (int i = MESH_DID_CACHE_SIZE - 1; i > 0; i--)
-                                recent_mesh_dids[i] = recent_mesh_dids[i - 1];
-                            recent_mesh_dids[0] = incoming_did;
-                        }
+                // Сценарій Б: Mesh Естафета (блоки з відкритим заголовком) або маяк Королеви.
+                // [ОПТИМІЗАЦІЯ Relay Queue] Сусід міг прислати агрегований пакет
+                // (власний блок + його естафета) — кожен блок розглядаємо окремо.
+                // [ОПТИМІЗАЦІЯ Cleartext Header] Рішення — лише за заголовком:
+                // жодного HAL_CRYP_Decrypt / Encrypt на естафеті.
+                else if (rx_blocks > 0) {
+                    // [ОПТИМІЗАЦІЯ Gradient] Передавач пише свій hop у кожен блок.
+                    // Вчимося градієнту навіть без енергії на естафету: це безкоштовно.
+                    uint8_t tx_hop = Route_Byte_Hop(rx[ROUTE_HDR_HOP_TTL]);
+                    uint8_t hop_trusted = 1;
+                    if (rx[ROUTE_HDR_TYPE] == FRAME_TYPE_BEACON) {
+                        // Маяк тягне на себе весь градієнт: перевіряємо, що тіло
+                        // зашифроване ключем мережі і збігається із заголовком
+                        HAL_CRYP_Decrypt(&hcryp, (uint32_t*)&rx[ROUTE_HDR_SIZE], 4,
+                                         (uint32_t*)decrypted_rx_payload, 1000);
+                        hop_trusted = Route_Hdr_Binds_Body(rx, decrypted_rx_payload);
+                    }
+                    if (hop_trusted) {
+                        Route_On_Heard(&route_state, tx_hop, incoming_lora_rssi);
+                        Chan_Heard(&chan_state); // Кластер на цьому каналі живий
+                    }
+                    // [ОПТИМІЗАЦІЯ ADR] Маяк-відповідь може нести команду потужності для нас
+                    if (rx[ROUTE_HDR_TYPE] == FRAME_TYPE_BEACON && hop_trusted &&
+                        Adr_On_Beacon(&adr_state, decrypted_rx_payload, tree_did)) {
+                        Radio_Set_Tx_Power(adr_state.power_dbm);
+                    }
+                    // [ОПТИМІЗАЦІЯ TDMA] …і наш слот з фазою кадру Королеви
+                    if (rx[ROUTE_HDR_TYPE] == FRAME_TYPE_BEACON && hop_trusted) {
+                        Sync_On_Beacon(&sync_state, decrypted_rx_payload, tree_did, incoming_lora_rtc_ms);
+                    }
+
+                    for (uint8_t b = 0; b < rx_blocks && energy_plan.relay; b++) {
+                        uint8_t* block = &rx[b * RELAYQ_FRAME_SIZE];
+                        uint8_t incoming_ttl = Route_Byte_TTL(block[ROUTE_HDR_HOP_TTL]);
+                        if (incoming_ttl == 0) continue; // Вичерпаний TTL або маяк
+
+                        // Передавач ближчий до Королеви або поруч — нехай несе сам
+                        if (!Route_Should_Relay(&route_state, tx_hop)) continue;
+
+                        // Логіка Checkerboard (Захист від пінг-понгу): той самий
+                        // блок від іншого сусіда — дублікат. Ключ без Hop|TTL.
+                        // Власне відлуння теж тут: свої блоки йдуть у seen-set при TX.
+                        if (Seen_Check_And_Insert(&mesh_seen, block)) continue;
+
+                        // Зменшуємо TTL, hop тепер наш — ми наступний передавач.
+                        // AES-тіло їде далі байт у байт.
+                        block[ROUTE_HDR_HOP_TTL] = Route_Byte(route_state.hop, (uint8_t)(incoming_ttl - 1));
+                        RelayQ_Push(&relay_queue, block);
                     }
                 }
 
                 break; // Виходимо з циклу
             }
-            HAL_IWDG_Refresh(&hiwdg);
+            // Тиша в ефірі — вікно закрите. Інакше це було стороннє
+            // переривання (EXTI п'єзо, PVD) — спимо далі.
+            if (lora_rx_window_closed) break;
         }
+        HAL_LPTIM_SetOnce_Stop_IT(&hlptim1);
         Radio.Sleep(); // Вимикаємо приймач
+
+        // Королева довго мовчить після наших кадрів — можливо, вже не чує: крок вгору
+        if (own_tx && Adr_Window_Closed(&adr_state)) {
+            Radio_Set_Tx_Power(adr_state.power_dbm);
+        }
+        Prof_End(&phase_prof, PROF_PHASE_RX);
     }
 
     // =========================================================================
     // ФАЗА 5: КЕНОЗИС (Абсолютний сон та збереження)
     // =========================================================================
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR0, acoustic_events);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR1, last_wakeup_timestamp);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR2, has_mesh_relay);
-
-    // Якщо є транзитний пакет (16 байтів), розкидаємо його на 4 регістри по 32 біти
-    if (has_mesh_relay) {
-        uint32_t r3 = ((uint32_t)mesh_relay_payload[0] << 24) | ((uint32_t)mesh_relay_payload[1] << 16) | ((uint32_t)mesh_relay_payload[2] << 8) | (uint32_t)mesh_relay_payload[3];
-        uint32_t r4 = ((uint32_t)mesh_relay_payload[4] << 24) | ((uint32_t)mesh_relay_payload[5] << 16) | ((uint32_t)mesh_relay_payload[6] << 8) | (uint32_t)mesh_relay_payload[7];
-        uint32_t r5 = ((uint32_t)mesh_relay_payload[8] << 24) | ((uint32_t)mesh_relay_payload[9] << 16) | ((uint32_t)mesh_relay_payload[10] << 8) | (uint32_t)mesh_relay_payload[11];
-        uint32_t r6 = ((uint32_t)mesh_relay_payload[12] << 24) | ((uint32_t)mesh_relay_payload[13] << 16) | ((uint32_t)mesh_relay_payload[14] << 8) | (uint32_t)mesh_relay_payload[15];
-
-        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR3, r3);
-        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR4, r4);
-        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR5, r5);
-        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR6, r6);
-    }
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR0, Rbe_Pack(&rbe_state));
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR1, Energy_Clock_Word(&wake_clock));
 
-    // Зберігаємо кеш DID-ів у вічну пам'ять перед сном
-    // [FIX: Mesh Ping-Pong] 8 слотів (DR8..DR15)
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR8, recent_mesh_dids[0]);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR9, recent_mesh_dids[1]);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR10, recent_mesh_dids[2]);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR11, recent_mesh_dids[3]);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR12, recent_mesh_dids[4]);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR13, recent_mesh_dids[5]);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR14, recent_mesh_dids[6]);
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR15, recent_mesh_dids[7]);
+    // [ОПТИМІЗАЦІЯ TDMA] Сон закінчується перед власним слотом, найближчим до
+    // плану: пробудження, ФАЗИ 1-3 — і TX рівно на старті слота
+    uint32_t sleep_s = Sync_Sleep_S(&sync_state, Rtc_Now_Ms(), energy_plan.sleep_s);
+
+    // Seen-set старіє на час майбутнього сну, потім — у вічну пам'ять
+    Seen_Age(&mesh_seen, sleep_s);
+    for (int i = 0; i < SEEN_STATE_WORDS; i++) {
+        HAL_RTCEx_BKUPWrite(&hrtc, mesh_seen_bkp_regs[i], mesh_seen.words[i]);
+    }
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR19, Bkp_Counters_Word());
 
     // [FIX: AUDIT Energy] Вимикаємо периферію перед STOP2 для мінімального споживання.
     // Без де-ініціалізації ці модулі тягнуть мікроампери навіть у STOP2.
     HAL_RNG_DeInit(&hrng);
     __HAL_RCC_CRYP_CLK_DISABLE();
 
+    // [ОПТИМІЗАЦІЯ Energy] Інтервал сну — з плану (ck_spre 1 Гц, лічильник з нуля)
+    HAL_RTCEx_SetWakeUpTimer_IT(&hrtc, sleep_s - 1, RTC_WAKEUPCLOCK_CK_SPRE_16BITS, 0);
+
     HAL_SuspendTick();
     HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
     HAL_ResumeTick();
@@ -653,6 +943,165 @@ int main(void)
 
 /* USER CODE BEGIN 4 */
 
+// =========================================================================
+// АЛОКАТОР mruby (Статичний пул замість libc malloc)
+// =========================================================================
+// Контракт mrb_allocf: size == 0 → free, інакше realloc. NULL при нестачі
+// пам'яті mruby перетворює на NoMemoryError → BIO_STATUS_VM_ERROR у ФАЗІ 3.
+static void* mrb_pool_allocf(mrb_state *mrb, void *p, size_t size, void *ud)
+{
+    (void)mrb;
+    return Pool_Realloc((SilkenPool*)ud, p, size);
+}
+
+// =========================================================================
+// ГАРЯЧА ЗАМІНА КОНТРАКТУ (A/B слоти + fallback VM)
+// =========================================================================
+// Вибір слота при старті. Збережений слот без байткоду (стертий, недописаний)
+// та CONTRACT_SLOT_UNSET → історичний порядок: A, B, вбудований.
+uint8_t Contract_Select_Boot_Slot(uint8_t stored_slot, uint8_t slot_a_valid, uint8_t slot_b_valid)
+{
+    if (stored_slot == CONTRACT_SLOT_A && slot_a_valid) return CONTRACT_SLOT_A;
+    if (stored_slot == CONTRACT_SLOT_B && slot_b_valid) return CONTRACT_SLOT_B;
+    if (stored_slot == CONTRACT_SLOT_BUILTIN) return CONTRACT_SLOT_BUILTIN;
+
+    if (slot_a_valid) return CONTRACT_SLOT_A;
+    if (slot_b_valid) return CONTRACT_SLOT_B;
+    return CONTRACT_SLOT_BUILTIN;
+}
+
+// Слот для наступного OTA: ніколи не той, з якого зараз виконується VM (XIP)
+uint8_t Contract_Inactive_Slot(uint8_t active_slot)
+{
+    return (active_slot == CONTRACT_SLOT_A) ? CONTRACT_SLOT_B : CONTRACT_SLOT_A;
+}
+
+static const uint8_t* Contract_Slot_Bytecode(uint8_t slot)
+{
+    switch (slot) {
+        case CONTRACT_SLOT_A: return (const uint8_t*)MRUBY_CONTRACT_FLASH_ADDR;
+        case CONTRACT_SLOT_B: return (const uint8_t*)MRUBY_CONTRACT_FLASH_ADDR_B;
+        default:              return lorenz_bytecode;
+    }
+}
+
+// Нова VM у спільному пулі. NULL — не вистачило пулу або контракт кинув
+// виняток уже на верхньому рівні (mrb_load_irep).
+static mrb_state* Contract_Open_VM(const uint8_t* bytecode)
+{
+    mrb_state *vm = mrb_open_allocf(mrb_pool_allocf, &mrb_pool);
+    if (!vm) return NULL;
+
+    // [СИНХРОНІЗОВАНО з сервером] Контракт рахує Z не в mruby float, а через
+    // SilkenNet.attractor_z_q16 — той самий Q16.16 код, що й SilkenNet::Attractor.
+    struct RClass *silken_module = mrb_define_module(vm, "SilkenNet");
+    mrb_define_module_function(vm, silken_module, "attractor_z_q16",
+                               mrb_silken_attractor_z_q16, MRB_ARGS_REQ(3));
+
+    // [ОПТИМІЗАЦІЯ XIP] Усі джерела контракту лежать у Flash, тому
+    // mrb_ro_data_p() повертає true і mruby не копіює байт-код у купу:
+    // iseq виконується прямо з Flash (MRB_ISEQ_NO_FREE), рядки пулу та імена
+    // символів стають static. У SRAM лишаються тільки мутабельні структури irep.
+    mrb_load_irep(vm, bytecode);
+    if (vm->exc) {
+        mrb_close(vm);
+        return NULL;
+    }
+    return vm;
+}
+
+// Один виклик calculate_state. 1 — успіх, байт статусу у *result.
+static uint8_t Contract_Call(mrb_state *vm, mrb_value* args, uint8_t* result)
+{
+    // [FIX: mruby Heap Fragmentation] Зберігаємо стан арени GC перед кожним
+    // виконанням. Після отримання результату — відновлюємо. Це запобігає
+    // повільному «витоку» пам'яті через тижні безперервної роботи.
+    int arena_idx = mrb_gc_arena_save(vm);
+
+    mrb_value ruby_result = mrb_funcall_argv(vm, mrb_top_self(vm), mrb_intern_lit(vm, "calculate_state"), 3, args);
+
+    uint8_t ok = 0;
+    if (!vm->exc) {
+        *result = (uint8_t)mrb_fixnum(ruby_result);
+        ok = 1;
+    } else {
+        vm->exc = NULL; // Скидаємо виняток для наступної ітерації
+    }
+
+    mrb_gc_arena_restore(vm, arena_idx);
+
+    // [ОПТИМІЗАЦІЯ mruby Heap] Пул заповнений понад поріг — повний GC зараз,
+    // поки ми ще не в радіо-фазі, а не посеред наступного контракту.
+    if (mrb_pool.stats.bytes_in_use >
+        (uint32_t)(MRB_ARENA_SIZE / 100) * MRB_GC_WATERMARK_PCT) {
+        mrb_full_gc(vm);
+        mrb_gc_runs++;
+    }
+    return ok;
+}
+
+// Записує ota_rx.buffer (без CRC32, перевіреного викликачем) у target_slot і робить
+// його активним у цьому ж пробудженні. Стара VM лишається fallback на
+// CONTRACT_PROBATION_CYCLES пробуджень.
+// [FIX: Probation Reset] RTC_BKP_DR16 тримає старий слот, доки новий контракт
+// не пройде випробування: зависання чи IWDG посеред нього — ребут у старий
+// контракт, а не цикл ребутів у новому.
+static void Contract_Hot_Swap(uint8_t target_slot, uint16_t data_len)
+{
+    // Новий OTA посеред випробування затре перевірений слот — до кінця
+    // випробування ребут іде у вбудований контракт
+    if (target_slot == contract_committed_slot) {
+        contract_committed_slot = CONTRACT_SLOT_BUILTIN;
+        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR16, contract_committed_slot);
+    }
+
+    // fallback_vm може виконуватися з target_slot (XIP) — закриваємо до стирання Flash
+    if (fallback_vm) {
+        mrb_close(fallback_vm);
+        fallback_vm = NULL;
+    }
+
+    Write_OTA_Contract_To_Flash((uint32_t)(uintptr_t)Contract_Slot_Bytecode(target_slot),
+                                ota_rx.buffer, data_len);
+
+    mrb_state *fresh = Contract_Open_VM(Contract_Slot_Bytecode(target_slot));
+
+    if (!fresh && contract_vm) {
+        // Дві VM не влазять у пул — звільняємо стару і пробуємо ще раз.
+        // Fallback у RAM тоді немає, але слот старого контракту лишається цілим.
+        mrb_close(contract_vm);
+        contract_vm = NULL;
+        fresh = Contract_Open_VM(Contract_Slot_Bytecode(target_slot));
+        if (!fresh) {
+            // Новий контракт не завантажився — повертаємо старий з його слота
+            contract_vm = Contract_Open_VM(Contract_Slot_Bytecode(contract_slot));
+            return;
+        }
+    } else if (!fresh) {
+        return; // Новий контракт не завантажився, стара VM працює далі
+    }
+
+    fallback_vm = contract_vm;
+    fallback_slot = contract_slot;
+    contract_vm = fresh;
+    contract_slot = target_slot;
+    contract_probation = 0;
+    current_lorenz_bytecode = (uint8_t*)Contract_Slot_Bytecode(contract_slot);
+}
+
+// =========================================================================
+// EXECUTE-IN-PLACE (mruby збирається з MRB_USE_CUSTOM_RO_DATA_P)
+// =========================================================================
+// mruby питає, чи буфер незмінний упродовж життя VM. Для Flash — так
+// (OTA пише лише в слот, з якого не виконується жодна VM), тож байт-код,
+// літерали та імена символів використовуються на місці замість копії в пул.
+mrb_bool mrb_ro_data_p(const char *p)
+{
+    uintptr_t addr = (uintptr_t)p;
+    return (addr >= SOLDIER_FLASH_BASE) &&
+           (addr < (SOLDIER_FLASH_BASE + SOLDIER_FLASH_SIZE));
+}
+
 // =========================================================================
 // АПАРАТНИЙ РЕФЛЕКС РАДІО (Вуха Солдата)
 // =========================================================================
@@ -664,10 +1113,137 @@ void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
         // the ISR is the sole writer and main loop does not read until lora_rx_flag is set.
         memcpy((void*)incoming_lora_payload, payload, size);
         incoming_lora_size = size;
+        incoming_lora_rssi = rssi;
+        incoming_lora_rtc_ms = Rtc_Now_Ms();
         lora_rx_flag = 1;
     }
 }
 
+void OnRxTimeout(void)
+{
+    lora_rx_window_closed = 1;
+}
+
+void OnRxError(void)
+{
+    lora_rx_window_closed = 1; // Бита преамбула / CRC — пакета вже не буде
+}
+
+void OnCadDone(bool channel_activity_detected)
+{
+    lora_cad_busy = channel_activity_detected ? 1 : 0;
+    lora_cad_done = 1;
+}
+
+// Один CAD SX126x (~2 символи). Ядро чекає у SLEEP: SysTick потрібен для
+// страховки LBT_CAD_TIMEOUT_MS. Немає CadDone — вважаємо канал вільним,
+// щоб збій радіо не заблокував телеметрію.
+static uint8_t Radio_Channel_Busy(void)
+{
+    lora_cad_done = 0;
+    lora_cad_busy = 0;
+    Radio.StartCad();
+
+    uint32_t start = HAL_GetTick();
+    while (!lora_cad_done && (HAL_GetTick() - start) < LBT_CAD_TIMEOUT_MS) {
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+    return lora_cad_busy;
+}
+
+// [ОПТИМІЗАЦІЯ Cleartext Header] Блок в ефір: заголовок маршрутизації з
+// відкритого тексту + AES-тіло. Свій блок одразу в seen-set: відлуння від
+// сусідів відсіється без розшифровки.
+static void Mesh_Seal_Block(uint8_t* plain, uint8_t* block)
+{
+    Route_Hdr_From_Body(block, plain);
+    HAL_CRYP_Encrypt(&hcryp, (uint32_t*)plain, 4, (uint32_t*)&block[ROUTE_HDR_SIZE], 1000);
+    Seen_Check_And_Insert(&mesh_seen, block);
+}
+
+// [ОПТИМІЗАЦІЯ LBT] Listen-Before-Talk замість сліпого Radio.Send:
+// CAD → зайнято → випадкова пауза у вікні, що подвоюється (LP_Delay_Ms, STOP2)
+// → знову CAD. Після LBT_MAX_ATTEMPTS кадр іде попри все (forced_tx).
+static void Radio_Send_LBT(uint8_t* buffer, uint8_t size)
+{
+    LBT_Frame_Start(&lbt_state);
+    while (1) {
+        uint32_t rnd = 0;
+        HAL_RNG_GenerateRandomNumber(&hrng, &rnd);
+        Energy_Spend(&energy_state, ENERGY_COST_CAD_UJ);
+
+        uint32_t backoff_ms = LBT_On_Cad(&lbt_state, Radio_Channel_Busy(), rnd);
+        if (backoff_ms == 0) break;
+        HAL_IWDG_Refresh(&hiwdg); // Найгірша серія: 50+100+…+1600 мс ≈ 3.2 с
+        LP_Delay_Ms(backoff_ms);
+    }
+    Radio.Send(buffer, size);
+}
+
+// [ОПТИМІЗАЦІЯ TDMA] Мілісекунди доби з календаря RTC: LSE тікає і в STOP2,
+// HAL_GetTick — ні. Доба = ціле число кадрів TDMA, тож північ фазу не рве.
+static uint32_t Rtc_Now_Ms(void)
+{
+    RTC_TimeTypeDef time;
+    RTC_DateTypeDef date;
+    HAL_RTC_GetTime(&hrtc, &time, RTC_FORMAT_BIN);
+    HAL_RTC_GetDate(&hrtc, &date, RTC_FORMAT_BIN); // Розблоковує тіньові регістри після GetTime
+    uint32_t sub_ms = ((time.SecondFraction - time.SubSeconds) * 1000U) / (time.SecondFraction + 1U);
+    return ((uint32_t)time.Hours * 3600U + (uint32_t)time.Minutes * 60U + time.Seconds) * 1000U + sub_ms;
+}
+
+// Очікування слота до ~9 с: у STOP2 шматками, Сторожовий Пес між ними
+static void Tx_Slot_Wait_Ms(uint32_t ms)
+{
+    while (ms > 0) {
+        uint32_t chunk = ms > SYNC_SLOT_MS ? SYNC_SLOT_MS : ms;
+        HAL_IWDG_Refresh(&hiwdg);
+        LP_Delay_Ms(chunk);
+        ms -= chunk;
+    }
+}
+
+// [ОПТИМІЗАЦІЯ ADR] Модуляція незмінна, змінюється лише потужність підсилювача
+static void Radio_Set_Tx_Power(int8_t power_dbm)
+{
+    Radio.SetTxConfig(MODEM_LORA, power_dbm, 0, LORA_BANDWIDTH, LORA_SPREADING_FACTOR, LORA_CODINGRATE,
+                      LORA_PREAMBLE_LENGTH, false, true, false, 0, false, LORA_TX_TIMEOUT_MS);
+}
+
+// LPTIM1 одноразово: або дедлайн вікна RX (радіо не підняло жодного
+// переривання), або кінець LP_Delay_Ms. Вони не перетинаються в часі,
+// а зайвий прапорець скидається на початку наступного вікна/паузи.
+void HAL_LPTIM_CompareMatchCallback(LPTIM_HandleTypeDef *hlptim)
+{
+    if (hlptim->Instance == LPTIM1) {
+        lora_rx_window_closed = 1;
+        LP_Delay_On_Compare();
+    }
+}
+
+// DR19: [7:0] tx_seq, [23:8] Route_Pack (hop ≤ 0xF лишає вільними [15:12]),
+// [15:12] Chan_Pack, [31:24] acoustic_events (ще не відправлені)
+static uint32_t Bkp_Counters_Word(void)
+{
+    return ((uint32_t)acoustic_events << 24) | ((uint32_t)Route_Pack(&route_state) << 8) |
+           ((uint32_t)Chan_Pack(&chan_state) << 12) | tx_seq;
+}
+
+// Сон ядра у STOP1 на час вікна RX. SUBGHZ Radio IRQ та LPTIM1 (LSE)
+// будять з STOP1; SRAM, регістри радіо та стан циклу зберігаються.
+// Прапорці перевіряються з вимкненими перериваннями: подія, що прийшла
+// між перевіркою та WFI, все одно розбудить ядро (pending IRQ).
+static void Rx_Sleep_Until_Event(void)
+{
+    HAL_SuspendTick();
+    __disable_irq();
+    if (!lora_rx_flag && !lora_rx_window_closed) {
+        HAL_PWREx_EnterSTOP1Mode(PWR_STOPENTRY_WFI);
+    }
+    __enable_irq();
+    HAL_ResumeTick();
+}
+
 // =========================================================================
 // АПАРАТНИЙ РЕФЛЕКС (Голос Дерева)
 // =========================================================================
@@ -686,7 +1262,7 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 void HAL_PWR_PVDCallback(void)
 {
     // 1. Немає часу на математику. Терміново ховаємо дані у вічну пам'ять!
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR0, acoustic_events);
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR19, Bkp_Counters_Word());
 
     // 2. Жорстко вимикаємо всі периферійні пристрої (Радіо)
     Radio.Sleep();
@@ -702,7 +1278,7 @@ void HAL_PWR_PVDCallback(void)
 void Trigger_Emergency_LoRa_TX(void)
 {
     uint8_t panic_payload[16] = {0};
-    uint8_t encrypted_panic[16] = {0};
+    uint8_t encrypted_panic[ROUTE_BLOCK_SIZE] = {0};
 
     // 1. Пакуємо DID дерева
     panic_payload[0] = (uint8_t)(tree_did >> 24);
@@ -714,17 +1290,38 @@ void Trigger_Emergency_LoRa_TX(void)
     panic_payload[7] = 0xFF;
 
     // 3. Збільшуємо TTL до 5, щоб пакет вижив довше і точно дійшов
-    panic_payload[11] = PANIC_TTL;
-
-    // 4. Шифруємо AES-256 і миттєво вистрілюємо
-    HAL_CRYP_Encrypt(&hcryp, (uint32_t*)panic_payload, 4, (uint32_t*)encrypted_panic, 1000);
-    Radio.Send(encrypted_panic, 16);
+    panic_payload[11] = Route_Byte(route_state.hop, PANIC_TTL);
+    panic_payload[14] = tx_seq++; // Кожна паніка — новий кадр для seen-set сусідів
+
+    // 4. Шифруємо AES-256 і вистрілюємо, щойно канал вільний: бензопилу чують
+    // кілька сусідніх дерев одночасно, і сліпі паніки гасять одна одну.
+    // Паніка — завжди на повній потужності, хоч би що радив ADR.
+    // [FIX: TDMA] Паніка слотів не чекає — одразу в ефір через LBT, навіть у
+    // чужий слот: CAD почує власника і відкладе старт на backoff.
+    Mesh_Seal_Block(panic_payload, encrypted_panic);
+    Radio_Set_Tx_Power(ADR_POWER_MAX_DBM);
+    Radio_Send_LBT(encrypted_panic, ROUTE_BLOCK_SIZE);
 
     // 5. Мікро-пауза, щоб радіомодуль встиг фізично випромінити пакет
-    HAL_Delay(100);
+    LP_Delay_Ms(TX_INTERFRAME_GAP_MS);
 
     // 6. Примусово присипляємо радіо, щоб не садити батарею
     Radio.Sleep();
+    Radio_Set_Tx_Power(adr_state.power_dbm);
+}
+
+// =========================================================================
+// МІСТ mruby → C (Біт-точний Атрактор)
+// =========================================================================
+// SilkenNet.attractor_z_q16(seed, temp, acoustic) → Z у Q16.16 (Integer).
+// Жодних алокацій на купі VM: результат завжди вміщується у fixnum.
+static mrb_value mrb_silken_attractor_z_q16(mrb_state *mrb, mrb_value self)
+{
+    mrb_int seed, temp, acoustic;
+    mrb_get_args(mrb, "iii", &seed, &temp, &acoustic);
+
+    int32_t z_q16 = Attractor_Calculate_Z_Q16((uint32_t)seed, (int32_t)temp, (int32_t)acoustic);
+    return mrb_fixnum_value(z_q16);
 }
 
 // =========================================================================
@@ -748,6 +1345,21 @@ static void MX_CRYP_Init(void)
   HAL_CRYP_Init(&hcryp);
 }
 
+// LPTIM1 від LSE: одноразовий compare для вікна RX та LP_Delay_Ms (Створюється CubeMX)
+static void MX_LPTIM1_Init(void)
+{
+  hlptim1.Instance = LPTIM1;
+  hlptim1.Init.Clock.Source = LPTIM_CLOCKSOURCE_APBCLOCK_LPOSC;
+  hlptim1.Init.Clock.Prescaler = LPTIM_PRESCALER_DIV1;
+  hlptim1.Init.Trigger.Source = LPTIM_TRIGSOURCE_SOFTWARE;
+  hlptim1.Init.OutputPolarity = LPTIM_OUTPUTPOLARITY_HIGH;
+  hlptim1.Init.UpdateMode = LPTIM_UPDATE_IMMEDIATE;
+  hlptim1.Init.CounterSource = LPTIM_COUNTERSOURCE_INTERNAL;
+  hlptim1.Init.Input1Source = LPTIM_INPUT1SOURCE_GPIO;
+  hlptim1.Init.Input2Source = LPTIM_INPUT2SOURCE_GPIO;
+  HAL_LPTIM_Init(&hlptim1);
+}
+
 /* USER CODE END 4 */
 
 /**
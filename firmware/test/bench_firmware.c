@@ -0,0 +1,464 @@
+/*
+ * bench_firmware.c — Host benchmark of firmware hot paths (make bench).
+ *
+ * Unlike test_queen_logic.c, nothing here is re-implemented. The Queen half is
+ * firmware/queen/main.c itself, compiled against hal_mock.h (mock/main.h,
+ * mock/radio.h) with its main() renamed. The Soldier half links the modules
+ * firmware/soldier/main.c runs: silken_ota.c, silken_seen.c, silken_crc.c.
+ * HAL_CRYP_* is a memcpy in the mock, so AES is not part of any timing below.
+ *
+ * Workloads:
+ *   queen_cache_hit      Process_And_Cache_Data, full cache, DID already cached
+ *   queen_cache_evict    Process_And_Cache_Data, full cache, new DID → CIFO eviction
+ *   queen_batch_pack     Flush_Cache_To_Rails over 50 entries (pack, pad, IV, CBC)
+ *   queen_cmd_dedup      djb2_hash of a UUID token + Cmd_Dedup_Check, 1 in 4 a retry
+ *   queen_ota_chunk      Handle_CoAP_Command with a 512-byte OTA chunk (CRC16, assembly)
+ *   soldier_ota_chunk    Ota_Rx_Chunk, 93-chunk image joined mid-way, incremental CRC32
+ *   soldier_crc32_1k     Crc32 over the 1 KB OTA buffer
+ *   soldier_mesh_seen    Seen_Check_And_Insert, 1 in 3 blocks a duplicate from another relay
+ *
+ * Each workload runs in batches until BENCH_MIN_NS; the best of BENCH_ROUNDS
+ * rounds is reported, which keeps scheduler noise out. Results go to stdout
+ * and, with --json, to a file. With --baseline the run fails (exit 1) if any
+ * workload is slower than the baseline by more than --tolerance percent.
+ * Baselines are host-specific: refresh with `make bench-baseline` on the
+ * machine that does the comparison.
+ *
+ * A second table reruns each workload with the HAL_MOCK_ACCOUNTING counters
+ * and prints what its HAL calls would cost on target (time on air, UART, AES,
+ * inits), plus one whole flush session through Task_Flush. Host CPU time is
+ * not in it; the modem's own draw is not either.
+ *
+ * Build & run: make -C firmware/test bench
+ */
+#define _POSIX_C_SOURCE 199309L   /* clock_gettime under -std=c11 */
+#define HAL_MOCK_ACCOUNTING
+#define main queen_firmware_main
+#include "../queen/main.c"
+#undef main
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "silken_ota.h"
+#include "silken_seen.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * BENCHMARK PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define BENCH_SEED           0xBE4C2026U
+#define BENCH_MIN_NS         100000000ULL   /* Per round */
+#define BENCH_ROUNDS         5
+#define BENCH_BATCH          256            /* Ops between clock reads */
+#define BENCH_TOLERANCE_PCT  50.0           /* Run-to-run noise on a shared host reaches ~30% */
+#define BENCH_SOLDIERS       1000           /* DIDs behind one Queen */
+#define BENCH_OTA_IMAGE      1023           /* 93 × 11: the largest image OtaRx holds */
+#define BENCH_COST_OPS       1000           /* Ops per row of the modelled-cost table */
+
+typedef struct {
+    const char* name;
+    void (*setup)(void);
+    void (*op)(uint32_t i);
+    double ns_per_op;
+} BenchCase;
+
+static uint32_t rng_state = BENCH_SEED;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * QUEEN: CIFO CACHE AND BATCH PACKING
+ * ════════════════════════════════════════════════════════════════════ */
+#define BENCH_STREAM 4096
+
+static uint32_t stream_did[BENCH_STREAM];
+static int8_t   stream_rssi[BENCH_STREAM];
+static uint8_t  stream_payload[BENCH_STREAM][16];
+static EdgeCache cache_snapshot[CACHE_MAX_ENTRIES];
+
+/* Telemetry payload as the Soldier packs it: DID, bio status in byte 10 */
+static void bench_payload(uint8_t* p, uint32_t did)
+{
+    for (int b = 0; b < 16; b++) p[b] = (uint8_t)rng_next();
+    p[0] = (uint8_t)(did >> 24);
+    p[1] = (uint8_t)(did >> 16);
+    p[2] = (uint8_t)(did >> 8);
+    p[3] = (uint8_t)did;
+    p[10] = (uint8_t)((rng_next() % 10 == 0 ? 2U : 0U) << 6);  /* 10% critical */
+    p[15] = 0;
+}
+
+static void cache_fill(void)
+{
+    memset(forest_cache, 0, sizeof(forest_cache));
+    cache_count = 0;
+    for (uint32_t i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        uint8_t p[16];
+        bench_payload(p, 0x10000000U + i);
+        Process_And_Cache_Data(0x10000000U + i, p, (int8_t)(-60 - (int)(rng_next() % 60)));
+    }
+}
+
+static void setup_cache_hit(void)
+{
+    cache_fill();
+    for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+        stream_did[i] = 0x10000000U + rng_next() % CACHE_MAX_ENTRIES;
+        stream_rssi[i] = (int8_t)(-60 - (int)(rng_next() % 60));
+        bench_payload(stream_payload[i], stream_did[i]);
+    }
+}
+
+static void setup_cache_evict(void)
+{
+    cache_fill();
+    for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+        stream_did[i] = 0x20000000U + rng_next() % BENCH_SOLDIERS;
+        stream_rssi[i] = (int8_t)(-60 - (int)(rng_next() % 60));
+        bench_payload(stream_payload[i], stream_did[i]);
+    }
+}
+
+static void op_cache(uint32_t i)
+{
+    uint32_t k = i % BENCH_STREAM;
+    /* Evict stream: DIDs outside the cache, so a (DID, type) match only comes
+     * from an eviction earlier in the stream — as in a busy cluster */
+    Process_And_Cache_Data(stream_did[k], stream_payload[k], stream_rssi[k]);
+}
+
+static void setup_batch_pack(void)
+{
+    cache_fill();
+    memcpy(cache_snapshot, forest_cache, sizeof(cache_snapshot));
+}
+
+static void op_batch_pack(uint32_t i)
+{
+    (void)i;
+    memcpy(forest_cache, cache_snapshot, sizeof(forest_cache));
+    cache_count = CACHE_MAX_ENTRIES;
+    flush_total = Flush_Cache_To_Rails();
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * QUEEN: COMMAND DEDUP AND OTA DOWNLINK
+ * ════════════════════════════════════════════════════════════════════ */
+static char tokens[BENCH_STREAM][UUID_STR_LEN + 1];
+
+static void setup_cmd_dedup(void)
+{
+    memset(cmd_dedup_ring, 0, sizeof(cmd_dedup_ring));
+    cmd_dedup_idx = 0;
+    cmd_dedup_used = 0;
+    static const char hex[] = "0123456789abcdef";
+    for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+        if (i > 0 && rng_next() % 4 == 0) {           /* Rails retry of a recent command */
+            memcpy(tokens[i], tokens[i - 1 - rng_next() % (i < 8 ? i : 8)], sizeof(tokens[i]));
+            continue;
+        }
+        for (int c = 0; c < UUID_STR_LEN; c++) {
+            tokens[i][c] = (c == 8 || c == 13 || c == 18 || c == 23) ? '-' : hex[rng_next() & 0xF];
+        }
+        tokens[i][UUID_STR_LEN] = '\0';
+    }
+}
+
+static void op_cmd_dedup(uint32_t i)
+{
+    (void)Cmd_Dedup_Check(djb2_hash(tokens[i % BENCH_STREAM], UUID_STR_LEN));
+}
+
+#define BENCH_COAP_CHUNKS 16
+static uint32_t coap_chunk[BENCH_COAP_CHUNKS][(16 + 528) / 4];
+static uint16_t coap_len[BENCH_COAP_CHUNKS];
+
+/* [IV:16][0x99][index:2][total:2][code:512][CRC16:2][zero pad] — the mock
+ * CBC is a copy, so the "ciphertext" is the plaintext */
+static void setup_queen_ota(void)
+{
+    for (uint16_t c = 0; c < BENCH_COAP_CHUNKS; c++) {
+        uint8_t* b = (uint8_t*)coap_chunk[c];
+        memset(b, 0, sizeof(coap_chunk[c]));
+        uint8_t* plain = b + 16;
+        plain[0] = OTA_MARKER;
+        plain[1] = (uint8_t)(c >> 8);
+        plain[2] = (uint8_t)c;
+        plain[3] = 0;
+        plain[4] = BENCH_COAP_CHUNKS;
+        for (int k = 0; k < MAX_OTA_CHUNK_PAYLOAD; k++) plain[5 + k] = (uint8_t)rng_next();
+        uint16_t msg = 5 + MAX_OTA_CHUNK_PAYLOAD;
+        uint16_t crc = Crc16_Ccitt(plain, msg);
+        plain[msg] = (uint8_t)(crc >> 8);
+        plain[msg + 1] = (uint8_t)crc;
+        coap_len[c] = (uint16_t)(16 + ((msg + 2 + 15) / 16) * 16);
+    }
+    ota_chunk_bitmap = 0;
+    ota_chunks_received = 0;
+    ota_total_expected_chunks = 0;
+}
+
+static void op_queen_ota(uint32_t i)
+{
+    uint16_t c = (uint16_t)(i % BENCH_COAP_CHUNKS);
+    Handle_CoAP_Command((uint8_t*)coap_chunk[c], coap_len[c]);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * SOLDIER: OTA REASSEMBLY, CRC32, MESH SEEN-SET
+ * ════════════════════════════════════════════════════════════════════ */
+#define BENCH_LORA_CHUNKS ((BENCH_OTA_IMAGE + 10) / 11)
+
+static OtaRx ota_rx_bench;
+static uint8_t lora_chunk[BENCH_LORA_CHUNKS][16];
+static uint16_t lora_join;
+static uint32_t ota_images_ok;
+
+static void setup_soldier_ota(void)
+{
+    static uint8_t image[BENCH_LORA_CHUNKS * 11];
+    for (uint32_t k = 0; k < BENCH_OTA_IMAGE - 4; k++) image[k] = (uint8_t)rng_next();
+    uint32_t crc = Crc32(image, BENCH_OTA_IMAGE - 4);
+    image[BENCH_OTA_IMAGE - 4] = (uint8_t)(crc >> 24);
+    image[BENCH_OTA_IMAGE - 3] = (uint8_t)(crc >> 16);
+    image[BENCH_OTA_IMAGE - 2] = (uint8_t)(crc >> 8);
+    image[BENCH_OTA_IMAGE - 1] = (uint8_t)crc;
+    for (uint16_t c = 0; c < BENCH_LORA_CHUNKS; c++) {
+        lora_chunk[c][0] = OTA_MARKER;
+        lora_chunk[c][1] = (uint8_t)(c >> 8);
+        lora_chunk[c][2] = (uint8_t)c;
+        lora_chunk[c][3] = 0;
+        lora_chunk[c][4] = BENCH_LORA_CHUNKS;
+        memcpy(&lora_chunk[c][5], &image[c * 11], 11);
+    }
+    Ota_Rx_Init(&ota_rx_bench);
+    lora_join = (uint16_t)(rng_next() % BENCH_LORA_CHUNKS);
+    ota_images_ok = 0;
+}
+
+static void op_soldier_ota(uint32_t i)
+{
+    uint16_t c = (uint16_t)((lora_join + i) % BENCH_LORA_CHUNKS);
+    uint16_t len = 0;
+    if (Ota_Rx_Chunk(&ota_rx_bench, lora_chunk[c], 16, &len) == OTA_RX_COMPLETE) ota_images_ok++;
+}
+
+static uint8_t crc_image[OTA_RX_BUFFER_SIZE];
+static volatile uint32_t crc_sink;
+
+static void setup_crc32(void)
+{
+    for (uint32_t k = 0; k < sizeof(crc_image); k++) crc_image[k] = (uint8_t)rng_next();
+}
+
+static void op_crc32(uint32_t i)
+{
+    (void)i;
+    crc_sink ^= Crc32(crc_image, sizeof(crc_image));
+}
+
+static SeenSet seen_bench;
+static uint8_t seen_blocks[BENCH_STREAM][SEEN_FRAME_SIZE];
+
+static void setup_mesh_seen(void)
+{
+    Seen_Init(&seen_bench);
+    for (uint32_t i = 0; i < BENCH_STREAM; i++) {
+        if (i > 0 && rng_next() % 3 == 0) {
+            memcpy(seen_blocks[i], seen_blocks[i - 1], SEEN_FRAME_SIZE);
+            seen_blocks[i][SEEN_TTL_OFFSET] ^= 0x11;    /* Another relay: other Hop|TTL */
+            continue;
+        }
+        for (int b = 0; b < SEEN_FRAME_SIZE; b++) seen_blocks[i][b] = (uint8_t)rng_next();
+    }
+}
+
+static void op_mesh_seen(uint32_t i)
+{
+    (void)Seen_Check_And_Insert(&seen_bench, seen_blocks[i % BENCH_STREAM]);
+    if (i % 64 == 63) Seen_Age(&seen_bench, 600);     /* A wake's worth of blocks, then sleep */
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * RUNNER
+ * ════════════════════════════════════════════════════════════════════ */
+static BenchCase cases[] = {
+    { "queen_cache_hit",   setup_cache_hit,   op_cache,       0 },
+    { "queen_cache_evict", setup_cache_evict, op_cache,       0 },
+    { "queen_batch_pack",  setup_batch_pack,  op_batch_pack,  0 },
+    { "queen_cmd_dedup",   setup_cmd_dedup,   op_cmd_dedup,   0 },
+    { "queen_ota_chunk",   setup_queen_ota,   op_queen_ota,   0 },
+    { "soldier_ota_chunk", setup_soldier_ota, op_soldier_ota, 0 },
+    { "soldier_crc32_1k",  setup_crc32,       op_crc32,       0 },
+    { "soldier_mesh_seen", setup_mesh_seen,   op_mesh_seen,   0 },
+};
+#define BENCH_CASES (sizeof(cases) / sizeof(cases[0]))
+
+static double run_case(BenchCase* c)
+{
+    double best = 0;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        c->setup();
+        uint64_t ops = 0, t0 = now_ns(), t;
+        do {
+            for (uint32_t k = 0; k < BENCH_BATCH; k++) c->op((uint32_t)(ops + k));
+            ops += BENCH_BATCH;
+            t = now_ns() - t0;
+        } while (t < BENCH_MIN_NS);
+        double ns = (double)t / (double)ops;
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+/* One Task_Flush session of a full cache; the scheduler's timers between
+ * the steps are spent in SLEEP */
+static void cost_flush_session(void)
+{
+    cache_fill();
+    flush_step = FLUSH_IDLE;
+    Task_Flush(EV_FLUSH_START, HAL_GetTick());
+    while (flush_step != FLUSH_IDLE) {
+        if (flush_step == FLUSH_SEND) {
+            Task_Flush(EV_FLUSH_STEP, HAL_GetTick());
+            continue;
+        }
+        Hal_Cost_Idle(flush_step == FLUSH_OPEN ? FLUSH_OPEN_MS :
+                      flush_step == FLUSH_ACK  ? FLUSH_ACK_MS : FLUSH_CLOSE_MS);
+        Task_Flush(SCHED_EV_TIMER, HAL_GetTick());
+    }
+}
+
+static int write_json(const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return 0;
+    }
+    fprintf(f, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < BENCH_CASES; i++) {
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.2f, \"ops_per_s\": %.0f}%s\n",
+                cases[i].name, cases[i].ns_per_op, 1e9 / cases[i].ns_per_op,
+                i + 1 < BENCH_CASES ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return 1;
+}
+
+/* Reads the ns_per_op of one workload from a file written by write_json */
+static int baseline_ns(const char* path, const char* name, double* ns)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    char line[256], key[64];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        const char* p = strstr(line, "\"name\":");
+        if (p && sscanf(p, "\"name\": \"%63[^\"]\", \"ns_per_op\": %lf", key, ns) == 2 &&
+            strcmp(key, name) == 0) {
+            found = 1;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+int main(int argc, char** argv)
+{
+    const char* json = NULL;
+    const char* baseline = NULL;
+    double tolerance = BENCH_TOLERANCE_PCT;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--json") == 0 && a + 1 < argc) {
+            json = argv[++a];
+        } else if (strcmp(argv[a], "--baseline") == 0 && a + 1 < argc) {
+            baseline = argv[++a];
+        } else if (strcmp(argv[a], "--tolerance") == 0 && a + 1 < argc) {
+            tolerance = atof(argv[++a]);
+        } else {
+            fprintf(stderr, "usage: %s [--json out.json] [--baseline base.json] [--tolerance pct]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Crc_Init();
+    Keys_Init(&key_cache, NULL, 0, aes_key);
+
+    printf("\n⏱️  Firmware Hot Paths (host, mock HAL, best of %d rounds)\n", BENCH_ROUNDS);
+    printf("══════════════════════════════════════════════════════════════\n");
+    printf("  %-20s %12s %14s %12s %10s\n", "workload", "ns/op", "ops/s", "baseline", "change");
+
+    int regressions = 0, missing_baseline = 0;
+    for (size_t i = 0; i < BENCH_CASES; i++) {
+        cases[i].ns_per_op = run_case(&cases[i]);
+        printf("  %-20s %12.2f %14.0f", cases[i].name, cases[i].ns_per_op, 1e9 / cases[i].ns_per_op);
+
+        double base = 0;
+        int have = baseline ? baseline_ns(baseline, cases[i].name, &base) : 0;
+        if (have == 1 && base > 0) {
+            double change = 100.0 * (cases[i].ns_per_op - base) / base;
+            int slow = change > tolerance;
+            regressions += slow;
+            printf(" %12.2f %+9.1f%%%s\n", base, change, slow ? "  ❌ REGRESSION" : "");
+        } else {
+            missing_baseline += (baseline != NULL);
+            printf(" %12s %10s\n", "—", "");
+        }
+    }
+
+    /* A workload that never reaches its last step times only the rejections */
+    if (!ota_is_active || ota_images_ok == 0) {
+        printf("\n  ❌ %s never completed an image — the workload is broken\n",
+               !ota_is_active ? "queen_ota_chunk" : "soldier_ota_chunk");
+        return 1;
+    }
+
+    printf("\n🔋 Modelled on target (hal_mock accounting, %u ops per workload)\n", BENCH_COST_OPS);
+    printf("══════════════════════════════════════════════════════════════\n");
+    Hal_Cost_Report_Header();
+    for (size_t i = 0; i < BENCH_CASES; i++) {
+        cases[i].setup();
+        Hal_Cost_Reset();
+        for (uint32_t k = 0; k < BENCH_COST_OPS; k++) cases[i].op(k);
+        Hal_Cost_Report(cases[i].name, BENCH_COST_OPS);
+    }
+    Hal_Cost_Reset();
+    cost_flush_session();
+    Hal_Cost_Report("queen_flush_session", 1);
+
+    if (json && !write_json(json)) return 1;
+    if (json) printf("\n  Results written to %s\n", json);
+
+    if (baseline) {
+        double probe;
+        if (baseline_ns(baseline, cases[0].name, &probe) < 0) {
+            printf("  No baseline at %s — run `make bench-baseline` first\n", baseline);
+            return 0;
+        }
+        if (missing_baseline) {
+            printf("  %d workload(s) missing from %s — refresh with `make bench-baseline`\n",
+                   missing_baseline, baseline);
+        }
+        if (regressions) {
+            printf("\n  ❌ %d workload(s) slower than %s by more than %.0f%%\n", regressions, baseline, tolerance);
+            return 1;
+        }
+        printf("  ✅ No workload slower than the baseline by more than %.0f%%\n", tolerance);
+    }
+    return 0;
+}
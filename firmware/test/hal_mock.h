@@ -4,6 +4,13 @@
  * This header provides just enough type definitions and function stubs
  * so that firmware logic can be compiled with gcc on x86/x64.
  * Only pure-logic functions are tested — no hardware interaction.
+ *
+ * Cost accounting (opt-in): #define HAL_MOCK_ACCOUNTING before including this
+ * header and the stubs charge what the call would cost on target to hal_cost:
+ * a virtual clock (HAL_GetTick reads it), LoRa time on air per Radio.Send,
+ * UART bytes at uart_baud, AES blocks and peripheral inits, each with a
+ * current draw from hal_cost_profile. CPU time between HAL calls is not on
+ * the clock. Hal_Cost_Report prints wall time and mJ per operation.
  */
 #ifndef HAL_MOCK_H
 #define HAL_MOCK_H
@@ -26,9 +33,25 @@ typedef struct {
 } RNG_HandleTypeDef;
 typedef struct { int dummy; } RTC_HandleTypeDef;
 typedef struct { int dummy; } SUBGHZ_HandleTypeDef;
-typedef struct { int dummy; } UART_HandleTypeDef;
+typedef struct {
+    void* Instance;
+    int dummy;
+} UART_HandleTypeDef;
 typedef struct { int dummy; } PWR_PVDTypeDef;
 
+typedef struct {
+    void* Instance;
+    struct {
+        struct { int Source; int Prescaler; } Clock;
+        struct { int Source; } Trigger;
+        int OutputPolarity;
+        int UpdateMode;
+        int CounterSource;
+        int Input1Source;
+        int Input2Source;
+    } Init;
+} LPTIM_HandleTypeDef;
+
 typedef struct {
     void* Instance;
     struct {
@@ -42,6 +65,9 @@ typedef struct {
 
 /* ── Constants ─────────────────────────────────────────────────────── */
 #define RNG             ((void*)0x58001000UL) /* RNG peripheral base (mock) */
+#define AES             ((void*)0x58001800UL)
+#define LPTIM1          ((void*)0x40007C00UL)
+#define USART1          ((void*)0x40013800UL)
 #define CRYP_DATATYPE_32B   0
 #define CRYP_KEYSIZE_256B   1
 #define CRYP_AES_ECB        0
@@ -53,6 +79,15 @@ typedef struct {
 #define PWR_SLEEPENTRY_WFI          0
 #define PWR_STOPENTRY_WFI           0
 
+#define LPTIM_CLOCKSOURCE_APBCLOCK_LPOSC 0
+#define LPTIM_PRESCALER_DIV1        0
+#define LPTIM_TRIGSOURCE_SOFTWARE   0
+#define LPTIM_OUTPUTPOLARITY_HIGH   0
+#define LPTIM_UPDATE_IMMEDIATE      0
+#define LPTIM_COUNTERSOURCE_INTERNAL 0
+#define LPTIM_INPUT1SOURCE_GPIO     0
+#define LPTIM_INPUT2SOURCE_GPIO     0
+
 #define GPIO_PIN_0      0x0001
 #define LL_ADC_RESOLUTION_12B 12
 
@@ -73,28 +108,143 @@ typedef struct {
 #define RTC_BKP_DR13 13
 #define RTC_BKP_DR14 14
 #define RTC_BKP_DR15 15
+#define RTC_BKP_DR16 16
+#define RTC_BKP_DR17 17
+#define RTC_BKP_DR18 18
+#define RTC_BKP_DR19 19
+
+/* ── Cost accounting (HAL_MOCK_ACCOUNTING) ────────────────────────── */
+#ifdef HAL_MOCK_ACCOUNTING
+#include <stdio.h>
+
+typedef enum {
+    HAL_COST_DELAY = 0,   /* HAL_Delay: the core spins in Run */
+    HAL_COST_SLEEP,       /* LP_Delay_Ms < 5 ms (LPDELAY_STOP2_MIN_MS), LP_Delay_Sleep_Ms, Hal_Cost_Idle */
+    HAL_COST_STOP2,       /* LP_Delay_Ms ≥ 5 ms */
+    HAL_COST_RADIO_TX,    /* Radio.Send: time on air */
+    HAL_COST_UART,        /* HAL_UART_Transmit: 10 bits per byte, polled */
+    HAL_COST_CRYPTO,      /* HAL_CRYP_Encrypt/Decrypt: per 16-byte block */
+    HAL_COST_INIT,        /* HAL_Init, MX_*_Init, HAL_*_Init: per call */
+    HAL_COST_KINDS
+} HalCostKind;
+
+typedef struct {
+    uint32_t supply_mv;
+    uint32_t draw_ua[HAL_COST_KINDS];  /* Whole-board current while it lasts */
+    uint8_t  lora_sf;                  /* 7..12 */
+    uint32_t lora_bw_hz;
+    uint8_t  lora_cr;                  /* 1..4 → 4/5..4/8 */
+    uint16_t lora_preamble;
+    uint8_t  lora_crc_on;
+    uint8_t  lora_implicit_header;
+    uint32_t uart_baud;
+    uint32_t crypto_block_ns;
+    uint32_t init_ns;
+} HalCostProfile;
+
+/* SF7/125 kHz as silken_sync.h; TX draw from ENERGY_COST_RELAY_BLOCK_UJ
+ * (4 mJ per 29 ms at 3.3 V), STOP2 from ENERGY_P_SLEEP_UW, Run ~3.5 mA at
+ * 48 MHz (silken_lpdelay.h); AES and init times are order-of-magnitude */
+#define HAL_COST_PROFILE_DEFAULT { \
+    .supply_mv = 3300, \
+    .draw_ua = { [HAL_COST_DELAY] = 3500, [HAL_COST_SLEEP] = 1000, \
+                 [HAL_COST_STOP2] = 2, [HAL_COST_RADIO_TX] = 42000, \
+                 [HAL_COST_UART] = 3500, [HAL_COST_CRYPTO] = 3800, \
+                 [HAL_COST_INIT] = 3500 }, \
+    .lora_sf = 7, .lora_bw_hz = 125000, .lora_cr = 1, .lora_preamble = 8, \
+    .lora_crc_on = 1, .lora_implicit_header = 0, \
+    .uart_baud = 115200, .crypto_block_ns = 2000, .init_ns = 50000 }
+
+typedef struct {
+    uint64_t clock_ns;                 /* Virtual clock, HAL_GetTick = clock_ns / 1e6 */
+    uint64_t ns[HAL_COST_KINDS];
+    uint32_t calls[HAL_COST_KINDS];
+    uint32_t units[HAL_COST_KINDS];    /* Bytes on air / UART, AES blocks */
+} HalCost;
+
+static HalCostProfile hal_cost_profile = HAL_COST_PROFILE_DEFAULT;
+static HalCost hal_cost;
+
+static inline void Hal_Cost_Reset(void) { memset(&hal_cost, 0, sizeof(hal_cost)); }
+
+static inline void hal_cost_charge(HalCostKind kind, uint64_t ns, uint32_t units)
+{
+    hal_cost.clock_ns += ns;
+    hal_cost.ns[kind] += ns;
+    hal_cost.calls[kind]++;
+    hal_cost.units[kind] += units;
+}
+
+/* Semtech AN1200.13 time on air, SF7-12 (LDRO from 16 ms symbols) */
+static inline uint32_t Hal_Cost_Airtime_Us(uint8_t size)
+{
+    const HalCostProfile* p = &hal_cost_profile;
+    uint32_t sym_us = (uint32_t)(((uint64_t)1000000 << p->lora_sf) / p->lora_bw_hz);
+    int32_t ldro = sym_us >= 16384;
+    int32_t num = 8 * size - 4 * p->lora_sf + 28 + 16 * p->lora_crc_on - 20 * p->lora_implicit_header;
+    int32_t den = 4 * (p->lora_sf - 2 * ldro);
+    int32_t n = num > 0 ? (num + den - 1) / den : 0;
+    uint32_t symbols_x4 = 4U * p->lora_preamble + 17U + 4U * (8U + (uint32_t)n * (p->lora_cr + 4U));
+    return (uint32_t)((uint64_t)symbols_x4 * sym_us / 4U);
+}
+
+/* For harnesses that stand in for the scheduler: time the core spends in SLEEP */
+static inline void Hal_Cost_Idle(uint32_t ms) { hal_cost_charge(HAL_COST_SLEEP, (uint64_t)ms * 1000000U, 0); }
+
+static inline double Hal_Cost_Energy_MJ(void)
+{
+    double nj = 0; /* ns × µA × mV = 1e-18 J */
+    for (int k = 0; k < HAL_COST_KINDS; k++) {
+        nj += (double)hal_cost.ns[k] * hal_cost_profile.draw_ua[k] * hal_cost_profile.supply_mv * 1e-9;
+    }
+    return nj * 1e-6;
+}
+
+static inline void Hal_Cost_Report_Header(void)
+{
+    printf("  %-20s %12s %12s %10s %10s %8s %6s\n",
+           "operation", "ms/op", "mJ/op", "air B/op", "uart B/op", "aes/op", "init");
+}
+
+static inline void Hal_Cost_Report(const char* label, uint32_t ops)
+{
+    double n = ops ? (double)ops : 1.0;
+    printf("  %-20s %12.3f %12.5f %10.1f %10.1f %8.1f %6.1f\n", label,
+           (double)hal_cost.clock_ns / 1e6 / n, Hal_Cost_Energy_MJ() / n,
+           hal_cost.units[HAL_COST_RADIO_TX] / n, hal_cost.units[HAL_COST_UART] / n,
+           hal_cost.units[HAL_COST_CRYPTO] / n, hal_cost.calls[HAL_COST_INIT] / n);
+}
+
+#define HAL_COST_CHARGE(kind, ns, units) hal_cost_charge((kind), (ns), (units))
+#define HAL_COST_TICK()                  ((uint32_t)(hal_cost.clock_ns / 1000000U))
+#define HAL_COST_INIT_CALL()             hal_cost_charge(HAL_COST_INIT, hal_cost_profile.init_ns, 0)
+#else
+#define HAL_COST_CHARGE(kind, ns, units) ((void)0)
+#define HAL_COST_TICK()                  0U
+#define HAL_COST_INIT_CALL()             ((void)0)
+#endif
 
 /* ── Stub functions (no-ops) ───────────────────────────────────────── */
-static inline int  HAL_Init(void) { return HAL_OK; }
+static inline int  HAL_Init(void) { HAL_COST_INIT_CALL(); return HAL_OK; }
 static inline void SystemClock_Config(void) {}
-static inline void MX_GPIO_Init(void) {}
-static inline void MX_ADC_Init(void) {}
-static inline void MX_TIM2_Init(void) {}
-static inline void MX_IWDG_Init(void) {}
-static inline void MX_RNG_Init(void) {}
-static inline void MX_RTC_Init(void) {}
-static inline void MX_SUBGHZ_Init(void) {}
-static inline void MX_USART1_UART_Init(void) {}
-static inline int  HAL_CRYP_Init(CRYP_HandleTypeDef *h) { (void)h; return HAL_OK; }
-static inline int  HAL_RNG_Init(RNG_HandleTypeDef *h) { (void)h; return HAL_OK; }
+static inline void MX_GPIO_Init(void) { HAL_COST_INIT_CALL(); }
+static inline void MX_ADC_Init(void) { HAL_COST_INIT_CALL(); }
+static inline void MX_TIM2_Init(void) { HAL_COST_INIT_CALL(); }
+static inline void MX_IWDG_Init(void) { HAL_COST_INIT_CALL(); }
+static inline void MX_RNG_Init(void) { HAL_COST_INIT_CALL(); }
+static inline void MX_RTC_Init(void) { HAL_COST_INIT_CALL(); }
+static inline void MX_SUBGHZ_Init(void) { HAL_COST_INIT_CALL(); }
+static inline void MX_USART1_UART_Init(void) { HAL_COST_INIT_CALL(); }
+static inline int  HAL_CRYP_Init(CRYP_HandleTypeDef *h) { (void)h; HAL_COST_INIT_CALL(); return HAL_OK; }
+static inline int  HAL_RNG_Init(RNG_HandleTypeDef *h) { (void)h; HAL_COST_INIT_CALL(); return HAL_OK; }
 static inline int  HAL_RNG_DeInit(RNG_HandleTypeDef *h) { (void)h; return HAL_OK; }
 
 /* RCC clock control stubs (for peripheral power management) */
 #define __HAL_RCC_CRYP_CLK_DISABLE() ((void)0)
 #define __HAL_RCC_CRYP_CLK_ENABLE()  ((void)0)
 
-static inline void HAL_Delay(uint32_t ms) { (void)ms; }
-static inline uint32_t HAL_GetTick(void) { return 0; }
+static inline void HAL_Delay(uint32_t ms) { (void)ms; HAL_COST_CHARGE(HAL_COST_DELAY, (uint64_t)ms * 1000000U, 0); }
+static inline uint32_t HAL_GetTick(void) { return HAL_COST_TICK(); }
 
 static inline void HAL_PWR_ConfigPVD(PWR_PVDTypeDef *c) { (void)c; }
 static inline void HAL_PWR_EnablePVD(void) {}
@@ -127,43 +277,75 @@ static inline int HAL_CRYP_Encrypt(CRYP_HandleTypeDef *h, uint32_t *in, uint16_t
                                     uint32_t *out, uint32_t to) {
     (void)h; (void)to;
     memcpy(out, in, sz * 4);
+    HAL_COST_CHARGE(HAL_COST_CRYPTO, (uint64_t)sz / 4U * hal_cost_profile.crypto_block_ns, sz / 4U);
     return HAL_OK;
 }
 static inline int HAL_CRYP_Decrypt(CRYP_HandleTypeDef *h, uint32_t *in, uint16_t sz,
                                     uint32_t *out, uint32_t to) {
     (void)h; (void)to;
     memcpy(out, in, sz * 4);
+    HAL_COST_CHARGE(HAL_COST_CRYPTO, (uint64_t)sz / 4U * hal_cost_profile.crypto_block_ns, sz / 4U);
     return HAL_OK;
 }
 
 static inline int HAL_UART_Transmit(UART_HandleTypeDef *h, uint8_t *d, uint16_t s, uint32_t t) {
-    (void)h; (void)d; (void)s; (void)t; return HAL_OK;
+    (void)h; (void)d; (void)s; (void)t;
+    HAL_COST_CHARGE(HAL_COST_UART, (uint64_t)s * 10U * 1000000000U / hal_cost_profile.uart_baud, s);
+    return HAL_OK;
+}
+static inline int HAL_UART_Receive_IT(UART_HandleTypeDef *h, uint8_t *d, uint16_t s) {
+    (void)h; (void)d; (void)s; return HAL_OK;
 }
 
+static inline int HAL_LPTIM_Init(LPTIM_HandleTypeDef *h) { (void)h; HAL_COST_INIT_CALL(); return HAL_OK; }
+
+/* LP_Delay (firmware/common/silken_lpdelay.c) is Cortex-M only */
+static inline void LP_Delay_Init(LPTIM_HandleTypeDef *h) { (void)h; }
+static inline void LP_Delay_Ms(uint32_t ms) {
+    (void)ms;
+    HAL_COST_CHARGE(ms < 5U ? HAL_COST_SLEEP : HAL_COST_STOP2, (uint64_t)ms * 1000000U, 0);
+}
+static inline void LP_Delay_Sleep_Ms(uint32_t ms) {
+    (void)ms;
+    HAL_COST_CHARGE(HAL_COST_SLEEP, (uint64_t)ms * 1000000U, 0);
+}
+static inline void LP_Delay_On_Compare(void) {}
+
 /* Temperature macro stub */
 #define __LL_ADC_CALC_TEMPERATURE(vref, raw, res) ((int)(25 + ((raw - 1000) / 10)))
 
 /* Radio driver stub */
+typedef enum { MODEM_FSK = 0, MODEM_LORA } RadioModems_t;
+
 typedef struct {
     void (*Init)(void*);
     void (*SetChannel)(uint32_t);
     void (*Send)(uint8_t*, uint8_t);
     void (*Rx)(uint32_t);
     void (*Sleep)(void);
+    void (*Standby)(void);
+    int16_t (*Rssi)(RadioModems_t);
 } RadioDriver_t;
 
 static inline void radio_init_stub(void* p) { (void)p; }
 static inline void radio_set_channel_stub(uint32_t f) { (void)f; }
-static inline void radio_send_stub(uint8_t *b, uint8_t s) { (void)b; (void)s; }
+static inline void radio_send_stub(uint8_t *b, uint8_t s) {
+    (void)b; (void)s;
+    HAL_COST_CHARGE(HAL_COST_RADIO_TX, (uint64_t)Hal_Cost_Airtime_Us(s) * 1000U, s);
+}
 static inline void radio_rx_stub(uint32_t t) { (void)t; }
 static inline void radio_sleep_stub(void) {}
+static inline void radio_standby_stub(void) {}
+static inline int16_t radio_rssi_stub(RadioModems_t m) { (void)m; return -120; }
 
 static RadioDriver_t Radio = {
     .Init = radio_init_stub,
     .SetChannel = radio_set_channel_stub,
     .Send = radio_send_stub,
     .Rx = radio_rx_stub,
-    .Sleep = radio_sleep_stub
+    .Sleep = radio_sleep_stub,
+    .Standby = radio_standby_stub,
+    .Rssi = radio_rssi_stub
 };
 
 /* System reset stub */
@@ -175,6 +357,6 @@ static inline void NVIC_SystemReset(void) {}
 #define __enable_irq()  ((void)0)
 
 /* Flash stubs for OTA */
-static inline void Write_OTA_Contract_To_Flash(uint8_t* d, uint16_t s) { (void)d; (void)s; }
+static inline void Write_OTA_Contract_To_Flash(uint32_t a, uint8_t* d, uint16_t s) { (void)a; (void)d; (void)s; }
 
 #endif /* HAL_MOCK_H */
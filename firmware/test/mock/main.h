@@ -0,0 +1,10 @@
+/*
+ * mock/main.h — Stands in for the CubeMX main.h when a firmware main.c is
+ * compiled on the host (make bench): everything comes from hal_mock.h.
+ */
+#ifndef MOCK_MAIN_H
+#define MOCK_MAIN_H
+
+#include "hal_mock.h"
+
+#endif /* MOCK_MAIN_H */
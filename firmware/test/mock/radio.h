@@ -0,0 +1,10 @@
+/*
+ * mock/radio.h — Stands in for the SubGHz_Phy radio.h on the host (make bench):
+ * the Radio driver stub lives in hal_mock.h.
+ */
+#ifndef MOCK_RADIO_H
+#define MOCK_RADIO_H
+
+#include "hal_mock.h"
+
+#endif /* MOCK_RADIO_H */
@@ -0,0 +1,370 @@
+/*
+ * sim_chan.c — Host simulation of Queen capacity vs the number of EU868 channels.
+ *
+ * A dense forest: SIM_GRID × SIM_GRID Queens, SIM_SPACING_KM apart, each with N
+ * direct Soldiers scattered within SIM_CLUSTER_KM. A Soldier's frame corrupts
+ * reception at every Queen within SIM_INTERFERE_KM on the same channel, so on a
+ * single channel a Queen also carries its neighbours' traffic. Soldiers hear each
+ * other's CAD within SIM_SENSE_KM (farther pairs are hidden).
+ *
+ * Queens boot one by one in random order. Each runs the real channel survey
+ * (firmware/common/silken_chan.c) over the first C channels of the plan: RSSI
+ * samples are busy with the airtime share of the clusters already running on that
+ * channel within earshot. Its Soldiers then transmit on the chosen channel with
+ * jitter + LBT (firmware/common/silken_lbt.c) — the random access that every
+ * Soldier without a TDMA slot uses. Frames overlapping at a Queen on its channel
+ * are both lost (no capture effect).
+ *
+ * For each C the sim grows N in steps of SIM_N_STEP and reports the largest N at
+ * which every Queen still delivers ≥ SIM_TARGET_PCT of its Soldiers' frames
+ * ("sustainable Soldiers per Queen"). An isolated Queen (no neighbours) is the
+ * ceiling no channel plan can beat.
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "silken_lbt.h"
+#include "silken_chan.h"
+#include "silken_sync.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_GRID             3
+#define SIM_QUEENS           (SIM_GRID * SIM_GRID)
+#define SIM_SPACING_KM       1.0
+#define SIM_CLUSTER_KM       0.5      /* Direct Soldiers around their Queen */
+#define SIM_INTERFERE_KM     1.6      /* Same-channel frame still corrupts reception */
+#define SIM_SENSE_KM         0.7      /* CAD detects a neighbour's preamble */
+#define SIM_N_MAX            400
+#define SIM_N_STEP           10
+#define SIM_TARGET_PCT       95.0
+#define SIM_SEED             0xC4A11E5DU
+#define SIM_HOURS            2
+#define SIM_PERIOD_MIN_S     60       /* ENERGY_SLEEP_MIN_S */
+#define SIM_PERIOD_SPAN_S    241
+#define SIM_MAX_BLOCKS       4        /* RBE_BATCH_READINGS */
+#define SIM_JITTER_MAX_MS    500      /* TX_JITTER_MAX_MS in soldier/main.c */
+#define SIM_CAD_MS           2
+#define SIM_TURNAROUND_MS    1
+#define SIM_TX_RING          8192
+#define SIM_ISOLATED_SCALE   100.0    /* Isolated: Queens far beyond earshot */
+#define SIM_TWO_PI           6.283185307179586
+
+#define SIM_MAX_SOLDIERS     (SIM_QUEENS * SIM_N_MAX)
+
+typedef struct {
+    double   x, y;
+    int      queen;
+    uint8_t  ch;
+    uint32_t period_ms;
+    double   wake_ms;
+    double   next_ms;
+    uint8_t  in_cad;           /* 0 — next event is a wake, 1 — a CAD */
+    uint8_t  blocks;
+    LbtState lbt;
+} SimSoldier;
+
+typedef struct {
+    double  x, y;
+    uint8_t ch;
+    uint8_t up;
+    uint64_t frames, delivered;
+} SimQueen;
+
+typedef struct {
+    double  start_ms, end_ms;
+    int     soldier;
+    uint8_t ch;
+} SimTx;
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: deterministic across hosts */
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static double rng_unit(void)
+{
+    return (double)(rng_next() >> 8) / 16777216.0;
+}
+
+static SimQueen   queens[SIM_QUEENS];
+static SimSoldier soldiers[SIM_MAX_SOLDIERS];
+static int        heap[SIM_MAX_SOLDIERS];
+static int        heap_len;
+static SimTx      tx_ring[SIM_TX_RING];
+static uint32_t   tx_count;
+
+static double dist(double ax, double ay, double bx, double by)
+{
+    return sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by));
+}
+
+/* Mean airtime of a 1…SIM_MAX_BLOCKS batch */
+static double mean_airtime_ms(void)
+{
+    double sum = 0.0;
+    for (uint16_t b = 1; b <= SIM_MAX_BLOCKS; b++) sum += Sync_Airtime_Ms((uint16_t)(b * 20U));
+    return sum / SIM_MAX_BLOCKS;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * EVENT QUEUE (binary min-heap of Soldiers by next_ms)
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void heap_swap(int a, int b)
+{
+    int t = heap[a];
+    heap[a] = heap[b];
+    heap[b] = t;
+}
+
+static void heap_down(int i)
+{
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < heap_len && soldiers[heap[l]].next_ms < soldiers[heap[m]].next_ms) m = l;
+        if (r < heap_len && soldiers[heap[r]].next_ms < soldiers[heap[m]].next_ms) m = r;
+        if (m == i) return;
+        heap_swap(i, m);
+        i = m;
+    }
+}
+
+static void heap_build(int n)
+{
+    heap_len = n;
+    for (int i = 0; i < n; i++) heap[i] = i;
+    for (int i = n / 2 - 1; i >= 0; i--) heap_down(i);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * FOREST
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void build_forest(int n, uint8_t channels, uint8_t isolated)
+{
+    int total = 0;
+    for (int q = 0; q < SIM_QUEENS; q++) {
+        double spacing = SIM_SPACING_KM * (isolated ? SIM_ISOLATED_SCALE : 1.0);
+        queens[q].x = (q % SIM_GRID) * spacing;
+        queens[q].y = (q / SIM_GRID) * spacing;
+        queens[q].up = 0;
+        queens[q].frames = queens[q].delivered = 0;
+        for (int i = 0; i < n; i++, total++) {
+            SimSoldier* s = &soldiers[total];
+            double r = SIM_CLUSTER_KM * sqrt(rng_unit());
+            double a = SIM_TWO_PI * rng_unit();
+            s->x = queens[q].x + r * cos(a);
+            s->y = queens[q].y + r * sin(a);
+            s->queen = q;
+            s->period_ms = (SIM_PERIOD_MIN_S + rng_next() % SIM_PERIOD_SPAN_S) * 1000U;
+            s->next_ms = (double)(rng_next() % s->period_ms);
+            s->in_cad = 0;
+            LBT_Init(&s->lbt);
+        }
+    }
+
+    /* Queens boot in random order; each surveys the clusters already on air.
+     * The survey draws from its own stream: traffic is the same for every C. */
+    uint32_t traffic_rng = rng_state;
+    rng_state ^= 0x9E3779B9U * channels;
+    int order[SIM_QUEENS];
+    for (int q = 0; q < SIM_QUEENS; q++) order[q] = q;
+    for (int q = SIM_QUEENS - 1; q > 0; q--) {
+        int k = (int)(rng_next() % (uint32_t)(q + 1));
+        int t = order[q];
+        order[q] = order[k];
+        order[k] = t;
+    }
+    double duty_per_soldier = mean_airtime_ms() / ((SIM_PERIOD_MIN_S + SIM_PERIOD_SPAN_S / 2.0) * 1000.0);
+    for (int b = 0; b < SIM_QUEENS; b++) {
+        SimQueen* me = &queens[order[b]];
+        double occupancy[CHAN_COUNT] = {0};
+        for (int i = 0; i < total; i++) {
+            const SimQueen* owner = &queens[soldiers[i].queen];
+            if (owner->up && dist(soldiers[i].x, soldiers[i].y, me->x, me->y) <= SIM_INTERFERE_KM) {
+                occupancy[owner->ch] += duty_per_soldier;
+            }
+        }
+        ChanSurvey survey;
+        char uid[24];
+        Chan_Survey_Init(&survey);
+        for (uint8_t ch = 0; ch < channels; ch++) {
+            for (int k = 0; k < CHAN_SURVEY_SAMPLES; k++) {
+                Chan_Survey_Add(&survey, ch, (int16_t)(rng_unit() < occupancy[ch] ? -95 : -118));
+            }
+        }
+        snprintf(uid, sizeof(uid), "QUEEN-%03d", order[b] + 1);
+        me->ch = Chan_Survey_Pick(&survey, Chan_Home(uid, channels), channels);
+        me->up = 1;
+    }
+    for (int i = 0; i < total; i++) {
+        soldiers[i].ch = queens[soldiers[i].queen].ch;
+    }
+    rng_state = traffic_rng;
+    tx_count = 0;
+    heap_build(total);
+}
+
+/* A transmission on ch overlapping [start, end] within range of (x, y) */
+static uint8_t heard_on_air(uint8_t ch, double x, double y, double range, double start, double end, int self)
+{
+    for (uint32_t k = tx_count; k > 0 && tx_count - k < SIM_TX_RING; k--) {
+        const SimTx* tx = &tx_ring[(k - 1) % SIM_TX_RING];
+        if (tx->end_ms + 2000.0 < start) break; /* Older frames ended long ago */
+        if (tx->ch != ch || tx->soldier == self) continue;
+        if (tx->start_ms >= end || tx->end_ms <= start) continue;
+        const SimSoldier* o = &soldiers[tx->soldier];
+        if (dist(o->x, o->y, x, y) <= range) return 1;
+    }
+    return 0;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * RUN
+ * ════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    double worst_pct, mean_pct;
+    int    distinct;
+} SimResult;
+
+/* Delivery of frames that ended before t (all their interferers have started) */
+typedef struct {
+    double start, end;
+    int    soldier;
+} SimPending;
+
+static SimPending pending[SIM_TX_RING];
+static uint32_t   pending_head, pending_tail;
+
+static void settle(double t)
+{
+    while (pending_head != pending_tail && pending[pending_head % SIM_TX_RING].end + 1.0 < t) {
+        const SimPending* p = &pending[pending_head++ % SIM_TX_RING];
+        const SimSoldier* s = &soldiers[p->soldier];
+        SimQueen* q = &queens[s->queen];
+        q->frames++;
+        q->delivered += !heard_on_air(s->ch, q->x, q->y, SIM_INTERFERE_KM, p->start, p->end, p->soldier);
+    }
+}
+
+static void run(int n, uint8_t channels, uint8_t isolated, SimResult* res)
+{
+    build_forest(n, channels, isolated);
+    pending_head = pending_tail = 0;
+    const double horizon = SIM_HOURS * 3600000.0;
+
+    while (heap_len > 0) {
+        int idx = heap[0];
+        SimSoldier* s = &soldiers[idx];
+        double t = s->next_ms;
+        if (t >= horizon) break;
+        settle(t);
+
+        if (!s->in_cad) {
+            s->blocks = (uint8_t)(1 + rng_next() % SIM_MAX_BLOCKS);
+            LBT_Frame_Start(&s->lbt);
+            s->in_cad = 1;
+            s->wake_ms = t;
+            s->next_ms = t + (double)(rng_next() % SIM_JITTER_MAX_MS);
+        } else {
+            uint8_t busy = heard_on_air(s->ch, s->x, s->y, SIM_SENSE_KM, t, t + SIM_CAD_MS, idx);
+            uint32_t backoff_ms = LBT_On_Cad(&s->lbt, busy, rng_next());
+            if (backoff_ms) {
+                s->next_ms = t + SIM_CAD_MS + backoff_ms;
+            } else {
+                SimTx* tx = &tx_ring[tx_count++ % SIM_TX_RING];
+                tx->start_ms = t + SIM_CAD_MS + SIM_TURNAROUND_MS;
+                tx->end_ms = tx->start_ms + Sync_Airtime_Ms((uint16_t)(s->blocks * 20U));
+                tx->soldier = idx;
+                tx->ch = s->ch;
+                SimPending* p = &pending[pending_tail++ % SIM_TX_RING];
+                p->start = tx->start_ms;
+                p->end = tx->end_ms;
+                p->soldier = idx;
+                s->in_cad = 0;
+                s->next_ms = s->wake_ms + s->period_ms;
+                if (s->next_ms <= tx->end_ms) s->next_ms = tx->end_ms + 1.0;
+            }
+        }
+        heap_down(0);
+    }
+    settle(horizon + 10000.0);
+
+    uint8_t used[CHAN_COUNT] = {0};
+    res->worst_pct = 100.0;
+    res->mean_pct = 0.0;
+    res->distinct = 0;
+    for (int q = 0; q < SIM_QUEENS; q++) {
+        double pct = queens[q].frames ? 100.0 * (double)queens[q].delivered / (double)queens[q].frames : 100.0;
+        if (pct < res->worst_pct) res->worst_pct = pct;
+        res->mean_pct += pct / SIM_QUEENS;
+        if (!used[queens[q].ch]) res->distinct++;
+        used[queens[q].ch] = 1;
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void sweep(const char* name, uint8_t channels, uint8_t isolated)
+{
+    SimResult at100 = {0}, r;
+    int sustainable = 0;
+    int distinct = 0;
+    for (int n = SIM_N_STEP; n <= SIM_N_MAX; n += SIM_N_STEP) {
+        rng_state = SIM_SEED; /* Same forest and traffic for every channel count */
+        run(n, channels, isolated, &r);
+        if (n == 100) at100 = r;
+        if (n == SIM_N_STEP) distinct = r.distinct;
+        if (r.worst_pct >= SIM_TARGET_PCT) {
+            sustainable = n;
+        } else if (n > 100) {
+            break;
+        }
+    }
+    char cap[16];
+    if (sustainable == 0) {
+        snprintf(cap, sizeof(cap), "< %d", SIM_N_STEP);
+    } else {
+        snprintf(cap, sizeof(cap), "%s%d", sustainable >= SIM_N_MAX ? "≥ " : "", sustainable);
+    }
+    printf("  %-10s %8d %10.1f%% %10.1f%% %15s\n", name, isolated ? 1 : distinct, at100.mean_pct,
+           at100.worst_pct, cap);
+}
+
+int main(void)
+{
+    static const uint8_t plans[] = { 1, 2, 3, 4, 8 };
+
+    printf("\n📡 Queen Capacity vs EU868 Channels (%d×%d Queens %.1f km apart, %d h, jitter + LBT)\n",
+           SIM_GRID, SIM_GRID, SIM_SPACING_KM, SIM_HOURS);
+    printf("══════════════════════════════════════════════════════════════\n");
+    printf("  %-10s %8s %11s %11s %15s\n", "channels", "in use", "deliv@100", "worst@100",
+           "sustainable/Q");
+    for (size_t p = 0; p < sizeof(plans) / sizeof(plans[0]); p++) {
+        char name[16];
+        snprintf(name, sizeof(name), "%u", plans[p]);
+        sweep(name, plans[p], 0);
+    }
+    sweep("isolated", 1, 1);
+    printf("\n  sustainable/Q: largest N (step %d) with every Queen ≥ %.0f%% delivered\n\n",
+           SIM_N_STEP, SIM_TARGET_PCT);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * sim_crc.c — Host benchmark of the OTA CRC paths (firmware/common/silken_crc.c).
+ *
+ * 1. Throughput of the three CRC32 implementations over a 1 KB Soldier OTA
+ *    image (OtaRx.buffer) and of CRC16-CCITT over a full 528-byte CoAP chunk:
+ *      bitwise    — Crc32_Update_Bitwise, the Soldier's old loop (8 shifts/byte)
+ *      slice-by-8 — Crc32_Update_Slice8, the host build of Crc32_Update
+ *      STM32 CRC  — the hardware unit of the target build; it cannot run here,
+ *                   so the row is the reference-manual rate (one 32-bit word in
+ *                   4 AHB cycles) at SIM_CORE_MHZ, not a measurement
+ *    bitwise and slice-by-8 are timed on this host.
+ *
+ * 2. Work left for the last chunk. The Queen broadcasts the image chunk after
+ *    chunk in a circle, one per reflex shot, so a Soldier joins at a random
+ *    chunk and misses some (SIM_LOSS_PCT). The old code CRC'd the whole image
+ *    after the last chunk; the new one folds the contiguous prefix as it grows
+ *    (firmware/common/silken_ota.c), so the last chunk only closes what is left.
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#define _POSIX_C_SOURCE 199309L   /* clock_gettime under -std=c11 */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "silken_crc.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_SEED             0xC3C32026U
+#define SIM_IMAGE_BYTES      1024     /* OTA_RX_BUFFER_SIZE */
+#define SIM_CHUNK_BYTES      11       /* LoRa OTA chunk: 16 - 5 header bytes */
+#define SIM_COAP_CHUNK       528      /* 5 + 512 + 2, AES-padded */
+#define SIM_MIN_BENCH_NS     200000000ULL
+#define SIM_CORE_MHZ         48       /* SYSCLK STM32WLE5 */
+#define SIM_HW_CYCLES_WORD   4        /* RM0461: CRC of a 32-bit word in 4 AHB cycles */
+#define SIM_RECEPTIONS       20000
+#define SIM_LOSS_PCT         30
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+typedef uint32_t (*Crc32Fn)(uint32_t crc, const uint8_t* data, uint32_t len);
+
+static volatile uint32_t sink;
+
+/* ns per call, repeated until the run is long enough to trust the clock */
+static double bench_crc32(Crc32Fn fn, const uint8_t* buf, uint32_t len)
+{
+    uint64_t calls = 0, t0 = now_ns(), t;
+    do {
+        for (int i = 0; i < 64; i++) {
+            sink ^= fn(CRC32_INIT, buf, len);
+        }
+        calls += 64;
+        t = now_ns() - t0;
+    } while (t < SIM_MIN_BENCH_NS);
+    return (double)t / (double)calls;
+}
+
+static double bench_crc16(const uint8_t* buf, uint32_t len)
+{
+    uint64_t calls = 0, t0 = now_ns(), t;
+    do {
+        for (int i = 0; i < 64; i++) {
+            sink ^= Crc16_Ccitt(buf, len);
+        }
+        calls += 64;
+        t = now_ns() - t0;
+    } while (t < SIM_MIN_BENCH_NS);
+    return (double)t / (double)calls;
+}
+
+static void print_rate(const char* name, double ns, uint32_t len, const char* note)
+{
+    printf("  %-12s %10.1f %10.2f %9.1f   %s\n", name, ns / 1000.0, ns / len, len * 1000.0 / ns, note);
+}
+
+static int cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Bytes CRC'd when the last missing chunk arrives: the contiguous prefix
+ * still unfolded, minus the 4 bytes held back as the expected CRC */
+static uint32_t last_chunk_work(uint16_t chunks, uint8_t* got)
+{
+    memset(got, 0, chunks);
+    uint16_t left = chunks, next = 0, idx = (uint16_t)(rng_next() % chunks);
+    uint32_t folded = 0, work = 0;
+    while (left > 0) {
+        if (!got[idx] && rng_next() % 100 >= SIM_LOSS_PCT) {
+            got[idx] = 1;
+            left--;
+            uint32_t end = folded;
+            while (next < chunks && got[next]) {
+                next++;
+                end = (uint32_t)next * SIM_CHUNK_BYTES;
+            }
+            work = 0;
+            if (end > folded + 4) {
+                work = end - 4 - folded;
+                folded = end - 4;
+            }
+        }
+        idx = (uint16_t)((idx + 1) % chunks);
+    }
+    return work;
+}
+
+int main(void)
+{
+    static uint8_t image[SIM_IMAGE_BYTES];
+    static uint8_t coap[SIM_COAP_CHUNK];
+    for (uint32_t i = 0; i < sizeof(image); i++) image[i] = (uint8_t)rng_next();
+    for (uint32_t i = 0; i < sizeof(coap); i++) coap[i] = (uint8_t)rng_next();
+    Crc_Init();
+
+    if (Crc32_Update_Slice8(CRC32_INIT, image, sizeof(image)) !=
+        Crc32_Update_Bitwise(CRC32_INIT, image, sizeof(image))) {
+        printf("slice-by-8 and bitwise CRC32 disagree\n");
+        return 1;
+    }
+
+    printf("\n🧮 OTA CRC — Bitwise vs Slicing-by-8 vs STM32 CRC Unit\n");
+    printf("══════════════════════════════════════════════════════════════\n");
+
+    double hw_ns = (double)SIM_HW_CYCLES_WORD * 1000.0 / (4.0 * SIM_CORE_MHZ);   /* per byte */
+    printf("\n  CRC32 over the %u-byte Soldier OTA image\n", SIM_IMAGE_BYTES);
+    printf("  %-12s %10s %10s %9s\n", "impl", "us/image", "ns/byte", "MB/s");
+    double bit_ns = bench_crc32(Crc32_Update_Bitwise, image, sizeof(image));
+    double s8_ns = bench_crc32(Crc32_Update_Slice8, image, sizeof(image));
+    print_rate("bitwise", bit_ns, sizeof(image), "this host");
+    print_rate("slice-by-8", s8_ns, sizeof(image), "this host");
+    print_rate("STM32 CRC", hw_ns * sizeof(image), sizeof(image), "RM0461 rate at 48 MHz, not measured");
+    printf("  slice-by-8 is %.1fx bitwise on this host\n", bit_ns / s8_ns);
+
+    printf("\n  CRC16-CCITT over a %u-byte Queen CoAP OTA chunk\n", SIM_COAP_CHUNK);
+    printf("  %-12s %10s %10s %9s\n", "impl", "us/chunk", "ns/byte", "MB/s");
+    print_rate("table", bench_crc16(coap, sizeof(coap)), sizeof(coap), "this host");
+    print_rate("STM32 CRC", hw_ns * sizeof(coap), sizeof(coap), "RM0461 rate at 48 MHz, not measured");
+
+    static uint32_t work[SIM_RECEPTIONS];
+    static uint8_t got[SIM_IMAGE_BYTES / SIM_CHUNK_BYTES + 1];
+    uint16_t chunks = (SIM_IMAGE_BYTES + SIM_CHUNK_BYTES - 1) / SIM_CHUNK_BYTES;
+    uint64_t sum = 0;
+    uint32_t in_one_chunk = 0;
+    for (int r = 0; r < SIM_RECEPTIONS; r++) {
+        work[r] = last_chunk_work(chunks, got);
+        sum += work[r];
+        if (work[r] <= SIM_CHUNK_BYTES) in_one_chunk++;
+    }
+    qsort(work, SIM_RECEPTIONS, sizeof(work[0]), cmp_u32);
+    uint32_t full = (uint32_t)chunks * SIM_CHUNK_BYTES - 4;
+
+    printf("\n  Bytes CRC'd after the last chunk (%u chunks of %u B, join at random, %d%% lost, %d receptions)\n",
+           chunks, SIM_CHUNK_BYTES, SIM_LOSS_PCT, SIM_RECEPTIONS);
+    printf("  %-12s %8s %8s %8s %12s %14s\n", "verify", "mean", "p50", "p95", "<= 1 chunk", "STM32 CRC us");
+    printf("  %-12s %8u %8u %8u %11.1f%% %14.1f\n", "at the end", full, full, full, 0.0, hw_ns * full / 1000.0);
+    printf("  %-12s %8.0f %8u %8u %11.1f%% %14.1f\n", "incremental",
+           (double)sum / SIM_RECEPTIONS, work[SIM_RECEPTIONS / 2], work[SIM_RECEPTIONS * 95 / 100],
+           100.0 * in_one_chunk / SIM_RECEPTIONS, hw_ns * ((double)sum / SIM_RECEPTIONS) / 1000.0);
+    return 0;
+}
@@ -0,0 +1,318 @@
+/*
+ * sim_energy.c — Host simulation of the Soldier energy budget over harvest traces.
+ *
+ * Replays a harvest trace (CSV: t_s,harvest_uw, piecewise constant) through a
+ * 0.47 F supercapacitor model and compares three wake policies:
+ *   fixed    — constant RTC period, listen if Vcap > 2.8 V, a frame every wake
+ *   adaptive — firmware/common/silken_energy.c (the same object code as on the MCU)
+ *   rbe      — adaptive + report-by-exception (firmware/common/silken_rbe.c):
+ *              the own frame goes out only on a change or a heartbeat
+ *   batch    — rbe + buffered uplink: up to RBE_BATCH_READINGS readings per frame
+ *
+ * Reports uptime (time above PVD), telemetry packets delivered, RX windows,
+ * mesh relays, PVD brownouts and the energy spent on radio TX.
+ * Readings for report-by-exception: Vcap from the supercap model, a diurnal
+ * temperature swing, homeostasis bio status and occasional cavitation.
+ *
+ * Build & run: make -C firmware/test sim
+ *              ./sim_energy traces/teg_diurnal.csv [more.csv ...]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "silken_energy.h"
+#include "silken_rbe.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_BASELINE_INTERVAL_S   300     /* Fixed RTC period of the current firmware */
+#define SIM_START_MV              3000    /* Initial supercap voltage */
+#define SIM_VCAP_MAX_MV           3600    /* Charger clamp (VREFINT range) */
+#define SIM_RESTART_MV            2400    /* PVD rising edge: MCU boots again */
+#define SIM_STEP_S                10      /* Integration step while sleeping */
+#define SIM_VIBRATION_EVERY       8       /* Every Nth wake is a piezo wake (TinyML) */
+#define SIM_RELAY_EVERY           4       /* Every Nth RX window hears a neighbour */
+#define SIM_CAVITATION_EVERY      4       /* Every Nth TinyML wake confirms cavitation */
+#define SIM_TEMP_MEAN_C           10      /* Diurnal temperature: mean ± swing */
+#define SIM_TEMP_SWING_C          6
+#define SIM_BIO_HOMEOSTASIS       0x05    /* Status 0, 5 growth points */
+#define SIM_MAX_POINTS            4096
+#define SIM_TWO_PI                6.283185307179586
+
+typedef struct {
+    uint32_t t_s[SIM_MAX_POINTS];
+    uint32_t harvest_uw[SIM_MAX_POINTS];
+    uint32_t count;
+    uint32_t duration_s;
+} HarvestTrace;
+
+typedef enum { POLICY_FIXED = 0, POLICY_ADAPTIVE = 1, POLICY_RBE = 2, POLICY_BATCH = 3 } SimPolicy;
+
+typedef struct {
+    uint32_t alive_s;
+    uint32_t packets;       /* Own telemetry frames sent */
+    uint32_t rx_windows;
+    uint32_t relays;
+    uint32_t brownouts;
+    uint32_t wakes;
+    uint32_t cycles;        /* Wakes completed without a brownout */
+    uint64_t sleep_sum_s;
+    uint64_t radio_uj;      /* Own uplink + relays (preamble, airtime, CAD not counted) */
+} SimResult;
+
+/* ════════════════════════════════════════════════════════════════════
+ * TRACE LOADING
+ * ════════════════════════════════════════════════════════════════════ */
+
+static int load_trace(const char* path, HarvestTrace* tr)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+
+    char line[256];
+    tr->count = 0;
+    while (fgets(line, sizeof(line), f) && tr->count < SIM_MAX_POINTS) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        unsigned long t, p;
+        if (sscanf(line, "%lu,%lu", &t, &p) == 2) {
+            tr->t_s[tr->count] = (uint32_t)t;
+            tr->harvest_uw[tr->count] = (uint32_t)p;
+            tr->count++;
+        }
+    }
+    fclose(f);
+    if (tr->count < 2) return -1;
+
+    /* Last sample lasts as long as the average step */
+    tr->duration_s = tr->t_s[tr->count - 1] +
+                     (tr->t_s[tr->count - 1] - tr->t_s[0]) / (tr->count - 1);
+    return 0;
+}
+
+static uint32_t harvest_at(const HarvestTrace* tr, uint32_t t)
+{
+    uint32_t p = tr->harvest_uw[0];
+    for (uint32_t i = 0; i < tr->count && tr->t_s[i] <= t; i++) p = tr->harvest_uw[i];
+    return p;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * SUPERCAP MODEL
+ * ════════════════════════════════════════════════════════════════════ */
+
+static uint16_t vcap_from_uj(int64_t e_uj)
+{
+    if (e_uj <= 0) return 0;
+    /* E = C_mF · mV² / 2000 → mV = sqrt(2000·E / C_mF) */
+    return (uint16_t)sqrt((double)e_uj * 2000.0 / ENERGY_CAP_MF);
+}
+
+static int64_t clamp_charge(int64_t e_uj)
+{
+    int64_t e_max = Energy_Stored_UJ(SIM_VCAP_MAX_MV, 0);
+    return e_uj > e_max ? e_max : e_uj;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * POLICY RUN
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* The Soldier's payload for this wake: bytes Rbe_Decide reads */
+static void sim_payload(uint8_t* p, uint32_t t, uint16_t vcap, uint8_t acoustic)
+{
+    double temp = SIM_TEMP_MEAN_C + SIM_TEMP_SWING_C * sin(SIM_TWO_PI * (double)(t % 86400) / 86400.0);
+    memset(p, 0, 16);
+    p[4] = (uint8_t)(vcap >> 8);
+    p[5] = (uint8_t)(vcap & 0xFF);
+    p[6] = (uint8_t)(int8_t)lround(temp);
+    p[7] = acoustic;
+    p[10] = SIM_BIO_HOMEOSTASIS;
+}
+
+static void simulate(const HarvestTrace* tr, SimPolicy policy, SimResult* res)
+{
+    memset(res, 0, sizeof(*res));
+
+    const int64_t e_pvd = Energy_Stored_UJ(ENERGY_PVD_MV, 0);
+    const int64_t e_restart = Energy_Stored_UJ(SIM_RESTART_MV, 0);
+
+    int64_t e = Energy_Stored_UJ(SIM_START_MV, 0);
+    uint8_t alive = 1;
+    uint8_t pending_relay = 0;
+    uint8_t acoustic = 0, buffered = 0;
+    uint32_t t = 0, rx_count = 0, ml_count = 0, held_s = 0;
+
+    EnergyState st;
+    EnergyClock clk;   /* dt as the firmware takes it: RTC time of day */
+    RbeState rbe;
+    Energy_Init(&st);
+    Energy_Clock_Restore(&clk, 0);
+    Rbe_Init(&rbe);
+
+    while (t < tr->duration_s) {
+        uint32_t sleep_s = SIM_BASELINE_INTERVAL_S;
+
+        if (alive) {
+            /* ── Wake ── */
+            uint16_t vcap = vcap_from_uj(e);
+            uint32_t dt = Energy_Clock_Elapsed_S(&clk, (t % 86400U) * 1000U);
+            uint8_t run_ml = 1, listen, relay;
+
+            if (policy != POLICY_FIXED) {
+                EnergyPlan plan;
+                Energy_Update(&st, vcap, dt);
+                Energy_Plan(&st, &plan);
+                run_ml = plan.run_tinyml;
+                listen = plan.listen;
+                relay = plan.relay;
+                sleep_s = plan.sleep_s;
+            } else {
+                listen = vcap > ENERGY_LISTEN_MV;
+                relay = 1;
+            }
+
+            uint32_t cost = ENERGY_COST_WAKE_UJ;
+            if (run_ml && (res->wakes % SIM_VIBRATION_EVERY) == 0) {
+                cost += ENERGY_COST_TINYML_UJ;
+                if (++ml_count % SIM_CAVITATION_EVERY == 0 && acoustic < 0xFF) acoustic++;
+            }
+
+            /* A reading is recorded (fixed/adaptive: always), then goes out at once
+             * or, in batch mode, waits for Rbe_Batch_Due */
+            RbeDecision d = RBE_SEND_HEARTBEAT;
+            uint8_t payload[16];
+            if (policy == POLICY_RBE || policy == POLICY_BATCH) {
+                sim_payload(payload, t, vcap, acoustic);
+                d = Rbe_Decide(&rbe, payload);
+            }
+            uint8_t record = d != RBE_SKIP;
+            uint8_t relay_due = relay && pending_relay;
+            uint8_t pending = (uint8_t)(buffered + record);
+            if (buffered > 0) held_s += dt;
+            uint8_t own_due = policy == POLICY_BATCH
+                            ? (Rbe_Batch_Due(d, pending, held_s) || (relay_due && pending > 0))
+                            : pending > 0;
+
+            /* The first block pays the preamble, every further block its airtime */
+            uint8_t blocks = (uint8_t)((own_due ? pending : 0) + relay_due);
+            uint32_t radio = blocks ? ENERGY_COST_UPLINK_UJ + (blocks - 1U) * ENERGY_COST_RELAY_BLOCK_UJ : 0;
+            cost = cost - ENERGY_COST_UPLINK_UJ + radio;
+            if (listen) cost += ENERGY_COST_LISTEN_UJ;
+
+            res->wakes++;
+
+            if (e - (int64_t)cost < e_pvd) {
+                /* PVD fires mid-wake: frame lost, node dies */
+                e = e_pvd;
+                alive = 0;
+                res->brownouts++;
+                Energy_Init(&st);
+                pending_relay = 0;
+                buffered = 0;
+            } else {
+                e -= cost;
+                res->radio_uj += radio;
+                if (record) {
+                    acoustic = 0;
+                    Rbe_Sent(&rbe, payload);
+                } else {
+                    Rbe_Skipped(&rbe);
+                }
+                buffered = pending;
+                if (own_due) {
+                    res->packets += buffered;
+                    buffered = 0;
+                    held_s = 0;
+                }
+                if (relay && pending_relay) {
+                    res->relays++;
+                    pending_relay = 0;
+                }
+                if (listen) {
+                    res->rx_windows++;
+                    if (++rx_count % SIM_RELAY_EVERY == 0 && relay) pending_relay = 1;
+                }
+                if (policy != POLICY_FIXED) Energy_Spend(&st, cost);
+                res->cycles++;
+                res->sleep_sum_s += sleep_s;
+            }
+        }
+
+        /* ── Sleep (or brownout) until the next wake ── */
+        uint32_t slept = 0;
+        while (slept < sleep_s && t < tr->duration_s) {
+            uint32_t dt = SIM_STEP_S;
+            int64_t drain = alive ? ENERGY_P_SLEEP_UW : 0;
+            e = clamp_charge(e + ((int64_t)harvest_at(tr, t) - drain) * dt);
+            t += dt;
+            slept += dt;
+
+            if (alive) {
+                res->alive_s += dt;
+                if (e < e_pvd) {
+                    alive = 0;
+                    res->brownouts++;
+                    Energy_Init(&st);
+                    pending_relay = 0;
+                    buffered = 0;
+                }
+            } else if (e >= e_restart) {
+                alive = 1; /* Cold boot: wake immediately */
+                Energy_Clock_Restore(&clk, 0);
+                break;
+            }
+        }
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void print_result(const char* name, const HarvestTrace* tr, const SimResult* r)
+{
+    double uptime = 100.0 * (double)r->alive_s / (double)tr->duration_s;
+    double mean_sleep = r->cycles ? (double)r->sleep_sum_s / (double)r->cycles : 0.0;
+    printf("  %-9s %7.2f%% %9u %9u %8u %10u %10.0f %9.1f\n",
+           name, uptime, r->packets, r->rx_windows, r->relays, r->brownouts, mean_sleep,
+           (double)r->radio_uj / 1e6);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s trace.csv [trace.csv ...]\n", argv[0]);
+        return 2;
+    }
+
+    static HarvestTrace tr;
+    printf("\n🔋 Soldier Energy Scheduler — Harvest Trace Simulation\n");
+    printf("══════════════════════════════════════════════════════════════\n");
+
+    for (int i = 1; i < argc; i++) {
+        if (load_trace(argv[i], &tr) != 0) {
+            fprintf(stderr, "cannot read trace %s\n", argv[i]);
+            return 1;
+        }
+
+        SimResult fixed, adaptive, rbe, batch;
+        simulate(&tr, POLICY_FIXED, &fixed);
+        simulate(&tr, POLICY_ADAPTIVE, &adaptive);
+        simulate(&tr, POLICY_RBE, &rbe);
+        simulate(&tr, POLICY_BATCH, &batch);
+
+        printf("\n  %s (%.1f days)\n", argv[i], tr.duration_s / 86400.0);
+        printf("  %-9s %8s %9s %9s %8s %10s %10s %9s\n",
+               "policy", "uptime", "packets", "rx_win", "relays", "brownouts", "mean_sleep", "radio_J");
+        print_result("fixed", &tr, &fixed);
+        print_result("adaptive", &tr, &adaptive);
+        print_result("rbe", &tr, &rbe);
+        print_result("batch", &tr, &batch);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,766 @@
+/*
+ * sim_forest.c — Discrete-event simulation of a whole forest: 500 Soldiers, 3 Queens.
+ *
+ * The other sims isolate one mechanism. This one runs them together for
+ * SIM_DAYS days so their interactions show: collisions between clusters of
+ * relays, gradient learning from reflex beacons, CIFO evictions, flush latency
+ * and how long an OTA image takes to reach the forest over reflex shots.
+ *
+ * Firmware logic, the same object code as on the MCU:
+ *   Soldier — silken_route.c (gradient, relay decision), silken_seen.c (mesh
+ *             dedup), silken_relayq.c (aggregated frames), silken_lbt.c (CAD +
+ *             backoff), silken_ota.c + silken_crc.c (OTA reassembly)
+ *   Queen   — firmware/queen/main.c itself, compiled against hal_mock.h as in
+ *             bench_firmware.c: Process_And_Cache_Data (CIFO) and
+ *             Flush_Cache_To_Rails. The three Queens share its globals, so the
+ *             sim swaps forest_cache whenever another Queen's turn comes.
+ * Modelled here after the firmware: the Soldier wake (Phases 1-5, one reading
+ * per wake, no report-by-exception), the Queen's reflex choice in Task_Radio
+ * (OTA chunk, else a beacon to a Soldier that is not hop 1 or every
+ * SIM_ADR_HISTORY-th direct frame), and the flush session timings.
+ *
+ * Radio model: log-distance path loss with per-link shadowing (sim_mesh.c),
+ * SF7/125 kHz airtime (Sync_Airtime_Ms), one EU868 channel per Queen cluster;
+ * a Soldier locks to the channel of the nearest Queen. A frame is lost at a
+ * receiver that transmits meanwhile, or if an overlapping frame on the same
+ * channel arrives there less than SIM_CAPTURE_DB weaker. A Soldier hears only
+ * during its 500 ms RX window after its own TX, and only the first frame.
+ *
+ * Energy uses the ENERGY_COST_* figures of silken_energy.h. Delivery counts
+ * distinct readings that reached Rails; latency is reading → end of the flush
+ * session that carried it. Not modelled: TDMA slots, ADR power steps, RBE,
+ * diagnostic frames, the Queen's own health frames.
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#define _POSIX_C_SOURCE 199309L   /* clock_gettime under -std=c11 */
+#define main queen_firmware_main
+#include "../queen/main.c"
+#undef main
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "silken_energy.h"
+#include "silken_lbt.h"
+#include "silken_ota.h"
+#include "silken_relayq.h"
+#include "silken_route.h"
+#include "silken_seen.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_SOLDIERS         500
+#define SIM_QUEENS           3
+#define SIM_NODES            (SIM_SOLDIERS + SIM_QUEENS)
+#define SIM_DAYS             20       /* 500 × 20 = 10 000 node-days per row */
+#define SIM_SEED             0xF02E5726U
+#define SIM_PLOT_W_M         3000.0   /* Queens 1 km apart along the middle */
+#define SIM_PLOT_H_M         1600.0
+#define SIM_TX_DBM           14.0
+#define SIM_PL_1M_DB         40.0
+#define SIM_PL_EXP           3.5      /* Forest canopy, as sim_mesh.c */
+#define SIM_SHADOW_DB        4.0
+#define SIM_SENS_DBM         (-123)   /* SF7 / 125 kHz: decode and CAD */
+#define SIM_CAPTURE_DB       6        /* Co-channel rejection of SF7 */
+#define SIM_PERIOD_MS        300000U  /* Mean wake period; uniform ±50% */
+#define SIM_PHASES_MS        400      /* Wake → Phase 4 (sensors, mruby, AES) */
+#define SIM_JITTER_MAX_MS    500      /* TX_JITTER_MAX_MS */
+#define SIM_CAD_MS           2
+#define SIM_TURNAROUND_MS    1
+#define SIM_RX_WINDOW_MS     500      /* LORA_RX_TIMEOUT_MS */
+#define SIM_QUEEN_TURN_MS    5        /* RxDone → reflex on air */
+#define SIM_ADR_HISTORY      8        /* ADR_HISTORY in silken_adr.h */
+#define SIM_FLUSH_MS         (FLUSH_OPEN_MS + FLUSH_ACK_MS + FLUSH_CLOSE_MS)
+#define SIM_OTA_START_MS     86400000.0
+#define SIM_OTA_IMAGE        1023     /* 93 LoRa chunks: the largest image OtaRx holds */
+#define SIM_TX_RING          8192
+#define SIM_MAX_AIRTIME_MS   400.0    /* > airtime of 8 blocks; bounds overlap scans */
+#define SIM_LAT_BIN_S        10
+#define SIM_LAT_BINS         8640     /* 24 h */
+#define SIM_DID_BASE         0x5A000000U
+
+typedef enum { EV_WAKE = 0, EV_CAD, EV_TX_END, EV_REFLEX, EV_FLUSH, EV_OTA_START } SimEvType;
+
+typedef struct {
+    double   t;
+    uint32_t seq;                 /* Ties in time run in scheduling order */
+    uint8_t  type;
+    int32_t  id;
+    uint32_t aux;
+} SimEvent;
+
+typedef struct {
+    double   start, end;
+    int16_t  sender;              /* Node index; Queens follow the Soldiers */
+    uint8_t  channel;
+    uint16_t size;
+    uint8_t  frame[RELAYQ_AGG_MAX_SIZE];
+} SimTx;
+
+typedef struct {
+    uint32_t   did;
+    uint8_t    queen;             /* Cluster = EU868 channel */
+    uint8_t    seq;
+    uint8_t    listed;            /* In listeners[queen] */
+    uint8_t    direct;            /* Own Queen above sensitivity */
+    uint32_t   period_ms;
+    uint32_t   direct_frames;
+    double     rx_from, rx_until; /* Open RX window, Queen time */
+    double     ota_done_ms;
+    RouteState route;
+    SeenSet    seen;
+    RelayQueue relay_queue;
+    LbtState   lbt;
+    OtaRx      ota;
+    uint8_t    frame[RELAYQ_AGG_MAX_SIZE];
+    uint16_t   frame_size;
+} SimSoldier;
+
+typedef struct {
+    EdgeCache  cache[CACHE_MAX_ENTRIES];
+    uint8_t    cache_count;
+    double     flush_until;       /* Modem session open: reflexes are stale */
+    uint32_t   flush_gen;         /* Invalidates the hourly timer after a flush */
+    uint8_t    flush_posted;
+    uint8_t    ota_active;
+    uint16_t   ota_idx;
+    double     tx_until;
+} SimQueen;
+
+typedef struct {
+    const char* name;
+    uint8_t     relay;            /* energy_plan.relay on every Soldier */
+    uint32_t    period_ms;
+    uint8_t     ota;              /* Rails hands every Queen an image after day 1 */
+} SimScenario;
+
+typedef struct {
+    uint64_t readings, delivered, evicted, superseded;
+    uint64_t mesh_readings, mesh_delivered;  /* From Soldiers out of their Queen's range */
+    uint64_t queen_rx, queen_rx_lost;       /* Frames in range of the own Queen */
+    uint64_t events;
+    double   soldier_airtime_ms, queen_airtime_ms;
+    double   energy_uj;
+    uint32_t lat_hist[SIM_LAT_BINS + 1];
+    uint32_t ota_done, ota_done_direct, direct;
+    double   ota_ms[SIM_SOLDIERS];
+} SimTotals;
+
+/* Reading bookkeeping: id is carried in body bytes 4-7 */
+enum { RD_AIR = 0, RD_CACHED, RD_SUPERSEDED, RD_EVICTED, RD_DELIVERED };
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: deterministic across hosts */
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static double rng_unit(void)
+{
+    return ((double)rng_next() + 1.0) / 4294967297.0;
+}
+
+static double rng_gauss(void)
+{
+    return sqrt(-2.0 * log(rng_unit())) * cos(6.283185307179586 * rng_unit());
+}
+
+static double     sim_x[SIM_NODES], sim_y[SIM_NODES];
+static int16_t    sim_rssi[SIM_NODES][SIM_NODES];
+static uint16_t   listeners[SIM_QUEENS][SIM_SOLDIERS]; /* Soldiers with an RX window open, per channel */
+static uint16_t   listener_count[SIM_QUEENS];
+static SimSoldier soldiers[SIM_SOLDIERS];
+static SimQueen   queens[SIM_QUEENS];
+static SimTx      tx_ring[SIM_TX_RING];
+static uint32_t   tx_total;
+static uint8_t    ota_image[SIM_OTA_IMAGE];
+static uint16_t   ota_chunks;
+
+static float*     rd_born_s;
+static uint8_t*   rd_state;
+static uint32_t   rd_count, rd_cap;
+
+/* ════════════════════════════════════════════════════════════════════
+ * EVENT QUEUE (binary min-heap)
+ * ════════════════════════════════════════════════════════════════════ */
+static SimEvent*  heap;
+static uint32_t   heap_len, heap_cap, heap_seq;
+
+static int ev_before(const SimEvent* a, const SimEvent* b)
+{
+    return a->t < b->t || (a->t == b->t && a->seq < b->seq);
+}
+
+static void ev_push(double t, SimEvType type, int32_t id, uint32_t aux)
+{
+    if (heap_len == heap_cap) {
+        heap_cap = heap_cap ? 2 * heap_cap : 4096;
+        heap = realloc(heap, heap_cap * sizeof(SimEvent));
+    }
+    SimEvent ev = { t, heap_seq++, (uint8_t)type, id, aux };
+    uint32_t i = heap_len++;
+    while (i > 0 && ev_before(&ev, &heap[(i - 1) / 2])) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = ev;
+}
+
+static SimEvent ev_pop(void)
+{
+    SimEvent top = heap[0], last = heap[--heap_len];
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t c = 2 * i + 1;
+        if (c >= heap_len) break;
+        if (c + 1 < heap_len && ev_before(&heap[c + 1], &heap[c])) c++;
+        if (!ev_before(&heap[c], &last)) break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = last;
+    return top;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * FOREST
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void build_forest(void)
+{
+    for (int q = 0; q < SIM_QUEENS; q++) {
+        sim_x[SIM_SOLDIERS + q] = SIM_PLOT_W_M * (2 * q + 1) / (2 * SIM_QUEENS);
+        sim_y[SIM_SOLDIERS + q] = SIM_PLOT_H_M / 2.0;
+    }
+    for (int i = 0; i < SIM_SOLDIERS; i++) {
+        sim_x[i] = rng_unit() * SIM_PLOT_W_M;
+        sim_y[i] = rng_unit() * SIM_PLOT_H_M;
+    }
+    for (int i = 0; i < SIM_NODES; i++) {
+        sim_rssi[i][i] = 0;
+        for (int j = i + 1; j < SIM_NODES; j++) {
+            double d = hypot(sim_x[i] - sim_x[j], sim_y[i] - sim_y[j]);
+            if (d < 1.0) d = 1.0;
+            double r = SIM_TX_DBM - (SIM_PL_1M_DB + 10.0 * SIM_PL_EXP * log10(d) + SIM_SHADOW_DB * rng_gauss());
+            if (r < -200.0) r = -200.0;
+            sim_rssi[i][j] = sim_rssi[j][i] = (int16_t)lround(r);
+        }
+    }
+
+    /* One image for the whole forest, CRC32 in its last 4 bytes as Rails builds it */
+    for (int k = 0; k < SIM_OTA_IMAGE - 4; k++) ota_image[k] = (uint8_t)rng_next();
+    uint32_t crc = Crc32(ota_image, SIM_OTA_IMAGE - 4);
+    ota_image[SIM_OTA_IMAGE - 4] = (uint8_t)(crc >> 24);
+    ota_image[SIM_OTA_IMAGE - 3] = (uint8_t)(crc >> 16);
+    ota_image[SIM_OTA_IMAGE - 2] = (uint8_t)(crc >> 8);
+    ota_image[SIM_OTA_IMAGE - 1] = (uint8_t)crc;
+    ota_chunks = (SIM_OTA_IMAGE + 10) / 11;
+}
+
+static uint8_t nearest_queen(int i)
+{
+    uint8_t best = 0;
+    for (uint8_t q = 1; q < SIM_QUEENS; q++) {
+        if (hypot(sim_x[i] - sim_x[SIM_SOLDIERS + q], sim_y[i] - sim_y[SIM_SOLDIERS + q]) <
+            hypot(sim_x[i] - sim_x[SIM_SOLDIERS + best], sim_y[i] - sim_y[SIM_SOLDIERS + best])) {
+            best = q;
+        }
+    }
+    return best;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * RADIO
+ * ════════════════════════════════════════════════════════════════════ */
+
+static uint32_t tx_begin(int sender, uint8_t channel, double start, const uint8_t* frame, uint16_t size)
+{
+    uint32_t idx = tx_total++ % SIM_TX_RING;
+    SimTx* tx = &tx_ring[idx];
+    tx->start = start;
+    tx->end = start + Sync_Airtime_Ms(size);
+    tx->sender = (int16_t)sender;
+    tx->channel = channel;
+    tx->size = size;
+    memcpy(tx->frame, frame, size);
+    ev_push(tx->end, EV_TX_END, (int32_t)idx, 0);
+    return idx;
+}
+
+/* CAD at node: any frame on air on the channel above sensitivity */
+static uint8_t channel_busy(int node, uint8_t channel, double t)
+{
+    for (uint32_t k = tx_total; k > 0 && tx_total - k < SIM_TX_RING; k--) {
+        const SimTx* tx = &tx_ring[(k - 1) % SIM_TX_RING];
+        if (tx->start < t - SIM_MAX_AIRTIME_MS) break;
+        if (tx->channel != channel || tx->sender == node) continue;
+        if (tx->start < t + SIM_CAD_MS && tx->end > t && sim_rssi[tx->sender][node] >= SIM_SENS_DBM) return 1;
+    }
+    return 0;
+}
+
+/* Frame f decodes at node: in range, node silent, no overlap within the capture margin */
+static uint8_t frame_ok(uint32_t f_idx, int node)
+{
+    const SimTx* f = &tx_ring[f_idx];
+    int16_t p = sim_rssi[f->sender][node];
+    if (p < SIM_SENS_DBM) return 0;
+    for (uint32_t k = tx_total; k > 0 && tx_total - k < SIM_TX_RING; k--) {
+        uint32_t g_idx = (k - 1) % SIM_TX_RING;
+        const SimTx* g = &tx_ring[g_idx];
+        if (g->start < f->start - SIM_MAX_AIRTIME_MS) break;
+        if (g_idx == f_idx || g->channel != f->channel) continue;
+        if (g->start >= f->end || g->end <= f->start) continue;
+        if (g->sender == node) return 0;                      /* Half duplex */
+        if (sim_rssi[g->sender][node] >= p - SIM_CAPTURE_DB) return 0;
+    }
+    return 1;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * QUEEN: the real CIFO cache, one Queen at a time
+ * ════════════════════════════════════════════════════════════════════ */
+
+static uint32_t body_reading(const uint8_t* body)
+{
+    return ((uint32_t)body[4] << 24) | ((uint32_t)body[5] << 16) | ((uint32_t)body[6] << 8) | body[7];
+}
+
+static int loaded_queen = -1;     /* Whose cache sits in forest_cache */
+
+static void queen_load(int qi)
+{
+    if (loaded_queen == qi) return;
+    if (loaded_queen >= 0) {
+        memcpy(queens[loaded_queen].cache, forest_cache, sizeof(forest_cache));
+        queens[loaded_queen].cache_count = cache_count;
+    }
+    memcpy(forest_cache, queens[qi].cache, sizeof(forest_cache));
+    cache_count = queens[qi].cache_count;
+    loaded_queen = qi;
+}
+
+static void queen_cache_block(int qi, const uint8_t* body, int16_t rssi, double t)
+{
+    SimQueen* q = &queens[qi];
+    uint32_t uid = ((uint32_t)body[0] << 24) | ((uint32_t)body[1] << 16) | ((uint32_t)body[2] << 8) | body[3];
+    uint32_t before[CACHE_MAX_ENTRIES];
+    uint32_t before_uid[CACHE_MAX_ENTRIES];
+    uint8_t payload[16];
+    memcpy(payload, body, 16);
+
+    queen_load(qi);
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        before[i] = forest_cache[i].is_active ? body_reading(forest_cache[i].payload) : UINT32_MAX;
+        before_uid[i] = forest_cache[i].uid;
+    }
+    Process_And_Cache_Data(uid, payload, (int8_t)(rssi < -128 ? -128 : rssi));
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        uint32_t now = forest_cache[i].is_active ? body_reading(forest_cache[i].payload) : UINT32_MAX;
+        if (before[i] == now || before[i] == UINT32_MAX) continue;
+        if (rd_state[before[i]] == RD_CACHED) {
+            rd_state[before[i]] = (before_uid[i] == uid) ? RD_SUPERSEDED : RD_EVICTED;
+        }
+    }
+    uint32_t id = body_reading(body);
+    if (rd_state[id] != RD_DELIVERED) rd_state[id] = RD_CACHED;
+
+    if (cache_count >= CACHE_MAX_ENTRIES - FLUSH_HEADROOM && !q->flush_posted) {
+        q->flush_posted = 1;
+        ev_push(t > q->flush_until ? t : q->flush_until, EV_FLUSH, qi, UINT32_MAX);
+    }
+}
+
+static void queen_flush(int qi, double t, SimTotals* tot)
+{
+    SimQueen* q = &queens[qi];
+    q->flush_posted = 0;
+    q->flush_gen++;
+    ev_push(t + FLUSH_INTERVAL_MS, EV_FLUSH, qi, q->flush_gen);
+    queen_load(qi);
+    if (cache_count == 0) return;
+
+    double done = t + SIM_FLUSH_MS;
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        if (!forest_cache[i].is_active) continue;
+        uint32_t id = body_reading(forest_cache[i].payload);
+        if (rd_state[id] == RD_DELIVERED) continue;
+        rd_state[id] = RD_DELIVERED;
+        tot->delivered++;
+        tot->mesh_delivered += !soldiers[forest_cache[i].uid - SIM_DID_BASE].direct;
+        double lat_s = done / 1000.0 - rd_born_s[id];
+        uint32_t bin = lat_s < 0 ? 0 : (uint32_t)(lat_s / SIM_LAT_BIN_S);
+        tot->lat_hist[bin < SIM_LAT_BINS ? bin : SIM_LAT_BINS]++;
+    }
+    (void)Flush_Cache_To_Rails();
+    q->flush_until = done;
+}
+
+/* Reflex, as Task_Radio chooses it: OTA chunk first, otherwise a beacon when
+ * the sender is not hop 1 or its ADR window is full */
+static void queen_reflex(int qi, uint32_t rx_idx, double t, SimTotals* tot)
+{
+    SimQueen* q = &queens[qi];
+    if (t < q->flush_until || t < q->tx_until) return;   /* Frame waited in the ring / radio busy */
+    uint8_t frame[RELAYQ_FRAME_SIZE];
+    uint16_t size;
+
+    if (q->ota_active) {
+        frame[0] = OTA_MARKER;
+        frame[1] = (uint8_t)(q->ota_idx >> 8);
+        frame[2] = (uint8_t)q->ota_idx;
+        frame[3] = (uint8_t)(ota_chunks >> 8);
+        frame[4] = (uint8_t)ota_chunks;
+        memset(&frame[5], 0, 11);
+        uint16_t off = (uint16_t)(q->ota_idx * 11);
+        memcpy(&frame[5], &ota_image[off], SIM_OTA_IMAGE - off > 11 ? 11 : SIM_OTA_IMAGE - off);
+        q->ota_idx = (uint16_t)((q->ota_idx + 1) % ota_chunks);
+        size = 16;
+    } else {
+        const SimTx* rx = &tx_ring[rx_idx];
+        SimSoldier* s = &soldiers[rx->sender];
+        uint8_t direct = Route_Byte_Hop(rx->frame[ROUTE_HDR_HOP_TTL]) == ROUTE_HOP_QUEEN + 1;
+        uint8_t adr_due = ++s->direct_frames % SIM_ADR_HISTORY == 0;
+        if (direct && !adr_due) return;
+        uint8_t body[ROUTE_BODY_SIZE];
+        Route_Pack_Beacon(body);
+        Route_Hdr_From_Body(frame, body);
+        memcpy(&frame[ROUTE_HDR_SIZE], body, ROUTE_BODY_SIZE);
+        size = ROUTE_BLOCK_SIZE;
+    }
+    uint32_t idx = tx_begin(SIM_SOLDIERS + qi, (uint8_t)qi, t, frame, size);
+    q->tx_until = tx_ring[idx].end;
+    tot->queen_airtime_ms += tx_ring[idx].end - tx_ring[idx].start;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * SOLDIER
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void soldier_wake(int i, const SimScenario* sc, double t, SimTotals* tot)
+{
+    SimSoldier* s = &soldiers[i];
+    Route_Tick(&s->route);
+    Seen_Age(&s->seen, s->period_ms / 1000U);
+    tot->energy_uj += ENERGY_COST_WAKE_UJ + (double)ENERGY_P_SLEEP_UW * s->period_ms / 1000.0;
+
+    if (rd_count == rd_cap) {
+        rd_cap *= 2;
+        rd_born_s = realloc(rd_born_s, rd_cap * sizeof(*rd_born_s));
+        rd_state = realloc(rd_state, rd_cap * sizeof(*rd_state));
+    }
+    uint32_t id = rd_count++;
+    rd_born_s[id] = (float)(t / 1000.0);
+    rd_state[id] = RD_AIR;
+    tot->readings++;
+    tot->mesh_readings += !s->direct;
+
+    /* Phase 2 payload; Mesh_Seal_Block without the AES */
+    uint8_t body[ROUTE_BODY_SIZE] = {0};
+    body[0] = (uint8_t)(s->did >> 24);
+    body[1] = (uint8_t)(s->did >> 16);
+    body[2] = (uint8_t)(s->did >> 8);
+    body[3] = (uint8_t)s->did;
+    body[4] = (uint8_t)(id >> 24);
+    body[5] = (uint8_t)(id >> 16);
+    body[6] = (uint8_t)(id >> 8);
+    body[7] = (uint8_t)id;
+    body[10] = (uint8_t)((rng_next() % 10 == 0 ? 2U : 0U) << 6);   /* 10% stressed trees */
+    body[11] = Route_Byte(s->route.hop, 3);                         /* DEFAULT_TTL */
+    body[14] = s->seq++;
+    uint8_t own[ROUTE_BLOCK_SIZE];
+    Route_Hdr_From_Body(own, body);
+    memcpy(&own[ROUTE_HDR_SIZE], body, ROUTE_BODY_SIZE);
+    Seen_Check_And_Insert(&s->seen, own);
+
+    s->frame_size = RelayQ_Build_Frame(&s->relay_queue, own, sc->relay ? RELAYQ_CAPACITY : 0, s->frame);
+    tot->energy_uj += (double)(s->frame_size / RELAYQ_FRAME_SIZE - 1) * ENERGY_COST_RELAY_BLOCK_UJ;
+
+    LBT_Frame_Start(&s->lbt);
+    ev_push(t + SIM_PHASES_MS + rng_next() % SIM_JITTER_MAX_MS, EV_CAD, i, 0);
+}
+
+static void soldier_cad(int i, double t, SimTotals* tot)
+{
+    SimSoldier* s = &soldiers[i];
+    tot->energy_uj += ENERGY_COST_CAD_UJ;
+    uint32_t backoff = LBT_On_Cad(&s->lbt, channel_busy(i, s->queen, t), rng_next());
+    if (backoff) {
+        ev_push(t + SIM_CAD_MS + backoff, EV_CAD, i, 0);
+        return;
+    }
+    uint32_t idx = tx_begin(i, s->queen, t + SIM_CAD_MS + SIM_TURNAROUND_MS, s->frame, s->frame_size);
+    tot->soldier_airtime_ms += tx_ring[idx].end - tx_ring[idx].start;
+}
+
+/* First frame heard in the RX window ends it, as the RX loop in soldier/main.c */
+static void soldier_hear(int i, const SimTx* tx, const SimScenario* sc)
+{
+    SimSoldier* s = &soldiers[i];
+    s->rx_until = tx->end;
+
+    uint8_t blocks = RelayQ_Frame_Blocks(tx->size);
+    if (blocks == 0) {
+        if (tx->frame[0] != OTA_MARKER || s->ota_done_ms >= 0) return;
+        uint16_t len = 0;
+        if (Ota_Rx_Chunk(&s->ota, tx->frame, tx->size, &len) == OTA_RX_COMPLETE &&
+            len == SIM_OTA_IMAGE - 4 && memcmp(s->ota.buffer, ota_image, len) == 0) {
+            s->ota_done_ms = tx->end;
+        }
+        return;
+    }
+
+    uint8_t tx_hop = Route_Byte_Hop(tx->frame[ROUTE_HDR_HOP_TTL]);
+    Route_On_Heard(&s->route, tx_hop, sim_rssi[tx->sender][i]);
+    for (uint8_t b = 0; b < blocks && sc->relay; b++) {
+        const uint8_t* block = &tx->frame[b * RELAYQ_FRAME_SIZE];
+        uint8_t ttl = Route_Byte_TTL(block[ROUTE_HDR_HOP_TTL]);
+        if (ttl == 0) continue;
+        if (!Route_Should_Relay(&s->route, tx_hop)) continue;
+        if (Seen_Check_And_Insert(&s->seen, block)) continue;
+        uint8_t fwd[RELAYQ_FRAME_SIZE];
+        memcpy(fwd, block, RELAYQ_FRAME_SIZE);
+        fwd[ROUTE_HDR_HOP_TTL] = Route_Byte(s->route.hop, (uint8_t)(ttl - 1));
+        RelayQ_Push(&s->relay_queue, fwd);
+    }
+}
+
+static void tx_end(uint32_t idx, const SimScenario* sc, SimTotals* tot)
+{
+    SimTx* tx = &tx_ring[idx];
+    int qi = tx->channel;
+    int queen_node = SIM_SOLDIERS + qi;
+
+    /* Soldiers with an open window on this channel; the preamble must find them
+     * listening. Windows closed long before this frame leave the list. */
+    uint16_t kept = 0;
+    for (uint16_t k = 0; k < listener_count[qi]; k++) {
+        int j = listeners[qi][k];
+        SimSoldier* s = &soldiers[j];
+        if (s->rx_until < tx->start - SIM_MAX_AIRTIME_MS) {
+            s->listed = 0;
+            continue;
+        }
+        listeners[qi][kept++] = (uint16_t)j;
+        if (j == tx->sender || tx->start < s->rx_from || tx->start >= s->rx_until) continue;
+        if (frame_ok(idx, j)) soldier_hear(j, tx, sc);
+    }
+    listener_count[qi] = kept;
+
+    if (tx->sender >= SIM_SOLDIERS) return;
+
+    /* Sender: listen window, then sleep until the next wake */
+    SimSoldier* s = &soldiers[tx->sender];
+    s->rx_from = tx->end;
+    s->rx_until = tx->end + SIM_RX_WINDOW_MS;
+    if (!s->listed) {
+        s->listed = 1;
+        listeners[qi][listener_count[qi]++] = (uint16_t)tx->sender;
+    }
+    tot->energy_uj += ENERGY_COST_LISTEN_UJ;
+    double next = tx->end + SIM_RX_WINDOW_MS + s->period_ms * (0.5 + rng_unit());
+    ev_push(next, EV_WAKE, tx->sender, 0);
+
+    /* Own Queen */
+    if (sim_rssi[tx->sender][queen_node] < SIM_SENS_DBM) return;
+    tot->queen_rx++;
+    if (!frame_ok(idx, queen_node)) {
+        tot->queen_rx_lost++;
+        return;
+    }
+    uint8_t blocks = RelayQ_Frame_Blocks(tx->size);
+    for (uint8_t b = 0; b < blocks; b++) {
+        queen_cache_block(qi, &tx->frame[b * RELAYQ_FRAME_SIZE + ROUTE_HDR_SIZE],
+                          sim_rssi[tx->sender][queen_node], tx->end);
+    }
+    ev_push(tx->end + SIM_QUEEN_TURN_MS, EV_REFLEX, qi, idx);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ONE RUN
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void run(const SimScenario* sc, SimTotals* tot)
+{
+    memset(tot, 0, sizeof(*tot));
+    heap_len = 0;
+    tx_total = 0;
+    rd_count = 0;
+    uint32_t saved = rng_state;
+
+    loaded_queen = -1;
+    memset(forest_cache, 0, sizeof(forest_cache));
+    cache_count = 0;
+    for (int q = 0; q < SIM_QUEENS; q++) {
+        memset(&queens[q], 0, sizeof(queens[q]));
+        listener_count[q] = 0;
+        ev_push(FLUSH_INTERVAL_MS, EV_FLUSH, q, 0);
+        if (sc->ota) ev_push(SIM_OTA_START_MS, EV_OTA_START, q, 0);
+    }
+    for (int i = 0; i < SIM_SOLDIERS; i++) {
+        SimSoldier* s = &soldiers[i];
+        memset(s, 0, sizeof(*s));
+        s->did = SIM_DID_BASE + (uint32_t)i;
+        s->queen = nearest_queen(i);
+        s->period_ms = sc->period_ms;
+        s->ota_done_ms = -1.0;
+        Route_Init(&s->route);
+        Seen_Init(&s->seen);
+        RelayQ_Init(&s->relay_queue);
+        LBT_Init(&s->lbt);
+        Ota_Rx_Init(&s->ota);
+        ev_push(rng_unit() * sc->period_ms, EV_WAKE, i, 0);
+        s->direct = sim_rssi[i][SIM_SOLDIERS + s->queen] >= SIM_SENS_DBM;
+        tot->direct += s->direct;
+    }
+
+    const double end_ms = SIM_DAYS * 86400000.0;
+    while (heap_len > 0) {
+        SimEvent ev = ev_pop();
+        if (ev.t >= end_ms) break;
+        tot->events++;
+        switch (ev.type) {
+        case EV_WAKE:   soldier_wake(ev.id, sc, ev.t, tot); break;
+        case EV_CAD:    soldier_cad(ev.id, ev.t, tot); break;
+        case EV_TX_END: tx_end((uint32_t)ev.id, sc, tot); break;
+        case EV_REFLEX: queen_reflex(ev.id, ev.aux, ev.t, tot); break;
+        case EV_FLUSH:
+            /* Hourly timer re-armed by a forced flush is stale */
+            if (ev.aux != UINT32_MAX && ev.aux != queens[ev.id].flush_gen) break;
+            if (ev.t < queens[ev.id].flush_until) {
+                ev_push(queens[ev.id].flush_until, EV_FLUSH, ev.id, UINT32_MAX);
+                break;
+            }
+            queen_flush(ev.id, ev.t, tot);
+            break;
+        case EV_OTA_START:
+            queens[ev.id].ota_active = 1;
+            queens[ev.id].ota_idx = 0;
+            break;
+        }
+    }
+    /* Whatever the caches still hold goes up with the last flush */
+    for (int q = 0; q < SIM_QUEENS; q++) queen_flush(q, end_ms, tot);
+
+    for (uint32_t id = 0; id < rd_count; id++) {
+        tot->evicted += rd_state[id] == RD_EVICTED;
+        tot->superseded += rd_state[id] == RD_SUPERSEDED;
+    }
+    for (int i = 0; i < SIM_SOLDIERS; i++) {
+        const SimSoldier* s = &soldiers[i];
+        if (s->ota_done_ms < 0) continue;
+        tot->ota_ms[tot->ota_done++] = s->ota_done_ms - SIM_OTA_START_MS;
+        tot->ota_done_direct += s->direct;
+    }
+    rng_state = saved;   /* Same draws for every scenario */
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * REPORT
+ * ════════════════════════════════════════════════════════════════════ */
+
+static double lat_pct(const SimTotals* t, double pct)
+{
+    uint64_t want = (uint64_t)ceil(pct / 100.0 * (double)t->delivered), seen = 0;
+    for (uint32_t b = 0; b <= SIM_LAT_BINS; b++) {
+        seen += t->lat_hist[b];
+        if (seen >= want) return (b + 0.5) * SIM_LAT_BIN_S / 60.0;
+    }
+    return 0;
+}
+
+static int cmp_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double ota_pct_h(SimTotals* t, double pct)
+{
+    /* Percentile over the whole forest: a Soldier that never finished is +inf */
+    uint32_t k = (uint32_t)ceil(pct / 100.0 * SIM_SOLDIERS);
+    if (k == 0 || k > t->ota_done) return -1.0;
+    return t->ota_ms[k - 1] / 3600000.0;
+}
+
+static void fmt_h(char* buf, size_t n, double h)
+{
+    if (h < 0) snprintf(buf, n, "-");
+    else snprintf(buf, n, "%.1f", h);
+}
+
+int main(void)
+{
+    static const SimScenario scenarios[] = {
+        { "mesh",      1, SIM_PERIOD_MS,     0 },
+        { "no relay",  0, SIM_PERIOD_MS,     0 },
+        { "mesh 2x",   1, SIM_PERIOD_MS / 2, 0 },
+        { "mesh+ota",  1, SIM_PERIOD_MS,     1 },
+    };
+    static SimTotals tot[sizeof(scenarios) / sizeof(scenarios[0])];
+    double wall[sizeof(scenarios) / sizeof(scenarios[0])];
+
+    Crc_Init();
+    Keys_Init(&key_cache, NULL, 0, aes_key);
+    rd_cap = 1U << 20;
+    rd_born_s = malloc(rd_cap * sizeof(*rd_born_s));
+    rd_state = malloc(rd_cap * sizeof(*rd_state));
+    build_forest();
+
+    for (size_t r = 0; r < sizeof(scenarios) / sizeof(scenarios[0]); r++) {
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        run(&scenarios[r], &tot[r]);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        wall[r] = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+        qsort(tot[r].ota_ms, tot[r].ota_done, sizeof(double), cmp_double);
+    }
+
+    printf("\n🌲 Forest Network — %d Soldiers, %d Queens, %d days (%.1f x %.1f km, one EU868 channel per cluster)\n",
+           SIM_SOLDIERS, SIM_QUEENS, SIM_DAYS, SIM_PLOT_W_M / 1000.0, SIM_PLOT_H_M / 1000.0);
+    printf("══════════════════════════════════════════════════════════════\n");
+    printf("  %d of %d Soldiers reach their Queen directly; the rest depend on the mesh\n",
+           tot[0].direct, SIM_SOLDIERS);
+
+    printf("\n  %-9s %9s %9s %9s %8s %8s %8s %8s %8s %8s\n", "scenario", "readings", "delivery",
+           "mesh_dlv", "p50_min", "p90_min", "p99_min", "queen_rx", "evicted", "supersed");
+    for (size_t r = 0; r < sizeof(scenarios) / sizeof(scenarios[0]); r++) {
+        const SimTotals* t = &tot[r];
+        printf("  %-9s %9llu %8.2f%% %8.2f%% %8.1f %8.1f %8.1f %7.1f%% %8llu %8llu\n", scenarios[r].name,
+               (unsigned long long)t->readings, 100.0 * (double)t->delivered / (double)t->readings,
+               100.0 * (double)t->mesh_delivered / (double)t->mesh_readings,
+               lat_pct(t, 50), lat_pct(t, 90), lat_pct(t, 99),
+               100.0 * (double)(t->queen_rx - t->queen_rx_lost) / (double)t->queen_rx,
+               (unsigned long long)t->evicted, (unsigned long long)t->superseded);
+    }
+
+    printf("\n  %-9s %11s %11s %10s %8s %8s %8s %8s %10s\n", "scenario", "air_s/nday", "queen_duty",
+           "mJ/deliv", "ota_ok", "ota_dir", "ota_p50h", "ota_p90h", "node-d/s");
+    for (size_t r = 0; r < sizeof(scenarios) / sizeof(scenarios[0]); r++) {
+        SimTotals* t = &tot[r];
+        char ok[16] = "-", dir[16] = "-", p50[16] = "-", p90[16] = "-";
+        if (scenarios[r].ota) {
+            snprintf(ok, sizeof(ok), "%.1f%%", 100.0 * t->ota_done / SIM_SOLDIERS);
+            snprintf(dir, sizeof(dir), "%.1f%%", 100.0 * t->ota_done_direct / t->direct);
+            fmt_h(p50, sizeof(p50), ota_pct_h(t, 50));
+            fmt_h(p90, sizeof(p90), ota_pct_h(t, 90));
+        }
+        printf("  %-9s %11.1f %10.3f%% %10.2f %8s %8s %8s %8s %10.0f\n", scenarios[r].name,
+               t->soldier_airtime_ms / 1000.0 / (SIM_SOLDIERS * (double)SIM_DAYS),
+               100.0 * t->queen_airtime_ms / (SIM_QUEENS * SIM_DAYS * 86400000.0),
+               t->energy_uj / (double)t->delivered / 1000.0, ok, dir, p50, p90,
+               SIM_SOLDIERS * (double)SIM_DAYS / wall[r]);
+    }
+    printf("\n");
+    return 0;
+}
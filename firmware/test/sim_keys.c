@@ -0,0 +1,302 @@
+/*
+ * sim_keys.c — Host benchmark of the Queen's per-device key cache.
+ *
+ * N Soldiers, each with its own AES key in the flash table (random DIDs, so
+ * some share a 16-bit Src). A day of uplinks is replayed through the real
+ * firmware/common/silken_keys.c exactly as firmware/queen/main.c drives it:
+ * the reflex (OTA chunk / beacon) on the network key, which every Soldier can
+ * read, then one lookup per block with retries until the decrypted DID matches
+ * the key's owner.
+ *
+ * Traffic model: every Soldier wakes on its own energy-planned interval
+ * (60…3600 s, log-uniform) with a random phase. SIM_DIRECT_PCT of Soldiers
+ * reach the Queen directly; the rest queue their block at a random direct
+ * Soldier, and with SIM_MULTIPATH_PCT also at a second one (several downhill
+ * relays carry the same block, see sim_mesh.c). A direct Soldier's wake sends
+ * one packet: own block + up to 4 queued relays. Every 96th wake adds a
+ * diagnostic frame right after the telemetry packet.
+ *
+ * Reports, per block: cache hit rate, flash records read, key reloads of the
+ * AES peripheral and retries, against a Queen without the cache that searches
+ * the table and reloads the key for every crypto operation. LRU hit rates for
+ * other cache sizes come from the reuse (stack) distance of the same lookups.
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "silken_keys.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_MAX_NODES        KEYS_TABLE_MAX
+#define SIM_SEED             0x5EED6B65U
+#define SIM_DAY_S            86400U
+#define SIM_MIN_INTERVAL_S   60       /* ENERGY_SLEEP_MIN_S */
+#define SIM_MAX_INTERVAL_S   3600     /* ENERGY_SLEEP_MAX_S */
+#define SIM_DIRECT_PCT       40
+#define SIM_MULTIPATH_PCT    50
+#define SIM_QUEUE            4        /* RELAYQ_CAPACITY */
+#define SIM_DIAG_EVERY       96       /* DIAG_INTERVAL_CYCLES */
+#define SIM_LRU_DEPTH        256      /* Deepest LRU size reported */
+
+typedef struct {
+    uint32_t t;
+    uint16_t node;
+} SimWake;
+
+typedef struct {
+    uint32_t did;
+    uint32_t interval_s;
+    uint16_t carrier[2];     /* Direct Soldiers that carry our block; self if direct */
+    uint8_t  carriers;
+    uint16_t wakes;
+    uint16_t queue[SIM_QUEUE];
+    uint8_t  queued;
+} SimNode;
+
+typedef struct {
+    uint64_t packets;
+    uint64_t blocks;
+    uint64_t naive_probes;
+    uint64_t naive_loads;
+    uint64_t stack_hits[4];  /* LRU hits at the sizes below */
+} SimTotals;
+
+static const int lru_sizes[4] = { 4, KEYS_CACHE_SLOTS, 64, SIM_LRU_DEPTH };
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: deterministic across hosts */
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static SimNode nodes[SIM_MAX_NODES];
+static uint16_t direct[SIM_MAX_NODES];
+static struct {
+    KeyTableHeader hdr;
+    KeyRecord rec[SIM_MAX_NODES];
+} flash;
+static const uint32_t network_key[KEYS_WORDS] = { 0 };
+static KeyCache cache;
+static uint16_t lru[SIM_LRU_DEPTH];
+static int lru_used;
+
+static int cmp_record(const void* a, const void* b)
+{
+    uint16_t sa = (uint16_t)((const KeyRecord*)a)->did, sb = (uint16_t)((const KeyRecord*)b)->did;
+    return (sa > sb) - (sa < sb);
+}
+
+static int cmp_wake(const void* a, const void* b)
+{
+    const SimWake* x = a;
+    const SimWake* y = b;
+    if (x->t != y->t) return (x->t > y->t) - (x->t < y->t);
+    return (x->node > y->node) - (x->node < y->node);
+}
+
+static void build_cluster(int n)
+{
+    int n_direct = 0;
+    for (int i = 0; i < n; i++) {
+        nodes[i].did = rng_next() | 1U;
+        /* Log-uniform 60…3600 s: the energy plan spreads across the range */
+        double u = (double)(rng_next() % 10000U) / 10000.0;
+        double iv = SIM_MIN_INTERVAL_S * pow((double)SIM_MAX_INTERVAL_S / SIM_MIN_INTERVAL_S, u);
+        nodes[i].interval_s = (uint32_t)iv;
+        nodes[i].wakes = 0;
+        nodes[i].queued = 0;
+        if ((int)(rng_next() % 100U) < SIM_DIRECT_PCT || n_direct == 0) {
+            direct[n_direct++] = (uint16_t)i;
+            nodes[i].carrier[0] = (uint16_t)i;
+            nodes[i].carriers = 1;
+        } else {
+            nodes[i].carriers = 0;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (nodes[i].carriers) continue;
+        nodes[i].carrier[0] = direct[rng_next() % (uint32_t)n_direct];
+        nodes[i].carriers = 1;
+        if ((int)(rng_next() % 100U) < SIM_MULTIPATH_PCT && n_direct > 1) {
+            uint16_t second = direct[rng_next() % (uint32_t)n_direct];
+            if (second != nodes[i].carrier[0]) nodes[i].carrier[nodes[i].carriers++] = second;
+        }
+    }
+
+    flash.hdr.magic = KEYS_TABLE_MAGIC;
+    flash.hdr.count = (uint32_t)n;
+    for (int i = 0; i < n; i++) {
+        flash.rec[i].did = nodes[i].did;
+        for (int w = 0; w < KEYS_WORDS; w++) flash.rec[i].key[w] = nodes[i].did * (uint32_t)(w + 1);
+    }
+    qsort(flash.rec, (size_t)n, sizeof(flash.rec[0]), cmp_record);
+
+    uint16_t count;
+    const KeyRecord* table = Keys_Table_From_Flash(&flash, &count);
+    Keys_Init(&cache, table, count, network_key);
+    lru_used = 0;
+}
+
+/* Table records a Queen without the cache reads for one Src */
+static uint32_t naive_probes(int n, uint16_t src)
+{
+    uint32_t probes = 0;
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        probes++;
+        if ((uint16_t)flash.rec[mid].did < src) lo = mid + 1;
+        else hi = mid;
+    }
+    while (lo < n) {
+        probes++;
+        if ((uint16_t)flash.rec[lo++].did != src) break;
+    }
+    return probes + 1;
+}
+
+/* Reuse distance: position of src in a move-to-front list = LRU hit at any larger size */
+static void stack_access(uint16_t src, SimTotals* tot)
+{
+    int pos = -1;
+    for (int i = 0; i < lru_used; i++) {
+        if (lru[i] == src) { pos = i; break; }
+    }
+    for (int k = 0; k < 4; k++) {
+        if (pos >= 0 && pos < lru_sizes[k]) tot->stack_hits[k]++;
+    }
+    int from = pos >= 0 ? pos : (lru_used < SIM_LRU_DEPTH ? lru_used++ : SIM_LRU_DEPTH - 1);
+    memmove(&lru[1], &lru[0], (size_t)from * sizeof(lru[0]));
+    lru[0] = src;
+}
+
+static void key_for(uint16_t src, uint8_t attempt, KeyRef* ref, SimTotals* tot)
+{
+    *ref = Keys_Lookup(&cache, src, attempt);
+    if (attempt == 0) stack_access(src, tot);
+    Keys_Mark_Loaded(&cache, ref);
+}
+
+/* One packet at the Queen, the same sequence as firmware/queen/main.c */
+static void queen_receive(int n, const uint16_t* blocks, int count, SimTotals* tot)
+{
+    KeyRef ref;
+    uint8_t body[4];
+
+    ref = Keys_Network(&cache);                            /* Reflex shot */
+    Keys_Mark_Loaded(&cache, &ref);
+    tot->naive_loads++;
+    tot->packets++;
+
+    for (int b = 0; b < count; b++) {
+        uint32_t did = nodes[blocks[b]].did;
+        body[0] = (uint8_t)(did >> 24); body[1] = (uint8_t)(did >> 16);
+        body[2] = (uint8_t)(did >> 8);  body[3] = (uint8_t)did;
+        tot->blocks++;
+        tot->naive_probes += naive_probes(n, (uint16_t)did);
+
+        for (uint8_t attempt = 0; ; attempt++) {
+            key_for((uint16_t)did, attempt, &ref, tot);
+            if (ref.key == NULL) break;
+            tot->naive_loads++;
+            if (Keys_Ref_Owns(&ref, body)) break;
+        }
+    }
+}
+
+static void run_day(int n, SimTotals* tot)
+{
+    size_t cap = 0;
+    for (int i = 0; i < n; i++) cap += SIM_DAY_S / nodes[i].interval_s + 1;
+    SimWake* wakes = malloc(cap * sizeof(*wakes));
+    size_t w = 0;
+    if (wakes == NULL) return;
+
+    for (int i = 0; i < n; i++) {
+        for (uint32_t t = rng_next() % nodes[i].interval_s; t < SIM_DAY_S; t += nodes[i].interval_s) {
+            wakes[w].t = t;
+            wakes[w++].node = (uint16_t)i;
+        }
+    }
+    qsort(wakes, w, sizeof(*wakes), cmp_wake);
+
+    for (size_t k = 0; k < w; k++) {
+        SimNode* me = &nodes[wakes[k].node];
+        uint16_t self = wakes[k].node;
+        me->wakes++;
+
+        if (me->carrier[0] == self) {
+            uint16_t packet[1 + SIM_QUEUE];
+            packet[0] = self;
+            memcpy(&packet[1], me->queue, me->queued * sizeof(me->queue[0]));
+            queen_receive(n, packet, 1 + me->queued, tot);
+            me->queued = 0;
+        } else {
+            for (int c = 0; c < me->carriers; c++) {
+                SimNode* carrier = &nodes[me->carrier[c]];
+                if (carrier->queued == SIM_QUEUE) {
+                    memmove(&carrier->queue[0], &carrier->queue[1], (SIM_QUEUE - 1) * sizeof(carrier->queue[0]));
+                    carrier->queued--;
+                }
+                carrier->queue[carrier->queued++] = self;
+            }
+        }
+        if (me->wakes % SIM_DIAG_EVERY == 0 && me->carrier[0] == self) {
+            queen_receive(n, &self, 1, tot);
+        }
+    }
+    free(wakes);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    static const int cluster_sizes[] = { 500, 1000, 3000 };
+
+    printf("\n🔑 Queen Per-Device Keys — LRU Cache over a Flash Key Table (one day)\n");
+    printf("══════════════════════════════════════════════════════════════\n");
+
+    for (size_t c = 0; c < sizeof(cluster_sizes) / sizeof(cluster_sizes[0]); c++) {
+        int n = cluster_sizes[c];
+        SimTotals tot;
+        memset(&tot, 0, sizeof(tot));
+        build_cluster(n);
+        run_day(n, &tot);
+
+        const KeyStats* st = &cache.stats;
+        double blocks = (double)tot.blocks;
+        double lookups = (double)st->lookups;
+        printf("\n  %d Soldiers: %llu packets, %llu blocks\n", n,
+               (unsigned long long)tot.packets, (unsigned long long)tot.blocks);
+        printf("  %-9s %9s %12s %12s %10s\n", "queen", "hit rate", "flash/block", "reload/block", "retry/blk");
+        printf("  %-9s %8s%% %12.2f %12.2f %10s\n", "no cache", "0.0",
+               (double)tot.naive_probes / blocks, (double)tot.naive_loads / blocks, "-");
+        printf("  %-9s %8.1f%% %12.2f %12.2f %10.4f\n", "lru-16",
+               100.0 * (double)st->hits / lookups, (double)st->table_probes / blocks,
+               (double)st->loads / blocks, (double)st->retries / blocks);
+        printf("  LRU hit rate by size:");
+        for (int k = 0; k < 4; k++) {
+            printf("  %d → %.1f%%", lru_sizes[k], 100.0 * (double)tot.stack_hits[k] / lookups);
+        }
+        printf("\n");
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * sim_lbt.c — Host Monte Carlo simulation of a Soldier wake burst at the Queen.
+ *
+ * N Soldiers wake at the same instant (thunderclap, earthquake) and each sends
+ * one 20-byte wire block to the Queen. Two collision-avoidance schemes are compared:
+ *   jitter — current behaviour: random 0-500 ms delay, then blind Radio.Send
+ *   lbt    — same jitter, then CAD + binary exponential backoff
+ *            (firmware/common/silken_lbt.c, the same object code as on the MCU)
+ *
+ * Radio model: frames overlap at the Queen → both lost (no capture effect).
+ * A node's CAD sees a neighbour's transmission if the two can hear each other
+ * (HIDDEN_PCT of pairs cannot) and the transmission overlaps the CAD window.
+ *
+ * Reports delivery ratio, radio energy per delivered frame, mean TX latency
+ * and CAD / backoff statistics.
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "silken_lbt.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_MAX_NODES        100
+#define SIM_TRIALS           200
+#define SIM_SEED             0x5EED1234U
+#define SIM_JITTER_MAX_MS    500      /* TX_JITTER_MAX_MS in soldier/main.c */
+#define SIM_AIRTIME_US       51000    /* 20 B wire block, SF7 / 125 kHz, CR 4/5 */
+#define SIM_CAD_US           2000     /* 2 symbols at SF7 */
+#define SIM_TURNAROUND_US    1000     /* CAD done → TX start */
+#define SIM_TX_UJ            7300     /* ENERGY_COST_RELAY_UJ: one extra frame */
+#define SIM_CAD_UJ           60       /* ~5 mA × 3.3 V × 3 ms + wake */
+
+typedef enum { SCHEME_JITTER = 0, SCHEME_LBT = 1 } SimScheme;
+
+typedef struct {
+    uint32_t next_us;      /* Next CAD (lbt) or TX (jitter) instant */
+    uint32_t tx_start_us;
+    uint8_t  sent;
+} SimNode;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t delivered;
+    uint64_t energy_uj;
+    uint64_t latency_us;
+    uint64_t cad_runs;
+    uint64_t backoffs;
+    uint64_t forced;
+} SimTotals;
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: deterministic across hosts */
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static uint8_t hears[SIM_MAX_NODES][SIM_MAX_NODES];
+
+static void build_topology(int n, int hidden_pct)
+{
+    for (int i = 0; i < n; i++) {
+        hears[i][i] = 1;
+        for (int j = i + 1; j < n; j++) {
+            uint8_t h = (int)(rng_next() % 100) >= hidden_pct;
+            hears[i][j] = h;
+            hears[j][i] = h;
+        }
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ONE BURST
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void run_burst(int n, SimScheme scheme, SimTotals* tot)
+{
+    SimNode nodes[SIM_MAX_NODES];
+    LbtState lbt[SIM_MAX_NODES];
+
+    for (int i = 0; i < n; i++) {
+        nodes[i].next_us = (rng_next() % SIM_JITTER_MAX_MS) * 1000U;
+        nodes[i].sent = 0;
+        LBT_Init(&lbt[i]);
+        LBT_Frame_Start(&lbt[i]);
+    }
+
+    /* Process decisions in time order: a TX decided at t starts after t,
+     * so every transmission a CAD could see is already known. */
+    for (int done = 0; done < n; ) {
+        int k = -1;
+        for (int i = 0; i < n; i++) {
+            if (!nodes[i].sent && (k < 0 || nodes[i].next_us < nodes[k].next_us)) k = i;
+        }
+        uint32_t t = nodes[k].next_us;
+
+        if (scheme == SCHEME_JITTER) {
+            nodes[k].tx_start_us = t;
+        } else {
+            uint8_t busy = 0;
+            for (int j = 0; j < n && !busy; j++) {
+                if (j == k || !nodes[j].sent || !hears[k][j]) continue;
+                uint32_t s = nodes[j].tx_start_us, e = s + SIM_AIRTIME_US;
+                if (s < t + SIM_CAD_US && e > t) busy = 1;
+            }
+            tot->energy_uj += SIM_CAD_UJ;
+            uint32_t backoff_ms = LBT_On_Cad(&lbt[k], busy, rng_next());
+            if (backoff_ms) {
+                nodes[k].next_us = t + SIM_CAD_US + backoff_ms * 1000U;
+                continue;
+            }
+            nodes[k].tx_start_us = t + SIM_CAD_US + SIM_TURNAROUND_US;
+        }
+
+        nodes[k].sent = 1;
+        tot->energy_uj += SIM_TX_UJ;
+        done++;
+    }
+
+    for (int i = 0; i < n; i++) {
+        uint32_t s = nodes[i].tx_start_us, e = s + SIM_AIRTIME_US;
+        uint8_t ok = 1;
+        for (int j = 0; j < n && ok; j++) {
+            if (j == i) continue;
+            uint32_t s2 = nodes[j].tx_start_us;
+            if (s2 < e && s2 + SIM_AIRTIME_US > s) ok = 0;
+        }
+        tot->frames++;
+        tot->delivered += ok;
+        tot->latency_us += s;
+        tot->cad_runs += lbt[i].cad_runs;
+        tot->backoffs += lbt[i].cad_busy;
+        tot->forced += lbt[i].forced_tx;
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void print_row(const char* name, const SimTotals* t)
+{
+    double frames = (double)t->frames;
+    double ratio = 100.0 * (double)t->delivered / frames;
+    char mj[16];
+    if (t->delivered) {
+        snprintf(mj, sizeof(mj), "%.2f", (double)t->energy_uj / (double)t->delivered / 1000.0);
+    } else {
+        snprintf(mj, sizeof(mj), "-");   /* Nothing got through */
+    }
+    printf("  %-7s %8.1f%% %11s %10.0f %8.2f %9.2f %8.3f\n",
+           name, ratio, mj, (double)t->latency_us / frames / 1000.0,
+           (double)t->cad_runs / frames, (double)t->backoffs / frames,
+           (double)t->forced / frames);
+}
+
+int main(void)
+{
+    static const int cluster_sizes[] = { 10, 25, 50, 100 };
+    static const int hidden_pcts[] = { 0, 20 };
+
+    printf("\n📡 Soldier Wake Burst — Listen-Before-Talk vs Jitter (%d trials each)\n", SIM_TRIALS);
+    printf("══════════════════════════════════════════════════════════════\n");
+
+    for (size_t h = 0; h < sizeof(hidden_pcts) / sizeof(hidden_pcts[0]); h++) {
+        for (size_t c = 0; c < sizeof(cluster_sizes) / sizeof(cluster_sizes[0]); c++) {
+            int n = cluster_sizes[c];
+            SimTotals jit, lbt;
+            memset(&jit, 0, sizeof(jit));
+            memset(&lbt, 0, sizeof(lbt));
+
+            for (int trial = 0; trial < SIM_TRIALS; trial++) {
+                build_topology(n, hidden_pcts[h]);
+                uint32_t saved = rng_state;
+                run_burst(n, SCHEME_JITTER, &jit);
+                rng_state = saved; /* Same jitter draws for both schemes */
+                run_burst(n, SCHEME_LBT, &lbt);
+            }
+
+            printf("\n  %d nodes, %d%% hidden pairs\n", n, hidden_pcts[h]);
+            printf("  %-7s %9s %11s %10s %8s %9s %8s\n",
+                   "scheme", "delivery", "mJ/deliv", "lat_ms", "cad/fr", "backoff", "forced");
+            print_row("jitter", &jit);
+            print_row("lbt", &lbt);
+        }
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,267 @@
+/*
+ * sim_mesh.c — Host simulation of mesh relay airtime: TTL flood vs gradient.
+ *
+ * N Soldiers are scattered over a square forest plot with the Queen in the
+ * centre. Every Soldier originates one telemetry frame; the simulation counts
+ * how many relayed blocks each forwarding scheme puts on air and whether the
+ * frame reaches the Queen within its TTL:
+ *   flood    — previous behaviour: every Soldier that hears a fresh frame
+ *              with TTL > 0 relays it (seen-set stops loops)
+ *   gradient — only Soldiers closer to the Queen than the transmitter relay
+ *              (firmware/common/silken_route.c, the same object code as on the MCU)
+ *   ideal    — one forwarder per hop on the shortest path: hop − 1 relays
+ *
+ * Radio model: log-distance path loss with per-link log-normal shadowing
+ * (symmetric), link exists above SF7 sensitivity. Every neighbour is assumed
+ * to be listening — the worst case for flood airtime. Per-node seen-sets use
+ * firmware/common/silken_seen.c. The gradient is learnt by replaying Queen
+ * beacons and overheard frames through Route_On_Heard until it settles.
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "silken_route.h"
+#include "silken_seen.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_MAX_NODES        500
+#define SIM_NODE_FRAMES      2000     /* Originated frames per cluster size */
+#define SIM_SEED             0x5EED4D45U
+#define SIM_PLOT_M           2000.0   /* Square side, Queen in the centre */
+#define SIM_TX_DBM           14.0
+#define SIM_PL_1M_DB         40.0     /* Path loss at 1 m, 868 MHz */
+#define SIM_PL_EXP           3.5      /* Forest canopy */
+#define SIM_SHADOW_DB        4.0
+#define SIM_SENS_DBM         (-123.0) /* SF7 / 125 kHz */
+#define SIM_TTL              3        /* DEFAULT_TTL in soldier/main.c */
+#define SIM_LEARN_ROUNDS     8
+
+#define QUEEN                SIM_MAX_NODES /* Index of the Queen in rssi[][] */
+
+typedef enum { SCHEME_FLOOD = 0, SCHEME_GRADIENT = 1 } SimScheme;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t delivered;
+    uint64_t relays;
+} SimTotals;
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: deterministic across hosts */
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static double rng_unit(void)
+{
+    return ((double)rng_next() + 1.0) / 4294967297.0;
+}
+
+static double rng_gauss(void)
+{
+    /* Box-Muller */
+    return sqrt(-2.0 * log(rng_unit())) * cos(6.283185307179586 * rng_unit());
+}
+
+static double xs[SIM_MAX_NODES + 1], ys[SIM_MAX_NODES + 1];
+static int16_t rssi[SIM_MAX_NODES + 1][SIM_MAX_NODES + 1];
+static uint16_t nbr[SIM_MAX_NODES][SIM_MAX_NODES];
+static uint16_t nbr_count[SIM_MAX_NODES];
+static uint8_t hop_true[SIM_MAX_NODES];
+static RouteState route[SIM_MAX_NODES];
+static SeenSet seen[SIM_MAX_NODES];
+
+static uint8_t linked(int a, int b)
+{
+    return a != b && rssi[a][b] >= (int16_t)SIM_SENS_DBM;
+}
+
+static void build_topology(int n)
+{
+    for (int i = 0; i < n; i++) {
+        xs[i] = rng_unit() * SIM_PLOT_M;
+        ys[i] = rng_unit() * SIM_PLOT_M;
+    }
+    xs[QUEEN] = SIM_PLOT_M / 2.0;
+    ys[QUEEN] = SIM_PLOT_M / 2.0;
+
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j <= QUEEN; j++) {
+            if (j >= n && j != QUEEN) continue;
+            double d = hypot(xs[i] - xs[j], ys[i] - ys[j]);
+            if (d < 1.0) d = 1.0;
+            double pl = SIM_PL_1M_DB + 10.0 * SIM_PL_EXP * log10(d) + SIM_SHADOW_DB * rng_gauss();
+            double r = SIM_TX_DBM - pl;
+            if (r < -200.0) r = -200.0;
+            rssi[i][j] = rssi[j][i] = (int16_t)lround(r);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        nbr_count[i] = 0;
+        for (int j = 0; j < n; j++) {
+            if (linked(i, j)) nbr[i][nbr_count[i]++] = (uint16_t)j;
+        }
+    }
+}
+
+static void shortest_hops(int n)
+{
+    /* Breadth-first from the Queen over every usable link */
+    static int queue[SIM_MAX_NODES];
+    int head = 0, tail = 0;
+    for (int i = 0; i < n; i++) {
+        hop_true[i] = ROUTE_HOP_UNKNOWN;
+        if (linked(QUEEN, i)) {
+            hop_true[i] = 1;
+            queue[tail++] = i;
+        }
+    }
+    while (head < tail) {
+        int t = queue[head++];
+        for (int k = 0; k < nbr_count[t]; k++) {
+            int j = nbr[t][k];
+            if (hop_true[j] != ROUTE_HOP_UNKNOWN) continue;
+            hop_true[j] = (uint8_t)(hop_true[t] + 1);
+            queue[tail++] = j;
+        }
+    }
+}
+
+static void learn_gradient(int n)
+{
+    for (int i = 0; i < n; i++) Route_Init(&route[i]);
+
+    for (int round = 0; round < SIM_LEARN_ROUNDS; round++) {
+        for (int j = 0; j < n; j++) {
+            if (linked(QUEEN, j)) Route_On_Heard(&route[j], ROUTE_HOP_QUEEN, rssi[QUEEN][j]);
+        }
+        for (int t = 0; t < n; t++) {
+            for (int k = 0; k < nbr_count[t]; k++) {
+                int j = nbr[t][k];
+                Route_On_Heard(&route[j], route[t].hop, rssi[t][j]);
+            }
+        }
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ONE FRAME
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void run_frame(int origin, uint8_t seq, SimScheme scheme, SimTotals* tot)
+{
+    /* Breadth-first over transmissions: (transmitter, TTL carried) */
+    static int q_tx[4 * SIM_MAX_NODES];
+    static uint8_t q_ttl[4 * SIM_MAX_NODES];
+    int head = 0, tail = 0;
+    uint8_t delivered = 0;
+    uint8_t frame[ROUTE_BLOCK_SIZE];
+    uint8_t* body = &frame[ROUTE_HDR_SIZE]; /* Plaintext stands in for the AES body */
+
+    memset(frame, 0, sizeof(frame));
+    body[0] = (uint8_t)((origin + 1) >> 24);
+    body[1] = (uint8_t)((origin + 1) >> 16);
+    body[2] = (uint8_t)((origin + 1) >> 8);
+    body[3] = (uint8_t)(origin + 1);
+    body[14] = seq;
+    Route_Hdr_From_Body(frame, body);
+
+    Seen_Check_And_Insert(&seen[origin], frame); /* Own echo */
+    q_tx[tail] = origin;
+    q_ttl[tail++] = SIM_TTL;
+
+    while (head < tail) {
+        int t = q_tx[head];
+        uint8_t ttl = q_ttl[head++];
+        uint8_t tx_hop = scheme == SCHEME_GRADIENT ? route[t].hop : ROUTE_HOP_UNKNOWN;
+
+        if (linked(t, QUEEN)) delivered = 1;
+        if (ttl == 0) continue;
+
+        for (int k = 0; k < nbr_count[t]; k++) {
+            int j = nbr[t][k];
+            if (scheme == SCHEME_GRADIENT && !Route_Should_Relay(&route[j], tx_hop)) continue;
+            if (Seen_Check_And_Insert(&seen[j], frame)) continue;
+            if (tail == (int)(sizeof(q_tx) / sizeof(q_tx[0]))) break;
+            q_tx[tail] = j;
+            q_ttl[tail++] = (uint8_t)(ttl - 1);
+            tot->relays++;
+        }
+    }
+
+    tot->frames++;
+    tot->delivered += delivered;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void print_row(const char* name, const SimTotals* t, double baseline)
+{
+    double frames = (double)t->frames;
+    printf("  %-9s %8.1f%% %11.2f %10.1f%%\n",
+           name, 100.0 * (double)t->delivered / frames, (double)t->relays / frames,
+           baseline > 0.0 ? 100.0 * (double)t->relays / baseline : 100.0);
+}
+
+int main(void)
+{
+    static const int cluster_sizes[] = { 50, 100, 250, 500 };
+
+    printf("\n🌲 Mesh Relay Airtime — TTL Flood vs Hop-Count Gradient (%d frames each)\n", SIM_NODE_FRAMES);
+    printf("══════════════════════════════════════════════════════════════\n");
+
+    for (size_t c = 0; c < sizeof(cluster_sizes) / sizeof(cluster_sizes[0]); c++) {
+        int n = cluster_sizes[c];
+        int trials = SIM_NODE_FRAMES / n; /* Fresh topology per trial */
+        SimTotals flood, grad, ideal;
+        memset(&flood, 0, sizeof(flood));
+        memset(&grad, 0, sizeof(grad));
+        memset(&ideal, 0, sizeof(ideal));
+
+        for (int trial = 0; trial < trials; trial++) {
+            build_topology(n);
+            learn_gradient(n);
+            shortest_hops(n);
+
+            for (int s = 0; s < 2; s++) {
+                SimScheme scheme = s ? SCHEME_GRADIENT : SCHEME_FLOOD;
+                for (int i = 0; i < n; i++) Seen_Init(&seen[i]);
+                for (int i = 0; i < n; i++) {
+                    run_frame(i, (uint8_t)trial, scheme, s ? &grad : &flood);
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                ideal.frames++;
+                if (hop_true[i] <= SIM_TTL + 1) {
+                    ideal.delivered++;
+                    ideal.relays += (uint64_t)(hop_true[i] - 1);
+                }
+            }
+        }
+
+        printf("\n  %d nodes on %.0f × %.0f m\n", n, SIM_PLOT_M, SIM_PLOT_M);
+        printf("  %-9s %9s %11s %11s\n", "scheme", "delivery", "relays/fr", "vs flood");
+        print_row("flood", &flood, (double)flood.relays);
+        print_row("gradient", &grad, (double)flood.relays);
+        print_row("ideal", &ideal, (double)flood.relays);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,317 @@
+/*
+ * sim_rxring.c — Host stress test of the Queen's RX path: one frame buffer vs the RX ring.
+ *
+ * One Queen listens to N direct Soldiers for a simulated day. Frames reach the
+ * Queen back to back (collisions are sim_tdma.c's business): Poisson arrivals,
+ * each Soldier waking every SIM_PERIOD_S on average with a batch of 1-8 blocks,
+ * plus a storm every hour — SIM_STORM_PCT of the cluster panics within one
+ * second (a panic goes out at once under LBT). The main loop is replayed with the timings of
+ * firmware/queen/main.c:
+ *   reflex  — beacon / OTA chunk for SIM_REFLEX_PCT of frames: TX + 60 ms pause,
+ *             the radio hears nothing until Radio.Rx is armed again
+ *   blocks  — SIM_BLOCK_MS per block (AES, dedup scan of the 50-entry cache)
+ *   flush   — at CACHE_MAX_ENTRIES − FLUSH_HEADROOM entries the loop blocks for
+ *             SIM_FLUSH_MS (AT+CCOAPNEW, hex over UART, HAL_Delay(2000), CCOAPDEL)
+ * Two receive paths are compared:
+ *   single — before the ring: OnRxDone overwrites one buffer behind lora_rx_flag,
+ *            Radio.Rx is re-armed only after the frame is processed and the
+ *            reflex fires however long the frame waited
+ *   ring-K — firmware/common/silken_rxring.c (the same object code as on the
+ *            MCU) capped at K queued frames: Radio.Rx right after the reflex,
+ *            no reflex past RXRING_REFLEX_MAX_AGE_MS
+ *   sched  — ring-8 under the cooperative scheduler (firmware/common/silken_sched.c):
+ *            the flush is a chain of steps ≤ SIM_SCHED_STEP_MS, modem waits are
+ *            timers, and the RADIO task runs between any two steps
+ *
+ * Reports frames lost while the radio was deaf, frames dropped or overwritten
+ * in the buffer, delivery ratio, worst queue depth and the worst wait in the
+ * queue, reflexes that fired into a closed Soldier RX window, and the share of
+ * the day the core is awake (the polling loop never sleeps; the scheduler
+ * sleeps whenever no task has events — reflex pauses are STOP2 in both).
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "silken_rxring.h"
+#include "silken_sync.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_SEED             0x41C3B00FU
+#define SIM_DAY_MS           86400000U
+#define SIM_PERIOD_S         600      /* Mean wake interval of the energy plan */
+#define SIM_REFLEX_PCT       30       /* Frames answered by a beacon / OTA chunk */
+#define SIM_REFLEX_MS        60       /* Queen_Pause_Ms(60) after Radio.Send */
+#define SIM_RX_WINDOW_MS     500      /* LORA_RX_TIMEOUT_MS in soldier/main.c */
+#define SIM_BLOCK_MS         2        /* Decrypt + cache per block */
+#define SIM_CACHE_FLUSH_AT   45       /* CACHE_MAX_ENTRIES − FLUSH_HEADROOM */
+#define SIM_FLUSH_MS         3860     /* 1000 + ~360 UART + 2000 + 500 */
+#define SIM_STORM_EVERY_MS   3600000U
+#define SIM_STORM_PCT        20
+#define SIM_STORM_SPAN_MS    SYNC_SLOT_MS
+#define SIM_FLUSH_CPU_MS     200      /* Pack + AES-CBC + ~2.1 k hex chars on 115200 UART + AT lines */
+#define SIM_SCHED_STEP_MS    12       /* Longest FLUSH step: FLUSH_HEX_CHUNK bytes as hex */
+#define SIM_MAX_FRAMES       600000
+
+typedef struct {
+    uint32_t start_ms;
+    uint32_t end_ms;
+    uint8_t  blocks;
+    uint8_t  reflex;         /* Needs a reply in the Soldier's RX window */
+} SimFrame;
+
+typedef struct {
+    uint32_t offered;
+    uint32_t deaf;           /* On air while the Queen's radio was not listening */
+    uint32_t dropped;        /* Ring full / single buffer overwritten */
+    uint32_t delivered;
+    uint32_t stale_reflex;   /* Reply sent after the Soldier stopped listening */
+    uint32_t skipped_reflex; /* Ring: reply not sent, window already closed */
+    uint32_t max_wait_ms;
+    uint32_t high_water;
+    uint32_t awake_ms;       /* Core running (scheduler); polling — the whole day */
+} SimTotals;
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: deterministic across hosts */
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static double rng_exp(double mean)
+{
+    double u = ((double)(rng_next() % 1000000U) + 0.5) / 1000000.0;
+    return -mean * log(u);
+}
+
+static SimFrame frames[SIM_MAX_FRAMES];
+
+static int cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Frame schedule for the day: Poisson wakes + hourly storms, serialized on air */
+static int build_traffic(int n)
+{
+    static uint32_t wants[SIM_MAX_FRAMES];
+    int count = 0;
+    double mean_gap_ms = (double)SIM_PERIOD_S * 1000.0 / n;
+
+    for (double t = rng_exp(mean_gap_ms); t < SIM_DAY_MS && count < SIM_MAX_FRAMES; t += rng_exp(mean_gap_ms)) {
+        wants[count++] = (uint32_t)t;
+    }
+    for (uint32_t storm = SIM_STORM_EVERY_MS / 2; storm < SIM_DAY_MS; storm += SIM_STORM_EVERY_MS) {
+        int panics = n * SIM_STORM_PCT / 100;
+        for (int i = 0; i < panics && count < SIM_MAX_FRAMES; i++) {
+            wants[count++] = storm + rng_next() % SIM_STORM_SPAN_MS;
+        }
+    }
+    qsort(wants, (size_t)count, sizeof(wants[0]), cmp_u32);
+
+    uint32_t air_free = 0;
+    for (int i = 0; i < count; i++) {
+        SimFrame* f = &frames[i];
+        f->blocks = (uint8_t)(1 + rng_next() % RELAYQ_AGG_MAX_BLOCKS);
+        f->reflex = (uint8_t)(rng_next() % 100U < SIM_REFLEX_PCT);
+        f->start_ms = wants[i] > air_free ? wants[i] : air_free;
+        f->end_ms = f->start_ms + Sync_Airtime_Ms((uint16_t)(f->blocks * RELAYQ_FRAME_SIZE));
+        air_free = f->end_ms + 1;
+    }
+    return count;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * QUEEN MAIN LOOP
+ * ════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    uint8_t  ring;           /* 0 — single buffer */
+    uint8_t  depth;          /* Ring: frames allowed in the queue */
+    uint8_t  sched;          /* Flush in short steps, RX in between */
+    RxRing   rx;
+    uint8_t  single_full;
+    int      single_frame;
+    int      busy_frame;     /* Frame being processed, −1 — idle */
+    uint32_t busy_until;     /* Slot / lora_rx_flag released at this time */
+    uint32_t loop_free;      /* Main loop back at the RX check (after a flush) */
+    uint32_t deaf_from;
+    uint32_t deaf_until;
+    uint32_t cache;
+} SimQueen;
+
+static int queued_frame(SimQueen* q)
+{
+    if (!q->ring) return q->single_full ? q->single_frame : -1;
+    RxSlot* s = RxRing_Peek(&q->rx);
+    return s == NULL ? -1 : (int)(s->frame[0] | (s->frame[1] << 8) | (s->frame[2] << 16));
+}
+
+/* Main loop runs up to now_ms: finishes the current frame, starts the next */
+static void queen_run(SimQueen* q, uint32_t now_ms, SimTotals* tot)
+{
+    for (;;) {
+        if (q->busy_frame >= 0) {
+            if (q->busy_until > now_ms) return;
+            if (q->ring) RxRing_Release(&q->rx);
+            else q->single_full = 0;
+            q->busy_frame = -1;
+        }
+        int k = queued_frame(q);
+        if (k < 0 || q->loop_free > now_ms) return;
+
+        const SimFrame* f = &frames[k];
+        uint32_t start = q->loop_free > f->end_ms ? q->loop_free : f->end_ms;
+        uint32_t wait = start - f->end_ms;
+        if (wait > tot->max_wait_ms) tot->max_wait_ms = wait;
+
+        uint32_t t = start;
+        uint8_t fresh = wait <= RXRING_REFLEX_MAX_AGE_MS;
+        if (f->reflex && (fresh || !q->ring)) {
+            q->deaf_from = t;
+            t += SIM_REFLEX_MS;
+            if (wait + Sync_Airtime_Ms(ROUTE_BLOCK_SIZE) > SIM_RX_WINDOW_MS) tot->stale_reflex++;
+        } else if (f->reflex) {
+            tot->skipped_reflex++;
+        }
+        t += (uint32_t)f->blocks * SIM_BLOCK_MS;
+        tot->awake_ms += (uint32_t)f->blocks * SIM_BLOCK_MS;
+        /* Single buffer: Radio.Rx only after processing; ring: right after the reflex */
+        if (f->reflex && (fresh || !q->ring)) q->deaf_until = q->ring ? q->deaf_from + SIM_REFLEX_MS : t;
+        tot->delivered++;
+
+        q->busy_frame = k;
+        q->busy_until = t;
+
+        /* The flush runs after the frame is released: the buffer is free, the loop is not */
+        q->cache += f->blocks;
+        if (q->cache >= SIM_CACHE_FLUSH_AT) {
+            /* Scheduler: the next frame waits for one step at most, not for the session */
+            t += q->sched ? SIM_SCHED_STEP_MS : SIM_FLUSH_MS;
+            tot->awake_ms += SIM_FLUSH_CPU_MS;
+            q->cache = 0;
+        }
+        q->loop_free = t;
+    }
+}
+
+/* OnRxDone for frame k (the radio was listening for its whole airtime) */
+static void queen_rx_done(SimQueen* q, int k, SimTotals* tot)
+{
+    if (!q->ring) {
+        tot->high_water = 1;
+        if (!q->single_full) {
+            q->single_full = 1;
+            q->single_frame = k;
+        } else if (q->busy_frame == q->single_frame) {
+            tot->dropped++;                         /* lora_rx_flag = 0 at the end clears it */
+        } else {
+            tot->dropped++;                         /* Unread frame overwritten */
+            q->single_frame = k;
+        }
+        return;
+    }
+    if (RxRing_Count(&q->rx) >= q->depth) {
+        q->rx.received++;
+        q->rx.dropped++;
+        tot->dropped++;
+        return;
+    }
+    RxSlot* s = RxRing_Claim(&q->rx);
+    s->frame[0] = (uint8_t)k;
+    s->frame[1] = (uint8_t)(k >> 8);
+    s->frame[2] = (uint8_t)(k >> 16);
+    s->size = (uint16_t)(frames[k].blocks * RELAYQ_FRAME_SIZE);
+    s->rx_ms = frames[k].end_ms;
+    RxRing_Publish(&q->rx);
+    if (q->rx.high_water > tot->high_water) tot->high_water = q->rx.high_water;
+}
+
+static void run_day(int count, uint8_t ring, uint8_t depth, uint8_t sched, SimTotals* tot)
+{
+    static SimQueen q;
+    memset(&q, 0, sizeof(q));
+    memset(tot, 0, sizeof(*tot));
+    q.ring = ring;
+    q.depth = depth;
+    q.sched = sched;
+    q.busy_frame = -1;
+    RxRing_Init(&q.rx);
+
+    for (int k = 0; k < count; k++) {
+        const SimFrame* f = &frames[k];
+        tot->offered++;
+        queen_run(&q, f->start_ms, tot);
+        /* Deaf if any part of the frame overlaps a reflex-to-Radio.Rx window */
+        if (f->start_ms < q.deaf_until && f->end_ms > q.deaf_from) {
+            tot->deaf++;
+            continue;
+        }
+        queen_run(&q, f->end_ms, tot);
+        if (f->start_ms < q.deaf_until && f->end_ms > q.deaf_from) {
+            tot->deaf++;
+            continue;
+        }
+        queen_rx_done(&q, k, tot);
+    }
+    queen_run(&q, UINT32_MAX, tot);
+    if (!sched) tot->awake_ms = SIM_DAY_MS;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void print_row(const char* name, const SimTotals* t)
+{
+    printf("  %-8s %8u %7u %8u %8.2f%% %6u %8.1f %8u %8u %7.1f%%\n", name,
+           t->offered, t->deaf, t->dropped, 100.0 * t->delivered / t->offered,
+           t->high_water, t->max_wait_ms / 1000.0, t->stale_reflex, t->skipped_reflex,
+           100.0 * t->awake_ms / SIM_DAY_MS);
+}
+
+int main(void)
+{
+    static const int cluster_sizes[] = { 100, 300, 1000 };
+    static const uint8_t depths[] = { 2, 4, RXRING_SLOTS };
+
+    printf("\n📥 Queen RX Path — Single Buffer vs SPSC Ring vs Scheduler (24 h, storm of %d%% every hour)\n",
+           SIM_STORM_PCT);
+    printf("══════════════════════════════════════════════════════════════\n");
+
+    for (size_t c = 0; c < sizeof(cluster_sizes) / sizeof(cluster_sizes[0]); c++) {
+        int n = cluster_sizes[c];
+        int count = build_traffic(n);
+        SimTotals tot;
+        char name[16];
+
+        printf("\n  %d direct Soldiers (%.1f frames/min + storms)\n", n, 60.0 * n / SIM_PERIOD_S);
+        printf("  %-8s %8s %7s %8s %9s %6s %8s %8s %8s %8s\n",
+               "rx path", "frames", "deaf", "dropped", "deliver", "queue", "wait s", "stale", "skipped", "awake");
+        run_day(count, 0, 1, 0, &tot);
+        print_row("single", &tot);
+        for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+            run_day(count, 1, depths[d], 0, &tot);
+            snprintf(name, sizeof(name), "ring-%u", depths[d]);
+            print_row(name, &tot);
+        }
+        run_day(count, 1, RXRING_SLOTS, 1, &tot);
+        print_row("sched", &tot);
+    }
+    printf("\n");
+    return 0;
+}
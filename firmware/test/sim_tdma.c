@@ -0,0 +1,358 @@
+/*
+ * sim_tdma.c — Host simulation of Soldier uplink access at the Queen: random access vs TDMA.
+ *
+ * N direct (hop 1) Soldiers report to one Queen for a simulated day. Each wakes
+ * every 60-300 s (its energy plan), sends a batch of 1-4 wire blocks and, rarely,
+ * a panic block. Two access schemes are compared:
+ *   random — current behaviour before TDMA: jitter 0-500 ms, then LBT
+ *   tdma   — firmware/common/silken_sync.c (the same object code as on the MCU):
+ *            the Queen hands out slots by DID, reply beacons carry the frame phase,
+ *            Soldiers align their wake to the slot; panics go out at once in both
+ * Both schemes keep listen-before-talk (firmware/common/silken_lbt.c).
+ *
+ * Radio model: frames overlap at the Queen → both lost (no capture effect).
+ * HIDDEN_PCT of Soldier pairs cannot hear each other's CAD. Every Soldier crystal
+ * drifts by up to ±SIM_DRIFT_PPM; the RTC wakeup timer has 1 s granularity.
+ * The Queen replies to a delivered direct frame when the frame was off its slot
+ * or an ADR window closed (every ADR_HISTORY frames); reply beacons are assumed
+ * to reach the Soldier (they ride its RX window) and are not counted as airtime.
+ * A panic is an extra wake that does not move the routine schedule.
+ *
+ * Reports frames per hour, delivery ratio, radio energy per delivered frame,
+ * panic delivery and latency, sync beacons and how many Soldiers hold a slot.
+ *
+ * Build & run: make -C firmware/test sim
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "silken_lbt.h"
+#include "silken_sync.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * SIMULATION PARAMETERS
+ * ════════════════════════════════════════════════════════════════════ */
+#define SIM_MAX_NODES        200
+#define SIM_SEED             0x7D3A5EEDU
+#define SIM_DAY_MS           86400000U
+#define SIM_PERIOD_MIN_S     60       /* ENERGY_SLEEP_MIN_S */
+#define SIM_PERIOD_SPAN_S    241
+#define SIM_MAX_BLOCKS       4        /* RBE_BATCH_READINGS */
+#define SIM_PANIC_MEAN_S     21600    /* One panic per Soldier per 6 h */
+#define SIM_DRIFT_PPM        20       /* 32.768 kHz crystal over temperature */
+#define SIM_HIDDEN_PCT       20
+#define SIM_JITTER_MAX_MS    500      /* TX_JITTER_MAX_MS in soldier/main.c */
+#define SIM_PHASES_MS        400      /* Wake → ФАЗИ 1-3 done */
+#define SIM_CAD_MS           2        /* 2 symbols at SF7 */
+#define SIM_TURNAROUND_MS    1        /* CAD done → TX start */
+#define SIM_RX_WINDOW_MS     600      /* LORA_RX_TIMEOUT_MS + deadline */
+#define SIM_QUEEN_TURN_MS    5        /* RxDone → reply beacon on air */
+#define SIM_ADR_HISTORY      8        /* ADR_HISTORY: every 8th direct frame gets a reply */
+#define SIM_TX_UJ            7300     /* ENERGY_COST_UPLINK_UJ */
+#define SIM_TX_BLOCK_UJ      4000     /* ENERGY_COST_RELAY_BLOCK_UJ */
+#define SIM_CAD_UJ           60
+#define SIM_TX_RING          1024     /* Recent transmissions kept for overlap checks */
+
+typedef enum { SCHEME_RANDOM = 0, SCHEME_TDMA = 1 } SimScheme;
+typedef enum { ST_WAKE = 0, ST_CAD = 1, ST_RX = 2 } SimStep;
+
+/* One radio agent: the routine uplink of a Soldier or its panic path */
+typedef struct {
+    int      node;
+    uint8_t  panic;
+    SimStep  step;
+    double   next_ms;
+    double   tx_start_ms;
+    double   tx_end_ms;
+    double   ready_ms;     /* Panic: when it was raised (latency) */
+    uint8_t  blocks;
+    LbtState lbt;
+} SimAgent;
+
+typedef struct {
+    uint32_t  did;
+    double    drift_ppm;   /* > 0 — crystal slow, as SyncState.drift_ppm */
+    uint32_t  rtc0_ms;
+    uint32_t  period_s;
+    uint32_t  direct_frames;
+    SyncState sync;
+} SimNode;
+
+typedef struct {
+    double start_ms, end_ms;
+    int    agent;
+} SimTx;
+
+typedef struct {
+    uint64_t frames, delivered;
+    uint64_t panics, panics_delivered;
+    double   panic_latency_ms;
+    uint64_t energy_uj;
+    uint64_t beacons;
+    int      scheduled;
+} SimTotals;
+
+static uint32_t rng_state = SIM_SEED;
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: deterministic across hosts */
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static double rng_unit(void)
+{
+    return (double)(rng_next() >> 8) / 16777216.0;
+}
+
+static SimNode   nodes[SIM_MAX_NODES];
+static SimAgent  agents[2 * SIM_MAX_NODES];
+static uint8_t   hears[SIM_MAX_NODES][SIM_MAX_NODES];
+static SimTx     tx_ring[SIM_TX_RING];
+static uint32_t  tx_count;
+static SyncSchedule schedule;
+
+/* Soldier RTC, ms of day, at Queen time t */
+static uint32_t local_ms(const SimNode* n, double t)
+{
+    double local = (double)n->rtc0_ms + t * (1.0 - n->drift_ppm * 1e-6);
+    return (uint32_t)((uint64_t)local % SIM_DAY_MS);
+}
+
+/* Local duration → Queen duration */
+static double queen_span(const SimNode* n, double local_span)
+{
+    return local_span / (1.0 - n->drift_ppm * 1e-6);
+}
+
+static double panic_gap_ms(void)
+{
+    return -log(1.0 - rng_unit()) * SIM_PANIC_MEAN_S * 1000.0; /* Poisson arrivals */
+}
+
+static void build_cluster(int n)
+{
+    for (int i = 0; i < n; i++) {
+        nodes[i].did = 0x51000000U | (rng_next() & 0x00FFFFFFU);
+        nodes[i].drift_ppm = (rng_unit() * 2.0 - 1.0) * SIM_DRIFT_PPM;
+        nodes[i].rtc0_ms = rng_next() % SIM_DAY_MS;
+        nodes[i].period_s = SIM_PERIOD_MIN_S + rng_next() % SIM_PERIOD_SPAN_S;
+        hears[i][i] = 1;
+        for (int j = i + 1; j < n; j++) {
+            uint8_t h = (int)(rng_next() % 100) >= SIM_HIDDEN_PCT;
+            hears[i][j] = h;
+            hears[j][i] = h;
+        }
+    }
+}
+
+static uint8_t channel_busy(int node, double t)
+{
+    for (uint32_t k = tx_count; k > 0 && tx_count - k < SIM_TX_RING; k--) {
+        const SimTx* tx = &tx_ring[(k - 1) % SIM_TX_RING];
+        if (tx->end_ms + 1000.0 < t) break; /* Older frames ended long ago */
+        if (!hears[node][agents[tx->agent].node]) continue;
+        if (tx->start_ms < t + SIM_CAD_MS && tx->end_ms > t) return 1;
+    }
+    return 0;
+}
+
+static uint8_t delivered(int agent, double start, double end)
+{
+    for (uint32_t k = tx_count; k > 0 && tx_count - k < SIM_TX_RING; k--) {
+        const SimTx* tx = &tx_ring[(k - 1) % SIM_TX_RING];
+        if (tx->end_ms + 1000.0 < start) break;
+        if (tx->agent == agent && tx->start_ms == start) continue;
+        if (tx->start_ms < end && tx->end_ms > start) return 0;
+    }
+    return 1;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ONE DAY
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void agent_wake(SimAgent* a, SimScheme scheme, double t)
+{
+    SimNode* n = &nodes[a->node];
+    uint32_t rnd = rng_next();
+    double wait;
+
+    Sync_Expire(&n->sync, local_ms(n, t));
+    if (a->panic) {
+        /* Phase 1.5: straight to the air under LBT in both schemes */
+        a->ready_ms = t;
+        a->blocks = 1;
+        wait = 0.0;
+    } else {
+        t += SIM_PHASES_MS;
+        a->blocks = (uint8_t)(1 + rng_next() % SIM_MAX_BLOCKS);
+        uint32_t w = SYNC_WAIT_MISSED;
+        if (scheme == SCHEME_TDMA) w = Sync_Slot_Wait_Ms(&n->sync, local_ms(n, t));
+        wait = w == SYNC_WAIT_MISSED ? (double)(rnd % SIM_JITTER_MAX_MS) : queen_span(n, w);
+    }
+    LBT_Frame_Start(&a->lbt);
+    a->step = ST_CAD;
+    a->next_ms = t + wait;
+}
+
+static void agent_cad(SimAgent* a, int idx, SimTotals* tot, double t)
+{
+    tot->energy_uj += SIM_CAD_UJ;
+    uint32_t backoff_ms = LBT_On_Cad(&a->lbt, channel_busy(a->node, t), rng_next());
+    if (backoff_ms) {
+        a->next_ms = t + SIM_CAD_MS + backoff_ms;
+        return;
+    }
+    uint16_t size = (uint16_t)(a->blocks * 20U);
+    a->tx_start_ms = t + SIM_CAD_MS + SIM_TURNAROUND_MS;
+    a->tx_end_ms = a->tx_start_ms + Sync_Airtime_Ms(size);
+    SimTx* tx = &tx_ring[tx_count++ % SIM_TX_RING];
+    tx->start_ms = a->tx_start_ms;
+    tx->end_ms = a->tx_end_ms;
+    tx->agent = idx;
+    tot->energy_uj += SIM_TX_UJ + (uint32_t)(a->blocks - 1) * SIM_TX_BLOCK_UJ;
+    a->step = ST_RX;
+    a->next_ms = a->tx_end_ms + 1.0; /* Every overlapping TX has started by now */
+}
+
+static void agent_rx(SimAgent* a, int idx, SimScheme scheme, SimTotals* tot, double t)
+{
+    SimNode* n = &nodes[a->node];
+    uint8_t ok = delivered(idx, a->tx_start_ms, a->tx_end_ms);
+
+    if (a->panic) {
+        tot->panics++;
+        tot->panics_delivered += ok;
+        if (ok) tot->panic_latency_ms += a->tx_end_ms - a->ready_ms;
+    } else {
+        tot->frames++;
+        tot->delivered += ok;
+    }
+
+    if (ok && scheme == SCHEME_TDMA) {
+        /* Queen reflex: slot by DID, reply when off-slot or ADR is due */
+        uint8_t slot = Sync_Schedule_Slot(&schedule, n->did, (uint32_t)a->tx_end_ms);
+        uint8_t due = !Sync_On_Slot(slot, (uint32_t)a->tx_start_ms);
+        if (++n->direct_frames % SIM_ADR_HISTORY == 0) due = 1;
+        if (due) {
+            uint8_t beacon[16] = {0};
+            double sent = a->tx_end_ms + SIM_QUEEN_TURN_MS;
+            Sync_Fill_Beacon(beacon, n->did, slot, (uint32_t)sent);
+            Sync_On_Beacon(&n->sync, beacon, n->did, local_ms(n, sent + Sync_Airtime_Ms(20)));
+            tot->beacons++;
+        }
+    }
+
+    a->step = ST_WAKE;
+    if (a->panic) {
+        a->next_ms = t + panic_gap_ms();
+    } else {
+        double sleep_at = a->tx_end_ms + SIM_RX_WINDOW_MS;
+        uint32_t sleep_s = scheme == SCHEME_TDMA ? Sync_Sleep_S(&n->sync, local_ms(n, sleep_at), n->period_s)
+                                                 : n->period_s;
+        /* ck_spre: the first tick comes anywhere within a second */
+        double local_sleep = (double)sleep_s * 1000.0 - (double)(rng_next() % 1000U);
+        a->next_ms = sleep_at + queen_span(n, local_sleep);
+    }
+}
+
+static void run_day(int n, SimScheme scheme, SimTotals* tot)
+{
+    memset(tot, 0, sizeof(*tot));
+    tx_count = 0;
+    Sync_Schedule_Init(&schedule);
+    for (int i = 0; i < n; i++) {
+        Sync_Init(&nodes[i].sync);
+        nodes[i].direct_frames = 0;
+        for (int p = 0; p < 2; p++) {
+            SimAgent* a = &agents[2 * i + p];
+            a->node = i;
+            a->panic = (uint8_t)p;
+            a->step = ST_WAKE;
+            a->next_ms = p ? panic_gap_ms() : (double)(rng_next() % (nodes[i].period_s * 1000U));
+            LBT_Init(&a->lbt);
+        }
+    }
+
+    for (;;) {
+        int k = 0;
+        for (int i = 1; i < 2 * n; i++) {
+            if (agents[i].next_ms < agents[k].next_ms) k = i;
+        }
+        SimAgent* a = &agents[k];
+        double t = a->next_ms;
+        if (t >= SIM_DAY_MS) break;
+
+        switch (a->step) {
+        case ST_WAKE: agent_wake(a, scheme, t); break;
+        case ST_CAD:  agent_cad(a, k, tot, t); break;
+        case ST_RX:   agent_rx(a, k, scheme, tot, t); break;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        tot->scheduled += nodes[i].sync.valid && nodes[i].sync.slot != SYNC_SLOT_NONE;
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void print_row(const char* name, int n, const SimTotals* t)
+{
+    char mj[16], lat[16];
+    if (t->delivered) {
+        snprintf(mj, sizeof(mj), "%.2f", (double)t->energy_uj / (double)t->delivered / 1000.0);
+    } else {
+        snprintf(mj, sizeof(mj), "-");
+    }
+    if (t->panics_delivered) {
+        snprintf(lat, sizeof(lat), "%.0f", t->panic_latency_ms / (double)t->panics_delivered);
+    } else {
+        snprintf(lat, sizeof(lat), "-");
+    }
+    printf("  %-7s %8.0f %8.1f%% %8.0f %9s %8.1f%% %8s %9.1f %6d/%d\n",
+           name, (double)t->frames / 24.0, 100.0 * (double)t->delivered / (double)t->frames,
+           (double)t->delivered / 24.0, mj,
+           t->panics ? 100.0 * (double)t->panics_delivered / (double)t->panics : 0.0, lat,
+           (double)t->beacons / n, t->scheduled, n);
+}
+
+int main(void)
+{
+    static const int cluster_sizes[] = { 25, 50, 100, 200 };
+
+    printf("\n🕰  Soldier Uplink Access — TDMA Slots vs Random Access (24 h, %d%% hidden pairs, ±%d ppm)\n",
+           SIM_HIDDEN_PCT, SIM_DRIFT_PPM);
+    printf("══════════════════════════════════════════════════════════════\n");
+
+    for (size_t c = 0; c < sizeof(cluster_sizes) / sizeof(cluster_sizes[0]); c++) {
+        int n = cluster_sizes[c];
+        SimTotals rnd, tdma;
+
+        build_cluster(n);
+        uint32_t saved = rng_state;
+        run_day(n, SCHEME_RANDOM, &rnd);
+        rng_state = saved; /* Same periods, drifts and first wakes for both schemes */
+        run_day(n, SCHEME_TDMA, &tdma);
+
+        printf("\n  %d direct Soldiers\n", n);
+        printf("  %-7s %8s %9s %8s %9s %9s %8s %9s %8s\n",
+               "scheme", "frames/h", "delivery", "deliv/h", "mJ/deliv", "panic_ok", "panic_ms",
+               "beacon/n", "slots");
+        print_row("random", n, &rnd);
+        print_row("tdma", n, &tdma);
+    }
+    printf("\n");
+    return 0;
+}
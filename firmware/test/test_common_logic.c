@@ -0,0 +1,2283 @@
+/*
+ * test_common_logic.c — Host-based unit tests for shared firmware modules.
+ *
+ * Unlike test_queen_logic.c / test_soldier_logic.c, these tests link the
+ * real sources from firmware/common/ (no re-implementation), so the same
+ * object code that runs on the Cortex-M4 is verified on x86.
+ * Covers: fixed-point Lorenz attractor (golden vectors shared with
+ * spec/services/silken_net/attractor_spec.rb), size-class pool allocator
+ * (mruby heap), diagnostic frame packing, energy-aware wake planning,
+ * per-phase cycle profiler, low-power delay sizing, listen-before-talk backoff,
+ * mesh relay queue and aggregated frames, mesh seen-set (Bloom filter),
+ * hop-count gradient routing, Queen per-device key cache, Soldier
+ * report-by-exception, adaptive TX power (ADR), beacon time sync and TDMA slots,
+ * EU868 channel plan (Queen survey, Soldier channel scan), Queen RX frame ring,
+ * Queen cooperative scheduler, OTA CRC32 / CRC16-CCITT, Soldier OTA reassembly,
+ * cost accounting of hal_mock.h (HAL_MOCK_ACCOUNTING).
+ *
+ * Build: make -C firmware/test common
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "silken_attractor.h"
+#include "silken_pool.h"
+#include "silken_diag.h"
+#include "silken_energy.h"
+#include "silken_prof.h"
+#include "silken_lpdelay.h"
+#include "silken_lbt.h"
+#include "silken_relayq.h"
+#include "silken_seen.h"
+#include "silken_route.h"
+#include "silken_keys.h"
+#include "silken_rbe.h"
+#include "silken_adr.h"
+#include "silken_sync.h"
+#include "silken_chan.h"
+#include "silken_rxring.h"
+#include "silken_sched.h"
+#include "silken_crc.h"
+#include "silken_ota.h"
+
+#define HAL_MOCK_ACCOUNTING
+#include "hal_mock.h"
+
+/* ════════════════════════════════════════════════════════════════════
+ * TEST FRAMEWORK
+ * ════════════════════════════════════════════════════════════════════ */
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+#define RUN(name) do { \
+    printf("  %-58s", #name); \
+    name(); \
+    printf(" ✅\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a != _b) { \
+        printf(" ❌ FAIL (line %d: got %lld, expected %lld)\n", __LINE__, _a, _b); \
+        tests_failed++; return; \
+    } \
+} while(0)
+
+#define ASSERT_NE(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a == _b) { \
+        printf(" ❌ FAIL (line %d: %lld == %lld)\n", __LINE__, _a, _b); \
+        tests_failed++; return; \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(expr)  ASSERT_EQ(!!(expr), 1)
+#define ASSERT_FALSE(expr) ASSERT_EQ(!!(expr), 0)
+
+/* ════════════════════════════════════════════════════════════════════
+ * 1. FIXED-POINT ATTRACTOR TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Golden vectors: locked Q16.16 outputs. The same table lives in
+ * spec/services/silken_net/attractor_spec.rb — if either side drifts,
+ * device and server verdicts no longer match. */
+typedef struct {
+    uint32_t seed;
+    int32_t  temp_c;
+    int32_t  acoustic;
+    int32_t  z_q16;
+} AttractorGolden;
+
+static const AttractorGolden attractor_golden[] = {
+    { 0,          22,    5,   2484669 },
+    { 42,         -15,   0,   758431  },
+    { 123456,     0,     255, 766701  },
+    { 0xDEADBEEF, 50,    10,  2542632 },
+    { 0xFFFFFFFF, -128,  3,   550892  },
+    { 1,          127,   500, 1839846 },
+    { 99999,      20,    0,   955932  },
+};
+
+TEST(test_attractor_golden_vectors) {
+    for (size_t i = 0; i < sizeof(attractor_golden) / sizeof(attractor_golden[0]); i++) {
+        const AttractorGolden* g = &attractor_golden[i];
+        ASSERT_EQ(Attractor_Calculate_Z_Q16(g->seed, g->temp_c, g->acoustic), g->z_q16);
+    }
+}
+
+TEST(test_attractor_deterministic) {
+    int32_t a = Attractor_Calculate_Z_Q16(42, 20, 10);
+    int32_t b = Attractor_Calculate_Z_Q16(42, 20, 10);
+    ASSERT_EQ(a, b);
+}
+
+TEST(test_attractor_seed_changes_output) {
+    ASSERT_NE(Attractor_Calculate_Z_Q16(1, 22, 5), Attractor_Calculate_Z_Q16(99999, 22, 5));
+}
+
+TEST(test_attractor_rho_clamp_high) {
+    /* temp 100 → rho = 48, temp 127 → 53.4 → clamped to 50 (same as temp 110) */
+    ASSERT_EQ(Attractor_Calculate_Z_Q16(42, 127, 5), Attractor_Calculate_Z_Q16(42, 110, 5));
+    ASSERT_NE(Attractor_Calculate_Z_Q16(42, 100, 5), Attractor_Calculate_Z_Q16(42, 110, 5));
+}
+
+TEST(test_attractor_rho_clamp_low) {
+    /* rho = 28 + temp * 0.2 → 10.0 at temp -90, below that clamped */
+    ASSERT_EQ(Attractor_Calculate_Z_Q16(42, -128, 5), Attractor_Calculate_Z_Q16(42, -90, 5));
+}
+
+TEST(test_attractor_sigma_clamp) {
+    /* sigma = 10 + acoustic * 0.1 → 30.0 at acoustic 200 */
+    ASSERT_EQ(Attractor_Calculate_Z_Q16(42, 22, 500), Attractor_Calculate_Z_Q16(42, 22, 200));
+    ASSERT_EQ(Attractor_Calculate_Z_Q16(42, 22, -1000), Attractor_Calculate_Z_Q16(42, 22, -50));
+}
+
+TEST(test_attractor_negative_temp_truncates_toward_zero) {
+    /* -7 * 0.2 = -1.4 → -91750.4 in Q16 → truncated to -91750 (not floored).
+     * Different from temp -8 to make sure the perturbation is applied. */
+    ASSERT_NE(Attractor_Calculate_Z_Q16(42, -7, 5), Attractor_Calculate_Z_Q16(42, -8, 5));
+    ASSERT_NE(Attractor_Calculate_Z_Q16(42, -7, 5), Attractor_Calculate_Z_Q16(42, 0, 5));
+}
+
+TEST(test_attractor_state_bounded) {
+    /* Extreme inputs never leave the saturation window */
+    for (uint32_t seed = 0; seed < 2000; seed += 37) {
+        int32_t z = Attractor_Calculate_Z_Q16(seed * 2654435761U, 127, 255);
+        ASSERT_TRUE(z <= ATTRACTOR_STATE_LIMIT_Q && z >= -ATTRACTOR_STATE_LIMIT_Q);
+    }
+}
+
+TEST(test_attractor_trajectory_initial_state) {
+    int32_t xyz[3 * 2];
+    Attractor_Trajectory_Q16(0, 22, 5, xyz, 2);
+    /* seed 0 → x = y = z = -1.0 */
+    ASSERT_EQ(xyz[0], -ATTRACTOR_ONE);
+    ASSERT_EQ(xyz[1], -ATTRACTOR_ONE);
+    ASSERT_EQ(xyz[2], -ATTRACTOR_ONE);
+    /* dx = sigma * (y - x) = 0 on the first step, z moves */
+    ASSERT_EQ(xyz[3], xyz[0]);
+    ASSERT_NE(xyz[5], xyz[2]);
+}
+
+TEST(test_attractor_trajectory_matches_z) {
+    /* N+1 points = initial state + N steps → last z equals Calculate_Z */
+    static int32_t xyz[3 * (ATTRACTOR_ITERATIONS + 1)];
+    uint16_t n = Attractor_Trajectory_Q16(123456, 0, 255, xyz, ATTRACTOR_ITERATIONS + 1);
+    ASSERT_EQ(n, ATTRACTOR_ITERATIONS + 1);
+    ASSERT_EQ(xyz[3 * ATTRACTOR_ITERATIONS + 2], Attractor_Calculate_Z_Q16(123456, 0, 255));
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 2. POOL ALLOCATOR TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+static uint64_t test_arena[4096 / sizeof(uint64_t)];
+static SilkenPool test_pool;
+
+static void reset_pool(void)
+{
+    memset(test_arena, 0xA5, sizeof(test_arena));
+    Pool_Init(&test_pool, test_arena, sizeof(test_arena));
+}
+
+TEST(test_pool_alloc_rounds_to_class) {
+    reset_pool();
+    void* p = Pool_Alloc(&test_pool, 20);
+    ASSERT_TRUE(p != NULL);
+    ASSERT_EQ(Pool_Block_Size(p), 32);
+    ASSERT_EQ(test_pool.stats.bytes_in_use, 32);
+    ASSERT_EQ(test_pool.stats.carved_bytes, 32 + POOL_HEADER_SIZE);
+}
+
+TEST(test_pool_alloc_8_byte_aligned) {
+    reset_pool();
+    for (int i = 0; i < 10; i++) {
+        void* p = Pool_Alloc(&test_pool, (size_t)(1 + i * 13));
+        ASSERT_EQ((uintptr_t)p & 7U, 0);
+    }
+}
+
+TEST(test_pool_free_reuses_same_block) {
+    reset_pool();
+    void* a = Pool_Alloc(&test_pool, 100);
+    Pool_Free(&test_pool, a);
+    uint32_t carved = test_pool.stats.carved_bytes;
+    void* b = Pool_Alloc(&test_pool, 70); /* same 128-byte class */
+    ASSERT_TRUE(a == b);
+    ASSERT_EQ(test_pool.stats.carved_bytes, carved);
+}
+
+TEST(test_pool_stats_peak_and_counts) {
+    reset_pool();
+    void* a = Pool_Alloc(&test_pool, 64);
+    void* b = Pool_Alloc(&test_pool, 64);
+    Pool_Free(&test_pool, a);
+    Pool_Free(&test_pool, b);
+    ASSERT_EQ(test_pool.stats.bytes_in_use, 0);
+    ASSERT_EQ(test_pool.stats.peak_bytes_in_use, 128);
+    ASSERT_EQ(test_pool.stats.alloc_count, 2);
+    ASSERT_EQ(test_pool.stats.free_count, 2);
+}
+
+TEST(test_pool_exhaustion_returns_null) {
+    reset_pool();
+    int n = 0;
+    while (Pool_Alloc(&test_pool, 512) != NULL) n++;
+    /* 4096 / (512 + 8) = 7 blocks */
+    ASSERT_EQ(n, 7);
+    ASSERT_EQ(test_pool.stats.failed_count, 1);
+}
+
+TEST(test_pool_oversize_rejected) {
+    reset_pool();
+    ASSERT_TRUE(Pool_Alloc(&test_pool, POOL_MAX_BLOCK + 1) == NULL);
+    ASSERT_EQ(test_pool.stats.failed_count, 1);
+    ASSERT_EQ(test_pool.stats.carved_bytes, 0);
+}
+
+TEST(test_pool_borrows_larger_free_block) {
+    reset_pool();
+    void* big = Pool_Alloc(&test_pool, 2048);
+    while (Pool_Alloc(&test_pool, 16) != NULL) {}
+    Pool_Free(&test_pool, big);
+    /* Arena fully carved: small request is served from the freed 2048 block */
+    void* small = Pool_Alloc(&test_pool, 16);
+    ASSERT_TRUE(small == big);
+    ASSERT_EQ(Pool_Block_Size(small), 2048);
+}
+
+TEST(test_pool_double_free_ignored) {
+    reset_pool();
+    void* a = Pool_Alloc(&test_pool, 32);
+    Pool_Free(&test_pool, a);
+    Pool_Free(&test_pool, a);
+    ASSERT_EQ(test_pool.stats.free_count, 1);
+    void* b = Pool_Alloc(&test_pool, 32);
+    void* c = Pool_Alloc(&test_pool, 32);
+    ASSERT_TRUE(b != c);
+}
+
+TEST(test_pool_realloc_grows_and_copies) {
+    reset_pool();
+    uint8_t* p = Pool_Realloc(&test_pool, NULL, 16);
+    for (int i = 0; i < 16; i++) p[i] = (uint8_t)i;
+    uint8_t* same = Pool_Realloc(&test_pool, p, 12); /* fits in class */
+    ASSERT_TRUE(same == p);
+    uint8_t* grown = Pool_Realloc(&test_pool, p, 300);
+    ASSERT_TRUE(grown != p);
+    for (int i = 0; i < 16; i++) ASSERT_EQ(grown[i], i);
+    ASSERT_EQ(test_pool.stats.bytes_in_use, 512);
+}
+
+TEST(test_pool_realloc_zero_frees) {
+    reset_pool();
+    void* p = Pool_Realloc(&test_pool, NULL, 64);
+    ASSERT_TRUE(Pool_Realloc(&test_pool, p, 0) == NULL);
+    ASSERT_EQ(test_pool.stats.bytes_in_use, 0);
+}
+
+TEST(test_pool_churn_no_growth) {
+    /* Weeks of contract calls: same allocation pattern must not carve more */
+    reset_pool();
+    void* ptrs[8];
+    for (int i = 0; i < 8; i++) ptrs[i] = Pool_Alloc(&test_pool, (size_t)(24 << (i % 4)));
+    for (int i = 0; i < 8; i++) Pool_Free(&test_pool, ptrs[i]);
+    uint32_t carved = test_pool.stats.carved_bytes;
+    for (int cycle = 0; cycle < 1000; cycle++) {
+        for (int i = 0; i < 8; i++) ptrs[i] = Pool_Alloc(&test_pool, (size_t)(24 << (i % 4)));
+        for (int i = 7; i >= 0; i--) Pool_Free(&test_pool, ptrs[i]);
+    }
+    ASSERT_EQ(test_pool.stats.carved_bytes, carved);
+    ASSERT_EQ(test_pool.stats.failed_count, 0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 3. DIAGNOSTIC FRAME TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+TEST(test_diag_heap_frame_layout) {
+    SilkenPoolStats st = {0};
+    st.peak_bytes_in_use = 0x1234;
+    st.carved_bytes = 0x2345;
+    st.alloc_count = 0x00015678; /* wraps to low 16 bits */
+    st.failed_count = 3;
+    uint8_t f[16];
+    Diag_Pack_Heap_Frame(f, 0xAABBCCDD, 3, 0x0001, &st, 7);
+    ASSERT_EQ(f[0], 0xAA); ASSERT_EQ(f[3], 0xDD);
+    ASSERT_EQ(f[4], 0x12); ASSERT_EQ(f[5], 0x34);
+    ASSERT_EQ(f[6], 0x23); ASSERT_EQ(f[7], 0x45);
+    ASSERT_EQ(f[8], 0x56); ASSERT_EQ(f[9], 0x78);
+    ASSERT_EQ(f[10], 7);
+    ASSERT_EQ(f[11], 3);
+    ASSERT_EQ(f[12], 0x00); ASSERT_EQ(f[13], 0x01);
+    ASSERT_EQ(f[14], 3);
+    ASSERT_EQ(Diag_Frame_Type(f), FRAME_TYPE_DIAG_HEAP);
+}
+
+TEST(test_diag_heap_frame_saturates) {
+    SilkenPoolStats st = {0};
+    st.peak_bytes_in_use = 70000;
+    st.carved_bytes = 70000;
+    st.failed_count = 1000;
+    uint8_t f[16];
+    Diag_Pack_Heap_Frame(f, 1, 3, 1, &st, 300);
+    ASSERT_EQ(f[4], 0xFF); ASSERT_EQ(f[5], 0xFF);
+    ASSERT_EQ(f[6], 0xFF); ASSERT_EQ(f[7], 0xFF);
+    ASSERT_EQ(f[10], 0xFF);
+    ASSERT_EQ(f[14], 0xFF);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 4. ENERGY SCHEDULER TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* State after two wakes with a known harvest estimate */
+static void energy_state_with_harvest(EnergyState* st, uint16_t vcap_mv, uint32_t harvest_uw)
+{
+    Energy_Init(st);
+    st->last_vcap_mv = vcap_mv;
+    st->initialized = 2;
+    st->harvest_uw = harvest_uw;
+}
+
+TEST(test_energy_stored_formula) {
+    /* 0.47 F between 3.0 V and 2.4 V: 0.5 · 0.47 · (9.00 − 5.76) J = 761.4 mJ */
+    ASSERT_EQ(Energy_Stored_UJ(3000, 2400), 761400);
+    ASSERT_EQ(Energy_Stored_UJ(2400, 2400), 0);
+    ASSERT_TRUE(Energy_Stored_UJ(2300, 2400) < 0);
+}
+
+TEST(test_energy_harvest_estimate) {
+    EnergyState st;
+    Energy_Init(&st);
+    Energy_Update(&st, 3000, 0);          /* First wake: only remembers Vcap */
+    ASSERT_EQ(st.initialized, 1);
+    Energy_Spend(&st, ENERGY_COST_WAKE_UJ);
+    Energy_Update(&st, 3000, 1000);       /* Vcap held: harvest = (wake cost + 7·1000) / 1000 */
+    ASSERT_EQ(st.harvest_uw, (ENERGY_COST_WAKE_UJ + ENERGY_P_SLEEP_UW * 1000) / 1000);
+    ASSERT_EQ(st.spent_uj, 0);
+}
+
+TEST(test_energy_harvest_ewma) {
+    EnergyState st;
+    energy_state_with_harvest(&st, 3000, 18);
+    Energy_Spend(&st, 411000);            /* Sample = (411000 + 7000) / 1000 = 418 µW */
+    Energy_Update(&st, 3000, 1000);
+    ASSERT_EQ(st.harvest_uw, 18 + (418 - 18) / 4);
+}
+
+TEST(test_energy_survival_at_reserve) {
+    EnergyState st;
+    energy_state_with_harvest(&st, 2410, 0);
+    EnergyPlan plan;
+    Energy_Plan(&st, &plan);
+    ASSERT_EQ(plan.tier, ENERGY_TIER_SURVIVAL);
+    ASSERT_EQ(plan.sleep_s, ENERGY_SLEEP_MAX_S);
+    ASSERT_FALSE(plan.run_tinyml);
+    ASSERT_FALSE(plan.listen);
+    ASSERT_FALSE(plan.relay);
+}
+
+TEST(test_energy_no_listen_below_floor) {
+    EnergyState st;
+    energy_state_with_harvest(&st, 2700, 50);
+    EnergyPlan plan;
+    Energy_Plan(&st, &plan);
+    ASSERT_EQ(plan.tier, ENERGY_TIER_LEAN);
+    ASSERT_TRUE(plan.run_tinyml);
+    ASSERT_FALSE(plan.listen);
+    ASSERT_TRUE(plan.sleep_s > ENERGY_SLEEP_MIN_S && plan.sleep_s < ENERGY_SLEEP_MAX_S);
+}
+
+TEST(test_energy_rich_node_relays_at_min_interval) {
+    EnergyState st;
+    energy_state_with_harvest(&st, 3300, 100000);
+    EnergyPlan plan;
+    Energy_Plan(&st, &plan);
+    ASSERT_EQ(plan.tier, ENERGY_TIER_RELAY);
+    ASSERT_TRUE(plan.listen);
+    ASSERT_EQ(plan.sleep_s, ENERGY_SLEEP_MIN_S);
+}
+
+TEST(test_energy_first_wake_assumes_no_harvest) {
+    EnergyState st;
+    Energy_Init(&st);
+    Energy_Update(&st, 3300, 0);
+    EnergyPlan plan;
+    Energy_Plan(&st, &plan);
+    ASSERT_EQ(plan.sleep_s, ENERGY_SLEEP_MAX_S);
+}
+
+TEST(test_energy_lower_vcap_sleeps_longer) {
+    EnergyState hi, lo;
+    energy_state_with_harvest(&hi, 3200, 200);
+    energy_state_with_harvest(&lo, 2700, 200);
+    EnergyPlan p_hi, p_lo;
+    Energy_Plan(&hi, &p_hi);
+    Energy_Plan(&lo, &p_lo);
+    ASSERT_TRUE(p_lo.sleep_s > p_hi.sleep_s);
+}
+
+TEST(test_energy_clock_rtc_across_midnight) {
+    EnergyClock c;
+    Energy_Clock_Restore(&c, 0);                   /* First power-up: time unknown */
+    ASSERT_EQ(Energy_Clock_Elapsed_S(&c, 86390000U), 0);
+    uint32_t word = Energy_Clock_Word(&c);
+    Energy_Clock_Restore(&c, word);                /* Reset: DR1 keeps the last wake */
+    ASSERT_EQ(c.last_ms, 86390000U);
+    /* 600 s of STOP2 + 1.5 s awake, over midnight; the half second carries */
+    ASSERT_EQ(Energy_Clock_Elapsed_S(&c, 591500U), 601);
+    ASSERT_EQ(Energy_Clock_Elapsed_S(&c, 1193000U), 602);
+    Energy_Clock_Restore(&c, ENERGY_DAY_MS + 5U);  /* Not a time of day: unknown */
+    ASSERT_EQ(c.valid, 0);
+}
+
+/* Vcap of a stored energy (inverse of Energy_Stored_UJ above 0 V) */
+static uint16_t ut_vcap_mv(int64_t uj)
+{
+    uint16_t lo = 0, hi = 5500;
+    while (lo < hi) {
+        uint16_t mid = (uint16_t)((lo + hi + 1) / 2);
+        if (Energy_Stored_UJ(mid, 0) <= uj) lo = mid; else hi = (uint16_t)(mid - 1);
+    }
+    return lo;
+}
+
+TEST(test_energy_main_loop_tracks_harvest) {
+    /* The Soldier main loop: dt from the RTC calendar, SysTick only while awake.
+     * A 300 µW harvester must show up as ~300 µW; dt from SysTick never gets there. */
+    const int64_t harvest_uw = 300, awake_ms = 800;
+    EnergyState st, tick_st;
+    EnergyClock clk;
+    EnergyPlan plan;
+    Energy_Init(&st);
+    Energy_Init(&tick_st);
+    Energy_Clock_Restore(&clk, 0);
+    int64_t e = Energy_Stored_UJ(2500, 0);
+    uint32_t rtc_ms = 86000000U;                   /* Crosses midnight on the way */
+    for (int wake = 0; wake < 30; wake++) {
+        uint16_t vcap = ut_vcap_mv(e);
+        Energy_Update(&st, vcap, Energy_Clock_Elapsed_S(&clk, rtc_ms));
+        Energy_Update(&tick_st, vcap, (uint32_t)(awake_ms / 1000));
+        Energy_Plan(&st, &plan);
+        Energy_Spend(&st, ENERGY_COST_WAKE_UJ);
+        Energy_Spend(&tick_st, ENERGY_COST_WAKE_UJ);
+        int64_t cycle_ms = awake_ms + (int64_t)plan.sleep_s * 1000;
+        e += harvest_uw * cycle_ms / 1000 - ENERGY_COST_WAKE_UJ - ENERGY_P_SLEEP_UW * (int64_t)plan.sleep_s;
+        rtc_ms = (uint32_t)((rtc_ms + cycle_ms) % ENERGY_DAY_MS);
+    }
+    ASSERT_TRUE(st.harvest_uw > 285 && st.harvest_uw < 315);
+    ASSERT_EQ(plan.sleep_s, ENERGY_SLEEP_MIN_S);
+    ASSERT_EQ(tick_st.harvest_uw, 0);              /* dt = 0 s: never estimated */
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 5. PHASE PROFILER TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+TEST(test_prof_first_sample_sets_all) {
+    ProfTable t;
+    Prof_Init(&t);
+    Prof_Record(&t, PROF_PHASE_MRUBY, 4800);
+    ASSERT_EQ(t.stat[PROF_PHASE_MRUBY].min_cycles, 4800);
+    ASSERT_EQ(t.stat[PROF_PHASE_MRUBY].max_cycles, 4800);
+    ASSERT_EQ(t.stat[PROF_PHASE_MRUBY].ewma_cycles, 4800);
+    ASSERT_EQ(t.stat[PROF_PHASE_MRUBY].count, 1);
+    ASSERT_EQ(t.stat[PROF_PHASE_TX].count, 0);
+}
+
+TEST(test_prof_min_max_ewma) {
+    ProfTable t;
+    Prof_Init(&t);
+    Prof_Record(&t, PROF_PHASE_TX, 1000);
+    Prof_Record(&t, PROF_PHASE_TX, 9000);   /* EWMA: 1000 + 8000/8 = 2000 */
+    Prof_Record(&t, PROF_PHASE_TX, 200);    /* EWMA: 2000 − 1800/8 = 1775 */
+    ASSERT_EQ(t.stat[PROF_PHASE_TX].min_cycles, 200);
+    ASSERT_EQ(t.stat[PROF_PHASE_TX].max_cycles, 9000);
+    ASSERT_EQ(t.stat[PROF_PHASE_TX].ewma_cycles, 1775);
+    ASSERT_EQ(t.stat[PROF_PHASE_TX].count, 3);
+}
+
+TEST(test_prof_invalid_phase_ignored) {
+    ProfTable t;
+    Prof_Init(&t);
+    Prof_Record(&t, PROF_PHASE_COUNT, 123);
+    for (int i = 0; i < PROF_PHASE_COUNT; i++) ASSERT_EQ(t.stat[i].count, 0);
+}
+
+TEST(test_prof_begin_end_host_counter) {
+    ProfTable t;
+    Prof_Init(&t);
+    Prof_Begin(&t, PROF_PHASE_ACQUIRE);
+    volatile uint32_t spin = 0;
+    for (uint32_t i = 0; i < 100000; i++) spin += i;
+    Prof_End(&t, PROF_PHASE_ACQUIRE);
+    ASSERT_EQ(t.stat[PROF_PHASE_ACQUIRE].count, 1);
+    /* Host clock is scaled to 48 MHz cycles: a 100k-iteration loop is well under 1 s */
+    ASSERT_TRUE(t.stat[PROF_PHASE_ACQUIRE].max_cycles < 48000000U);
+}
+
+TEST(test_prof_phase_names) {
+    ASSERT_EQ(strcmp(Prof_Phase_Name(PROF_PHASE_ACQUIRE), "acquire"), 0);
+    ASSERT_EQ(strcmp(Prof_Phase_Name(PROF_PHASE_FLUSH), "flush"), 0);
+    ASSERT_EQ(strcmp(Prof_Phase_Name(PROF_PHASE_COUNT), "?"), 0);
+}
+
+TEST(test_diag_profile_frame_layout) {
+    ProfStat st = { 48 * 160, 48 * 4000, 48 * 640, 17 };  /* 160 µs, 4 ms, 640 µs */
+    uint8_t f[16];
+    Diag_Pack_Profile_Frame(f, 0x11223344, 3, 0x0001, PROF_PHASE_MRUBY, &st);
+    ASSERT_EQ(f[0], 0x11); ASSERT_EQ(f[3], 0x44);
+    ASSERT_EQ(f[4], PROF_PHASE_MRUBY);
+    ASSERT_EQ((f[5] << 8) | f[6], 10);     /* 16 µs ticks */
+    ASSERT_EQ((f[7] << 8) | f[8], 250);
+    ASSERT_EQ((f[9] << 8) | f[10], 40);
+    ASSERT_EQ(f[11], 3);
+    ASSERT_EQ(f[14], 17);
+    ASSERT_EQ(Diag_Frame_Type(f), FRAME_TYPE_DIAG_PROFILE);
+}
+
+TEST(test_diag_profile_frame_saturates) {
+    ProfStat st = { 0, 0xFFFFFFFFU, 48U * 2000000U, 1000 };  /* max ≈ 89 s, EWMA 2 s */
+    uint8_t f[16];
+    Diag_Pack_Profile_Frame(f, 1, 3, 1, PROF_PHASE_RX, &st);
+    ASSERT_EQ((f[5] << 8) | f[6], 0);
+    ASSERT_EQ((f[7] << 8) | f[8], 0xFFFF);
+    ASSERT_EQ((f[9] << 8) | f[10], 0xFFFF);
+    ASSERT_EQ(f[14], 0xFF);
+}
+
+TEST(test_diag_radio_frame_layout) {
+    LbtState lbt = { 0, 4, 0x12345, 300, 2550, 0, 700 };
+    uint8_t f[16];
+    Diag_Pack_Radio_Frame(f, 0xAABBCCDD, 3, 0x0001, &lbt);
+    ASSERT_EQ(f[0], 0xAA);
+    ASSERT_EQ(f[3], 0xDD);
+    ASSERT_EQ((f[4] << 8) | f[5], 0x2345);   /* Low 16 bits, wraps */
+    ASSERT_EQ((f[6] << 8) | f[7], 300);
+    ASSERT_EQ((f[8] << 8) | f[9], 25);       /* 2550 ms in 100 ms units */
+    ASSERT_EQ(f[10], 0xFF);                  /* forced_tx saturates */
+    ASSERT_EQ(f[11], 3);
+    ASSERT_EQ(f[14], 4);
+    ASSERT_EQ(Diag_Frame_Type(f), FRAME_TYPE_DIAG_RADIO);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 6. LOW-POWER DELAY TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+TEST(test_lpdelay_ticks_from_ms) {
+    ASSERT_EQ(LP_Delay_Ticks(100), 3276);    /* Inter-frame gap */
+    ASSERT_EQ(LP_Delay_Ticks(499), 16351);   /* Max TX jitter */
+    ASSERT_EQ(LP_Delay_Ticks(1000), 32768);
+}
+
+TEST(test_lpdelay_ticks_never_zero) {
+    /* A zero compare would never fire after the counter starts */
+    ASSERT_EQ(LP_Delay_Ticks(0), 1);
+}
+
+TEST(test_lpdelay_ticks_chunk_fits_16_bits) {
+    ASSERT_TRUE(LP_Delay_Ticks(LPDELAY_MAX_CHUNK_MS) <= 0xFFFF);
+    ASSERT_EQ(LP_Delay_Ticks(60000), LP_Delay_Ticks(LPDELAY_MAX_CHUNK_MS));
+}
+
+TEST(test_lpdelay_mode_by_length) {
+    ASSERT_EQ(LP_Delay_Mode(0), LPDELAY_MODE_NONE);
+    ASSERT_EQ(LP_Delay_Mode(1), LPDELAY_MODE_SLEEP);
+    ASSERT_EQ(LP_Delay_Mode(LPDELAY_STOP2_MIN_MS - 1), LPDELAY_MODE_SLEEP);
+    ASSERT_EQ(LP_Delay_Mode(LPDELAY_STOP2_MIN_MS), LPDELAY_MODE_STOP2);
+    ASSERT_EQ(LP_Delay_Mode(60), LPDELAY_MODE_STOP2);
+}
+
+TEST(test_lpdelay_sleep_only_keeps_uart_awake) {
+    /* Queen pauses while the modem UART receives: never STOP2 */
+    ASSERT_EQ(LP_Delay_Mode_Max(0, LPDELAY_MODE_SLEEP), LPDELAY_MODE_NONE);
+    ASSERT_EQ(LP_Delay_Mode_Max(1, LPDELAY_MODE_SLEEP), LPDELAY_MODE_SLEEP);
+    ASSERT_EQ(LP_Delay_Mode_Max(60, LPDELAY_MODE_SLEEP), LPDELAY_MODE_SLEEP);
+    ASSERT_EQ(LP_Delay_Mode_Max(LPDELAY_MAX_CHUNK_MS, LPDELAY_MODE_SLEEP), LPDELAY_MODE_SLEEP);
+    ASSERT_EQ(LP_Delay_Mode_Max(60, LPDELAY_MODE_STOP2), LP_Delay_Mode(60));
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 7. LISTEN-BEFORE-TALK TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+TEST(test_lbt_free_channel_sends_now) {
+    LbtState st;
+    LBT_Init(&st);
+    LBT_Frame_Start(&st);
+    ASSERT_EQ(LBT_On_Cad(&st, 0, 12345), 0);
+    ASSERT_EQ(st.cad_runs, 1);
+    ASSERT_EQ(st.cad_busy, 0);
+    ASSERT_EQ(st.frames, 1);
+}
+
+TEST(test_lbt_backoff_window_doubles) {
+    LbtState st;
+    LBT_Init(&st);
+    LBT_Frame_Start(&st);
+    /* rnd = window - 1 → the longest pause in each window */
+    for (uint32_t i = 0; i < LBT_MAX_ATTEMPTS; i++) {
+        uint32_t window = (uint32_t)LBT_SLOT_MS << i;
+        ASSERT_EQ(LBT_On_Cad(&st, 1, window - 1), window);
+    }
+    ASSERT_EQ(st.attempt, LBT_MAX_ATTEMPTS);
+}
+
+TEST(test_lbt_backoff_never_zero) {
+    /* 0 means "transmit" — a busy channel must always pause */
+    LbtState st;
+    LBT_Init(&st);
+    LBT_Frame_Start(&st);
+    ASSERT_EQ(LBT_On_Cad(&st, 1, 0), 1);
+    ASSERT_EQ(LBT_On_Cad(&st, 1, 2U * LBT_SLOT_MS), 1);
+}
+
+TEST(test_lbt_forced_after_max_attempts) {
+    LbtState st;
+    LBT_Init(&st);
+    LBT_Frame_Start(&st);
+    for (int i = 0; i < LBT_MAX_ATTEMPTS; i++) {
+        ASSERT_TRUE(LBT_On_Cad(&st, 1, 7) > 0);
+    }
+    ASSERT_EQ(LBT_On_Cad(&st, 1, 7), 0);
+    ASSERT_EQ(st.forced_tx, 1);
+    ASSERT_EQ(st.frames, 1);
+    ASSERT_EQ(st.cad_busy, LBT_MAX_ATTEMPTS + 1);
+}
+
+TEST(test_lbt_counters_span_frames) {
+    LbtState st;
+    LBT_Init(&st);
+    LBT_Frame_Start(&st);
+    LBT_On_Cad(&st, 1, 9);          /* 1 + 9 % 50 = 10 ms */
+    LBT_On_Cad(&st, 1, 29);         /* 1 + 29 % 100 = 30 ms */
+    LBT_On_Cad(&st, 0, 0);
+    LBT_Frame_Start(&st);           /* Next frame restarts the window */
+    ASSERT_EQ(st.attempt, 0);
+    ASSERT_EQ(LBT_On_Cad(&st, 1, 49), LBT_SLOT_MS);
+    LBT_On_Cad(&st, 0, 0);
+    ASSERT_EQ(st.cad_runs, 5);
+    ASSERT_EQ(st.cad_busy, 3);
+    ASSERT_EQ(st.frames, 2);
+    ASSERT_EQ(st.max_attempt, 2);
+    ASSERT_EQ(st.backoff_ms_total, 10 + 30 + LBT_SLOT_MS);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 8. RELAY QUEUE TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void relayq_frame(uint8_t* f, uint8_t tag)
+{
+    for (int i = 0; i < RELAYQ_FRAME_SIZE; i++) f[i] = (uint8_t)(tag + i);
+}
+
+TEST(test_relayq_fifo_order) {
+    RelayQueue q;
+    uint8_t f[RELAYQ_FRAME_SIZE], own[RELAYQ_FRAME_SIZE], out[RELAYQ_AGG_MAX_SIZE];
+    RelayQ_Init(&q);
+    for (uint8_t t = 1; t <= 3; t++) { relayq_frame(f, (uint8_t)(t * 0x10)); RelayQ_Push(&q, f); }
+    relayq_frame(own, 0xA0);
+
+    ASSERT_EQ(RelayQ_Build_Frame(&q, own, RELAYQ_CAPACITY, out), 4 * RELAYQ_FRAME_SIZE);
+    ASSERT_EQ(out[0], 0xA0);     /* Own block first */
+    ASSERT_EQ(out[1 * RELAYQ_FRAME_SIZE], 0x10);    /* Then oldest relay */
+    ASSERT_EQ(out[2 * RELAYQ_FRAME_SIZE], 0x20);
+    ASSERT_EQ(out[3 * RELAYQ_FRAME_SIZE], 0x30);
+    ASSERT_EQ(q.count, 0);
+}
+
+TEST(test_relayq_overflow_drops_oldest) {
+    RelayQueue q;
+    uint8_t f[RELAYQ_FRAME_SIZE], own[RELAYQ_FRAME_SIZE], out[RELAYQ_AGG_MAX_SIZE];
+    RelayQ_Init(&q);
+    for (uint8_t t = 1; t <= RELAYQ_CAPACITY + 2; t++) { relayq_frame(f, t); RelayQ_Push(&q, f); }
+    ASSERT_EQ(q.count, RELAYQ_CAPACITY);
+    ASSERT_EQ(q.dropped, 2);
+
+    relayq_frame(own, 0);
+    ASSERT_EQ(RelayQ_Build_Frame(&q, own, RELAYQ_CAPACITY, out), (1 + RELAYQ_CAPACITY) * RELAYQ_FRAME_SIZE);
+    ASSERT_EQ(out[1 * RELAYQ_FRAME_SIZE], 3);
+    ASSERT_EQ(out[4 * RELAYQ_FRAME_SIZE], RELAYQ_CAPACITY + 2);
+}
+
+TEST(test_relayq_no_energy_sends_own_only) {
+    RelayQueue q;
+    uint8_t f[RELAYQ_FRAME_SIZE], own[RELAYQ_FRAME_SIZE], out[RELAYQ_AGG_MAX_SIZE];
+    RelayQ_Init(&q);
+    relayq_frame(f, 1);
+    RelayQ_Push(&q, f);
+    relayq_frame(own, 0);
+    ASSERT_EQ(RelayQ_Build_Frame(&q, own, 0, out), RELAYQ_FRAME_SIZE);
+    ASSERT_EQ(q.count, 1);       /* Waits for the next wake */
+    ASSERT_EQ(RelayQ_Build_Frame(&q, own, 1, out), 2 * RELAYQ_FRAME_SIZE);
+    ASSERT_EQ(q.count, 0);
+}
+
+TEST(test_relayq_relays_only_without_own) {
+    /* Report-by-exception skipped the own reading: relays still go */
+    RelayQueue q;
+    uint8_t f[RELAYQ_FRAME_SIZE], out[RELAYQ_AGG_MAX_SIZE];
+    RelayQ_Init(&q);
+    ASSERT_EQ(RelayQ_Build_Frame(&q, NULL, RELAYQ_CAPACITY, out), 0);
+    relayq_frame(f, 0x10);
+    RelayQ_Push(&q, f);
+    ASSERT_EQ(RelayQ_Build_Frame(&q, NULL, RELAYQ_CAPACITY, out), RELAYQ_FRAME_SIZE);
+    ASSERT_EQ(out[0], 0x10);
+    ASSERT_EQ(q.count, 0);
+}
+
+TEST(test_relayq_drain_batch_then_relays) {
+    /* Batched uplink: own readings first, relays after, one frame */
+    RelayQueue own_q, relay_q;
+    uint8_t f[RELAYQ_FRAME_SIZE], out[RELAYQ_AGG_MAX_SIZE];
+    RelayQ_Init(&own_q);
+    RelayQ_Init(&relay_q);
+    for (uint8_t t = 1; t <= RELAYQ_CAPACITY; t++) {
+        relayq_frame(f, t); RelayQ_Push(&own_q, f);
+        relayq_frame(f, (uint8_t)(0x80 + t)); RelayQ_Push(&relay_q, f);
+    }
+    uint16_t size = RelayQ_Drain(&own_q, RELAYQ_CAPACITY, out);
+    size += RelayQ_Drain(&relay_q, RELAYQ_CAPACITY, out + size);
+    ASSERT_EQ(size, RELAYQ_AGG_MAX_SIZE);
+    ASSERT_EQ(RelayQ_Frame_Blocks(size), RELAYQ_AGG_MAX_BLOCKS);
+    ASSERT_EQ(out[0], 1);
+    ASSERT_EQ(out[(RELAYQ_CAPACITY - 1) * RELAYQ_FRAME_SIZE], RELAYQ_CAPACITY);
+    ASSERT_EQ(out[RELAYQ_CAPACITY * RELAYQ_FRAME_SIZE], 0x81);
+    ASSERT_EQ(own_q.count + relay_q.count, 0);
+    ASSERT_EQ(RelayQ_Drain(&own_q, 0, out), 0);
+}
+
+TEST(test_relayq_restore_keeps_valid_queue) {
+    /* Warm reset: SRAM2 keeps the struct, checksum still matches */
+    RelayQueue q;
+    uint8_t f[RELAYQ_FRAME_SIZE];
+    RelayQ_Init(&q);
+    relayq_frame(f, 7);
+    RelayQ_Push(&q, f);
+    RelayQ_Push(&q, f);
+    ASSERT_EQ(RelayQ_Restore(&q), 2);
+    ASSERT_EQ(q.frames[q.head][0], 7);
+}
+
+TEST(test_relayq_restore_rejects_garbage) {
+    /* Cold start: random SRAM2 content */
+    RelayQueue q;
+    uint8_t f[RELAYQ_FRAME_SIZE];
+    memset(&q, 0xA5, sizeof(q));
+    ASSERT_EQ(RelayQ_Restore(&q), 0);
+    ASSERT_EQ(q.magic, RELAYQ_MAGIC);
+
+    RelayQ_Init(&q);
+    relayq_frame(f, 7);
+    RelayQ_Push(&q, f);
+    q.frames[0][5] ^= 0x01;      /* One flipped bit */
+    ASSERT_EQ(RelayQ_Restore(&q), 0);
+}
+
+TEST(test_relayq_frame_blocks) {
+    ASSERT_EQ(RelayQ_Frame_Blocks(20), 1);
+    ASSERT_EQ(RelayQ_Frame_Blocks(60), 3);
+    ASSERT_EQ(RelayQ_Frame_Blocks(RELAYQ_AGG_MAX_SIZE), RELAYQ_AGG_MAX_BLOCKS);
+    ASSERT_EQ(RelayQ_Frame_Blocks(0), 0);
+    ASSERT_EQ(RelayQ_Frame_Blocks(21), 0);   /* Not whole wire blocks */
+    ASSERT_EQ(RelayQ_Frame_Blocks(16), 0);   /* Bare AES block: Queen OTA chunk */
+    ASSERT_EQ(RelayQ_Frame_Blocks(RELAYQ_AGG_MAX_SIZE + RELAYQ_FRAME_SIZE), 0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 9. MESH SEEN-SET TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Wire block: cleartext header + body (plaintext stands in for the AES body) */
+static void seen_frame(uint8_t* f, uint32_t did, uint8_t seq, uint8_t ttl)
+{
+    uint8_t* body = &f[ROUTE_HDR_SIZE];
+    memset(f, 0, SEEN_FRAME_SIZE);
+    body[0] = (uint8_t)(did >> 24);
+    body[1] = (uint8_t)(did >> 16);
+    body[2] = (uint8_t)(did >> 8);
+    body[3] = (uint8_t)did;
+    body[4] = 0x0D;             /* Vcap 3500 mV */
+    body[5] = 0xAC;
+    body[11] = Route_Byte(2, 3);
+    body[14] = seq;
+    Route_Hdr_From_Body(f, body);
+    f[ROUTE_HDR_HOP_TTL] = Route_Byte(2, ttl);
+}
+
+TEST(test_seen_zero_state_is_empty) {
+    /* Backup registers read all zeros after the first power-up */
+    SeenSet set;
+    uint8_t f[SEEN_FRAME_SIZE];
+    memset(&set, 0, sizeof(set));
+    seen_frame(f, 0xAABBCCDD, 0, 3);
+    ASSERT_FALSE(Seen_Contains(&set, f));
+    ASSERT_EQ(Seen_Check_And_Insert(&set, f), 0);
+    ASSERT_EQ(Seen_Check_And_Insert(&set, f), 1);
+}
+
+TEST(test_seen_next_seq_is_fresh) {
+    /* The old DID list blocked a tree's next reading */
+    SeenSet set;
+    uint8_t f[SEEN_FRAME_SIZE];
+    Seen_Init(&set);
+    seen_frame(f, 0xAABBCCDD, 41, 3);
+    Seen_Check_And_Insert(&set, f);
+    seen_frame(f, 0xAABBCCDD, 42, 3);
+    ASSERT_EQ(Seen_Check_And_Insert(&set, f), 0);
+}
+
+TEST(test_seen_ignores_ttl) {
+    /* The same frame one hop later has TTL − 1 and is still a duplicate */
+    SeenSet set;
+    uint8_t f[SEEN_FRAME_SIZE];
+    Seen_Init(&set);
+    seen_frame(f, 0x12345678, 7, 3);
+    Seen_Check_And_Insert(&set, f);
+    seen_frame(f, 0x12345678, 7, 2);
+    ASSERT_EQ(Seen_Check_And_Insert(&set, f), 1);
+}
+
+TEST(test_seen_pingpong_beyond_8_dids) {
+    /* 8-slot list forgot tree B after 8 other DIDs; seen-set keeps a generation */
+    SeenSet set;
+    uint8_t b[SEEN_FRAME_SIZE], f[SEEN_FRAME_SIZE];
+    Seen_Init(&set);
+    seen_frame(b, 0xBBBB, 1, 3);
+    Seen_Check_And_Insert(&set, b);
+    for (uint32_t i = 0; i < SEEN_GEN_CAPACITY - 1; i++) {
+        seen_frame(f, 0x1000 + i, 1, 3);
+        Seen_Check_And_Insert(&set, f);
+    }
+    ASSERT_TRUE(Seen_Contains(&set, b));
+}
+
+TEST(test_seen_false_positive_rate) {
+    /* Worst case: both generations full (2 × 20 keys) → analytic ≤ 1.6 % */
+    SeenSet set;
+    uint8_t f[SEEN_FRAME_SIZE];
+    Seen_Init(&set);
+    for (uint32_t i = 0; i < 2 * SEEN_GEN_CAPACITY; i++) {
+        seen_frame(f, 0x51000000U + i * 7919U, (uint8_t)i, 3);
+        Seen_Check_And_Insert(&set, f);
+    }
+    uint32_t hits = 0;
+    for (uint32_t i = 0; i < 10000; i++) {
+        seen_frame(f, 0x7E000000U + i * 104729U, (uint8_t)(i * 31U), 3);
+        hits += Seen_Contains(&set, f);
+    }
+    ASSERT_TRUE(hits < 250);   /* < 2.5 % with sampling margin */
+}
+
+TEST(test_seen_capacity_rotates_generations) {
+    SeenSet set;
+    uint8_t first[SEEN_FRAME_SIZE], f[SEEN_FRAME_SIZE];
+    Seen_Init(&set);
+    seen_frame(first, 0xF1F1F1F1, 0, 3);
+    Seen_Check_And_Insert(&set, first);
+    for (uint32_t i = 1; i < 2 * SEEN_GEN_CAPACITY; i++) {
+        seen_frame(f, 0x2000 + i, 0, 3);
+        Seen_Check_And_Insert(&set, f);
+    }
+    ASSERT_TRUE(Seen_Contains(&set, first));   /* Previous generation */
+    seen_frame(f, 0x3000, 0, 3);
+    Seen_Check_And_Insert(&set, f);            /* Third generation starts */
+    ASSERT_FALSE(Seen_Contains(&set, first));
+}
+
+TEST(test_seen_ages_out_after_two_generations) {
+    SeenSet set;
+    uint8_t f[SEEN_FRAME_SIZE];
+    Seen_Init(&set);
+    seen_frame(f, 0xDEADBEEF, 9, 3);
+    Seen_Check_And_Insert(&set, f);
+    Seen_Age(&set, SEEN_GEN_MAX_AGE_S - 1);
+    ASSERT_TRUE(Seen_Contains(&set, f));
+    Seen_Age(&set, 1);                         /* → previous generation */
+    ASSERT_TRUE(Seen_Contains(&set, f));
+    Seen_Age(&set, SEEN_GEN_MAX_AGE_S);        /* → forgotten */
+    ASSERT_FALSE(Seen_Contains(&set, f));
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 10. MESH GRADIENT ROUTING TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+TEST(test_route_cold_start_floods) {
+    /* Zeroed DR19 → unknown gradient → relay everything, as before */
+    RouteState st;
+    Route_Restore(&st, 0);
+    ASSERT_EQ(st.hop, ROUTE_HOP_UNKNOWN);
+    ASSERT_EQ(Route_Should_Relay(&st, 1), 1);
+    ASSERT_EQ(Route_Should_Relay(&st, 5), 1);
+}
+
+TEST(test_route_byte_keeps_ttl_nibble) {
+    uint8_t b = Route_Byte(2, 3);
+    ASSERT_EQ(b, 0x23);
+    ASSERT_EQ(Route_Byte_Hop(b), 2);
+    ASSERT_EQ(Route_Byte_TTL(b), 3);
+    ASSERT_EQ(Route_Byte_Hop(Route_Byte(ROUTE_HOP_UNKNOWN, 5)), ROUTE_HOP_UNKNOWN);
+}
+
+TEST(test_route_beacon_gives_hop_one) {
+    RouteState st;
+    uint8_t beacon[16];
+    Route_Init(&st);
+    Route_Pack_Beacon(beacon);
+    ASSERT_EQ(beacon[15], FRAME_TYPE_BEACON);
+    ASSERT_EQ(Route_Byte_TTL(beacon[11]), 0);  /* Never relayed */
+    ASSERT_EQ(Route_On_Heard(&st, Route_Byte_Hop(beacon[11]), -90), 1);
+    ASSERT_EQ(st.hop, 1);
+}
+
+TEST(test_route_keeps_shortest_hop) {
+    RouteState st;
+    Route_Init(&st);
+    Route_On_Heard(&st, 3, -100);
+    ASSERT_EQ(st.hop, 4);
+    ASSERT_EQ(Route_On_Heard(&st, 1, -100), 1);
+    ASSERT_EQ(st.hop, 2);
+    ASSERT_EQ(Route_On_Heard(&st, 4, -100), 0);  /* Longer path ignored */
+    ASSERT_EQ(st.hop, 2);
+    ASSERT_EQ(Route_On_Heard(&st, ROUTE_HOP_UNKNOWN, -100), 0);
+    ASSERT_EQ(st.hop, 2);
+}
+
+TEST(test_route_ignores_weak_link) {
+    RouteState st;
+    Route_Init(&st);
+    ASSERT_EQ(Route_On_Heard(&st, ROUTE_HOP_QUEEN, ROUTE_RSSI_FLOOR_DBM - 1), 0);
+    ASSERT_EQ(st.hop, ROUTE_HOP_UNKNOWN);
+    ASSERT_EQ(Route_On_Heard(&st, ROUTE_HOP_QUEEN, ROUTE_RSSI_FLOOR_DBM), 1);
+}
+
+TEST(test_route_relays_only_downhill) {
+    RouteState st;
+    Route_Init(&st);
+    Route_On_Heard(&st, 1, -100);                /* We are hop 2 */
+    ASSERT_EQ(Route_Should_Relay(&st, 3), 1);    /* Further away → carry it */
+    ASSERT_EQ(Route_Should_Relay(&st, 2), 0);    /* Sideways */
+    ASSERT_EQ(Route_Should_Relay(&st, 1), 0);    /* Closer to the Queen */
+    ASSERT_EQ(Route_Should_Relay(&st, ROUTE_HOP_UNKNOWN), 1); /* Lost sender */
+}
+
+TEST(test_route_goes_stale_without_refresh) {
+    RouteState st, back;
+    Route_Init(&st);
+    Route_On_Heard(&st, 0, -80);
+    for (int i = 0; i < ROUTE_STALE_WAKES - 1; i++) Route_Tick(&st);
+    ASSERT_EQ(st.hop, 1);
+    Route_On_Heard(&st, 0, -80);                 /* Same gradient confirmed */
+    ASSERT_EQ(st.age, 0);
+    Route_Restore(&back, Route_Pack(&st));
+    ASSERT_EQ(back.hop, 1);
+    for (int i = 0; i < ROUTE_STALE_WAKES; i++) Route_Tick(&st);
+    ASSERT_EQ(st.hop, ROUTE_HOP_UNKNOWN);
+}
+
+TEST(test_route_header_mirrors_body) {
+    uint8_t body[ROUTE_BODY_SIZE], hdr[ROUTE_HDR_SIZE];
+    memset(body, 0, sizeof(body));
+    body[0] = 0xAA; body[1] = 0xBB; body[2] = 0xCC; body[3] = 0xDD;
+    body[11] = Route_Byte(3, 2);
+    body[15] = 0xD1;
+    Route_Hdr_From_Body(hdr, body);
+    ASSERT_EQ(hdr[ROUTE_HDR_SRC], 0xCC);         /* DID low 16 bits */
+    ASSERT_EQ(hdr[ROUTE_HDR_SRC + 1], 0xDD);
+    ASSERT_EQ(hdr[ROUTE_HDR_HOP_TTL], Route_Byte(3, 2));
+    ASSERT_EQ(hdr[ROUTE_HDR_TYPE], 0xD1);
+    hdr[ROUTE_HDR_HOP_TTL] = Route_Byte(2, 1);   /* Relay rewrite keeps the binding */
+    ASSERT_EQ(Route_Hdr_Binds_Body(hdr, body), 1);
+}
+
+TEST(test_route_header_rejects_mismatch) {
+    uint8_t body[ROUTE_BODY_SIZE], hdr[ROUTE_HDR_SIZE];
+    memset(body, 0, sizeof(body));
+    body[3] = 0x42;
+    Route_Hdr_From_Body(hdr, body);
+    hdr[ROUTE_HDR_SRC + 1] ^= 0x01;              /* Spoofed source */
+    ASSERT_EQ(Route_Hdr_Binds_Body(hdr, body), 0);
+    Route_Hdr_From_Body(hdr, body);
+    hdr[ROUTE_HDR_TYPE] = FRAME_TYPE_BEACON;     /* Telemetry dressed as a beacon */
+    ASSERT_EQ(Route_Hdr_Binds_Body(hdr, body), 0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 11. PER-DEVICE KEY CACHE TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+static const uint32_t keys_network[KEYS_WORDS] = { 0x2B7E1516, 0x28AED2A6, 0xABF71588, 0x09CF4F3C,
+                                                   0x1A2B3C4D, 0x5E6F7A8B, 0x9C0D1E2F, 0x3A4B5C6D };
+
+/* Flash image: header + records sorted by Src; 0x1111BEEF / 0x2222BEEF share Src */
+static struct {
+    KeyTableHeader hdr;
+    KeyRecord rec[4];
+} keys_flash;
+
+static void keys_build_flash(void)
+{
+    static const uint32_t dids[4] = { 0x0A000001, 0x1111BEEF, 0x2222BEEF, 0x0B00F00D };
+    memset(&keys_flash, 0, sizeof(keys_flash));
+    keys_flash.hdr.magic = KEYS_TABLE_MAGIC;
+    keys_flash.hdr.count = 4;
+    for (int i = 0; i < 4; i++) {
+        keys_flash.rec[i].did = dids[i];
+        for (int w = 0; w < KEYS_WORDS; w++) keys_flash.rec[i].key[w] = dids[i] ^ (uint32_t)w;
+    }
+}
+
+static void keys_body(uint8_t* body, uint32_t did)
+{
+    memset(body, 0, ROUTE_BODY_SIZE);
+    body[0] = (uint8_t)(did >> 24);
+    body[1] = (uint8_t)(did >> 16);
+    body[2] = (uint8_t)(did >> 8);
+    body[3] = (uint8_t)did;
+}
+
+TEST(test_keys_table_from_flash_validates) {
+    uint16_t n;
+    keys_build_flash();
+    ASSERT_TRUE(Keys_Table_From_Flash(&keys_flash, &n) == keys_flash.rec);
+    ASSERT_EQ(n, 4);
+    keys_flash.rec[3].did = 0x0B000001;                 /* Src 0x0001 after 0xBEEF: unsorted */
+    ASSERT_TRUE(Keys_Table_From_Flash(&keys_flash, &n) == NULL);
+    ASSERT_EQ(n, 0);
+    memset(&keys_flash, 0xFF, sizeof(keys_flash));      /* Erased flash */
+    ASSERT_TRUE(Keys_Table_From_Flash(&keys_flash, &n) == NULL);
+}
+
+TEST(test_keys_lookup_caches_table_key) {
+    KeyCache c;
+    uint16_t n;
+    keys_build_flash();
+    const KeyRecord* table = Keys_Table_From_Flash(&keys_flash, &n);
+    Keys_Init(&c, table, n, keys_network);
+    KeyRef ref = Keys_Lookup(&c, 0xF00D, 0);
+    ASSERT_EQ(ref.index, 3);
+    ASSERT_EQ(ref.did, 0x0B00F00D);
+    ASSERT_EQ(memcmp(ref.key, keys_flash.rec[3].key, sizeof(keys_flash.rec[3].key)), 0);
+    uint32_t probes = c.stats.table_probes;
+    ref = Keys_Lookup(&c, 0xF00D, 0);
+    ASSERT_EQ(ref.index, 3);
+    ASSERT_EQ(c.stats.hits, 1);
+    ASSERT_EQ(c.stats.table_probes, probes);            /* Hit never touches flash */
+}
+
+TEST(test_keys_unknown_src_uses_network_key) {
+    KeyCache c;
+    uint8_t body[ROUTE_BODY_SIZE];
+    Keys_Init(&c, NULL, 0, keys_network);               /* No table flashed yet */
+    KeyRef ref = Keys_Lookup(&c, 0x1234, 0);
+    ASSERT_EQ(ref.index, KEYS_NETWORK);
+    ASSERT_EQ(memcmp(ref.key, keys_network, sizeof(keys_network)), 0);
+    keys_body(body, 0xCAFE1234);
+    ASSERT_TRUE(Keys_Ref_Owns(&ref, body));
+    ASSERT_TRUE(Keys_Lookup(&c, 0x1234, 1).key == NULL);
+}
+
+TEST(test_keys_shared_src_rotates_candidates) {
+    KeyCache c;
+    uint16_t n;
+    uint8_t body[ROUTE_BODY_SIZE];
+    keys_build_flash();
+    const KeyRecord* table = Keys_Table_From_Flash(&keys_flash, &n);
+    Keys_Init(&c, table, n, keys_network);
+    KeyRef ref = Keys_Lookup(&c, 0xBEEF, 0);
+    ASSERT_EQ(ref.did, 0x1111BEEF);
+    keys_body(body, 0x2222BEEF);
+    ASSERT_FALSE(Keys_Ref_Owns(&ref, body));            /* Wrong tree, same Src */
+    ref = Keys_Lookup(&c, 0xBEEF, 1);
+    ASSERT_EQ(ref.did, 0x2222BEEF);
+    ASSERT_TRUE(Keys_Ref_Owns(&ref, body));
+    ASSERT_EQ(Keys_Lookup(&c, 0xBEEF, 0).did, 0x2222BEEF); /* Winner stays cached */
+    ASSERT_EQ(Keys_Lookup(&c, 0xBEEF, 1).index, KEYS_NETWORK); /* Unprovisioned Soldier */
+    ASSERT_EQ(Keys_Lookup(&c, 0xBEEF, 2).did, 0x1111BEEF);
+    ASSERT_TRUE(Keys_Lookup(&c, 0xBEEF, 3).key == NULL);
+}
+
+TEST(test_keys_lru_evicts_least_recent) {
+    KeyCache c;
+    Keys_Init(&c, NULL, 0, keys_network);
+    for (uint16_t src = 0; src < KEYS_CACHE_SLOTS; src++) Keys_Lookup(&c, src, 0);
+    Keys_Lookup(&c, 0, 0);                              /* Src 0 is fresh again */
+    Keys_Lookup(&c, 0x7777, 0);                         /* Evicts Src 1 */
+    uint32_t hits = c.stats.hits;
+    Keys_Lookup(&c, 0, 0);
+    ASSERT_EQ(c.stats.hits, hits + 1);
+    Keys_Lookup(&c, 1, 0);
+    ASSERT_EQ(c.stats.hits, hits + 1);
+}
+
+TEST(test_keys_reload_only_on_switch) {
+    KeyCache c;
+    uint16_t n;
+    keys_build_flash();
+    const KeyRecord* table = Keys_Table_From_Flash(&keys_flash, &n);
+    Keys_Init(&c, table, n, keys_network);
+    KeyRef net = Keys_Lookup(&c, 0x4242, 0);
+    ASSERT_EQ(Keys_Mark_Loaded(&c, &net), 0);           /* MX_AES_Init loaded it */
+    KeyRef a = Keys_Lookup(&c, 0x0001, 0);
+    ASSERT_EQ(Keys_Mark_Loaded(&c, &a), 1);
+    ASSERT_EQ(Keys_Mark_Loaded(&c, &a), 0);             /* Same Soldier again */
+    Keys_Forget_Loaded(&c);                             /* CBC batch for Rails */
+    ASSERT_EQ(Keys_Mark_Loaded(&c, &a), 1);
+    ASSERT_EQ(c.stats.loads, 2);
+}
+
+TEST(test_keys_reply_uses_network_key_without_lookup) {
+    KeyCache c;
+    uint16_t n;
+    keys_build_flash();
+    const KeyRecord* table = Keys_Table_From_Flash(&keys_flash, &n);
+    Keys_Init(&c, table, n, keys_network);
+    KeyRef a = Keys_Lookup(&c, 0xF00D, 0);             /* Uplink block 0: per-device key */
+    ASSERT_EQ(Keys_Mark_Loaded(&c, &a), 1);
+    KeyRef reply = Keys_Network(&c);                    /* Beacon / OTA chunk back */
+    ASSERT_EQ(reply.index, KEYS_NETWORK);
+    ASSERT_TRUE(reply.key == keys_network);
+    ASSERT_EQ(Keys_Mark_Loaded(&c, &reply), 1);
+    ASSERT_EQ(c.stats.lookups, 1);                      /* Hit rate sees the block only */
+    ASSERT_EQ(c.stats.hits, 0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 12. REPORT-BY-EXCEPTION TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Soldier payload: only the bytes Rbe_Decide reads */
+static void rbe_payload(uint8_t* p, uint16_t vcap_mv, int8_t temp_c, uint8_t acoustic, uint8_t bio)
+{
+    memset(p, 0, 16);
+    p[4] = (uint8_t)(vcap_mv >> 8);
+    p[5] = (uint8_t)(vcap_mv & 0xFF);
+    p[6] = (uint8_t)temp_c;
+    p[7] = acoustic;
+    p[10] = bio;
+}
+
+TEST(test_rbe_first_reading_always_sent) {
+    RbeState st;
+    uint8_t p[16];
+    Rbe_Init(&st);
+    rbe_payload(p, 3000, 12, 0, 0x05);
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_FIRST);
+    Rbe_Restore(&st, 0);                 /* Zeroed DR0: same as birth */
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_FIRST);
+}
+
+TEST(test_rbe_inside_deadbands_skips) {
+    RbeState st;
+    uint8_t p[16];
+    Rbe_Init(&st);
+    rbe_payload(p, 3000, 12, 0, 0x05);
+    Rbe_Sent(&st, p);
+    rbe_payload(p, 3000 + RBE_VCAP_DEADBAND_MV - 10, 12 - RBE_TEMP_DEADBAND_C, 1, 0x05 + RBE_GROWTH_DEADBAND);
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SKIP);
+}
+
+TEST(test_rbe_outside_deadband_sends) {
+    RbeState st;
+    uint8_t p[16];
+    Rbe_Init(&st);
+    rbe_payload(p, 3000, 12, 0, 0x05);
+    Rbe_Sent(&st, p);
+    rbe_payload(p, 3000 - RBE_VCAP_DEADBAND_MV - 20, 12, 0, 0x05);
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_DELTA);
+    rbe_payload(p, 3000, 12 + RBE_TEMP_DEADBAND_C + 1, 0, 0x05);
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_DELTA);
+    rbe_payload(p, 3000, 12, 0, 0x05 + RBE_GROWTH_DEADBAND + 1);
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_DELTA);
+    rbe_payload(p, 3000, 12, RBE_ACOUSTIC_EVENTS, 0x05);
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_ACOUSTIC);
+}
+
+TEST(test_rbe_status_change_sends_at_once) {
+    /* One growth point is inside the deadband, the status bits are not */
+    RbeState st;
+    uint8_t p[16];
+    Rbe_Init(&st);
+    rbe_payload(p, 3000, 12, 0, (0 << 6) | 10);
+    Rbe_Sent(&st, p);
+    rbe_payload(p, 3000, 12, 0, (1 << 6) | 10);
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_STATUS);
+    rbe_payload(p, 3000, 12, 0, 0xFF);   /* BIO_STATUS_VM_ERROR = tamper */
+    ASSERT_EQ(Rbe_Decide(&st, p), RBE_SEND_STATUS);
+}
+
+TEST(test_rbe_heartbeat_bounds_silence) {
+    RbeState st;
+    uint8_t p[16];
+    int sent_at = -1;
+    Rbe_Init(&st);
+    rbe_payload(p, 3000, 12, 0, 0x05);
+    Rbe_Sent(&st, p);
+    for (int wake = 1; wake <= 2 * RBE_HEARTBEAT_CYCLES && sent_at < 0; wake++) {
+        if (Rbe_Decide(&st, p) == RBE_SEND_HEARTBEAT) sent_at = wake;
+        else Rbe_Skipped(&st);
+    }
+    ASSERT_EQ(sent_at, RBE_HEARTBEAT_CYCLES);
+    Rbe_Sent(&st, p);
+    ASSERT_EQ(st.silent, 0);
+}
+
+TEST(test_rbe_batch_waits_until_full) {
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SKIP, 0, 0), 0);
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SEND_DELTA, 1, 0), RBE_BATCH_READINGS == 1);
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SEND_HEARTBEAT, RBE_BATCH_READINGS - 1, 3600), RBE_BATCH_READINGS == 1);
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SEND_DELTA, RBE_BATCH_READINGS, 0), 1);
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SKIP, 1, RBE_BATCH_MAX_HOLD_S), 1);   /* Oldest reading aged out */
+}
+
+TEST(test_rbe_batch_urgent_goes_at_once) {
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SEND_STATUS, 1, 0), 1);
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SEND_FIRST, 1, 0), 1);
+    ASSERT_EQ(Rbe_Batch_Due(RBE_SEND_STATUS, 0, 0), 0);   /* Nothing buffered */
+}
+
+TEST(test_rbe_batch_max_hold_on_rtc_time) {
+    /* The Soldier main loop: one reading buffered, then quiet wakes, each an
+     * hour of STOP2 + 0.8 s awake. Held time and the gap in bytes 8-9 come
+     * from the RTC — SysTick stops in STOP2 and would add ~0 per wake. */
+    EnergyClock clk;
+    Energy_Clock_Restore(&clk, 0);
+    uint32_t rtc_ms = 0, held_s = 0, gap_s = 0;
+    Energy_Clock_Elapsed_S(&clk, rtc_ms);
+    int wake;
+    for (wake = 1; wake <= 10; wake++) {
+        rtc_ms += 3600800U;
+        uint32_t dt = Energy_Clock_Elapsed_S(&clk, rtc_ms % ENERGY_DAY_MS);
+        held_s += dt;
+        gap_s += dt;
+        if (Rbe_Batch_Due(RBE_SKIP, 1, held_s)) break;
+    }
+    ASSERT_EQ(wake, 6);                            /* 6 × 3600.8 s ≥ RBE_BATCH_MAX_HOLD_S */
+    ASSERT_EQ(gap_s, 21604);
+}
+
+TEST(test_rbe_pack_roundtrip) {
+    RbeState st, back;
+    uint8_t p[16];
+    Rbe_Init(&st);
+    rbe_payload(p, 3007, -15, 0, 0x8A);
+    Rbe_Sent(&st, p);
+    Rbe_Skipped(&st);
+    Rbe_Skipped(&st);
+    Rbe_Restore(&back, Rbe_Pack(&st));
+    ASSERT_EQ(back.vcap_mv, st.vcap_mv);
+    ASSERT_EQ(back.vcap_mv, 3008);       /* Nearest 16 mV step */
+    ASSERT_EQ(back.temp_c, -15);
+    ASSERT_EQ(back.bio, 0x8A);
+    ASSERT_EQ(back.silent, 2);
+    ASSERT_EQ(Rbe_Decide(&back, p), RBE_SKIP);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 13. ADAPTIVE TX POWER (ADR) TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+static uint32_t adr_beacon_did(const uint8_t* b)
+{
+    return ((uint32_t)b[ADR_BEACON_DID] << 24) | ((uint32_t)b[ADR_BEACON_DID + 1] << 16) |
+           ((uint32_t)b[ADR_BEACON_DID + 2] << 8) | (uint32_t)b[ADR_BEACON_DID + 3];
+}
+
+static void adr_command(uint8_t* beacon, uint32_t did, int8_t delta)
+{
+    Route_Pack_Beacon(beacon);
+    beacon[ADR_BEACON_DID]     = (uint8_t)(did >> 24);
+    beacon[ADR_BEACON_DID + 1] = (uint8_t)(did >> 16);
+    beacon[ADR_BEACON_DID + 2] = (uint8_t)(did >> 8);
+    beacon[ADR_BEACON_DID + 3] = (uint8_t)did;
+    beacon[ADR_BEACON_DELTA]   = (uint8_t)delta;
+}
+
+TEST(test_adr_margin_rssi_or_snr) {
+    /* Clean link: SNR saturates, RSSI tells how much is left */
+    ASSERT_EQ(Adr_Link_Margin(-80, 11), -80 - ADR_RSSI_FLOOR_DBM);
+    /* Noisy link: the SNR floor is closer than the RSSI floor */
+    ASSERT_EQ(Adr_Link_Margin(-80, -2), -2 - ADR_SNR_FLOOR_DB);
+    /* Weak but clean: RSSI is the limit */
+    ASSERT_EQ(Adr_Link_Margin(ADR_RSSI_FLOOR_DBM + 3, 5), 3);
+    ASSERT_EQ(Adr_Link_Margin(-400, -20), -128);   /* Saturates */
+}
+
+TEST(test_adr_delta_has_hysteresis) {
+    ASSERT_EQ(Adr_Delta_DB(ADR_MARGIN_DB), 0);
+    ASSERT_EQ(Adr_Delta_DB(ADR_MARGIN_DB + ADR_POWER_STEP_DB + ADR_HYSTERESIS_DB - 1), 0);
+    ASSERT_EQ(Adr_Delta_DB(ADR_MARGIN_DB + ADR_POWER_STEP_DB + ADR_HYSTERESIS_DB), -ADR_POWER_STEP_DB);
+    ASSERT_EQ(Adr_Delta_DB(ADR_MARGIN_DB + 20), -(20 - ADR_HYSTERESIS_DB) / ADR_POWER_STEP_DB * ADR_POWER_STEP_DB);
+    /* Short of the margin: up at once, rounded to a whole step */
+    ASSERT_EQ(Adr_Delta_DB(ADR_MARGIN_DB - 1), ADR_POWER_STEP_DB);
+    ASSERT_EQ(Adr_Delta_DB(ADR_MARGIN_DB - 3), 2 * ADR_POWER_STEP_DB);
+}
+
+TEST(test_adr_command_after_full_window) {
+    static AdrTable t;
+    uint8_t beacon[16];
+    uint32_t did = 0x1234ABCD;
+    Adr_Table_Init(&t);
+    for (int i = 0; i < ADR_HISTORY - 1; i++) Adr_Observe(&t, did, -70, 10);
+    Route_Pack_Beacon(beacon);
+    ASSERT_EQ(Adr_Fill_Beacon(&t, 0xABCD, beacon), 0);
+    ASSERT_EQ(adr_beacon_did(beacon), 0);            /* Gradient-only beacon */
+
+    Adr_Observe(&t, did, -100, 10);                   /* Best of the window counts */
+    ASSERT_EQ(Adr_Fill_Beacon(&t, 0xABCD, beacon), 1);
+    ASSERT_EQ(adr_beacon_did(beacon), did);
+    ASSERT_EQ((int8_t)beacon[ADR_BEACON_DELTA], Adr_Delta_DB(Adr_Link_Margin(-70, 10)));
+    ASSERT_EQ(beacon[15], FRAME_TYPE_BEACON);
+
+    Route_Pack_Beacon(beacon);                        /* New window starts empty */
+    ASSERT_EQ(Adr_Fill_Beacon(&t, 0xABCD, beacon), 0);
+    ASSERT_EQ(Adr_Fill_Beacon(&t, 0x0BCD, beacon), 0); /* Unknown Src */
+}
+
+TEST(test_adr_table_evicts_least_recent) {
+    static AdrTable t;
+    uint8_t beacon[16];
+    Adr_Table_Init(&t);
+    for (uint32_t d = 1; d <= ADR_TABLE_SLOTS; d++) {
+        for (int i = 0; i < ADR_HISTORY; i++) Adr_Observe(&t, d, -70, 10);
+    }
+    Adr_Observe(&t, 1, -70, 10);                      /* DID 2 is now the oldest */
+    Adr_Observe(&t, 0x10000, -70, 10);
+    Route_Pack_Beacon(beacon);
+    ASSERT_EQ(Adr_Fill_Beacon(&t, 2, beacon), 0);
+    ASSERT_EQ(Adr_Fill_Beacon(&t, 1, beacon), 1);
+    ASSERT_EQ(adr_beacon_did(beacon), 1);
+    ASSERT_EQ(Adr_Did_For_Src(&t, 1), 1);             /* Direct neighbour: DID from Src */
+    ASSERT_EQ(Adr_Did_For_Src(&t, 0x0000), 0x10000);
+    ASSERT_EQ(Adr_Did_For_Src(&t, 2), 0);             /* Evicted */
+}
+
+TEST(test_adr_soldier_applies_own_command) {
+    AdrState st;
+    uint8_t beacon[16];
+    Adr_Init(&st);
+    ASSERT_EQ(st.power_dbm, ADR_POWER_MAX_DBM);
+
+    adr_command(beacon, 0x2222, -4);
+    ASSERT_EQ(Adr_On_Beacon(&st, beacon, 0x1111), 0); /* Someone else's command */
+    ASSERT_EQ(st.power_dbm, ADR_POWER_MAX_DBM);
+
+    adr_command(beacon, 0x1111, -20);                 /* Damped to ADR_MAX_STEPS_DOWN */
+    ASSERT_EQ(Adr_On_Beacon(&st, beacon, 0x1111), 1);
+    ASSERT_EQ(st.power_dbm, ADR_POWER_MAX_DBM - ADR_MAX_STEPS_DOWN * ADR_POWER_STEP_DB);
+
+    for (int i = 0; i < 10; i++) Adr_On_Beacon(&st, beacon, 0x1111);
+    ASSERT_EQ(st.power_dbm, ADR_POWER_MIN_DBM);
+
+    adr_command(beacon, 0x1111, 40);                  /* Up in one go, capped */
+    ASSERT_EQ(Adr_On_Beacon(&st, beacon, 0x1111), 1);
+    ASSERT_EQ(st.power_dbm, ADR_POWER_MAX_DBM);
+    adr_command(beacon, 0x1111, 0);
+    ASSERT_EQ(Adr_On_Beacon(&st, beacon, 0x1111), 0);
+}
+
+TEST(test_adr_backoff_when_queen_is_silent) {
+    AdrState st;
+    uint8_t beacon[16];
+    Adr_Init(&st);
+    for (int i = 0; i < 3 * ADR_BACKOFF_WINDOWS; i++) ASSERT_EQ(Adr_Window_Closed(&st), 0); /* At max */
+
+    adr_command(beacon, 0x1111, -4);
+    Adr_On_Beacon(&st, beacon, 0x1111);
+    for (int i = 0; i < ADR_BACKOFF_WINDOWS - 1; i++) ASSERT_EQ(Adr_Window_Closed(&st), 0);
+    adr_command(beacon, 0x1111, 0);                   /* "Keep" resets the count */
+    Adr_On_Beacon(&st, beacon, 0x1111);
+    for (int i = 0; i < ADR_BACKOFF_WINDOWS - 1; i++) ASSERT_EQ(Adr_Window_Closed(&st), 0);
+    ASSERT_EQ(Adr_Window_Closed(&st), 1);
+    ASSERT_EQ(st.power_dbm, ADR_POWER_MAX_DBM - 4 + ADR_POWER_STEP_DB);
+}
+
+TEST(test_adr_tx_cost_scales_with_power) {
+    AdrState st;
+    Adr_Init(&st);
+    ASSERT_EQ(Adr_Tx_Cost_UJ(&st, ENERGY_COST_UPLINK_UJ), ENERGY_COST_UPLINK_UJ);
+    uint32_t prev = ENERGY_COST_UPLINK_UJ;
+    for (st.power_dbm = ADR_POWER_MAX_DBM - ADR_POWER_STEP_DB; st.power_dbm >= ADR_POWER_MIN_DBM;
+         st.power_dbm = (int8_t)(st.power_dbm - ADR_POWER_STEP_DB)) {
+        uint32_t cost = Adr_Tx_Cost_UJ(&st, ENERGY_COST_UPLINK_UJ);
+        ASSERT_TRUE(cost < prev);
+        prev = cost;
+    }
+    ASSERT_TRUE(prev > ENERGY_COST_UPLINK_UJ / 2);    /* Radio wake-up and CAD do not scale */
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 14. BEACON TIME SYNC & TDMA SLOT TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Queen reply beacon sent at Queen time queen_ms, heard by the Soldier
+ * at its own RTC time local_ms (end of the beacon) */
+static uint8_t sync_hear(SyncState* st, uint32_t did, uint8_t slot,
+                         uint32_t queen_ms, uint32_t local_ms)
+{
+    uint8_t beacon[16];
+    Route_Pack_Beacon(beacon);
+    Sync_Fill_Beacon(beacon, did, slot, queen_ms);
+    return Sync_On_Beacon(st, beacon, did, local_ms);
+}
+
+TEST(test_sync_airtime_sf7) {
+    ASSERT_EQ(Sync_Airtime_Ms(ROUTE_BLOCK_SIZE), 57);
+    ASSERT_EQ(Sync_Airtime_Ms(RELAYQ_AGG_MAX_SIZE), 261);
+    ASSERT_TRUE(Sync_Airtime_Ms(40) > Sync_Airtime_Ms(20));
+    /* A full batch, diagnostics and the 500 ms RX window fit one slot */
+    ASSERT_TRUE(SYNC_GUARD_MS + Sync_Airtime_Ms(RELAYQ_AGG_MAX_SIZE) + 500U < SYNC_SLOT_MS);
+    ASSERT_EQ(SYNC_DAY_MS % SYNC_FRAME_MS, 0);          /* Midnight keeps the phase */
+}
+
+TEST(test_sync_schedule_probes_and_skips_contention) {
+    static SyncSchedule s;
+    Sync_Schedule_Init(&s);
+    uint8_t a = Sync_Schedule_Slot(&s, 0x1111, 0);
+    ASSERT_TRUE(a != SYNC_SLOT_NONE);
+    ASSERT_TRUE(!Sync_Is_Contention(a));
+    ASSERT_EQ(Sync_Schedule_Slot(&s, 0x1111, 1000), a); /* Stable */
+
+    uint8_t seen[SYNC_SLOTS] = {0};
+    seen[a] = 1;
+    int granted = 1;
+    for (uint32_t did = 2; did < 400; did++) {
+        uint8_t slot = Sync_Schedule_Slot(&s, did * 7919U, 2000);
+        if (slot == SYNC_SLOT_NONE) break;
+        ASSERT_TRUE(!Sync_Is_Contention(slot));
+        ASSERT_EQ(seen[slot], 0);                       /* Collision-free */
+        seen[slot] = 1;
+        granted++;
+    }
+    ASSERT_EQ(granted, SYNC_SLOTS - SYNC_SLOTS / SYNC_CONTENTION_EVERY);
+    ASSERT_EQ(Sync_Schedule_Slot(&s, 0xDEAD, 3000), SYNC_SLOT_NONE);
+
+    /* A day of silence frees 0x1111's slot for a newcomer */
+    for (uint32_t did = 2; did < 400; did++) Sync_Schedule_Slot(&s, did * 7919U, SYNC_SLOT_EXPIRY_MS);
+    ASSERT_EQ(Sync_Schedule_Slot(&s, 0xDEAD, SYNC_SLOT_EXPIRY_MS + 1001), a);
+}
+
+TEST(test_sync_on_slot_tolerance) {
+    uint32_t frame0 = 5 * SYNC_FRAME_MS;
+    uint32_t start = frame0 + 9 * SYNC_SLOT_MS + SYNC_GUARD_MS;
+    ASSERT_EQ(Sync_On_Slot(9, start), 1);
+    ASSERT_EQ(Sync_On_Slot(9, start + SYNC_RESYNC_MS), 1);
+    ASSERT_EQ(Sync_On_Slot(9, start + SYNC_RESYNC_MS + 1), 0); /* Drifted: resync */
+    ASSERT_EQ(Sync_On_Slot(9, start - SYNC_RESYNC_MS - 1), 0);
+    ASSERT_EQ(Sync_On_Slot(10, start), 0);                     /* Someone else's slot */
+    ASSERT_EQ(Sync_On_Slot(9, frame0 + 16 * SYNC_SLOT_MS + 400), 1); /* Contention */
+    ASSERT_EQ(Sync_On_Slot(SYNC_SLOT_NONE, start + 333), 1);   /* No slot to fix */
+}
+
+TEST(test_sync_soldier_locks_to_queen_phase) {
+    SyncState st;
+    uint8_t beacon[16];
+    Sync_Init(&st);
+    ASSERT_EQ(Sync_Slot_Wait_Ms(&st, 0), SYNC_WAIT_MISSED);
+    ASSERT_EQ(Sync_Sleep_S(&st, 0, 300), 300);          /* Unsynced: plan as is */
+
+    Route_Pack_Beacon(beacon);
+    Sync_Fill_Beacon(beacon, 0x2222, 9, 1000);
+    ASSERT_EQ(Sync_On_Beacon(&st, beacon, 0x1111, 5000), 0); /* Not ours */
+    adr_command(beacon, 0x1111, -2);
+    ASSERT_EQ(Sync_On_Beacon(&st, beacon, 0x1111, 5000), 0); /* ADR only: slot byte 0 */
+    ASSERT_EQ(st.valid, 0);
+
+    /* Queen sends at 70 000 ms of its frame; Soldier hears it at 12:00:00.000 */
+    uint32_t local = 12U * 3600U * 1000U;
+    ASSERT_EQ(sync_hear(&st, 0x1111, 9, 70000, local), 1);
+    ASSERT_EQ(st.slot, 9);
+    ASSERT_EQ(Sync_Queen_Ms(&st, local), 70000 + Sync_Airtime_Ms(ROUTE_BLOCK_SIZE));
+    ASSERT_EQ(Sync_Queen_Ms(&st, local + 1000), 71000 + Sync_Airtime_Ms(ROUTE_BLOCK_SIZE));
+
+    /* Slot 9 is ~62 s ahead: an off-plan wake goes out on jitter + LBT */
+    ASSERT_EQ(Sync_Slot_Wait_Ms(&st, local), SYNC_WAIT_MISSED);
+}
+
+TEST(test_sync_sleep_lands_on_own_slot) {
+    SyncState st;
+    Sync_Init(&st);
+    uint32_t local = 3600000;
+    sync_hear(&st, 0x1111, 37, 5000, local);
+
+    for (uint32_t planned = 60; planned <= 3600; planned += 370) {
+        uint32_t s = Sync_Sleep_S(&st, local, planned);
+        uint32_t half = SYNC_FRAME_MS / 2000U;
+        ASSERT_TRUE(s >= planned / 2 && s + half + 3 >= planned); /* Nearest occurrence */
+        ASSERT_TRUE(s <= planned + half);
+        /* ck_spre wakes anywhere in (s - 1, s] seconds */
+        for (uint32_t early = 0; early < 1000; early += 250) {
+            uint32_t wake = local + s * 1000U - early;
+            uint32_t wait = Sync_Slot_Wait_Ms(&st, wake);
+            ASSERT_TRUE(wait != SYNC_WAIT_MISSED);
+            ASSERT_TRUE(wait >= SYNC_WAKE_LEAD_MS);
+            ASSERT_TRUE(Sync_On_Slot(37, Sync_Queen_Ms(&st, wake + wait)));
+        }
+    }
+}
+
+TEST(test_sync_drift_corrects_slow_crystal) {
+    SyncState st;
+    Sync_Init(&st);
+    /* Local crystal 40 ppm slow: 1 h of Queen time reads 3599.856 s locally */
+    const uint32_t hour = 3600000;
+    const uint32_t lag = hour / 1000U * 40U / 1000U;    /* 144 ms per hour */
+    uint32_t local = 1000;
+    uint32_t queen = 90000;
+    sync_hear(&st, 0x1111, 20, queen, local);
+    for (int h = 1; h <= 3; h++) {
+        sync_hear(&st, 0x1111, 20, queen + (uint32_t)h * hour, local + (uint32_t)h * (hour - lag));
+    }
+    ASSERT_TRUE(st.drift_ppm >= 38 && st.drift_ppm <= 42);
+
+    /* Six hours unsynced: prediction stays inside the resync tolerance */
+    uint32_t later = local + 9U * (hour - lag);
+    uint32_t truth = (queen + 9U * hour + Sync_Airtime_Ms(ROUTE_BLOCK_SIZE)) % SYNC_FRAME_MS;
+    int32_t err = (int32_t)Sync_Queen_Ms(&st, later) - (int32_t)truth;
+    ASSERT_TRUE(err >= -(int32_t)SYNC_RESYNC_MS && err <= (int32_t)SYNC_RESYNC_MS);
+    ASSERT_TRUE(6U * lag > SYNC_RESYNC_MS);             /* …which it would not without drift */
+}
+
+TEST(test_sync_expires_and_crosses_midnight) {
+    SyncState st;
+    Sync_Init(&st);
+    uint32_t local = SYNC_DAY_MS - 1000;                /* 23:59:59 */
+    sync_hear(&st, 0x1111, 20, 0, local);
+    uint32_t before = Sync_Queen_Ms(&st, local);
+    ASSERT_EQ(Sync_Queen_Ms(&st, 500), (before + 1500) % SYNC_FRAME_MS); /* 00:00:00.500 */
+
+    Sync_Expire(&st, (local + SYNC_MAX_AGE_MS - 1) % SYNC_DAY_MS);
+    ASSERT_EQ(st.valid, 1);
+    Sync_Expire(&st, (local + SYNC_MAX_AGE_MS) % SYNC_DAY_MS);
+    ASSERT_EQ(st.valid, 0);
+    ASSERT_EQ(Sync_Slot_Wait_Ms(&st, local), SYNC_WAIT_MISSED);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 15. EU868 CHANNEL PLAN TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+TEST(test_chan_plan_inside_eu868_subbands) {
+    for (uint8_t ch = 0; ch < CHAN_COUNT; ch++) {
+        uint32_t f = Chan_Freq_Hz(ch);
+        /* 125 kHz channel fully inside 865.0-868.0 or 868.0-868.6 MHz */
+        uint8_t g  = f - 62500U >= 865000000U && f + 62500U <= 868000000U;
+        uint8_t g1 = f - 62500U >= 868000000U && f + 62500U <= 868600000U;
+        ASSERT_TRUE(g || g1);
+        for (uint8_t other = 0; other < ch; other++) {
+            uint32_t o = Chan_Freq_Hz(other);
+            ASSERT_TRUE((f > o ? f - o : o - f) >= 200000U); /* No overlap */
+        }
+    }
+    ASSERT_EQ(Chan_Freq_Hz(CHAN_COUNT), Chan_Freq_Hz(0)); /* Corrupt index → channel 0 */
+}
+
+/* Survey: every channel sampled, busy_pct of samples above the threshold */
+static void chan_survey_fill(ChanSurvey* s, uint8_t ch, uint32_t busy_pct)
+{
+    for (uint32_t i = 0; i < CHAN_SURVEY_SAMPLES; i++) {
+        Chan_Survey_Add(s, ch, (int16_t)(i * 100U < busy_pct * CHAN_SURVEY_SAMPLES ? -80 : -120));
+    }
+}
+
+TEST(test_chan_survey_picks_quietest_home_on_tie) {
+    ChanSurvey s;
+    Chan_Survey_Init(&s);
+    for (uint8_t ch = 0; ch < CHAN_COUNT; ch++) chan_survey_fill(&s, ch, 20);
+    chan_survey_fill(&s, 5, 0);                         /* 400 samples, 10% busy */
+    ASSERT_EQ(s.samples[5], 2 * CHAN_SURVEY_SAMPLES);
+    ASSERT_EQ(s.peak_dbm[5], -80);
+    ASSERT_EQ(Chan_Survey_Pick(&s, 2, CHAN_COUNT), 5);
+
+    /* Within the slack the home channel wins: a reboot keeps the cluster */
+    Chan_Survey_Init(&s);
+    for (uint8_t ch = 0; ch < CHAN_COUNT; ch++) chan_survey_fill(&s, ch, ch == 2 ? 11 : 10);
+    ASSERT_EQ(Chan_Survey_Pick(&s, 2, CHAN_COUNT), 2);
+
+    /* Restricted plan: channels past count are never picked, unsampled never wins */
+    chan_survey_fill(&s, 7, 0);
+    ASSERT_EQ(Chan_Survey_Pick(&s, 2, 4), 2);
+    Chan_Survey_Init(&s);
+    chan_survey_fill(&s, 1, 50);
+    ASSERT_EQ(Chan_Survey_Pick(&s, 0, CHAN_COUNT), 1);
+
+    /* Home by UID: deterministic, inside the plan */
+    ASSERT_EQ(Chan_Home("QUEEN-001", CHAN_COUNT), Chan_Home("QUEEN-001", CHAN_COUNT));
+    ASSERT_TRUE(Chan_Home("QUEEN-002", 3) < 3);
+}
+
+TEST(test_chan_soldier_scans_then_locks) {
+    ChanState st;
+    Chan_Init(&st);
+    ASSERT_EQ(st.ch, 0);
+    ASSERT_EQ(st.locked, 0);
+    for (int i = 1; i < CHAN_SCAN_WAKES; i++) ASSERT_EQ(Chan_Tick(&st), 0);
+    ASSERT_EQ(Chan_Tick(&st), 1);                       /* Nobody here: next channel */
+    ASSERT_EQ(st.ch, 1);
+
+    Chan_Heard(&st);                                    /* Queen beacon on channel 1 */
+    ASSERT_EQ(st.locked, 1);
+    for (int i = 1; i < CHAN_LOST_WAKES; i++) ASSERT_EQ(Chan_Tick(&st), 0);
+    Chan_Heard(&st);                                    /* A neighbour keeps it alive */
+    for (int i = 1; i < CHAN_LOST_WAKES; i++) ASSERT_EQ(Chan_Tick(&st), 0);
+    ASSERT_EQ(Chan_Tick(&st), 1);                       /* Cluster gone: scan again */
+    ASSERT_EQ(st.ch, 2);
+    ASSERT_EQ(st.locked, 0);
+
+    /* Scan wraps around the plan */
+    st.ch = CHAN_COUNT - 1;
+    st.quiet = CHAN_SCAN_WAKES - 1;
+    ASSERT_EQ(Chan_Tick(&st), 1);
+    ASSERT_EQ(st.ch, 0);
+    ASSERT_TRUE(CHAN_LOST_WAKES > ROUTE_STALE_WAKES);   /* Gradient forgets first */
+}
+
+TEST(test_chan_dr19_roundtrip) {
+    ChanState st, back;
+    Chan_Init(&st);
+    st.ch = 6;
+    Chan_Heard(&st);
+    RouteState route;
+    Route_Init(&route);
+    Route_On_Heard(&route, 2, -90);                     /* hop 3 */
+    for (int i = 0; i < 40; i++) Route_Tick(&route);    /* age 40 */
+
+    /* Soldier DR19 layout: [7:0] seq, [23:8] route, [15:12] channel, [31:24] acoustic */
+    uint32_t word = (7U << 24) | ((uint32_t)Route_Pack(&route) << 8) | ((uint32_t)Chan_Pack(&st) << 12) | 0x55U;
+    RouteState route_back;
+    Route_Restore(&route_back, (uint16_t)((word >> 8) & 0xFF0F));
+    Chan_Restore(&back, (uint8_t)((word >> 12) & 0x0F));
+    ASSERT_EQ(route_back.hop, 3);
+    ASSERT_EQ(route_back.age, 40);
+    ASSERT_EQ(back.ch, 6);
+    ASSERT_EQ(back.locked, 1);                          /* Brownout: no rescan */
+
+    Chan_Restore(&back, 0);                             /* Cold start */
+    ASSERT_EQ(back.ch, 0);
+    ASSERT_EQ(back.locked, 0);
+    Chan_Restore(&back, CHAN_COUNT + 1);                /* Corrupt */
+    ASSERT_EQ(back.ch, 0);
+    ASSERT_EQ(back.locked, 0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 16. QUEEN RX FRAME RING TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* ISR side of the ring: claim, fill, publish. 0 — ring full, frame dropped. */
+static uint8_t rxring_push(RxRing* r, uint8_t tag, uint16_t size)
+{
+    RxSlot* slot = RxRing_Claim(r);
+    if (slot == NULL) return 0;
+    memset(slot->frame, tag, size);
+    slot->size = size;
+    slot->rssi_dbm = (int8_t)-tag;
+    slot->snr_db = (int8_t)(tag % 10);
+    slot->rx_ms = 1000U * tag;
+    RxRing_Publish(r);
+    return 1;
+}
+
+TEST(test_rxring_fifo_order_across_wrap) {
+    static RxRing r;
+    RxRing_Init(&r);
+    ASSERT_TRUE(RxRing_Peek(&r) == NULL);
+
+    /* 300 frames through 8 slots: uint8_t indices wrap past 255 */
+    uint8_t next_out = 1;
+    for (uint16_t i = 1; i <= 300; i++) {
+        uint8_t tag = (uint8_t)((i - 1) % 100 + 1);
+        ASSERT_TRUE(rxring_push(&r, tag, (uint16_t)(RELAYQ_FRAME_SIZE * (1 + i % RELAYQ_AGG_MAX_BLOCKS))));
+        if (i % 3 != 0) continue;                       /* Main loop lags: drain in bursts of 3 */
+        while (RxRing_Count(&r) > 0) {
+            RxSlot* s = RxRing_Peek(&r);
+            ASSERT_TRUE(s != NULL);
+            ASSERT_EQ(s->frame[0], next_out);
+            ASSERT_EQ(s->frame[s->size - 1], next_out);
+            ASSERT_EQ(s->rssi_dbm, -(int8_t)next_out);
+            ASSERT_EQ(s->rx_ms, 1000U * next_out);
+            RxRing_Release(&r);
+            next_out = (uint8_t)(next_out % 100 + 1);
+        }
+    }
+    ASSERT_EQ(r.received, 300);
+    ASSERT_EQ(r.dropped, 0);
+    ASSERT_EQ(r.high_water, 3);
+    ASSERT_EQ((uintptr_t)r.slot[1].frame % 4, 0);      /* In-place AES needs word alignment */
+}
+
+TEST(test_rxring_full_drops_newest) {
+    static RxRing r;
+    RxRing_Init(&r);
+    for (uint8_t i = 1; i <= RXRING_SLOTS; i++) ASSERT_TRUE(rxring_push(&r, i, RELAYQ_FRAME_SIZE));
+    ASSERT_EQ(RxRing_Count(&r), RXRING_SLOTS);
+
+    /* Flush blocks the main loop: further frames are counted, not overwritten */
+    ASSERT_EQ(rxring_push(&r, 99, RELAYQ_FRAME_SIZE), 0);
+    ASSERT_EQ(rxring_push(&r, 98, RELAYQ_FRAME_SIZE), 0);
+    ASSERT_EQ(r.received, RXRING_SLOTS + 2);
+    ASSERT_EQ(r.dropped, 2);
+    ASSERT_EQ(r.high_water, RXRING_SLOTS);
+    ASSERT_EQ(RxRing_Peek(&r)->frame[0], 1);           /* Oldest frame intact */
+
+    /* One slot released → exactly one more frame fits */
+    RxRing_Release(&r);
+    ASSERT_TRUE(rxring_push(&r, 50, RELAYQ_FRAME_SIZE));
+    ASSERT_EQ(rxring_push(&r, 51, RELAYQ_FRAME_SIZE), 0);
+    for (uint8_t i = 2; i <= RXRING_SLOTS; i++) {
+        ASSERT_EQ(RxRing_Peek(&r)->frame[0], i);
+        RxRing_Release(&r);
+    }
+    ASSERT_EQ(RxRing_Peek(&r)->frame[0], 50);
+    RxRing_Release(&r);
+    ASSERT_TRUE(RxRing_Peek(&r) == NULL);
+    ASSERT_EQ(r.dropped, 3);
+}
+
+TEST(test_rxring_slot_holds_max_frame) {
+    static RxRing r;
+    RxRing_Init(&r);
+    ASSERT_EQ(RXRING_FRAME_MAX, RELAYQ_AGG_MAX_SIZE);
+    ASSERT_TRUE(rxring_push(&r, 7, RELAYQ_AGG_MAX_SIZE));
+    RxSlot* s = RxRing_Peek(&r);
+    ASSERT_EQ(s->size, RELAYQ_AGG_MAX_SIZE);
+    ASSERT_EQ(RelayQ_Frame_Blocks(s->size), RELAYQ_AGG_MAX_BLOCKS);
+    ASSERT_EQ(s->frame[RELAYQ_AGG_MAX_SIZE - 1], 7);
+    ASSERT_EQ(s->snr_db, 7);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 17. QUEEN COOPERATIVE SCHEDULER TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Handlers record the call order and the events they were given */
+static Sched sched_ut;
+static uint8_t sched_log[16];
+static uint32_t sched_log_events[16];
+static uint8_t sched_log_n;
+static uint8_t sched_chain_left;
+
+static void sched_log_call(uint8_t who, uint32_t events)
+{
+    if (sched_log_n < sizeof(sched_log)) {
+        sched_log[sched_log_n] = who;
+        sched_log_events[sched_log_n++] = events;
+    }
+}
+
+static void sched_task_a(uint32_t events, uint32_t now_ms) { (void)now_ms; sched_log_call(0, events); }
+static void sched_task_b(uint32_t events, uint32_t now_ms) { (void)now_ms; sched_log_call(1, events); }
+
+/* State machine step: re-posts itself like the Queen's FLUSH task */
+static void sched_task_chain(uint32_t events, uint32_t now_ms)
+{
+    (void)now_ms;
+    sched_log_call(2, events);
+    if (sched_chain_left > 0) {
+        sched_chain_left--;
+        Sched_Post(&sched_ut, 2, 0x02U);
+    }
+}
+
+static void sched_reset(void)
+{
+    Sched_Init(&sched_ut);
+    sched_log_n = 0;
+    sched_chain_left = 0;
+}
+
+TEST(test_sched_priority_and_event_merge) {
+    sched_reset();
+    ASSERT_EQ(Sched_Add(&sched_ut, sched_task_a), 0);
+    ASSERT_EQ(Sched_Add(&sched_ut, sched_task_b), 1);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0), 0);              /* Nothing to do */
+    ASSERT_EQ(Sched_Idle_Ms(&sched_ut, 0), SCHED_IDLE_FOREVER);
+
+    Sched_Post(&sched_ut, 1, 0x01U);
+    Sched_Post(&sched_ut, 1, 0x04U);                    /* Merged with the first */
+    Sched_Post(&sched_ut, 0, 0x02U);
+    ASSERT_EQ(Sched_Idle_Ms(&sched_ut, 0), 0);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0), 1);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0), 1);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0), 0);
+    ASSERT_EQ(sched_log_n, 2);
+    ASSERT_EQ(sched_log[0], 0);                         /* Higher priority first */
+    ASSERT_EQ(sched_log_events[0], 0x02U);
+    ASSERT_EQ(sched_log[1], 1);
+    ASSERT_EQ(sched_log_events[1], 0x05U);
+    ASSERT_EQ(sched_ut.task[1].runs, 1);
+
+    /* Bad ids and a full table are ignored */
+    Sched_Post(&sched_ut, 5, 0x01U);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0), 0);
+    for (int i = 2; i < SCHED_MAX_TASKS; i++) ASSERT_EQ(Sched_Add(&sched_ut, sched_task_a), i);
+    ASSERT_EQ(Sched_Add(&sched_ut, sched_task_a), SCHED_NO_TASK);
+    ASSERT_EQ(Sched_Add(&sched_ut, NULL), SCHED_NO_TASK);
+}
+
+TEST(test_sched_timers_one_shot_and_periodic) {
+    sched_reset();
+    Sched_Add(&sched_ut, sched_task_a);
+    Sched_Add(&sched_ut, sched_task_b);
+    Sched_Timer(&sched_ut, 0, 1000, 500, 0);            /* One-shot at 1500 */
+    Sched_Timer(&sched_ut, 1, 1000, 2000, 1000);        /* 3000, 4000, ... */
+    ASSERT_EQ(Sched_Idle_Ms(&sched_ut, 1100), 400);     /* Nearest deadline */
+    ASSERT_EQ(Sched_Run(&sched_ut, 1499), 0);
+    ASSERT_EQ(Sched_Run(&sched_ut, 1500), 1);
+    ASSERT_EQ(sched_log_events[0], SCHED_EV_TIMER);
+    ASSERT_EQ(sched_ut.task[0].armed, 0);
+    ASSERT_EQ(Sched_Idle_Ms(&sched_ut, 1500), 1500);
+
+    ASSERT_EQ(Sched_Run(&sched_ut, 3000), 1);
+    ASSERT_EQ(sched_log[1], 1);
+    ASSERT_EQ(sched_ut.task[1].due_ms, 4000);
+    /* Main loop stalled for 3.5 periods: one firing, no backlog, next from now */
+    ASSERT_EQ(Sched_Run(&sched_ut, 7500), 1);
+    ASSERT_EQ(Sched_Run(&sched_ut, 7500), 0);
+    ASSERT_EQ(sched_ut.task[1].due_ms, 8500);
+
+    Sched_Timer_Stop(&sched_ut, 1);
+    ASSERT_EQ(Sched_Idle_Ms(&sched_ut, 9000), SCHED_IDLE_FOREVER);
+    ASSERT_EQ(Sched_Run(&sched_ut, 9000), 0);
+}
+
+TEST(test_sched_clock_wrap) {
+    sched_reset();
+    Sched_Add(&sched_ut, sched_task_a);
+    Sched_Timer(&sched_ut, 0, 0xFFFFFFC0U, 100, 0);     /* Due at 0x24 after the wrap */
+    ASSERT_EQ(Sched_Idle_Ms(&sched_ut, 0xFFFFFFFFU), 37);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0xFFFFFFFFU), 0);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0x23U), 0);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0x24U), 1);
+}
+
+TEST(test_sched_chain_yields_to_higher_priority) {
+    sched_reset();
+    Sched_Add(&sched_ut, sched_task_a);
+    Sched_Add(&sched_ut, sched_task_b);
+    Sched_Add(&sched_ut, sched_task_chain);
+    sched_chain_left = 3;
+    Sched_Post(&sched_ut, 2, 0x01U);
+    ASSERT_EQ(Sched_Run(&sched_ut, 0), 1);              /* Flush step 1 */
+    Sched_Post(&sched_ut, 0, 0x01U);                    /* RxDone arrives meanwhile */
+    while (Sched_Run(&sched_ut, 0)) { }
+    ASSERT_EQ(sched_log_n, 5);
+    ASSERT_EQ(sched_log[0], 2);
+    ASSERT_EQ(sched_log[1], 0);                         /* Radio between two steps */
+    ASSERT_EQ(sched_log[2], 2);
+    ASSERT_EQ(sched_log_events[2], 0x02U);
+    ASSERT_EQ(sched_log[4], 2);
+    ASSERT_EQ(Sched_Idle_Ms(&sched_ut, 0), SCHED_IDLE_FOREVER);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 18. OTA CRC TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void crc_fill(uint8_t* buf, uint32_t len, uint32_t seed)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        seed = seed * 1103515245U + 12345U;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+TEST(test_crc_known_values) {
+    const uint8_t check[] = "123456789";
+    ASSERT_EQ(Crc32(check, 9), (long long)0xCBF43926);          /* ISO 3309 check value */
+    ASSERT_EQ(Crc16_Ccitt(check, 9), 0x29B1);                   /* CCITT-FALSE check value */
+    ASSERT_EQ(Crc32(check, 0), 0);
+    ASSERT_EQ(Crc16_Ccitt(check, 0), CRC16_INIT);
+}
+
+TEST(test_crc_slice8_matches_bitwise) {
+    uint8_t buf[80];
+    crc_fill(buf, sizeof(buf), 7);
+    /* Every length and start offset: the 8-byte loop, its tail and unaligned starts */
+    for (uint32_t off = 0; off < 8; off++) {
+        for (uint32_t len = 0; len + off <= sizeof(buf); len++) {
+            ASSERT_EQ(Crc32_Update_Slice8(CRC32_INIT, buf + off, len),
+                      Crc32_Update_Bitwise(CRC32_INIT, buf + off, len));
+        }
+    }
+}
+
+TEST(test_crc32_incremental_equals_one_shot) {
+    uint8_t image[1024];
+    crc_fill(image, sizeof(image), 42);
+    uint32_t whole = Crc32(image, sizeof(image));
+
+    /* LoRa OTA chunks of 11 bytes, as the Soldier folds them in */
+    uint32_t crc = CRC32_INIT;
+    for (uint32_t off = 0; off < sizeof(image); off += 11) {
+        uint32_t n = (sizeof(image) - off < 11) ? (uint32_t)sizeof(image) - off : 11;
+        crc = Crc32_Update(crc, image + off, n);
+    }
+    ASSERT_EQ(Crc32_Final(crc), whole);
+
+    /* Uneven splits, including empty updates */
+    crc = CRC32_INIT;
+    uint32_t off = 0, step = 0;
+    while (off < sizeof(image)) {
+        uint32_t n = (step * 37U) % 29U;
+        if (n > sizeof(image) - off) n = (uint32_t)sizeof(image) - off;
+        crc = Crc32_Update(crc, image + off, n);
+        off += n;
+        step++;
+    }
+    ASSERT_EQ(Crc32_Final(crc), whole);
+}
+
+TEST(test_crc16_chunk_with_zero_padding) {
+    /* OtaPackagerService: [0x99][index:2][total:2][code][CRC16 BE], then CoapEncryption zero pad */
+    uint8_t chunk[16 * 34] = {0};
+    uint16_t code_len = 100;
+    chunk[0] = 0x99; chunk[1] = 0; chunk[2] = 3; chunk[3] = 0; chunk[4] = 9;
+    crc_fill(&chunk[5], code_len, 3);
+    uint16_t msg = (uint16_t)(5 + code_len);
+    uint16_t crc = Crc16_Ccitt(chunk, msg);
+    chunk[msg] = (uint8_t)(crc >> 8);
+    chunk[msg + 1] = (uint8_t)(crc & 0xFF);
+    uint16_t aligned = (uint16_t)(((msg + 2 + 15) / 16) * 16);
+
+    ASSERT_EQ(Crc16_Ccitt(chunk, (uint32_t)msg + 2), 0);
+    ASSERT_EQ(Crc16_Ccitt(chunk, aligned), 0);                  /* Padding keeps the residue */
+    ASSERT_EQ(Crc16_Ccitt(chunk, sizeof(chunk)), 0);
+
+    chunk[40] ^= 0x04;                                          /* One flipped bit in the code */
+    ASSERT_NE(Crc16_Ccitt(chunk, aligned), 0);
+    chunk[40] ^= 0x04;
+    chunk[aligned - 1] = 0x01;                                  /* Garbage instead of padding */
+    ASSERT_NE(Crc16_Ccitt(chunk, aligned), 0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 19. SOLDIER OTA REASSEMBLY TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+#define OTA_UT_CHUNKS 20
+
+/* 20 LoRa chunks of 11 bytes: 216 bytes of code + CRC32 BE, as the Queen sends them */
+static void ota_ut_image(uint8_t chunks[OTA_UT_CHUNKS][16], uint8_t* image)
+{
+    uint32_t len = OTA_UT_CHUNKS * 11;
+    crc_fill(image, len - 4, 11);
+    uint32_t crc = Crc32(image, len - 4);
+    image[len - 4] = (uint8_t)(crc >> 24);
+    image[len - 3] = (uint8_t)(crc >> 16);
+    image[len - 2] = (uint8_t)(crc >> 8);
+    image[len - 1] = (uint8_t)crc;
+    for (uint16_t c = 0; c < OTA_UT_CHUNKS; c++) {
+        chunks[c][0] = OTA_MARKER;
+        chunks[c][1] = 0;
+        chunks[c][2] = (uint8_t)c;
+        chunks[c][3] = 0;
+        chunks[c][4] = OTA_UT_CHUNKS;
+        memcpy(&chunks[c][5], &image[c * 11], 11);
+    }
+}
+
+static OtaRx ota_ut;
+
+TEST(test_ota_rx_joins_mid_broadcast) {
+    uint8_t chunks[OTA_UT_CHUNKS][16], image[OTA_UT_CHUNKS * 11];
+    ota_ut_image(chunks, image);
+    Ota_Rx_Init(&ota_ut);
+
+    /* Joins at chunk 13, misses 4 and 17 on the first lap; the second lap fills them, the rest are duplicates */
+    uint16_t len = 0;
+    int completes = 0;
+    for (int i = 0; i < 2 * OTA_UT_CHUNKS && !completes; i++) {
+        uint16_t c = (uint16_t)((13 + i) % OTA_UT_CHUNKS);
+        uint8_t missed = (c == 4 || c == 17);
+        if (i < OTA_UT_CHUNKS && missed) continue;
+        OtaRxResult r = Ota_Rx_Chunk(&ota_ut, chunks[c], 16, &len);
+        if (r == OTA_RX_COMPLETE) completes++;
+        else ASSERT_EQ(r, (i < OTA_UT_CHUNKS || missed) ? OTA_RX_STORED : OTA_RX_IGNORED);
+    }
+    ASSERT_EQ(completes, 1);
+    ASSERT_EQ(len, OTA_UT_CHUNKS * 11 - 4);
+    ASSERT_EQ(memcmp(ota_ut.buffer, image, len), 0);
+    ASSERT_EQ(ota_ut.chunks, 0);                                /* Ready for the next image */
+}
+
+TEST(test_ota_rx_bad_crc_restarts) {
+    uint8_t chunks[OTA_UT_CHUNKS][16], image[OTA_UT_CHUNKS * 11];
+    ota_ut_image(chunks, image);
+    Ota_Rx_Init(&ota_ut);
+    chunks[6][9] ^= 0x20;                                       /* Corrupted in flight */
+
+    uint16_t len = 0;
+    for (uint16_t c = 0; c + 1 < OTA_UT_CHUNKS; c++) {
+        ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, chunks[c], 16, &len), OTA_RX_STORED);
+    }
+    ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, chunks[OTA_UT_CHUNKS - 1], 16, &len), OTA_RX_BAD_CRC);
+
+    /* Next lap is clean: the whole image is collected again and accepted */
+    chunks[6][9] ^= 0x20;
+    OtaRxResult r = OTA_RX_IGNORED;
+    for (uint16_t c = 0; c < OTA_UT_CHUNKS; c++) r = Ota_Rx_Chunk(&ota_ut, chunks[c], 16, &len);
+    ASSERT_EQ(r, OTA_RX_COMPLETE);
+}
+
+TEST(test_ota_rx_rejects_dup_foreign_and_oversize) {
+    uint8_t chunks[OTA_UT_CHUNKS][16], image[OTA_UT_CHUNKS * 11];
+    ota_ut_image(chunks, image);
+    Ota_Rx_Init(&ota_ut);
+    uint16_t len = 0;
+
+    ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, chunks[2], 16, &len), OTA_RX_STORED);
+    ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, chunks[2], 16, &len), OTA_RX_IGNORED);  /* Duplicate */
+    ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, chunks[3], OTA_HEADER_SIZE, &len), OTA_RX_IGNORED);
+
+    uint8_t other[16];
+    memcpy(other, chunks[3], 16);
+    other[4] = OTA_UT_CHUNKS + 1;                               /* Another image's total */
+    ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, other, 16, &len), OTA_RX_IGNORED);
+    other[4] = OTA_UT_CHUNKS;
+    other[1] = 0x01;                                            /* Index 259: past the bitmap */
+    ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, other, 16, &len), OTA_RX_IGNORED);
+    other[1] = 0;
+    other[2] = 94;                                              /* 94 × 11 > OTA_RX_BUFFER_SIZE */
+    ASSERT_EQ(Ota_Rx_Chunk(&ota_ut, other, 16, &len), OTA_RX_IGNORED);
+    ASSERT_EQ(ota_ut.chunks, 1);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 20. HAL MOCK COST ACCOUNTING TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+TEST(test_hal_cost_airtime_matches_sync) {
+    for (uint32_t size = 1; size <= 255; size++) {
+        ASSERT_EQ((Hal_Cost_Airtime_Us((uint8_t)size) + 500U) / 1000U, Sync_Airtime_Ms((uint16_t)size));
+    }
+    /* SF12/125 kHz turns LDRO on: 40.25 symbols × 32.768 ms (Semtech calculator) */
+    HalCostProfile def = HAL_COST_PROFILE_DEFAULT;
+    hal_cost_profile.lora_sf = 12;
+    uint32_t sf12 = Hal_Cost_Airtime_Us(20);
+    hal_cost_profile = def;
+    ASSERT_EQ(sf12, 1318912);
+}
+
+TEST(test_hal_cost_clock_and_counters) {
+    uint8_t buf[128] = {0};
+    uint32_t blocks[8] = {0};
+    UART_HandleTypeDef uart = {0};
+    CRYP_HandleTypeDef cryp = {0};
+    Hal_Cost_Reset();
+    HAL_Delay(10);
+    Radio.Send(buf, 20);                                        /* 56.576 ms at SF7 */
+    HAL_UART_Transmit(&uart, buf, 115, 100);                    /* 9.98 ms at 115200 */
+    HAL_CRYP_Encrypt(&cryp, blocks, 8, blocks, 100);            /* 8 words = 2 blocks */
+    MX_USART1_UART_Init();
+    ASSERT_EQ(hal_cost.clock_ns, 10000000ULL + 56576000ULL + 9982638ULL + 4000ULL + 50000ULL);
+    ASSERT_EQ(HAL_GetTick(), 76);
+    ASSERT_EQ(hal_cost.units[HAL_COST_RADIO_TX], 20);
+    ASSERT_EQ(hal_cost.units[HAL_COST_UART], 115);
+    ASSERT_EQ(hal_cost.units[HAL_COST_CRYPTO], 2);
+    ASSERT_EQ(hal_cost.calls[HAL_COST_INIT], 1);
+    ASSERT_EQ(hal_cost.calls[HAL_COST_DELAY], 1);
+}
+
+TEST(test_hal_cost_energy_by_kind) {
+    uint8_t buf[20] = {0};
+    Hal_Cost_Reset();
+    Radio.Send(buf, 20);                                        /* 56.576 ms × 42 mA × 3.3 V */
+    LP_Delay_Ms(1000);                                          /* STOP2: 1 s × 2 µA */
+    LP_Delay_Ms(3);                                             /* SLEEP: 3 ms × 1 mA */
+    ASSERT_EQ(hal_cost.calls[HAL_COST_STOP2], 1);
+    ASSERT_EQ(hal_cost.calls[HAL_COST_SLEEP], 1);
+    ASSERT_EQ((long long)(Hal_Cost_Energy_MJ() * 1000.0 + 0.5), 7858);   /* µJ */
+    hal_cost_profile.draw_ua[HAL_COST_RADIO_TX] = 0;            /* Only the two delays left */
+    long long sleeps_uj = (long long)(Hal_Cost_Energy_MJ() * 1000.0 + 0.5);
+    hal_cost_profile.draw_ua[HAL_COST_RADIO_TX] = 42000;
+    ASSERT_EQ(sleeps_uj, 17);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * ENTRY POINT
+ * ════════════════════════════════════════════════════════════════════ */
+
+int main(void)
+{
+    printf("\n🧬 Common Firmware Modules — Host-Based Unit Tests\n");
+    printf("══════════════════════════════════════════════════════════════\n\n");
+
+    printf("  Fixed-Point Attractor:\n");
+    RUN(test_attractor_golden_vectors);
+    RUN(test_attractor_deterministic);
+    RUN(test_attractor_seed_changes_output);
+    RUN(test_attractor_rho_clamp_high);
+    RUN(test_attractor_rho_clamp_low);
+    RUN(test_attractor_sigma_clamp);
+    RUN(test_attractor_negative_temp_truncates_toward_zero);
+    RUN(test_attractor_state_bounded);
+    RUN(test_attractor_trajectory_initial_state);
+    RUN(test_attractor_trajectory_matches_z);
+
+    printf("\n  Pool Allocator (mruby heap):\n");
+    RUN(test_pool_alloc_rounds_to_class);
+    RUN(test_pool_alloc_8_byte_aligned);
+    RUN(test_pool_free_reuses_same_block);
+    RUN(test_pool_stats_peak_and_counts);
+    RUN(test_pool_exhaustion_returns_null);
+    RUN(test_pool_oversize_rejected);
+    RUN(test_pool_borrows_larger_free_block);
+    RUN(test_pool_double_free_ignored);
+    RUN(test_pool_realloc_grows_and_copies);
+    RUN(test_pool_realloc_zero_frees);
+    RUN(test_pool_churn_no_growth);
+
+    printf("\n  Diagnostic Frames:\n");
+    RUN(test_diag_heap_frame_layout);
+    RUN(test_diag_heap_frame_saturates);
+    RUN(test_diag_profile_frame_layout);
+    RUN(test_diag_profile_frame_saturates);
+    RUN(test_diag_radio_frame_layout);
+
+    printf("\n  Energy Scheduler:\n");
+    RUN(test_energy_stored_formula);
+    RUN(test_energy_harvest_estimate);
+    RUN(test_energy_harvest_ewma);
+    RUN(test_energy_survival_at_reserve);
+    RUN(test_energy_no_listen_below_floor);
+    RUN(test_energy_rich_node_relays_at_min_interval);
+    RUN(test_energy_first_wake_assumes_no_harvest);
+    RUN(test_energy_lower_vcap_sleeps_longer);
+    RUN(test_energy_clock_rtc_across_midnight);
+    RUN(test_energy_main_loop_tracks_harvest);
+
+    printf("\n  Phase Profiler:\n");
+    RUN(test_prof_first_sample_sets_all);
+    RUN(test_prof_min_max_ewma);
+    RUN(test_prof_invalid_phase_ignored);
+    RUN(test_prof_begin_end_host_counter);
+    RUN(test_prof_phase_names);
+
+    printf("\n  Low-Power Delay:\n");
+    RUN(test_lpdelay_ticks_from_ms);
+    RUN(test_lpdelay_ticks_never_zero);
+    RUN(test_lpdelay_ticks_chunk_fits_16_bits);
+    RUN(test_lpdelay_mode_by_length);
+    RUN(test_lpdelay_sleep_only_keeps_uart_awake);
+
+    printf("\n  Listen-Before-Talk:\n");
+    RUN(test_lbt_free_channel_sends_now);
+    RUN(test_lbt_backoff_window_doubles);
+    RUN(test_lbt_backoff_never_zero);
+    RUN(test_lbt_forced_after_max_attempts);
+    RUN(test_lbt_counters_span_frames);
+
+    printf("\n  Relay Queue:\n");
+    RUN(test_relayq_fifo_order);
+    RUN(test_relayq_overflow_drops_oldest);
+    RUN(test_relayq_no_energy_sends_own_only);
+    RUN(test_relayq_relays_only_without_own);
+    RUN(test_relayq_drain_batch_then_relays);
+    RUN(test_relayq_restore_keeps_valid_queue);
+    RUN(test_relayq_restore_rejects_garbage);
+    RUN(test_relayq_frame_blocks);
+
+    printf("\n  Mesh Seen-Set:\n");
+    RUN(test_seen_zero_state_is_empty);
+    RUN(test_seen_next_seq_is_fresh);
+    RUN(test_seen_ignores_ttl);
+    RUN(test_seen_pingpong_beyond_8_dids);
+    RUN(test_seen_false_positive_rate);
+    RUN(test_seen_capacity_rotates_generations);
+    RUN(test_seen_ages_out_after_two_generations);
+
+    printf("\n  Mesh Gradient Routing:\n");
+    RUN(test_route_cold_start_floods);
+    RUN(test_route_byte_keeps_ttl_nibble);
+    RUN(test_route_beacon_gives_hop_one);
+    RUN(test_route_keeps_shortest_hop);
+    RUN(test_route_ignores_weak_link);
+    RUN(test_route_relays_only_downhill);
+    RUN(test_route_goes_stale_without_refresh);
+    RUN(test_route_header_mirrors_body);
+    RUN(test_route_header_rejects_mismatch);
+
+    printf("\n  Per-Device Key Cache:\n");
+    RUN(test_keys_table_from_flash_validates);
+    RUN(test_keys_lookup_caches_table_key);
+    RUN(test_keys_unknown_src_uses_network_key);
+    RUN(test_keys_shared_src_rotates_candidates);
+    RUN(test_keys_lru_evicts_least_recent);
+    RUN(test_keys_reload_only_on_switch);
+    RUN(test_keys_reply_uses_network_key_without_lookup);
+
+    printf("\n  Report-by-Exception:\n");
+    RUN(test_rbe_first_reading_always_sent);
+    RUN(test_rbe_inside_deadbands_skips);
+    RUN(test_rbe_outside_deadband_sends);
+    RUN(test_rbe_status_change_sends_at_once);
+    RUN(test_rbe_heartbeat_bounds_silence);
+    RUN(test_rbe_batch_waits_until_full);
+    RUN(test_rbe_batch_urgent_goes_at_once);
+    RUN(test_rbe_batch_max_hold_on_rtc_time);
+    RUN(test_rbe_pack_roundtrip);
+
+    printf("\n  Adaptive TX Power (ADR):\n");
+    RUN(test_adr_margin_rssi_or_snr);
+    RUN(test_adr_delta_has_hysteresis);
+    RUN(test_adr_command_after_full_window);
+    RUN(test_adr_table_evicts_least_recent);
+    RUN(test_adr_soldier_applies_own_command);
+    RUN(test_adr_backoff_when_queen_is_silent);
+    RUN(test_adr_tx_cost_scales_with_power);
+
+    printf("\n  Beacon Time Sync & TDMA:\n");
+    RUN(test_sync_airtime_sf7);
+    RUN(test_sync_schedule_probes_and_skips_contention);
+    RUN(test_sync_on_slot_tolerance);
+    RUN(test_sync_soldier_locks_to_queen_phase);
+    RUN(test_sync_sleep_lands_on_own_slot);
+    RUN(test_sync_drift_corrects_slow_crystal);
+    RUN(test_sync_expires_and_crosses_midnight);
+
+    printf("\n  EU868 Channel Plan:\n");
+    RUN(test_chan_plan_inside_eu868_subbands);
+    RUN(test_chan_survey_picks_quietest_home_on_tie);
+    RUN(test_chan_soldier_scans_then_locks);
+    RUN(test_chan_dr19_roundtrip);
+
+    printf("\n  Queen RX Frame Ring:\n");
+    RUN(test_rxring_fifo_order_across_wrap);
+    RUN(test_rxring_full_drops_newest);
+    RUN(test_rxring_slot_holds_max_frame);
+
+    printf("\n  Queen Cooperative Scheduler:\n");
+    RUN(test_sched_priority_and_event_merge);
+    RUN(test_sched_timers_one_shot_and_periodic);
+    RUN(test_sched_clock_wrap);
+    RUN(test_sched_chain_yields_to_higher_priority);
+
+    printf("\n  OTA CRC32 / CRC16-CCITT:\n");
+    RUN(test_crc_known_values);
+    RUN(test_crc_slice8_matches_bitwise);
+    RUN(test_crc32_incremental_equals_one_shot);
+    RUN(test_crc16_chunk_with_zero_padding);
+
+    printf("\n  Soldier OTA Reassembly:\n");
+    RUN(test_ota_rx_joins_mid_broadcast);
+    RUN(test_ota_rx_bad_crc_restarts);
+    RUN(test_ota_rx_rejects_dup_foreign_and_oversize);
+
+    printf("\n  HAL Mock Cost Accounting:\n");
+    RUN(test_hal_cost_airtime_matches_sync);
+    RUN(test_hal_cost_clock_and_counters);
+    RUN(test_hal_cost_energy_by_kind);
+
+    printf("\n══════════════════════════════════════════════════════════════\n");
+    printf("  Results: %d passed, %d failed\n\n", tests_passed, tests_failed);
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -19,6 +19,11 @@
 #define CMD_DEDUP_SIZE        16
 #define UUID_STR_LEN          36
 #define CMD_DECRYPT_BUF_SIZE  96
+#define RELAYQ_FRAME_SIZE     20        /* [Src:2][Hop|TTL:1][Type:1] + AES body */
+#define ROUTE_HDR_SRC         0
+#define ROUTE_HDR_TYPE        3
+#define ROUTE_HDR_SIZE        4
+#define FRAME_TYPE_TELEMETRY  0x00
 
 /* ── Data structures (from queen/main.c) ────────────────────────────── */
 typedef struct {
@@ -102,18 +107,74 @@ static uint8_t Cmd_Dedup_Check(uint32_t hash)
     return 0;
 }
 
+static void Cache_Append_Data(uint32_t uid, uint8_t* payload, int8_t rssi);
+
 /* CIFO cache — with priority-aware eviction FIX (Risk 3) */
 static void Process_And_Cache_Data(uint32_t uid, uint8_t* payload, int8_t rssi)
 {
-    /* 1. DEDUP */
+    /* 1. DEDUP — keyed by (DID, frame type in byte 15) */
+    uint8_t frame_type = payload[15];
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        if (forest_cache[i].is_active && forest_cache[i].uid == uid &&
+            forest_cache[i].payload[15] == frame_type) {
+            memcpy(forest_cache[i].payload, payload, 16);
+            forest_cache[i].rssi = rssi;
+            return;
+        }
+    }
+    Cache_Append_Data(uid, payload, rssi);
+}
+
+/* Reading of a batched uplink frame: the same (DID, type, seq) heard again
+ * via a relay updates its entry; any other reading gets its own entry */
+static void Cache_Store_Reading(uint32_t uid, uint8_t* payload, int8_t rssi)
+{
     for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
-        if (forest_cache[i].is_active && forest_cache[i].uid == uid) {
+        if (forest_cache[i].is_active && forest_cache[i].uid == uid &&
+            forest_cache[i].payload[15] == payload[15] &&
+            forest_cache[i].payload[14] == payload[14]) {
             memcpy(forest_cache[i].payload, payload, 16);
             forest_cache[i].rssi = rssi;
             return;
         }
     }
+    Cache_Append_Data(uid, payload, rssi);
+}
 
+/* Block b is a batched reading if a neighbouring block is telemetry of the same
+ * tree: the previous one (decrypted DID) or the next one (cleartext Src) */
+static uint8_t Rx_Block_In_Batch(const uint8_t* rx, uint8_t rx_blocks, uint8_t b,
+                                 uint32_t sender_id, uint32_t prev_sender)
+{
+    const uint8_t* hdr = &rx[b * RELAYQ_FRAME_SIZE];
+    if (hdr[ROUTE_HDR_SIZE + 15] != FRAME_TYPE_TELEMETRY) return 0;
+    if (b > 0 && sender_id == prev_sender) return 1;
+    if (b + 1 >= rx_blocks) return 0;
+    const uint8_t* next = &rx[(b + 1) * RELAYQ_FRAME_SIZE];
+    uint16_t next_src = (uint16_t)((next[ROUTE_HDR_SRC] << 8) | next[ROUTE_HDR_SRC + 1]);
+    return next[ROUTE_HDR_TYPE] == FRAME_TYPE_TELEMETRY && next_src == (uint16_t)sender_id;
+}
+
+/* Task_Radio's cache step over an already decrypted multi-block frame */
+static void Cache_Rx_Frame(uint8_t* rx, uint8_t rx_blocks, int8_t rssi)
+{
+    uint32_t prev_sender = 0;
+    for (uint8_t b = 0; b < rx_blocks; b++) {
+        uint8_t* block = &rx[b * RELAYQ_FRAME_SIZE + ROUTE_HDR_SIZE];
+        uint32_t sender_id = ((uint32_t)block[0] << 24) | ((uint32_t)block[1] << 16) |
+                             ((uint32_t)block[2] << 8) | (uint32_t)block[3];
+        if (Rx_Block_In_Batch(rx, rx_blocks, b, sender_id, prev_sender)) {
+            Cache_Store_Reading(sender_id, block, rssi);
+        } else {
+            Process_And_Cache_Data(sender_id, block, rssi);
+        }
+        prev_sender = sender_id;
+    }
+}
+
+/* New entry without dedup: readings of a Soldier's batched uplink frame */
+static void Cache_Append_Data(uint32_t uid, uint8_t* payload, int8_t rssi)
+{
     /* 2. INSERT into free slot */
     if (cache_count < CACHE_MAX_ENTRIES) {
         for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
@@ -140,7 +201,9 @@ static void Process_And_Cache_Data(uint32_t uid, uint8_t* payload, int8_t rssi)
     for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
         if (!forest_cache[i].is_active) continue; /* [FIX] skip inactive */
 
-        uint8_t bio_status = (forest_cache[i].payload[10] >> 6) & 0x03;
+        /* Diagnostic frames (byte 15 != 0) carry no bio status */
+        uint8_t bio_status = forest_cache[i].payload[15] ? 0 :
+                             ((forest_cache[i].payload[10] >> 6) & 0x03);
 
         if (forest_cache[i].rssi < fallback_rssi) {
             fallback_rssi = forest_cache[i].rssi;
@@ -573,6 +636,102 @@ TEST(test_cache_eviction_preserves_count) {
     ASSERT_EQ(cache_count, 50);
 }
 
+TEST(test_cache_diag_frame_does_not_replace_telemetry) {
+    reset_cache();
+    uint8_t telemetry[16] = {0}, diag[16] = {0};
+    telemetry[7] = 9;
+    diag[15] = 0xD1; /* FRAME_TYPE_DIAG_HEAP */
+    diag[7] = 0x40;
+    Process_And_Cache_Data(0x77, telemetry, -50);
+    Process_And_Cache_Data(0x77, diag, -50);
+    ASSERT_EQ(cache_count, 2);
+    Process_And_Cache_Data(0x77, diag, -45);
+    ASSERT_EQ(cache_count, 2);
+    ASSERT_EQ(forest_cache[0].payload[7], 9);
+}
+
+TEST(test_cache_cifo_evicts_diag_before_critical) {
+    reset_cache();
+    /* Diagnostic frame whose byte 10 (gc_runs) looks like a critical status */
+    uint8_t diag[16] = {0};
+    diag[10] = 0xC0;
+    diag[15] = 0xD1;
+    Process_And_Cache_Data(0xD1A6, diag, -20);
+
+    uint8_t critical[16] = {0};
+    critical[10] = (1 << 6);
+    for (uint32_t i = 1; i < 50; i++)
+        Process_And_Cache_Data(i + 400, critical, -90);
+
+    Process_And_Cache_Data(0xBEEF, critical, -90);
+
+    int found = 0;
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++)
+        if (forest_cache[i].uid == 0xD1A6) found = 1;
+    ASSERT_EQ(found, 0);
+}
+
+/* One block as the Soldier seals it, decrypted: header mirrors Src and Type */
+static void rx_block(uint8_t* rx, uint8_t b, uint32_t did, uint8_t seq, uint8_t type)
+{
+    uint8_t* hdr = &rx[b * RELAYQ_FRAME_SIZE];
+    memset(hdr, 0, RELAYQ_FRAME_SIZE);
+    hdr[ROUTE_HDR_SRC] = (uint8_t)(did >> 8);
+    hdr[ROUTE_HDR_SRC + 1] = (uint8_t)did;
+    hdr[ROUTE_HDR_TYPE] = type;
+    uint8_t* body = hdr + ROUTE_HDR_SIZE;
+    body[0] = (uint8_t)(did >> 24);
+    body[1] = (uint8_t)(did >> 16);
+    body[2] = (uint8_t)(did >> 8);
+    body[3] = (uint8_t)did;
+    body[9] = 60;                                 /* Seconds since the previous reading */
+    body[14] = seq;
+    body[15] = type;
+}
+
+static int cache_seq_mask(uint32_t did)
+{
+    int seen = 0;
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++)
+        if (forest_cache[i].is_active && forest_cache[i].uid == did)
+            seen |= 1 << forest_cache[i].payload[14];
+    return seen;
+}
+
+TEST(test_cache_batched_readings_kept_apart) {
+    /* A single reading in the cache, then a frame with three readings of the
+     * same Soldier: each reading of the batch, the first too, gets its own entry */
+    reset_cache();
+    uint8_t rx[3 * RELAYQ_FRAME_SIZE];
+    rx_block(rx, 0, 0x55, 1, FRAME_TYPE_TELEMETRY);
+    Cache_Rx_Frame(rx, 1, -70);
+    for (uint8_t b = 0; b < 3; b++) rx_block(rx, b, 0x55, (uint8_t)(2 + b), FRAME_TYPE_TELEMETRY);
+    Cache_Rx_Frame(rx, 3, -60);
+    ASSERT_EQ(cache_count, 4);
+    ASSERT_EQ(cache_seq_mask(0x55), 0x1E);
+}
+
+TEST(test_cache_two_batches_one_flush_window) {
+    /* Two batches of one tree before a flush: none of the six readings is lost;
+     * the second batch heard again via a relay adds nothing */
+    reset_cache();
+    uint8_t rx[4 * RELAYQ_FRAME_SIZE];
+    for (uint8_t b = 0; b < 3; b++) rx_block(rx, b, 0xA0010055, (uint8_t)(1 + b), FRAME_TYPE_TELEMETRY);
+    Cache_Rx_Frame(rx, 3, -60);
+    for (uint8_t b = 0; b < 3; b++) rx_block(rx, b, 0xA0010055, (uint8_t)(4 + b), FRAME_TYPE_TELEMETRY);
+    rx_block(rx, 3, 0xB0020077, 9, FRAME_TYPE_TELEMETRY);     /* Relayed single reading */
+    Cache_Rx_Frame(rx, 4, -60);
+    ASSERT_EQ(cache_count, 7);
+    ASSERT_EQ(cache_seq_mask(0xA0010055), 0x7E);
+    Cache_Rx_Frame(rx, 4, -80);
+    ASSERT_EQ(cache_count, 7);
+    /* A single reading still replaces the tree's previous one */
+    rx_block(rx, 0, 0xB0020077, 10, FRAME_TYPE_TELEMETRY);
+    Cache_Rx_Frame(rx, 1, -60);
+    ASSERT_EQ(cache_count, 7);
+    ASSERT_EQ(cache_seq_mask(0xB0020077), 1 << 10);
+}
+
 /* ════════════════════════════════════════════════════════════════════
  * 4. BATCH PACKING TESTS
  * ════════════════════════════════════════════════════════════════════ */
@@ -1261,6 +1420,10 @@ int main(void)
     RUN(test_cache_rssi_minus128);
     RUN(test_cache_rssi_zero);
     RUN(test_cache_eviction_preserves_count);
+    RUN(test_cache_diag_frame_does_not_replace_telemetry);
+    RUN(test_cache_cifo_evicts_diag_before_critical);
+    RUN(test_cache_batched_readings_kept_apart);
+    RUN(test_cache_two_batches_one_flush_window);
 
     printf("\n  Batch Packing:\n");
     RUN(test_batch_single_21_bytes);
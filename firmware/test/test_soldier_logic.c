@@ -2,8 +2,10 @@
  * test_soldier_logic.c — Comprehensive host-based unit tests for Soldier firmware.
  *
  * Extracts pure-logic functions from firmware/soldier/main.c and tests on x86.
- * Covers: payload packing, DID generation, mesh dedup (anti-pingpong),
+ * Covers: payload packing, DID generation, mesh relay decision (anti-pingpong),
  * OTA chunk assembly with CRC32, bio-contract byte parsing, TTL handling,
+ * execute-in-place flash predicate, A/B contract slot selection, sleep-based RX window,
+ * link aging gated on the energy plan,
  * and all edge cases from the firmware audit (35 bugs found).
  *
  * Build: make -C firmware/test
@@ -14,12 +16,21 @@
 #include <stdint.h>
 
 #include "hal_mock.h"
+#include "silken_energy.h"
+#include "silken_route.h"
+#include "silken_chan.h"
 
 /* ════════════════════════════════════════════════════════════════════
  * CONSTANTS (from soldier/main.c)
  * ════════════════════════════════════════════════════════════════════ */
 #define MRUBY_CONTRACT_FLASH_ADDR  0x0803F000
-#define MESH_DID_CACHE_SIZE        8  /* [FIX] expanded from 3 → 8 */
+#define SOLDIER_FLASH_BASE         0x08000000U
+#define SOLDIER_FLASH_SIZE         (256U * 1024U)
+#define CONTRACT_SLOT_UNSET        0
+#define CONTRACT_SLOT_A            1
+#define CONTRACT_SLOT_B            2
+#define CONTRACT_SLOT_BUILTIN      3
+#define CONTRACT_PROBATION_CYCLES  8
 #define OTA_BUFFER_SIZE            1024
 #define OTA_CHUNK_MAP_SIZE         256
 
@@ -111,36 +122,9 @@ static uint32_t Generate_DID(uint32_t uid0, uint32_t uid1, uint32_t uid2, uint32
     return did;
 }
 
-/* ---------- Mesh dedup ring (anti-pingpong) ---------- */
-static uint32_t mesh_dids[MESH_DID_CACHE_SIZE];
-static uint8_t  mesh_dids_count = 0;
-
-static void Mesh_DID_Cache_Init(void)
-{
-    memset(mesh_dids, 0, sizeof(mesh_dids));
-    mesh_dids_count = 0;
-}
-
-static uint8_t Mesh_DID_Is_Known(uint32_t did)
-{
-    uint8_t limit = mesh_dids_count < MESH_DID_CACHE_SIZE
-                  ? mesh_dids_count : MESH_DID_CACHE_SIZE;
-    for (uint8_t i = 0; i < limit; i++) {
-        if (mesh_dids[i] == did) return 1;
-    }
-    return 0;
-}
-
-static void Mesh_DID_Cache_Push(uint32_t did)
-{
-    /* Shift all entries right by 1, drop the oldest */
-    for (int i = MESH_DID_CACHE_SIZE - 1; i > 0; i--)
-        mesh_dids[i] = mesh_dids[i - 1];
-    mesh_dids[0] = did;
-    if (mesh_dids_count < MESH_DID_CACHE_SIZE)
-        mesh_dids_count++;
-}
-
+/* ---------- Mesh relay decision (anti-pingpong) ----------
+ * The seen-set itself is firmware/common/silken_seen.c, tested with the real
+ * source in test_common_logic.c; here only the order of the checks. */
 /* Full mesh relay decision logic */
 typedef enum {
     MESH_RELAY_OK      = 0,
@@ -152,11 +136,12 @@ typedef enum {
 static MeshRelayResult Mesh_Relay_Decision(
     uint32_t incoming_did,
     uint32_t own_did,
-    uint8_t  incoming_ttl)
+    uint8_t  incoming_ttl,
+    uint8_t  frame_seen)       /* Seen_Check_And_Insert() result */
 {
     if (incoming_ttl == 0) return MESH_RELAY_TTL_ZERO;
     if (incoming_did == own_did) return MESH_RELAY_OWN_ECHO;
-    if (Mesh_DID_Is_Known(incoming_did)) return MESH_RELAY_KNOWN;
+    if (frame_seen) return MESH_RELAY_KNOWN;
     return MESH_RELAY_OK;
 }
 
@@ -453,74 +438,20 @@ TEST(test_did_random_changes_output) {
  * 3. MESH DEDUP (ANTI-PINGPONG) TESTS
  * ════════════════════════════════════════════════════════════════════ */
 
-TEST(test_mesh_empty_cache_unknown) {
-    Mesh_DID_Cache_Init();
-    ASSERT_FALSE(Mesh_DID_Is_Known(0x12345678));
-}
-
-TEST(test_mesh_push_then_known) {
-    Mesh_DID_Cache_Init();
-    Mesh_DID_Cache_Push(0xAAAA);
-    ASSERT_TRUE(Mesh_DID_Is_Known(0xAAAA));
-}
-
-TEST(test_mesh_8_slots_all_known) {
-    Mesh_DID_Cache_Init();
-    for (uint32_t i = 1; i <= MESH_DID_CACHE_SIZE; i++)
-        Mesh_DID_Cache_Push(i * 0x1111);
-    for (uint32_t i = 1; i <= MESH_DID_CACHE_SIZE; i++)
-        ASSERT_TRUE(Mesh_DID_Is_Known(i * 0x1111));
-}
-
-TEST(test_mesh_9th_evicts_oldest) {
-    Mesh_DID_Cache_Init();
-    for (uint32_t i = 1; i <= MESH_DID_CACHE_SIZE; i++)
-        Mesh_DID_Cache_Push(i);
-    /* Push 9th — evicts DID=1 (oldest) */
-    Mesh_DID_Cache_Push(99);
-    ASSERT_FALSE(Mesh_DID_Is_Known(1)); /* evicted */
-    ASSERT_TRUE(Mesh_DID_Is_Known(2));  /* still there */
-    ASSERT_TRUE(Mesh_DID_Is_Known(99)); /* new */
-}
-
-TEST(test_mesh_pingpong_scenario) {
-    /* Two trees A and B keep bouncing a packet.
-     * With only 3 slots (old code), if 3 other DIDs fill the cache,
-     * A's DID gets evicted and the packet bounces infinitely.
-     * With 8 slots, this is prevented for up to 8 unique DIDs. */
-    Mesh_DID_Cache_Init();
-    uint32_t tree_b = 0xBBBB;
-
-    /* Tree A receives from B, caches B */
-    Mesh_DID_Cache_Push(tree_b);
-
-    /* 6 other trees' packets arrive */
-    for (uint32_t i = 0; i < 6; i++)
-        Mesh_DID_Cache_Push(0x1000 + i);
-
-    /* Tree A receives from B again — with 8 slots, B should still be cached */
-    ASSERT_TRUE(Mesh_DID_Is_Known(tree_b));
-}
-
 TEST(test_mesh_relay_own_echo) {
-    Mesh_DID_Cache_Init();
-    ASSERT_EQ(Mesh_Relay_Decision(0xAA, 0xAA, 3), MESH_RELAY_OWN_ECHO);
+    ASSERT_EQ(Mesh_Relay_Decision(0xAA, 0xAA, 3, 0), MESH_RELAY_OWN_ECHO);
 }
 
 TEST(test_mesh_relay_ttl_zero) {
-    Mesh_DID_Cache_Init();
-    ASSERT_EQ(Mesh_Relay_Decision(0xBB, 0xAA, 0), MESH_RELAY_TTL_ZERO);
+    ASSERT_EQ(Mesh_Relay_Decision(0xBB, 0xAA, 0, 0), MESH_RELAY_TTL_ZERO);
 }
 
-TEST(test_mesh_relay_known_did) {
-    Mesh_DID_Cache_Init();
-    Mesh_DID_Cache_Push(0xCC);
-    ASSERT_EQ(Mesh_Relay_Decision(0xCC, 0xAA, 3), MESH_RELAY_KNOWN);
+TEST(test_mesh_relay_known_frame) {
+    ASSERT_EQ(Mesh_Relay_Decision(0xCC, 0xAA, 3, 1), MESH_RELAY_KNOWN);
 }
 
 TEST(test_mesh_relay_ok) {
-    Mesh_DID_Cache_Init();
-    ASSERT_EQ(Mesh_Relay_Decision(0xDD, 0xAA, 3), MESH_RELAY_OK);
+    ASSERT_EQ(Mesh_Relay_Decision(0xDD, 0xAA, 3, 0), MESH_RELAY_OK);
 }
 
 TEST(test_mesh_relay_ttl_decrement) {
@@ -836,6 +767,370 @@ TEST(test_onrxdone_size_zero_rejected) {
     ASSERT_EQ(test_rx_flag, 0);
 }
 
+/* ════════════════════════════════════════════════════════════════════
+ * 9. EXECUTE-IN-PLACE (mrb_ro_data_p) TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Extracted from soldier/main.c: mruby keeps iseq/literals/symbol names in
+ * place only when this predicate says the buffer lives in flash. */
+static int Soldier_Ro_Data_P(uintptr_t addr)
+{
+    return (addr >= SOLDIER_FLASH_BASE) &&
+           (addr < (SOLDIER_FLASH_BASE + SOLDIER_FLASH_SIZE));
+}
+
+TEST(test_xip_ota_contract_slot_is_flash) {
+    ASSERT_TRUE(Soldier_Ro_Data_P(MRUBY_CONTRACT_FLASH_ADDR));
+    /* Whole 4 KB OTA slot up to the last byte of flash */
+    ASSERT_TRUE(Soldier_Ro_Data_P(MRUBY_CONTRACT_FLASH_ADDR + 0xFFF));
+}
+
+TEST(test_xip_builtin_contract_is_flash) {
+    /* .rodata (const lorenz_bytecode[]) is linked into flash */
+    ASSERT_TRUE(Soldier_Ro_Data_P(SOLDIER_FLASH_BASE));
+    ASSERT_TRUE(Soldier_Ro_Data_P(0x08012340U));
+}
+
+TEST(test_xip_sram_is_copied) {
+    /* ota_buffer and other SRAM buffers must be copied onto the heap */
+    ASSERT_FALSE(Soldier_Ro_Data_P(0x20000000U));
+    ASSERT_FALSE(Soldier_Ro_Data_P(0x2000FFFFU));
+}
+
+TEST(test_xip_flash_boundaries) {
+    ASSERT_FALSE(Soldier_Ro_Data_P(SOLDIER_FLASH_BASE - 1));
+    ASSERT_FALSE(Soldier_Ro_Data_P(SOLDIER_FLASH_BASE + SOLDIER_FLASH_SIZE));
+    ASSERT_FALSE(Soldier_Ro_Data_P(0x1FFF7590U)); /* System memory (UID) */
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 10. CONTRACT HOT SWAP (A/B SLOTS) TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Extracted from soldier/main.c */
+static uint8_t Contract_Select_Boot_Slot(uint8_t stored_slot, uint8_t slot_a_valid, uint8_t slot_b_valid)
+{
+    if (stored_slot == CONTRACT_SLOT_A && slot_a_valid) return CONTRACT_SLOT_A;
+    if (stored_slot == CONTRACT_SLOT_B && slot_b_valid) return CONTRACT_SLOT_B;
+    if (stored_slot == CONTRACT_SLOT_BUILTIN) return CONTRACT_SLOT_BUILTIN;
+
+    if (slot_a_valid) return CONTRACT_SLOT_A;
+    if (slot_b_valid) return CONTRACT_SLOT_B;
+    return CONTRACT_SLOT_BUILTIN;
+}
+
+static uint8_t Contract_Inactive_Slot(uint8_t active_slot)
+{
+    return (active_slot == CONTRACT_SLOT_A) ? CONTRACT_SLOT_B : CONTRACT_SLOT_A;
+}
+
+TEST(test_contract_boot_stored_slot_wins) {
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_B, 1, 1), CONTRACT_SLOT_B);
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_A, 1, 1), CONTRACT_SLOT_A);
+}
+
+TEST(test_contract_boot_unset_legacy_order) {
+    /* Backup domain reset: same behaviour as before A/B slots */
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_UNSET, 1, 1), CONTRACT_SLOT_A);
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_UNSET, 0, 1), CONTRACT_SLOT_B);
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_UNSET, 0, 0), CONTRACT_SLOT_BUILTIN);
+}
+
+TEST(test_contract_boot_erased_slot_skipped) {
+    /* Stored slot lost its RITE header (erase interrupted by brownout) */
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_B, 1, 0), CONTRACT_SLOT_A);
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_A, 0, 0), CONTRACT_SLOT_BUILTIN);
+}
+
+TEST(test_contract_boot_builtin_after_rollback) {
+    /* Rolled back to built-in: a failing OTA contract in flash is not revived */
+    ASSERT_EQ(Contract_Select_Boot_Slot(CONTRACT_SLOT_BUILTIN, 1, 1), CONTRACT_SLOT_BUILTIN);
+}
+
+TEST(test_contract_boot_garbage_register) {
+    ASSERT_EQ(Contract_Select_Boot_Slot(0xA7, 0, 1), CONTRACT_SLOT_B);
+}
+
+TEST(test_contract_ota_never_targets_active_slot) {
+    ASSERT_EQ(Contract_Inactive_Slot(CONTRACT_SLOT_A), CONTRACT_SLOT_B);
+    ASSERT_EQ(Contract_Inactive_Slot(CONTRACT_SLOT_B), CONTRACT_SLOT_A);
+    ASSERT_EQ(Contract_Inactive_Slot(CONTRACT_SLOT_BUILTIN), CONTRACT_SLOT_A);
+}
+
+TEST(test_contract_ota_alternates) {
+    uint8_t slot = CONTRACT_SLOT_BUILTIN;
+    slot = Contract_Inactive_Slot(slot);
+    ASSERT_EQ(slot, CONTRACT_SLOT_A);
+    slot = Contract_Inactive_Slot(slot);
+    ASSERT_EQ(slot, CONTRACT_SLOT_B);
+    slot = Contract_Inactive_Slot(slot);
+    ASSERT_EQ(slot, CONTRACT_SLOT_A);
+}
+
+/* Slot bookkeeping of Contract_Hot_Swap and the Phase 3 probation, extracted
+ * from soldier/main.c. dr16 is RTC_BKP_DR16 — the only field a reset keeps. */
+typedef struct {
+    uint8_t slot;                 /* contract_slot */
+    uint8_t fallback;             /* fallback_slot, valid while has_fallback */
+    uint8_t has_fallback;         /* fallback_vm != NULL */
+    uint8_t committed;            /* contract_committed_slot */
+    uint8_t probation;
+    uint8_t dr16;
+} ContractSlots;
+
+static void contract_reset(ContractSlots* c, uint8_t slot_a_valid, uint8_t slot_b_valid)
+{
+    uint8_t dr16 = c->dr16;
+    memset(c, 0, sizeof(*c));
+    c->slot = Contract_Select_Boot_Slot(dr16, slot_a_valid, slot_b_valid);
+    c->committed = c->slot;
+    c->dr16 = c->committed;
+}
+
+static void contract_hot_swap(ContractSlots* c, uint8_t target_slot)
+{
+    if (target_slot == c->committed) {
+        c->committed = CONTRACT_SLOT_BUILTIN;
+        c->dr16 = c->committed;
+    }
+    c->fallback = c->slot;
+    c->has_fallback = 1;
+    c->slot = target_slot;
+    c->probation = 0;
+}
+
+static void contract_wake(ContractSlots* c, uint8_t contract_ok)
+{
+    if (!contract_ok && c->has_fallback) {
+        c->slot = c->fallback;
+        c->probation = 0;
+        c->has_fallback = 0;
+    } else if (contract_ok && c->slot != c->committed &&
+               ++c->probation >= CONTRACT_PROBATION_CYCLES) {
+        c->has_fallback = 0;
+        c->committed = c->slot;
+        c->dr16 = c->committed;
+    }
+}
+
+TEST(test_contract_reset_during_probation_boots_old_slot) {
+    ContractSlots c = { .dr16 = CONTRACT_SLOT_A };
+    contract_reset(&c, 1, 0);
+    contract_hot_swap(&c, Contract_Inactive_Slot(c.slot));
+    ASSERT_EQ(c.slot, CONTRACT_SLOT_B);
+    ASSERT_EQ(c.dr16, CONTRACT_SLOT_A);              /* Not yet proven */
+    for (int i = 0; i < CONTRACT_PROBATION_CYCLES - 1; i++) contract_wake(&c, 1);
+    ASSERT_EQ(c.dr16, CONTRACT_SLOT_A);
+    contract_reset(&c, 1, 1);                        /* Hang → IWDG one wake short */
+    ASSERT_EQ(c.slot, CONTRACT_SLOT_A);
+}
+
+TEST(test_contract_probation_commits_new_slot) {
+    ContractSlots c = { .dr16 = CONTRACT_SLOT_A };
+    contract_reset(&c, 1, 0);
+    contract_hot_swap(&c, CONTRACT_SLOT_B);
+    for (int i = 0; i < CONTRACT_PROBATION_CYCLES; i++) contract_wake(&c, 1);
+    ASSERT_EQ(c.dr16, CONTRACT_SLOT_B);
+    ASSERT_EQ(c.has_fallback, 0);
+    contract_reset(&c, 1, 1);
+    ASSERT_EQ(c.slot, CONTRACT_SLOT_B);
+}
+
+TEST(test_contract_exception_rolls_back_without_touching_dr16) {
+    ContractSlots c = { .dr16 = CONTRACT_SLOT_B };
+    contract_reset(&c, 1, 1);
+    contract_hot_swap(&c, CONTRACT_SLOT_A);
+    contract_wake(&c, 1);
+    contract_wake(&c, 0);                            /* New contract raised */
+    ASSERT_EQ(c.slot, CONTRACT_SLOT_B);
+    ASSERT_EQ(c.dr16, CONTRACT_SLOT_B);
+    for (int i = 0; i < 2 * CONTRACT_PROBATION_CYCLES; i++) contract_wake(&c, 1);
+    ASSERT_EQ(c.dr16, CONTRACT_SLOT_B);
+}
+
+TEST(test_contract_ota_during_probation_boots_builtin) {
+    /* The second image overwrites the proven slot: neither A nor B is proven */
+    ContractSlots c = { .dr16 = CONTRACT_SLOT_A };
+    contract_reset(&c, 1, 0);
+    contract_hot_swap(&c, CONTRACT_SLOT_B);
+    contract_wake(&c, 1);
+    contract_hot_swap(&c, Contract_Inactive_Slot(c.slot));
+    ASSERT_EQ(c.slot, CONTRACT_SLOT_A);
+    ASSERT_EQ(c.dr16, CONTRACT_SLOT_BUILTIN);
+    contract_reset(&c, 1, 1);
+    ASSERT_EQ(c.slot, CONTRACT_SLOT_BUILTIN);
+    contract_hot_swap(&c, CONTRACT_SLOT_A);
+    for (int i = 0; i < CONTRACT_PROBATION_CYCLES; i++) contract_wake(&c, 1);
+    ASSERT_EQ(c.dr16, CONTRACT_SLOT_A);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 11. SLEEP-BASED RX WINDOW TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+#define LORA_RX_TIMEOUT_MS         500
+#define LORA_RX_LOOP_MS            600
+#define LPTIM_LSE_HZ               32768U
+#define RX_DEADLINE_LPTIM_TICKS    ((LORA_RX_LOOP_MS * LPTIM_LSE_HZ) / 1000U)
+
+/* Wake sources while the core is in STOP1 */
+typedef enum { RX_EV_RX_DONE, RX_EV_RX_TIMEOUT, RX_EV_RX_ERROR, RX_EV_LPTIM, RX_EV_PIEZO } RxEvent;
+
+static volatile uint8_t t_rx_flag, t_rx_closed;
+static const RxEvent* t_events;
+static int t_event_idx, t_stop1_entries;
+
+/* ISR side: RadioEvents_t callbacks, HAL_LPTIM_CompareMatchCallback, EXTI */
+static void rx_fire_event(RxEvent ev)
+{
+    if (ev == RX_EV_RX_DONE) t_rx_flag = 1;
+    else if (ev != RX_EV_PIEZO) t_rx_closed = 1;
+}
+
+/* Extracted from soldier/main.c Rx_Sleep_Until_Event(): STOP1 only if nothing is pending */
+static void Rx_Sleep_Until_Event(void)
+{
+    if (!t_rx_flag && !t_rx_closed) {
+        t_stop1_entries++;
+        rx_fire_event(t_events[t_event_idx++]); /* WFI returns on the next IRQ */
+    }
+}
+
+/* Phase 4.5 wait loop: 1 — packet to process, 0 — window closed */
+static int rx_wait_loop(const RxEvent* script)
+{
+    t_events = script;
+    t_event_idx = 0;
+    t_stop1_entries = 0;
+    while (1) {
+        Rx_Sleep_Until_Event();
+        if (t_rx_flag == 1) return 1;
+        if (t_rx_closed) return 0;
+    }
+}
+
+static void rx_reset(void) { t_rx_flag = 0; t_rx_closed = 0; }
+
+TEST(test_rx_deadline_after_radio_timeout) {
+    ASSERT_EQ(RX_DEADLINE_LPTIM_TICKS, 19660);
+    /* LPTIM is only a backstop: the radio RxTimeout (500 ms) fires first */
+    ASSERT_TRUE(RX_DEADLINE_LPTIM_TICKS > (LORA_RX_TIMEOUT_MS * LPTIM_LSE_HZ) / 1000U);
+    ASSERT_TRUE(RX_DEADLINE_LPTIM_TICKS <= 0xFFFF); /* 16-bit LPTIM compare */
+}
+
+TEST(test_rx_packet_wakes_once) {
+    static const RxEvent script[] = { RX_EV_RX_DONE };
+    rx_reset();
+    ASSERT_EQ(rx_wait_loop(script), 1);
+    ASSERT_EQ(t_stop1_entries, 1);
+}
+
+TEST(test_rx_silence_closes_window) {
+    static const RxEvent timeout[] = { RX_EV_RX_TIMEOUT };
+    static const RxEvent error[] = { RX_EV_RX_ERROR };
+    static const RxEvent deadline[] = { RX_EV_LPTIM };
+    rx_reset();
+    ASSERT_EQ(rx_wait_loop(timeout), 0);
+    rx_reset();
+    ASSERT_EQ(rx_wait_loop(error), 0);
+    rx_reset();
+    ASSERT_EQ(rx_wait_loop(deadline), 0);
+}
+
+TEST(test_rx_foreign_irq_sleeps_again) {
+    static const RxEvent script[] = { RX_EV_PIEZO, RX_EV_PIEZO, RX_EV_RX_DONE };
+    rx_reset();
+    ASSERT_EQ(rx_wait_loop(script), 1);
+    ASSERT_EQ(t_stop1_entries, 3);
+}
+
+TEST(test_rx_pending_packet_skips_stop1) {
+    /* RxDone raced in between Radio.Rx() and the first WFI */
+    static const RxEvent script[] = { RX_EV_RX_TIMEOUT };
+    rx_reset();
+    t_rx_flag = 1;
+    ASSERT_EQ(rx_wait_loop(script), 1);
+    ASSERT_EQ(t_stop1_entries, 0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ * 12. LINK AGING TESTS
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Extracted from soldier/main.c Phase 1: links age only on wakes that open
+ * an RX window (Phase 4.5) — a node that did not listen could hear nobody */
+static uint8_t Soldier_Link_Tick(const EnergyPlan* plan, RouteState* route, ChanState* chan)
+{
+    if (plan->listen) Route_Tick(route);
+    if (plan->listen && Chan_Tick(chan)) {
+        Route_Init(route);
+        return 1;                         /* Radio.SetChannel on the next channel */
+    }
+    return 0;
+}
+
+static void starved_plan(EnergyPlan* plan)
+{
+    EnergyState st;
+    Energy_Init(&st);
+    st.last_vcap_mv = 2410;               /* At the reserve, no harvest */
+    st.initialized = 2;
+    Energy_Plan(&st, plan);
+}
+
+TEST(test_link_starved_node_keeps_route) {
+    EnergyPlan plan;
+    RouteState route;
+    ChanState chan;
+    starved_plan(&plan);
+    ASSERT_EQ(plan.listen, 0);
+    Route_Init(&route);
+    Route_On_Heard(&route, 1, -80);
+    Chan_Init(&chan);
+    for (int i = 0; i < 3 * ROUTE_STALE_WAKES; i++) Soldier_Link_Tick(&plan, &route, &chan);
+    ASSERT_EQ(route.hop, 2);              /* Never listened: nothing went stale */
+}
+
+TEST(test_link_listening_node_forgets_route) {
+    EnergyPlan plan;
+    RouteState route;
+    ChanState chan;
+    memset(&plan, 0, sizeof(plan));
+    plan.listen = 1;
+    Route_Init(&route);
+    Route_On_Heard(&route, 1, -80);
+    Chan_Restore(&chan, 3);
+    for (int i = 0; i < ROUTE_STALE_WAKES; i++) ASSERT_EQ(Soldier_Link_Tick(&plan, &route, &chan), 0);
+    ASSERT_EQ(route.hop, ROUTE_HOP_UNKNOWN); /* Listened and heard nobody */
+}
+
+TEST(test_link_starved_node_keeps_locked_channel) {
+    EnergyPlan plan;
+    RouteState route;
+    ChanState chan;
+    starved_plan(&plan);
+    Route_Init(&route);
+    Chan_Restore(&chan, 3);               /* Locked on channel 2 before the reset */
+    for (int i = 0; i < 3 * CHAN_LOST_WAKES; i++) ASSERT_EQ(Soldier_Link_Tick(&plan, &route, &chan), 0);
+    ASSERT_EQ(chan.ch, 2);
+    ASSERT_EQ(chan.locked, 1);
+    ASSERT_EQ(chan.quiet, 0);
+}
+
+TEST(test_link_listening_node_leaves_silent_channel) {
+    EnergyPlan plan;
+    RouteState route;
+    ChanState chan;
+    memset(&plan, 0, sizeof(plan));
+    plan.listen = 1;
+    Route_Init(&route);
+    Chan_Restore(&chan, 3);
+    for (int i = 1; i < CHAN_LOST_WAKES; i++) ASSERT_EQ(Soldier_Link_Tick(&plan, &route, &chan), 0);
+    ASSERT_EQ(Soldier_Link_Tick(&plan, &route, &chan), 1);  /* Heard nobody: scan */
+    ASSERT_EQ(chan.ch, 3 % CHAN_COUNT);
+    ASSERT_EQ(chan.locked, 0);
+}
+
 /* ════════════════════════════════════════════════════════════════════
  * ENTRY POINT
  * ════════════════════════════════════════════════════════════════════ */
@@ -867,14 +1162,9 @@ int main(void)
     RUN(test_did_random_changes_output);
 
     printf("\n  Mesh Dedup (Anti-Pingpong):\n");
-    RUN(test_mesh_empty_cache_unknown);
-    RUN(test_mesh_push_then_known);
-    RUN(test_mesh_8_slots_all_known);
-    RUN(test_mesh_9th_evicts_oldest);
-    RUN(test_mesh_pingpong_scenario);
     RUN(test_mesh_relay_own_echo);
     RUN(test_mesh_relay_ttl_zero);
-    RUN(test_mesh_relay_known_did);
+    RUN(test_mesh_relay_known_frame);
     RUN(test_mesh_relay_ok);
     RUN(test_mesh_relay_ttl_decrement);
 
@@ -919,6 +1209,38 @@ int main(void)
     RUN(test_onrxdone_size_257_rejected);
     RUN(test_onrxdone_size_zero_rejected);
 
+    printf("\n  Execute-In-Place (mrb_ro_data_p):\n");
+    RUN(test_xip_ota_contract_slot_is_flash);
+    RUN(test_xip_builtin_contract_is_flash);
+    RUN(test_xip_sram_is_copied);
+    RUN(test_xip_flash_boundaries);
+
+    printf("\n  Contract Hot Swap (A/B Slots):\n");
+    RUN(test_contract_boot_stored_slot_wins);
+    RUN(test_contract_boot_unset_legacy_order);
+    RUN(test_contract_boot_erased_slot_skipped);
+    RUN(test_contract_boot_builtin_after_rollback);
+    RUN(test_contract_boot_garbage_register);
+    RUN(test_contract_ota_never_targets_active_slot);
+    RUN(test_contract_ota_alternates);
+    RUN(test_contract_reset_during_probation_boots_old_slot);
+    RUN(test_contract_probation_commits_new_slot);
+    RUN(test_contract_exception_rolls_back_without_touching_dr16);
+    RUN(test_contract_ota_during_probation_boots_builtin);
+
+    printf("\n  Sleep-Based RX Window:\n");
+    RUN(test_rx_deadline_after_radio_timeout);
+    RUN(test_rx_packet_wakes_once);
+    RUN(test_rx_silence_closes_window);
+    RUN(test_rx_foreign_irq_sleeps_again);
+    RUN(test_rx_pending_packet_skips_stop1);
+
+    printf("\n  Link Aging:\n");
+    RUN(test_link_starved_node_keeps_route);
+    RUN(test_link_listening_node_forgets_route);
+    RUN(test_link_starved_node_keeps_locked_channel);
+    RUN(test_link_listening_node_leaves_silent_channel);
+
     printf("\n══════════════════════════════════════════════════════════════\n");
     printf("  Results: %d passed, %d failed\n\n", tests_passed, tests_failed);
     return tests_failed > 0 ? 1 : 0;
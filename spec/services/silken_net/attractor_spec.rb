@@ -45,6 +45,38 @@ RSpec.describe SilkenNet::Attractor do
     end
   end
 
+  describe ".calculate_z_q16" do
+    # Ті самі golden vectors, що й у firmware/test/test_common_logic.c:
+    # розбіжність = Солдат і сервер виносять різні вироки.
+    golden = [
+      [ 0, 22, 5, 2_484_669 ],
+      [ 42, -15, 0, 758_431 ],
+      [ 123_456, 0, 255, 766_701 ],
+      [ 0xDEADBEEF, 50, 10, 2_542_632 ],
+      [ 0xFFFFFFFF, -128, 3, 550_892 ],
+      [ 1, 127, 500, 1_839_846 ],
+      [ 99_999, 20, 0, 955_932 ]
+    ]
+
+    golden.each do |seed, temp, acoustic, z_q16|
+      it "matches the firmware golden vector for seed=#{seed}, temp=#{temp}, acoustic=#{acoustic}" do
+        expect(described_class.calculate_z_q16(seed, temp, acoustic)).to eq(z_q16)
+      end
+    end
+
+    it "rounds calibrated Float temperature to whole degrees like the int8 payload byte" do
+      expect(described_class.calculate_z_q16(42, 21.6, 5)).to eq(described_class.calculate_z_q16(42, 22, 5))
+    end
+
+    it "wraps seeds to uint32 like the firmware" do
+      expect(described_class.calculate_z_q16(2**32 + 42, 22, 5)).to eq(described_class.calculate_z_q16(42, 22, 5))
+    end
+
+    it "converts to the Float returned by .calculate_z" do
+      expect(described_class.calculate_z(0, 22, 5)).to eq((2_484_669 / 65_536.0).round(4))
+    end
+  end
+
   describe ".homeostatic?" do
     it "returns true when z_value is within family bounds" do
       family = build(:tree_family, critical_z_min: 5.0, critical_z_max: 45.0)
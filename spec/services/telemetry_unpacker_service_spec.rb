@@ -52,6 +52,14 @@ RSpec.describe TelemetryUnpackerService, type: :service do
     expect(log.mesh_ttl).to eq(3)
   end
 
+  it "strips the mesh hop nibble from the TTL byte" do
+    chunk = build_chunk(did_hex, -70, 3500, 25, 5, 100, 0, 0x23)
+
+    described_class.call(chunk)
+
+    expect(TelemetryLog.last.mesh_ttl).to eq(3)
+  end
+
   it "rejects sensor data outside safe voltage range" do
     chunk = build_chunk(did_hex, -70, 5001, 25, 5, 100, 0, 3)
 
@@ -122,6 +130,51 @@ RSpec.describe TelemetryUnpackerService, type: :service do
     end
   end
 
+  describe "diagnostic frame routing" do
+    # Heap frame (firmware/common/silken_diag.h): byte 15 = 0xD1
+    def build_heap_chunk(did_hex, peak:, carved:, allocs:, gc_runs:, failed:)
+      did_int = did_hex.to_i(16)
+      payload = [ did_int, peak, carved, allocs, gc_runs, 3, 1, failed, 0xD1 ].pack("N n n n C C n C C")
+      [ did_int ].pack("N") + [ 70 ].pack("C") + payload
+    end
+
+    it "logs heap diagnostics without creating a telemetry log" do
+      allow(Rails.logger).to receive(:info)
+      chunk = build_heap_chunk(did_hex, peak: 18_432, carved: 20_480, allocs: 1200, gc_runs: 4, failed: 0)
+
+      expect { described_class.call(chunk) }.not_to change(TelemetryLog, :count)
+      expect(Rails.logger).to have_received(:info).with(/Heap.*#{extracted_did}.*18432B.*20480B.*GC 4/)
+    end
+
+    it "does not credit the wallet from diagnostic frames" do
+      chunk = build_heap_chunk(did_hex, peak: 100, carved: 100, allocs: 1, gc_runs: 63, failed: 0)
+
+      expect { described_class.call(chunk) }.not_to change { tree.wallet.reload.balance }
+    end
+
+    it "logs phase profile frames in microseconds" do
+      allow(Rails.logger).to receive(:info)
+      did_int = did_hex.to_i(16)
+      # Phase 2 (mruby): min 10, max 250, EWMA 40 ticks of 16 µs
+      payload = [ did_int, 2, 10, 250, 40, 3, 1, 17, 0xD2 ].pack("N C n n n C n C C")
+      chunk = [ did_int ].pack("N") + [ 70 ].pack("C") + payload
+
+      expect { described_class.call(chunk) }.not_to change(TelemetryLog, :count)
+      expect(Rails.logger).to have_received(:info).with(/Profile.*#{extracted_did}.*mruby.*min 160µs.*max 4000µs.*EWMA 640µs.*17/)
+    end
+
+    it "logs listen-before-talk radio frames" do
+      allow(Rails.logger).to receive(:info)
+      did_int = did_hex.to_i(16)
+      # 120 CAD, 30 busy, 25 × 100 ms backoff, 2 forced TX, longest streak 4
+      payload = [ did_int, 120, 30, 25, 2, 3, 1, 4, 0xD3 ].pack("N n n n C C n C C")
+      chunk = [ did_int ].pack("N") + [ 70 ].pack("C") + payload
+
+      expect { described_class.call(chunk) }.not_to change(TelemetryLog, :count)
+      expect(Rails.logger).to have_received(:info).with(/LBT.*#{extracted_did}.*CAD 120.*зайнято 30.*backoff 2.5s.*примусових TX 2.*серія 4/)
+    end
+  end
+
   describe "interpret_status" do
     it "maps status codes 1, 2, 3 to stress, anomaly, tamper_detected" do
       # Status byte upper 2 bits: code = status_byte >> 6